@@ -29,7 +29,7 @@ class websocket_session : public boost::enable_shared_from_this<websocket_sessio
     beast::flat_buffer buffer_;
     websocket::stream<beast::tcp_stream> ws_;
     boost::shared_ptr<shared_state> state_;
-    std::vector<boost::shared_ptr<std::string const>> queue_;
+    std::vector<websocket::prepared_message> queue_;
 
     void fail(beast::error_code ec, char const* what);
     void on_accept(beast::error_code ec);
@@ -49,11 +49,11 @@ public:
 
     // Send a message
     void
-    send(boost::shared_ptr<std::string const> const& ss);
+    send(websocket::prepared_message const& pm);
 
 private:
     void
-    on_send(boost::shared_ptr<std::string const> const& ss);
+    on_send(websocket::prepared_message const& pm);
 };
 
 template<class Body, class Allocator>
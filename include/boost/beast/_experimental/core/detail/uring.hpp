@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_DETAIL_URING_HPP
+#define BOOST_BEAST_CORE_DETAIL_URING_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+
+// io_uring is used when the kernel headers are recent enough
+// to describe cancellation by file descriptor (Linux 5.19).
+#if ! defined(BOOST_BEAST_USE_IO_URING)
+# if defined(__linux__) && defined(__has_include)
+#  if __has_include(<linux/io_uring.h>)
+#   include <linux/io_uring.h>
+#   if defined(IORING_ASYNC_CANCEL_FD)
+#    define BOOST_BEAST_USE_IO_URING 1
+#   endif
+#  endif
+# endif
+#endif
+#if ! defined(BOOST_BEAST_USE_IO_URING)
+# define BOOST_BEAST_USE_IO_URING 0
+#endif
+
+#if BOOST_BEAST_USE_IO_URING
+
+#include <boost/beast/core/error.hpp>
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+/*  A minimal io_uring instance, driven with raw system calls.
+
+    The caller provides all synchronization.
+*/
+class uring
+{
+    int fd_ = -1;
+    unsigned features_ = 0;
+
+    void* sq_ring_ = nullptr;
+    std::size_t sq_ring_size_ = 0;
+    void* cq_ring_ = nullptr;
+    std::size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sq_local_tail_ = 0;
+    unsigned to_submit_ = 0;
+
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    bool buffers_ = false;
+
+public:
+    uring() = default;
+    uring(uring const&) = delete;
+    uring& operator=(uring const&) = delete;
+
+    ~uring()
+    {
+        close();
+    }
+
+    bool
+    is_open() const noexcept
+    {
+        return fd_ != -1;
+    }
+
+    // Number of entries placed but not yet submitted
+    unsigned
+    unsubmitted() const noexcept
+    {
+        return to_submit_;
+    }
+
+    BOOST_BEAST_DECL
+    void
+    open(unsigned entries, error_code& ec);
+
+    BOOST_BEAST_DECL
+    void
+    close() noexcept;
+
+    // Returns a cleared submission entry, or nullptr if the
+    // submission queue is full. The entry is submitted by
+    // the next call to submit.
+    BOOST_BEAST_DECL
+    io_uring_sqe*
+    get_sqe() noexcept;
+
+    // Submit pending entries, and optionally wait
+    // until at least `wait_nr` completions are ready.
+    BOOST_BEAST_DECL
+    void
+    submit(unsigned wait_nr, error_code& ec);
+
+    // Signal `efd` whenever a completion is posted
+    BOOST_BEAST_DECL
+    void
+    register_eventfd(int efd, error_code& ec);
+
+    // Replace the table of registered buffers
+    BOOST_BEAST_DECL
+    void
+    register_buffers(
+        iovec const* v, unsigned n, error_code& ec);
+
+    // Invoke f(user_data, res) for each completion,
+    // returning the number of completions consumed.
+    template<class F>
+    std::size_t
+    reap(F&& f)
+    {
+        auto head = *cq_head_;
+        auto const tail = __atomic_load_n(
+            cq_tail_, __ATOMIC_ACQUIRE);
+        std::size_t n = 0;
+        for(; head != tail; ++head, ++n)
+        {
+            auto const& cqe = cqes_[head & cq_mask_];
+            f(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return n;
+    }
+};
+
+} // detail
+} // beast
+} // boost
+
+#if BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/core/detail/uring.ipp>
+#endif
+
+#endif
+
+#endif
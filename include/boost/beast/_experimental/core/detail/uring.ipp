@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_DETAIL_URING_IPP
+#define BOOST_BEAST_CORE_DETAIL_URING_IPP
+
+#include <boost/beast/_experimental/core/detail/uring.hpp>
+
+#if BOOST_BEAST_USE_IO_URING
+
+#include <cstring>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+void
+uring::
+open(unsigned entries, error_code& ec)
+{
+    close();
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CLAMP;
+    int const fd = static_cast<int>(::syscall(
+        __NR_io_uring_setup, entries, &p));
+    if(fd < 0)
+    {
+        ec.assign(errno, system_category());
+        return;
+    }
+    fd_ = fd;
+    features_ = p.features;
+
+    sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    if(features_ & IORING_FEAT_SINGLE_MMAP)
+    {
+        if(cq_ring_size_ > sq_ring_size_)
+            sq_ring_size_ = cq_ring_size_;
+        cq_ring_size_ = sq_ring_size_;
+    }
+    auto const map =
+        [&](std::size_t size, off_t offset) -> void*
+        {
+            auto const q = ::mmap(nullptr, size,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                fd_, offset);
+            if(q == MAP_FAILED)
+            {
+                ec.assign(errno, system_category());
+                return nullptr;
+            }
+            return q;
+        };
+    sq_ring_ = map(sq_ring_size_, IORING_OFF_SQ_RING);
+    if(! sq_ring_)
+        return close();
+    if(features_ & IORING_FEAT_SINGLE_MMAP)
+    {
+        cq_ring_ = sq_ring_;
+    }
+    else
+    {
+        cq_ring_ = map(cq_ring_size_, IORING_OFF_CQ_RING);
+        if(! cq_ring_)
+            return close();
+    }
+    sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(
+        map(sqes_size_, IORING_OFF_SQES));
+    if(! sqes_)
+        return close();
+
+    auto const sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_entries_ = p.sq_entries;
+    sq_local_tail_ = *sq_tail_;
+    to_submit_ = 0;
+
+    auto const cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    ec = {};
+}
+
+void
+uring::
+close() noexcept
+{
+    if(sqes_)
+        ::munmap(sqes_, sqes_size_);
+    if(cq_ring_ && cq_ring_ != sq_ring_)
+        ::munmap(cq_ring_, cq_ring_size_);
+    if(sq_ring_)
+        ::munmap(sq_ring_, sq_ring_size_);
+    sqes_ = nullptr;
+    cq_ring_ = nullptr;
+    sq_ring_ = nullptr;
+    if(fd_ != -1)
+        ::close(fd_);
+    fd_ = -1;
+    buffers_ = false;
+}
+
+io_uring_sqe*
+uring::
+get_sqe() noexcept
+{
+    auto const head = __atomic_load_n(
+        sq_head_, __ATOMIC_ACQUIRE);
+    if(sq_local_tail_ - head >= sq_entries_)
+        return nullptr;
+    auto const i = sq_local_tail_ & sq_mask_;
+    auto const sqe = &sqes_[i];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[i] = i;
+    ++sq_local_tail_;
+    ++to_submit_;
+    return sqe;
+}
+
+void
+uring::
+submit(unsigned wait_nr, error_code& ec)
+{
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    unsigned const flags =
+        wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    for(;;)
+    {
+        auto const n = ::syscall(__NR_io_uring_enter,
+            fd_, to_submit_, wait_nr, flags, nullptr, 0);
+        if(n >= 0)
+        {
+            to_submit_ -= static_cast<unsigned>(n);
+            if(to_submit_ == 0 || wait_nr > 0)
+                break;
+            continue;
+        }
+        if(errno != EINTR)
+        {
+            ec.assign(errno, system_category());
+            return;
+        }
+    }
+    ec = {};
+}
+
+void
+uring::
+register_eventfd(int efd, error_code& ec)
+{
+    if(::syscall(__NR_io_uring_register, fd_,
+        IORING_REGISTER_EVENTFD, &efd, 1) != 0)
+    {
+        ec.assign(errno, system_category());
+        return;
+    }
+    ec = {};
+}
+
+void
+uring::
+register_buffers(
+    iovec const* v, unsigned n, error_code& ec)
+{
+    if(buffers_)
+    {
+        ::syscall(__NR_io_uring_register, fd_,
+            IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        buffers_ = false;
+    }
+    if(n > 0)
+    {
+        if(::syscall(__NR_io_uring_register, fd_,
+            IORING_REGISTER_BUFFERS, v, n) != 0)
+        {
+            ec.assign(errno, system_category());
+            return;
+        }
+        buffers_ = true;
+    }
+    ec = {};
+}
+
+} // detail
+} // beast
+} // boost
+
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_DETAIL_URING_SERVICE_HPP
+#define BOOST_BEAST_CORE_DETAIL_URING_SERVICE_HPP
+
+#include <boost/beast/_experimental/core/detail/uring.hpp>
+
+#if BOOST_BEAST_USE_IO_URING
+
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/detail/service_base.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+// An operation submitted to the ring
+class uring_op
+{
+    friend class uring_service;
+
+    uring_op* prev_ = nullptr;
+    uring_op* next_ = nullptr;
+
+public:
+    // Called with the result of the operation.
+    // The implementation deletes the object.
+    virtual void on_complete(int res) = 0;
+
+    // Called to destroy the operation without completing it
+    virtual void destroy() = 0;
+
+protected:
+    ~uring_op() = default;
+};
+
+/*  One io_uring per io_context.
+
+    Submission entries placed during one turn of the io_context
+    are submitted together with a single system call. Completions
+    are signaled through an eventfd which is waited on with the
+    io_context's own reactor, and are read directly from the
+    completion queue in shared memory.
+*/
+class uring_service
+    : public beast::detail::service_base<uring_service>
+{
+    struct flush_op
+    {
+        uring_service* svc;
+
+        void
+        operator()() const
+        {
+            svc->flush();
+        }
+    };
+
+    struct event_op
+    {
+        uring_service* svc;
+
+        void
+        operator()(error_code ec, std::size_t) const
+        {
+            svc->on_event(ec);
+        }
+    };
+
+    net::io_context& ioc_;
+    std::mutex m_;
+    uring ring_;
+    net::posix::stream_descriptor ev_;
+    std::uint64_t ev_value_ = 0;
+    uring_op* list_ = nullptr;      // outstanding operations
+    std::size_t outstanding_ = 0;
+    bool waiting_ = false;          // eventfd read pending
+    bool flushing_ = false;         // flush posted
+    std::vector<iovec> buffers_;
+
+    BOOST_BEAST_DECL
+    void
+    shutdown() override;
+
+    BOOST_BEAST_DECL
+    void
+    flush();
+
+    BOOST_BEAST_DECL
+    void
+    on_event(error_code ec);
+
+    BOOST_BEAST_DECL
+    io_uring_sqe*
+    get_sqe();
+
+public:
+    BOOST_BEAST_DECL
+    explicit
+    uring_service(net::io_context& ioc);
+
+    // Returns `true` if io_uring is usable on this system
+    bool
+    is_open() const noexcept
+    {
+        return ring_.is_open();
+    }
+
+    /*  Start an operation.
+
+        `prep` fills in the submission entry, and is called
+        while the service is locked. The entry is submitted
+        when the io_context next runs a handler queued after
+        this call.
+    */
+    template<class Prep>
+    void
+    start(uring_op* op, Prep const& prep)
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        auto const sqe = get_sqe();
+        prep(*sqe);
+        sqe->user_data = reinterpret_cast<std::uintptr_t>(op);
+        op->prev_ = nullptr;
+        op->next_ = list_;
+        if(list_)
+            list_->prev_ = op;
+        list_ = op;
+        ++outstanding_;
+    }
+
+    // Cancel all operations on the file descriptor
+    BOOST_BEAST_DECL
+    void
+    cancel(int fd);
+
+    // Returns the index of the registered buffer which
+    // contains the buffer, or -1 if there is none. This
+    // may only be called from the `prep` function.
+    BOOST_BEAST_DECL
+    int
+    find_buffer(void const* data, std::size_t size);
+
+    // Add a buffer to the registered buffers
+    BOOST_BEAST_DECL
+    void
+    register_buffer(net::mutable_buffer b, error_code& ec);
+
+    // Remove every registered buffer
+    BOOST_BEAST_DECL
+    void
+    unregister_buffers();
+};
+
+} // detail
+} // beast
+} // boost
+
+#if BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/core/detail/uring_service.ipp>
+#endif
+
+#endif
+
+#endif
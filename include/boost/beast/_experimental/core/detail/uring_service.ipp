@@ -0,0 +1,236 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_DETAIL_URING_SERVICE_IPP
+#define BOOST_BEAST_CORE_DETAIL_URING_SERVICE_IPP
+
+#include <boost/beast/_experimental/core/detail/uring_service.hpp>
+
+#if BOOST_BEAST_USE_IO_URING
+
+#include <boost/asio/post.hpp>
+#include <boost/assert.hpp>
+#include <boost/system/system_error.hpp>
+#include <boost/throw_exception.hpp>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+uring_service::
+uring_service(net::io_context& ioc)
+    : beast::detail::service_base<uring_service>(ioc)
+    , ioc_(ioc)
+    , ev_(ioc)
+{
+    error_code ec;
+    ring_.open(256, ec);
+    if(ec)
+        return;
+    int const efd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(efd == -1)
+    {
+        ring_.close();
+        return;
+    }
+    ring_.register_eventfd(efd, ec);
+    if(! ec)
+        ev_.assign(efd, ec);
+    if(ec)
+    {
+        ::close(efd);
+        ring_.close();
+    }
+}
+
+void
+uring_service::
+shutdown()
+{
+    std::lock_guard<std::mutex> lock(m_);
+    // Closing the ring cancels everything in flight
+    ring_.close();
+    error_code ec;
+    ev_.close(ec);
+    while(list_)
+    {
+        auto const op = list_;
+        list_ = op->next_;
+        op->destroy();
+    }
+    outstanding_ = 0;
+}
+
+io_uring_sqe*
+uring_service::
+get_sqe()
+{
+    auto sqe = ring_.get_sqe();
+    if(! sqe)
+    {
+        // The submission queue is full
+        error_code ec;
+        ring_.submit(0, ec);
+        if(ec)
+            BOOST_THROW_EXCEPTION(system_error{ec});
+        sqe = ring_.get_sqe();
+        BOOST_ASSERT(sqe);
+    }
+    if(! flushing_)
+    {
+        flushing_ = true;
+        net::post(ioc_, flush_op{this});
+    }
+    return sqe;
+}
+
+void
+uring_service::
+flush()
+{
+    std::lock_guard<std::mutex> lock(m_);
+    flushing_ = false;
+    if(! ring_.is_open())
+        return;
+    if(ring_.unsubmitted() > 0)
+    {
+        error_code ec;
+        ring_.submit(0, ec);
+        if(ec)
+        {
+            // Try again on the next turn
+            flushing_ = true;
+            net::post(ioc_, flush_op{this});
+        }
+    }
+    if(! waiting_ && outstanding_ > 0)
+    {
+        waiting_ = true;
+        ev_.async_read_some(net::buffer(
+            &ev_value_, sizeof(ev_value_)), event_op{this});
+    }
+}
+
+void
+uring_service::
+on_event(error_code ec)
+{
+    std::vector<std::pair<uring_op*, int>> v;
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        waiting_ = false;
+        if(ec == net::error::operation_aborted ||
+            ! ring_.is_open())
+            return;
+        ring_.reap(
+            [&](std::uint64_t user_data, int res)
+            {
+                auto const op = reinterpret_cast<
+                    uring_op*>(static_cast<std::uintptr_t>(user_data));
+                if(! op)
+                    return;
+                if(op->prev_)
+                    op->prev_->next_ = op->next_;
+                else
+                    list_ = op->next_;
+                if(op->next_)
+                    op->next_->prev_ = op->prev_;
+                --outstanding_;
+                v.emplace_back(op, res);
+            });
+        if(outstanding_ > 0)
+        {
+            waiting_ = true;
+            ev_.async_read_some(net::buffer(
+                &ev_value_, sizeof(ev_value_)), event_op{this});
+        }
+    }
+    for(auto const& e : v)
+        e.first->on_complete(e.second);
+}
+
+void
+uring_service::
+cancel(int fd)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    if(! ring_.is_open())
+        return;
+    auto const sqe = get_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = fd;
+    sqe->cancel_flags =
+        IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = 0;
+    // Submit now, so the cancellation reaches the
+    // kernel before the descriptor can be closed.
+    error_code ec;
+    ring_.submit(0, ec);
+}
+
+int
+uring_service::
+find_buffer(void const* data, std::size_t size)
+{
+    auto const p = static_cast<char const*>(data);
+    for(std::size_t i = 0; i < buffers_.size(); ++i)
+    {
+        auto const base = static_cast<char const*>(
+            buffers_[i].iov_base);
+        if( p >= base &&
+            p + size <= base + buffers_[i].iov_len)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void
+uring_service::
+register_buffer(net::mutable_buffer b, error_code& ec)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    if(! ring_.is_open())
+    {
+        ec = net::error::operation_not_supported;
+        return;
+    }
+    buffers_.push_back(iovec{b.data(), b.size()});
+    ring_.register_buffers(buffers_.data(),
+        static_cast<unsigned>(buffers_.size()), ec);
+    if(ec)
+    {
+        // Restore the previous table
+        buffers_.pop_back();
+        error_code ignored;
+        ring_.register_buffers(buffers_.data(),
+            static_cast<unsigned>(buffers_.size()), ignored);
+    }
+}
+
+void
+uring_service::
+unregister_buffers()
+{
+    std::lock_guard<std::mutex> lock(m_);
+    buffers_.clear();
+    if(! ring_.is_open())
+        return;
+    error_code ec;
+    ring_.register_buffers(nullptr, 0, ec);
+}
+
+} // detail
+} // beast
+} // boost
+
+#endif
+
+#endif
@@ -0,0 +1,215 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_FILE_URING_HPP
+#define BOOST_BEAST_CORE_FILE_URING_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/file_posix.hpp>
+#include <boost/beast/_experimental/core/detail/uring.hpp>
+
+#if BOOST_BEAST_USE_IO_URING && BOOST_BEAST_USE_POSIX_FILE
+
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/file_base.hpp>
+#include <boost/assert.hpp>
+#include <cstdint>
+#include <memory>
+
+namespace boost {
+namespace beast {
+
+/** An implementation of File which reads and writes with io_uring.
+
+    This class implements a <em>File</em> on Linux. Opening,
+    seeking and closing are performed with POSIX interfaces.
+    Reads and writes are submitted to a small io_uring owned
+    by the file, at the current file position, and the calling
+    thread waits for the result. The ring is created on first
+    use; if it cannot be created the POSIX interfaces are used.
+
+    The <em>File</em> concept is synchronous, so this class does
+    not overlap file and network I/O by itself. It may be used
+    wherever a <em>File</em> is accepted, for example as the
+    template argument to `http::basic_file_body`.
+*/
+class file_uring
+{
+    file_posix f_;
+    mutable std::unique_ptr<detail::uring> ring_;
+
+    BOOST_BEAST_DECL
+    detail::uring*
+    ring() const;
+
+    BOOST_BEAST_DECL
+    std::size_t
+    transfer(
+        bool is_read,
+        void* buffer,
+        std::size_t n,
+        error_code& ec) const;
+
+public:
+    /** The type of the underlying file handle.
+
+        This is platform-specific.
+    */
+    using native_handle_type = int;
+
+    /** Destructor
+
+        If the file is open it is first closed.
+    */
+    ~file_uring() = default;
+
+    /** Constructor
+
+        There is no open file initially.
+    */
+    file_uring() = default;
+
+    /** Constructor
+
+        The moved-from object behaves as if default constructed.
+    */
+    file_uring(file_uring&& other) = default;
+
+    /** Assignment
+
+        The moved-from object behaves as if default constructed.
+    */
+    file_uring& operator=(file_uring&& other) = default;
+
+    /// Returns the native handle associated with the file.
+    native_handle_type
+    native_handle() const
+    {
+        return f_.native_handle();
+    }
+
+    /** Set the native handle associated with the file.
+
+        If the file is open it is first closed.
+
+        @param fd The native file handle to assign.
+    */
+    void
+    native_handle(native_handle_type fd)
+    {
+        f_.native_handle(fd);
+    }
+
+    /// Returns `true` if the file is open
+    bool
+    is_open() const
+    {
+        return f_.is_open();
+    }
+
+    /** Close the file if open
+
+        @param ec Set to the error, if any occurred.
+    */
+    void
+    close(error_code& ec)
+    {
+        f_.close(ec);
+    }
+
+    /** Open a file at the given path with the specified mode
+
+        @param path The utf-8 encoded path to the file
+
+        @param mode The file mode to use
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    open(char const* path, file_mode mode, error_code& ec)
+    {
+        f_.open(path, mode, ec);
+    }
+
+    /** Return the size of the open file
+
+        @param ec Set to the error, if any occurred
+
+        @return The size in bytes
+    */
+    std::uint64_t
+    size(error_code& ec) const
+    {
+        return f_.size(ec);
+    }
+
+    /** Return the current position in the open file
+
+        @param ec Set to the error, if any occurred
+
+        @return The offset in bytes from the beginning of the file
+    */
+    std::uint64_t
+    pos(error_code& ec) const
+    {
+        return f_.pos(ec);
+    }
+
+    /** Adjust the current position in the open file
+
+        @param offset The offset in bytes from the beginning of the file
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    seek(std::uint64_t offset, error_code& ec)
+    {
+        f_.seek(offset, ec);
+    }
+
+    /** Read from the open file
+
+        @param buffer The buffer for storing the result of the read
+
+        @param n The number of bytes to read
+
+        @param ec Set to the error, if any occurred
+    */
+    std::size_t
+    read(void* buffer, std::size_t n, error_code& ec) const
+    {
+        return transfer(true, buffer, n, ec);
+    }
+
+    /** Write to the open file
+
+        @param buffer The buffer holding the data to write
+
+        @param n The number of bytes to write
+
+        @param ec Set to the error, if any occurred
+    */
+    std::size_t
+    write(void const* buffer, std::size_t n, error_code& ec)
+    {
+        return transfer(false,
+            const_cast<void*>(buffer), n, ec);
+    }
+};
+
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/_experimental/core/impl/file_uring.ipp>
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_FILE_URING_IPP
+#define BOOST_BEAST_CORE_IMPL_FILE_URING_IPP
+
+#include <boost/beast/_experimental/core/file_uring.hpp>
+
+#if BOOST_BEAST_USE_IO_URING && BOOST_BEAST_USE_POSIX_FILE
+
+#include <algorithm>
+#include <errno.h>
+
+namespace boost {
+namespace beast {
+
+detail::uring*
+file_uring::
+ring() const
+{
+    if(! ring_)
+    {
+        ring_.reset(new detail::uring);
+        error_code ec;
+        ring_->open(2, ec);
+    }
+    if(! ring_->is_open())
+        return nullptr;
+    return ring_.get();
+}
+
+std::size_t
+file_uring::
+transfer(
+    bool is_read,
+    void* buffer,
+    std::size_t n,
+    error_code& ec) const
+{
+    if(! f_.is_open())
+    {
+        ec = make_error_code(errc::bad_file_descriptor);
+        return 0;
+    }
+    auto const r = ring();
+    if(! r)
+    {
+        if(is_read)
+            return f_.read(buffer, n, ec);
+        return const_cast<file_posix&>(f_).write(buffer, n, ec);
+    }
+    std::size_t total = 0;
+    while(n > 0)
+    {
+        auto const amount = (std::min<std::size_t>)(
+            n, 0x7ffff000); // largest single transfer in Linux
+        auto const sqe = r->get_sqe();
+        BOOST_ASSERT(sqe);
+        sqe->opcode = is_read ? IORING_OP_READ : IORING_OP_WRITE;
+        sqe->fd = f_.native_handle();
+        sqe->addr = reinterpret_cast<std::uintptr_t>(buffer);
+        sqe->len = static_cast<std::uint32_t>(amount);
+        // Use and advance the current file position
+        sqe->off = static_cast<std::uint64_t>(-1);
+        sqe->user_data = 1;
+        r->submit(1, ec);
+        if(ec)
+            return total;
+        int res = 0;
+        r->reap(
+            [&](std::uint64_t, int result)
+            {
+                res = result;
+            });
+        if(res < 0)
+        {
+            if(res == -EINTR || res == -EAGAIN)
+                continue;
+            ec.assign(-res, system_category());
+            return total;
+        }
+        if(res == 0)
+        {
+            // short read
+            if(is_read)
+                return total;
+            ec = make_error_code(errc::io_error);
+            return total;
+        }
+        n -= res;
+        total += res;
+        buffer = static_cast<char*>(buffer) + res;
+    }
+    ec = {};
+    return total;
+}
+
+} // beast
+} // boost
+
+#endif
+
+#endif
@@ -0,0 +1,382 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_IMPL_URING_STREAM_HPP
+#define BOOST_BEAST_CORE_IMPL_URING_STREAM_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/buffer_traits.hpp>
+#include <boost/beast/core/detail/get_io_context.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/beast/websocket/teardown.hpp>
+#include <boost/asio/error.hpp>
+#include <cstring>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+namespace boost {
+namespace beast {
+
+template<class Protocol, class Executor>
+struct basic_uring_stream<Protocol, Executor>::ops
+{
+
+/*  A read or write submitted to the ring.
+
+    The object is allocated when the operation is started
+    and deletes itself when the ring reports a result. If
+    the socket is not ready and the kernel refuses to wait,
+    for example because the socket is in non-blocking mode,
+    the operation first waits for readiness with a poll and
+    is then submitted again.
+*/
+template<bool isRead, class Handler>
+class transfer_op
+    : public async_base<Handler, Executor>
+    , public detail::uring_op
+{
+    static std::size_t constexpr max_iov = 16;
+
+    detail::uring_service& svc_;
+    int fd_;
+    iovec iov_[max_iov];
+    std::size_t n_ = 0;
+    msghdr msg_;
+    bool polling_ = false;
+
+    void
+    prep(io_uring_sqe& sqe)
+    {
+        sqe.fd = fd_;
+        if(polling_)
+        {
+            sqe.opcode = IORING_OP_POLL_ADD;
+            sqe.poll32_events = isRead ? POLLIN : POLLOUT;
+            return;
+        }
+        if(n_ > 1)
+        {
+            std::memset(&msg_, 0, sizeof(msg_));
+            msg_.msg_iov = iov_;
+            msg_.msg_iovlen = n_;
+            sqe.opcode = isRead ?
+                IORING_OP_RECVMSG : IORING_OP_SENDMSG;
+            sqe.addr = reinterpret_cast<std::uintptr_t>(&msg_);
+            sqe.len = 1;
+            sqe.msg_flags = isRead ? 0 : MSG_NOSIGNAL;
+            return;
+        }
+        sqe.addr = reinterpret_cast<
+            std::uintptr_t>(iov_[0].iov_base);
+        sqe.len = static_cast<std::uint32_t>(iov_[0].iov_len);
+        if(isRead)
+        {
+            auto const i = svc_.find_buffer(
+                iov_[0].iov_base, iov_[0].iov_len);
+            if(i >= 0)
+            {
+                sqe.opcode = IORING_OP_READ_FIXED;
+                sqe.buf_index = static_cast<std::uint16_t>(i);
+                sqe.off = static_cast<std::uint64_t>(-1);
+            }
+            else
+            {
+                sqe.opcode = IORING_OP_RECV;
+            }
+        }
+        else
+        {
+            // Registered buffers are not used for writes,
+            // since a fixed write can raise SIGPIPE.
+            sqe.opcode = IORING_OP_SEND;
+            sqe.msg_flags = MSG_NOSIGNAL;
+        }
+    }
+
+public:
+    template<class Handler_, class Buffers>
+    transfer_op(
+        Handler_&& h,
+        basic_uring_stream& s,
+        Buffers const& b)
+        : async_base<Handler, Executor>(
+            std::forward<Handler_>(h), s.get_executor())
+        , svc_(*s.svc_)
+        , fd_(s.socket_.native_handle())
+    {
+        for(auto it = net::buffer_sequence_begin(b),
+            end = net::buffer_sequence_end(b);
+            it != end && n_ < max_iov; ++it)
+        {
+            auto const bb = *it;
+            if(bb.size() == 0)
+                continue;
+            iov_[n_].iov_base = const_cast<void*>(
+                static_cast<void const*>(bb.data()));
+            iov_[n_].iov_len = bb.size();
+            ++n_;
+        }
+    }
+
+    void
+    start()
+    {
+        if(fd_ == -1)
+        {
+            this->complete(false,
+                error_code(net::error::bad_descriptor), 0);
+            delete this;
+            return;
+        }
+        if(n_ == 0)
+        {
+            this->complete(false, error_code{}, 0);
+            delete this;
+            return;
+        }
+        svc_.start(this,
+            [this](io_uring_sqe& sqe)
+            {
+                prep(sqe);
+            });
+    }
+
+    void
+    on_complete(int res) override
+    {
+        if(polling_)
+        {
+            polling_ = false;
+            if(res >= 0)
+                return start();
+        }
+        else if(res == -EAGAIN)
+        {
+            polling_ = true;
+            return start();
+        }
+        error_code ec;
+        std::size_t bytes_transferred = 0;
+        if(res < 0)
+            ec.assign(-res, system_category());
+        else if(isRead && res == 0)
+            ec = net::error::eof;
+        else
+            bytes_transferred = static_cast<std::size_t>(res);
+        this->complete(false, ec, bytes_transferred);
+        delete this;
+    }
+
+    void
+    destroy() override
+    {
+        delete this;
+    }
+};
+
+struct run_read_op
+{
+    template<class ReadHandler, class Buffers>
+    void
+    operator()(
+        ReadHandler&& h,
+        basic_uring_stream* s,
+        Buffers const& b)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<ReadHandler,
+                void(error_code, std::size_t)>::value,
+            "ReadHandler type requirements not met");
+
+        (new transfer_op<
+            true,
+            typename std::decay<ReadHandler>::type>(
+                std::forward<ReadHandler>(h), *s, b))->start();
+    }
+};
+
+struct run_write_op
+{
+    template<class WriteHandler, class Buffers>
+    void
+    operator()(
+        WriteHandler&& h,
+        basic_uring_stream* s,
+        Buffers const& b)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+                void(error_code, std::size_t)>::value,
+            "WriteHandler type requirements not met");
+
+        (new transfer_op<
+            false,
+            typename std::decay<WriteHandler>::type>(
+                std::forward<WriteHandler>(h), *s, b))->start();
+    }
+};
+
+};
+
+//------------------------------------------------------------------------------
+
+template<class Protocol, class Executor>
+detail::uring_service*
+basic_uring_stream<Protocol, Executor>::
+get_service(executor_type const& ex)
+{
+    auto const ioc = beast::detail::get_io_context(ex);
+    if(! ioc)
+        return nullptr;
+    auto& svc = net::use_service<detail::uring_service>(*ioc);
+    if(! svc.is_open())
+        return nullptr;
+    return &svc;
+}
+
+template<class Protocol, class Executor>
+void
+basic_uring_stream<Protocol, Executor>::
+cancel()
+{
+    if(svc_ && socket_.is_open())
+        svc_->cancel(socket_.native_handle());
+    error_code ec;
+    socket_.cancel(ec);
+}
+
+template<class Protocol, class Executor>
+void
+basic_uring_stream<Protocol, Executor>::
+close()
+{
+    if(svc_ && socket_.is_open())
+        svc_->cancel(socket_.native_handle());
+    error_code ec;
+    socket_.close(ec);
+}
+
+template<class Protocol, class Executor>
+void
+basic_uring_stream<Protocol, Executor>::
+register_buffer(net::mutable_buffer b, error_code& ec)
+{
+    if(! svc_)
+    {
+        ec = net::error::operation_not_supported;
+        return;
+    }
+    svc_->register_buffer(b, ec);
+}
+
+template<class Protocol, class Executor>
+void
+basic_uring_stream<Protocol, Executor>::
+unregister_buffers()
+{
+    if(svc_)
+        svc_->unregister_buffers();
+}
+
+template<class Protocol, class Executor>
+template<class MutableBufferSequence, class ReadHandler>
+BOOST_BEAST_ASYNC_RESULT2(ReadHandler)
+basic_uring_stream<Protocol, Executor>::
+async_read_some(
+    MutableBufferSequence const& buffers,
+    ReadHandler&& handler)
+{
+    static_assert(net::is_mutable_buffer_sequence<
+        MutableBufferSequence>::value,
+        "MutableBufferSequence type requirements not met");
+    if(! svc_)
+        return socket_.async_read_some(buffers,
+            std::forward<ReadHandler>(handler));
+    return net::async_initiate<
+        ReadHandler,
+        void(error_code, std::size_t)>(
+            typename ops::run_read_op{},
+            handler,
+            this,
+            buffers);
+}
+
+template<class Protocol, class Executor>
+template<class ConstBufferSequence, class WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+basic_uring_stream<Protocol, Executor>::
+async_write_some(
+    ConstBufferSequence const& buffers,
+    WriteHandler&& handler)
+{
+    static_assert(net::is_const_buffer_sequence<
+        ConstBufferSequence>::value,
+        "ConstBufferSequence type requirements not met");
+    if(! svc_)
+        return socket_.async_write_some(buffers,
+            std::forward<WriteHandler>(handler));
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code, std::size_t)>(
+            typename ops::run_write_op{},
+            handler,
+            this,
+            buffers);
+}
+
+//------------------------------------------------------------------------------
+
+#if ! BOOST_BEAST_DOXYGEN
+
+template<class Protocol, class Executor>
+void
+beast_close_socket(
+    basic_uring_stream<Protocol, Executor>& stream)
+{
+    stream.close();
+}
+
+template<class Protocol, class Executor, class TeardownHandler>
+void
+async_teardown(
+    role_type role,
+    basic_uring_stream<Protocol, Executor>& stream,
+    TeardownHandler&& handler)
+{
+    using boost::beast::websocket::async_teardown;
+    async_teardown(role, stream.socket(),
+        std::forward<TeardownHandler>(handler));
+}
+
+template<class Protocol, class Executor>
+void
+teardown(
+    role_type role,
+    basic_uring_stream<Protocol, Executor>& stream,
+    error_code& ec)
+{
+    using boost::beast::websocket::teardown;
+    teardown(role, stream.socket(), ec);
+}
+
+#endif
+
+} // beast
+} // boost
+
+#endif
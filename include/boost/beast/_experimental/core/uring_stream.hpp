@@ -0,0 +1,297 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_CORE_URING_STREAM_HPP
+#define BOOST_BEAST_CORE_URING_STREAM_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/_experimental/core/detail/uring_service.hpp>
+
+#if BOOST_BEAST_USE_IO_URING
+
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/role.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/basic_stream_socket.hpp>
+#include <boost/asio/executor.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <type_traits>
+
+namespace boost {
+namespace beast {
+
+/** A stream socket whose reads and writes are performed with io_uring.
+
+    This stream owns a `net::basic_stream_socket`. Asynchronous
+    reads and writes are submitted to an io_uring which is shared
+    by every such stream on the same `net::io_context`. All of the
+    operations started during one turn of the `io_context` are
+    submitted with a single system call, and completions are
+    collected from shared memory. This reduces the number of
+    system calls per operation when many connections are busy.
+
+    The stream meets the requirements of <em>AsyncReadStream</em>,
+    <em>AsyncWriteStream</em>, <em>SyncReadStream</em> and
+    <em>SyncWriteStream</em>, so it may be used with
+    `http::async_read`, `http::async_write` and `websocket::stream`
+    without changes. Connecting and accepting are performed on
+    the underlying socket, obtained with @ref socket.
+
+    Buffers may be registered with the kernel using
+    @ref register_buffer, for example the storage of a
+    `flat_static_buffer`, or the storage of a `flat_buffer`
+    after calling `reserve`. A read into a single buffer which
+    lies entirely inside a registered buffer then uses
+    `IORING_OP_READ_FIXED`, which avoids mapping the pages for
+    every operation. Buffer sequences, such as those of
+    `multi_buffer`, are read with one `IORING_OP_RECVMSG`.
+
+    If io_uring is not available at run time, the stream
+    performs its operations with the underlying socket.
+
+    @par Thread Safety
+    <em>Distinct objects:</em> Safe.@n
+    <em>Shared objects:</em> Unsafe. The application must also
+    ensure that all asynchronous operations are performed within
+    the same implicit or explicit strand.
+
+    @tparam Protocol A type meeting the requirements of <em>Protocol</em>
+    representing the protocol the protocol to use for the socket.
+
+    @tparam Executor A type meeting the requirements of <em>Executor</em>
+    to be used for submitting all completion handlers which do not already
+    have an associated executor. The executor must be that of a
+    `net::io_context` for io_uring to be used.
+*/
+template<
+    class Protocol,
+    class Executor = net::executor>
+class basic_uring_stream
+{
+public:
+    /// The type of the underlying socket.
+    using socket_type =
+        net::basic_stream_socket<Protocol, Executor>;
+
+    /// The type of the executor associated with the stream.
+    using executor_type = Executor;
+
+    /// The protocol type.
+    using protocol_type = Protocol;
+
+    /// The endpoint type.
+    using endpoint_type = typename Protocol::endpoint;
+
+private:
+    struct ops;
+
+    socket_type socket_;
+    detail::uring_service* svc_;
+
+    static
+    detail::uring_service*
+    get_service(executor_type const& ex);
+
+public:
+    /** Constructor
+
+        @param args A list of parameters forwarded to the
+        constructor of the underlying socket.
+    */
+    template<class Arg0, class... Args,
+        class = typename std::enable_if<
+            ! std::is_same<typename std::decay<Arg0>::type,
+                basic_uring_stream>::value>::type>
+    explicit
+    basic_uring_stream(Arg0&& arg0, Args&&... args)
+        : socket_(std::forward<Arg0>(arg0),
+            std::forward<Args>(args)...)
+        , svc_(get_service(socket_.get_executor()))
+    {
+    }
+
+    /** Move constructor
+
+        No operations may be outstanding on the
+        stream being moved from.
+    */
+    basic_uring_stream(basic_uring_stream&&) = default;
+
+    /// Move assignment (deleted)
+    basic_uring_stream& operator=(basic_uring_stream&&) = delete;
+
+    /// Return the executor associated with the stream.
+    executor_type
+    get_executor() noexcept
+    {
+        return socket_.get_executor();
+    }
+
+    /// Return a reference to the underlying socket
+    socket_type&
+    socket() noexcept
+    {
+        return socket_;
+    }
+
+    /// Return a reference to the underlying socket
+    socket_type const&
+    socket() const noexcept
+    {
+        return socket_;
+    }
+
+    /// Returns `true` if operations are performed with io_uring
+    bool
+    is_uring() const noexcept
+    {
+        return svc_ != nullptr;
+    }
+
+    /** Cancel all asynchronous operations.
+
+        Outstanding operations complete with
+        `net::error::operation_aborted`.
+    */
+    void
+    cancel();
+
+    /** Close the stream.
+
+        Outstanding operations are canceled first.
+    */
+    void
+    close();
+
+    /** Register a buffer with the kernel.
+
+        The buffer is registered with the io_uring shared by
+        all streams on the same `io_context`. It must remain
+        valid until @ref unregister_buffers is called or the
+        `io_context` is destroyed.
+
+        @param b The buffer to register
+
+        @param ec Set to the error, if any occurred. The error
+        `net::error::operation_not_supported` indicates that
+        io_uring is not in use.
+    */
+    void
+    register_buffer(net::mutable_buffer b, error_code& ec);
+
+    /** Unregister all buffers.
+
+        This affects every stream on the same `io_context`.
+    */
+    void
+    unregister_buffers();
+
+    /// Read some data from the stream.
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(MutableBufferSequence const& buffers)
+    {
+        return socket_.read_some(buffers);
+    }
+
+    /// Read some data from the stream.
+    template<class MutableBufferSequence>
+    std::size_t
+    read_some(
+        MutableBufferSequence const& buffers,
+        error_code& ec)
+    {
+        return socket_.read_some(buffers, ec);
+    }
+
+    /// Write some data to the stream.
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(ConstBufferSequence const& buffers)
+    {
+        return socket_.write_some(buffers);
+    }
+
+    /// Write some data to the stream.
+    template<class ConstBufferSequence>
+    std::size_t
+    write_some(
+        ConstBufferSequence const& buffers,
+        error_code& ec)
+    {
+        return socket_.write_some(buffers, ec);
+    }
+
+    /** Read some data asynchronously.
+
+        The handler is invoked in a manner equivalent to
+        using `net::post`. At most 16 buffers from the
+        sequence are used.
+
+        @param buffers The buffers into which the data will be read.
+
+        @param handler The completion handler to invoke when the
+        operation completes. The signature of the handler must be:
+        @code
+        void handler(
+            error_code const& error,        // result of operation
+            std::size_t bytes_transferred   // number of bytes transferred
+        );
+        @endcode
+    */
+    template<
+        class MutableBufferSequence,
+        BOOST_BEAST_ASYNC_TPARAM2 ReadHandler =
+            net::default_completion_token_t<executor_type>>
+    BOOST_BEAST_ASYNC_RESULT2(ReadHandler)
+    async_read_some(
+        MutableBufferSequence const& buffers,
+        ReadHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+
+    /** Write some data asynchronously.
+
+        The handler is invoked in a manner equivalent to
+        using `net::post`. At most 16 buffers from the
+        sequence are used.
+
+        @param buffers The data to be written.
+
+        @param handler The completion handler to invoke when the
+        operation completes. The signature of the handler must be:
+        @code
+        void handler(
+            error_code const& error,        // result of operation
+            std::size_t bytes_transferred   // number of bytes transferred
+        );
+        @endcode
+    */
+    template<
+        class ConstBufferSequence,
+        BOOST_BEAST_ASYNC_TPARAM2 WriteHandler =
+            net::default_completion_token_t<executor_type>>
+    BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+    async_write_some(
+        ConstBufferSequence const& buffers,
+        WriteHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+};
+
+/// A TCP/IP stream socket using io_uring
+using uring_stream = basic_uring_stream<net::ip::tcp>;
+
+} // beast
+} // boost
+
+#include <boost/beast/_experimental/core/impl/uring_stream.hpp>
+
+#endif
+
+#endif
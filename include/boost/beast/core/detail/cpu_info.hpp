@@ -11,9 +11,17 @@
 #define BOOST_BEAST_DETAIL_CPU_INFO_HPP
 
 #include <boost/config.hpp>
+#include <cstdint>
 
+/*  Wide-vector code paths are selected at runtime using the flags in
+    cpu_info, so the translation unit does not need to be compiled with
+    -msse4.2 or -mavx2. Each function using instructions beyond the
+    baseline ISA must be annotated with the matching target macro below.
+*/
 #ifndef BOOST_BEAST_NO_INTRINSICS
-# if defined(BOOST_MSVC) || ((defined(BOOST_GCC) || defined(BOOST_CLANG)) && defined(__SSE4_2__))
+# if (defined(BOOST_MSVC) && (defined(_M_IX86) || defined(_M_X64))) || \
+     ((defined(BOOST_CLANG) || (defined(BOOST_GCC) && BOOST_GCC >= 40900)) && \
+        (defined(__i386__) || defined(__x86_64__)))
 #  define BOOST_BEAST_NO_INTRINSICS 0
 # else
 #  define BOOST_BEAST_NO_INTRINSICS 1
@@ -28,6 +36,22 @@
 #include <cpuid.h>  // __get_cpuid
 #endif
 
+#ifdef BOOST_MSVC
+# define BOOST_BEAST_TARGET_SSE2
+# define BOOST_BEAST_TARGET_SSSE3
+# define BOOST_BEAST_TARGET_SSE42
+# define BOOST_BEAST_TARGET_PCLMUL
+# define BOOST_BEAST_TARGET_AVX2
+# define BOOST_BEAST_TARGET_AVX512BW
+#else
+# define BOOST_BEAST_TARGET_SSE2 __attribute__((target("sse2")))
+# define BOOST_BEAST_TARGET_SSSE3 __attribute__((target("ssse3")))
+# define BOOST_BEAST_TARGET_SSE42 __attribute__((target("sse4.2")))
+# define BOOST_BEAST_TARGET_PCLMUL __attribute__((target("sse4.1,pclmul")))
+# define BOOST_BEAST_TARGET_AVX2 __attribute__((target("avx2")))
+# define BOOST_BEAST_TARGET_AVX512BW __attribute__((target("avx512f,avx512bw")))
+#endif
+
 namespace boost {
 namespace beast {
 namespace detail {
@@ -56,9 +80,53 @@ cpuid(
 #endif
 }
 
+template<class = void>
+void
+cpuid(
+    std::uint32_t id,
+    std::uint32_t subid,
+    std::uint32_t& eax,
+    std::uint32_t& ebx,
+    std::uint32_t& ecx,
+    std::uint32_t& edx)
+{
+#ifdef BOOST_MSVC
+    int regs[4];
+    __cpuidex(regs, id, subid);
+    eax = regs[0];
+    ebx = regs[1];
+    ecx = regs[2];
+    edx = regs[3];
+#else
+    __cpuid_count(id, subid, eax, ebx, ecx, edx);
+#endif
+}
+
+// Returns the extended control register XCR0, which
+// tells which register sets the operating system saves.
+template<class = void>
+std::uint64_t
+xgetbv()
+{
+#ifdef BOOST_MSVC
+    return _xgetbv(0);
+#else
+    std::uint32_t eax;
+    std::uint32_t edx;
+    __asm__ __volatile__(
+        "xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<std::uint64_t>(edx) << 32) | eax;
+#endif
+}
+
 struct cpu_info
 {
+    bool sse2 = false;
+    bool ssse3 = false;
     bool sse42 = false;
+    bool pclmul = false;
+    bool avx2 = false;
+    bool avx512bw = false;
 
     cpu_info();
 };
@@ -67,7 +135,19 @@ inline
 cpu_info::
 cpu_info()
 {
+    constexpr std::uint32_t SSE2 = 1 << 26;
+    constexpr std::uint32_t SSSE3 = 1 << 9;
+    constexpr std::uint32_t SSE41 = 1 << 19;
     constexpr std::uint32_t SSE42 = 1 << 20;
+    constexpr std::uint32_t PCLMUL = 1 << 1;
+    constexpr std::uint32_t OSXSAVE = 1 << 27;
+    constexpr std::uint32_t AVX2 = 1 << 5;
+    constexpr std::uint32_t AVX512F = 1 << 16;
+    constexpr std::uint32_t AVX512BW = 1 << 30;
+
+    // XCR0 bits for the XMM/YMM and the opmask/ZMM state
+    constexpr std::uint64_t XCR0_YMM = 0x06;
+    constexpr std::uint64_t XCR0_ZMM = 0xe6;
 
     std::uint32_t eax = 0;
     std::uint32_t ebx = 0;
@@ -75,19 +155,44 @@ cpu_info()
     std::uint32_t edx = 0;
 
     cpuid(0, eax, ebx, ecx, edx);
-    if(eax >= 1)
-    {
-        cpuid(1, eax, ebx, ecx, edx);
-        sse42 = (ecx & SSE42) != 0;
-    }
+    auto const max_id = eax;
+    if(max_id < 1)
+        return;
+    cpuid(1, eax, ebx, ecx, edx);
+    sse2 = (edx & SSE2) != 0;
+    ssse3 = (ecx & SSSE3) != 0;
+    sse42 = (ecx & SSE42) != 0;
+    pclmul =
+        (ecx & PCLMUL) != 0 &&
+        (ecx & SSE41) != 0;
+    if((ecx & OSXSAVE) == 0 || max_id < 7)
+        return;
+    auto const xcr0 = xgetbv();
+    cpuid(7, 0, eax, ebx, ecx, edx);
+    avx2 =
+        (ebx & AVX2) != 0 &&
+        (xcr0 & XCR0_YMM) == XCR0_YMM;
+    avx512bw = avx2 &&
+        (ebx & AVX512F) != 0 &&
+        (ebx & AVX512BW) != 0 &&
+        (xcr0 & XCR0_ZMM) == XCR0_ZMM;
+}
+
+// Tests and benchmarks may clear flags here to
+// exercise the narrower code paths on a wide machine.
+template<class = void>
+cpu_info&
+get_mutable_cpu_info()
+{
+    static cpu_info ci;
+    return ci;
 }
 
 template<class = void>
 cpu_info const&
 get_cpu_info()
 {
-    static cpu_info const ci;
-    return ci;
+    return get_mutable_cpu_info();
 }
 
 } // detail
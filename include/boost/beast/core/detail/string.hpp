@@ -21,7 +21,7 @@ namespace detail {
 // so introduce a namespace for this purprose.
 namespace string_literals {
 
-inline
+constexpr
 string_view
 operator"" _sv(char const* p, std::size_t n)
 {
@@ -12,6 +12,7 @@
 
 #include <boost/beast/core/detail/config.hpp>
 
+#include <boost/beast/http/async_file_body.hpp>
 #include <boost/beast/http/basic_dynamic_body.hpp>
 #include <boost/beast/http/basic_file_body.hpp>
 #include <boost/beast/http/basic_parser.hpp>
@@ -22,7 +23,10 @@
 #include <boost/beast/http/error.hpp>
 #include <boost/beast/http/field.hpp>
 #include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/header_parser.hpp>
 #include <boost/beast/http/file_body.hpp>
+#include <boost/beast/http/flat_fields.hpp>
+#include <boost/beast/http/mapped_file_body.hpp>
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/parser.hpp>
 #include <boost/beast/http/read.hpp>
@@ -0,0 +1,265 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_ASYNC_FILE_BODY_HPP
+#define BOOST_BEAST_HTTP_ASYNC_FILE_BODY_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/core/saved_handler.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/executor.hpp>
+#include <boost/optional.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+namespace detail {
+template<class, class, bool, class, class>
+class write_some_async_file_op;
+struct run_write_some_async_file_op;
+} // detail
+
+/** A message body represented by a file read on a separate executor.
+
+    Messages with this type have bodies represented by a file
+    on the file system. When serialized with an asynchronous
+    write, the file is read in blocks on the executor set with
+    @ref value_type::set_executor, usually that of a
+    `net::thread_pool` dedicated to file I/O. While one block
+    is being written to the stream, the next block is read
+    into a second buffer, so the time spent waiting on the
+    disk overlaps the time spent sending. The thread running
+    the stream's `io_context` never blocks on the file.
+
+    If no executor is set, or when serializing with a
+    synchronous write, the file is read on the calling thread
+    like @ref basic_file_body.
+
+    Messages using this body type may only be serialized.
+
+    @tparam File The implementation to use for accessing files.
+    This type must meet the requirements of <em>File</em>.
+*/
+template<class File>
+struct basic_async_file_body
+{
+    // Make sure the type meets the requirements
+    static_assert(is_file<File>::value,
+        "File type requirements not met");
+
+    /// The type of File this body uses
+    using file_type = File;
+
+    /** Algorithm for retrieving buffers when serializing.
+
+        Objects of this type are created during serialization
+        to extract the buffers representing the body.
+    */
+#if BOOST_BEAST_DOXYGEN
+    using writer = __implementation_defined__;
+#else
+    class writer;
+#endif
+
+    /// The type of the @ref message::body member.
+    class value_type;
+
+    /** Returns the size of the body
+
+        @param body The file body to use
+    */
+    static
+    std::uint64_t
+    size(value_type const& body);
+};
+
+template<class File>
+class basic_async_file_body<File>::value_type
+{
+    // The two read buffers and the state
+    // shared with the file executor.
+    struct state
+    {
+        std::unique_ptr<char[]> buf[2];
+        std::size_t size = 0;   // size of each buffer
+        std::size_t ready = 0;  // bytes read into buf[cur ^ 1]
+        int cur = 0;            // buffer last returned by the writer
+        error_code ec;          // error from the last read
+        std::atomic<int> pending{0};
+        saved_handler op;       // a suspended write operation
+    };
+
+    template<class Executor>
+    struct fill_op;
+
+    friend class writer;
+    friend struct basic_async_file_body;
+
+    template<class, class, bool, class, class>
+    friend class detail::write_some_async_file_op;
+    friend struct detail::run_write_some_async_file_op;
+
+    File file_;
+    std::uint64_t file_size_ = 0;   // cached file size
+    std::uint64_t remain_ = 0;      // bytes not yet read
+    std::size_t buffer_size_ = 65536;
+    net::executor ex_;
+    std::unique_ptr<state> st_;
+
+    void init_state();
+
+    bool
+    need_fill() const
+    {
+        return st_ && st_->ready == 0 &&
+            ! st_->ec && remain_ > 0;
+    }
+
+    void fill();
+
+public:
+    /** Destructor.
+
+        If the file is open, it is closed first.
+    */
+    ~value_type() = default;
+
+    /// Constructor
+    value_type() = default;
+
+    /// Constructor
+    value_type(value_type&& other) = default;
+
+    /// Move assignment
+    value_type& operator=(value_type&& other) = default;
+
+    /// Return the file
+    File& file()
+    {
+        return file_;
+    }
+
+    /// Returns `true` if the file is open
+    bool
+    is_open() const
+    {
+        return file_.is_open();
+    }
+
+    /// Returns the size of the file if open
+    std::uint64_t
+    size() const
+    {
+        return file_size_;
+    }
+
+    /** Set the executor used to read the file.
+
+        Asynchronous writes of the message submit each file
+        read to this executor. The executor should not be the
+        one used by the stream, otherwise reads would block
+        the stream's threads again.
+    */
+    void
+    set_executor(net::executor ex)
+    {
+        ex_ = std::move(ex);
+    }
+
+    /** Set the size of each read from the file.
+
+        Two buffers of this size are allocated when the file
+        is opened. The new size applies to the next file
+        opened or set. The default is 64KB.
+    */
+    void
+    buffer_size(std::size_t n)
+    {
+        BOOST_ASSERT(n > 0);
+        buffer_size_ = n;
+    }
+
+    /// Close the file if open
+    void
+    close();
+
+    /** Open a file at the given path with the specified mode
+
+        @param path The utf-8 encoded path to the file
+
+        @param mode The file mode to use
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    open(char const* path, file_mode mode, error_code& ec);
+
+    /** Set the open file
+
+        This function is used to set the open file. Any previously
+        set file will be closed.
+
+        @param file The file to set. The file must be open or else
+        an error occurs
+
+        @param ec Set to the error, if any occurred
+    */
+    void
+    reset(File&& file, error_code& ec);
+};
+
+/// A message body represented by a file read on a separate executor.
+using async_file_body = basic_async_file_body<file>;
+
+//------------------------------------------------------------------------------
+
+/** Write part of a message to a stream asynchronously, reading the file ahead.
+
+    This overload is selected for messages whose body is a
+    @ref basic_async_file_body. It behaves like the general
+    @ref async_write_some, except that file reads are performed
+    on the body's executor, and the next block of the file is
+    read while the current one is being written.
+
+    The caller must not start another operation which uses
+    the same serializer until this one completes.
+*/
+template<
+    class AsyncWriteStream,
+    bool isRequest, class File, class Fields,
+    BOOST_BEAST_ASYNC_TPARAM2 WriteHandler =
+        net::default_completion_token_t<
+            executor_type<AsyncWriteStream>>>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+async_write_some(
+    AsyncWriteStream& stream,
+    serializer<isRequest,
+        basic_async_file_body<File>, Fields>& sr,
+    WriteHandler&& handler =
+        net::default_completion_token_t<
+            executor_type<AsyncWriteStream>>{});
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/http/impl/async_file_body.hpp>
+
+#endif
@@ -109,6 +109,15 @@ class basic_parser
     static unsigned constexpr flagUpgrade               = 1<< 12;
     static unsigned constexpr flagFinalChunk            = 1<< 13;
 
+    // Input was copied from a buffer sequence into temporary storage
+    static unsigned constexpr flagFlattened             = 1<< 14;
+
+    // Field value was unfolded into temporary storage
+    static unsigned constexpr flagUnfolded              = 1<< 15;
+
+    // Parse the header only once all of it is in the input
+    static unsigned constexpr flagWholeHeader           = 1<< 16;
+
     static constexpr
     std::uint64_t
     default_body_limit(std::true_type)
@@ -434,6 +443,49 @@ public:
     put_eof(error_code& ec);
 
 protected:
+    /** Set the whole header parse option.
+
+        Normally the parser makes progress on a header as soon as the
+        start-line or a field is available, so the calls to the virtual
+        functions for one header may be spread across several calls to
+        @ref put. When this option is set, the parser first waits until
+        the end of the header is present in the input, and then makes
+        every call for the start-line and fields during a single call
+        to @ref put, with strings that point into the same buffer.
+
+        The default setting is `false`.
+
+        @param v `true` to set the option or `false` to disable it.
+
+        @note This function must called before any bytes are processed.
+    */
+    void
+    whole_header(bool v)
+    {
+        BOOST_ASSERT(! got_some());
+        if(v)
+            f_ |= flagWholeHeader;
+        else
+            f_ &= ~flagWholeHeader;
+    }
+
+    /** Returns `true` if the strings passed to the virtual functions point into the input.
+
+        Strings passed to the virtual functions ordinarily refer to the
+        octets of the buffer given to @ref put, and remain valid for as
+        long as the caller keeps that memory unchanged. This function
+        returns `false` during a call to a virtual function when the
+        strings it receives refer to temporary storage instead, which
+        happens when the buffer sequence given to @ref put has more
+        than one element, or when a field value contains obs-fold.
+        Such strings are invalidated when the virtual function returns.
+    */
+    bool
+    in_place() const
+    {
+        return (f_ & (flagFlattened | flagUnfolded)) == 0;
+    }
+
     /** Called after receiving the request-line.
 
         This virtual function is invoked after receiving a request-line
@@ -101,6 +101,13 @@ struct basic_parser_base
         char const* ranges,
         size_t ranges_size);
 
+    BOOST_BEAST_DECL
+    static
+    std::pair<char const*, bool>
+    find_eom_fast(
+        char const* p,
+        char const* last);
+
     BOOST_BEAST_DECL
     static
     char const*
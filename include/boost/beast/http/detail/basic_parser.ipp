@@ -11,7 +11,16 @@
 #define BOOST_BEAST_HTTP_DETAIL_BASIC_PARSER_IPP
 
 #include <boost/beast/http/detail/basic_parser.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
+#include <boost/assert.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <cstring>
 #include <limits>
+#include <tuple>
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+#include <immintrin.h>
+#endif
 
 namespace boost {
 namespace beast {
@@ -104,6 +113,248 @@ unhex(unsigned char& d, char c)
 
 //--------------------------------------------------------------------------
 
+#if ! BOOST_BEAST_NO_INTRINSICS
+
+namespace simd {
+
+inline
+unsigned
+countr_zero(std::uint32_t v)
+{
+    BOOST_ASSERT(v != 0);
+#ifdef BOOST_MSVC
+    unsigned long n;
+    _BitScanForward(&n, v);
+    return static_cast<unsigned>(n);
+#else
+    return static_cast<unsigned>(__builtin_ctz(v));
+#endif
+}
+
+inline
+unsigned
+countr_zero(std::uint64_t v)
+{
+    BOOST_ASSERT(v != 0);
+#if defined(BOOST_MSVC) && defined(_M_X64)
+    unsigned long n;
+    _BitScanForward64(&n, v);
+    return static_cast<unsigned>(n);
+#elif defined(BOOST_MSVC)
+    auto const lo = static_cast<std::uint32_t>(v);
+    if(lo != 0)
+        return countr_zero(lo);
+    return 32 + countr_zero(
+        static_cast<std::uint32_t>(v >> 32));
+#else
+    return static_cast<unsigned>(__builtin_ctzll(v));
+#endif
+}
+
+/*  Each kernel below scans whole vectors only, and returns
+    the first matching position or the position where fewer
+    than one vector's worth of input remains. The caller
+    finishes the tail with a narrower kernel or scalar code.
+
+    A range pair [lo, hi] matches when (c - lo) <= (hi - lo)
+    using unsigned byte arithmetic, which is the same test
+    that pcmpestri performs in _SIDD_CMP_RANGES mode.
+*/
+
+BOOST_BEAST_TARGET_SSE42
+inline
+std::pair<char const*, bool>
+find_fast_sse42(
+    char const* buf,
+    char const* buf_end,
+    char const* ranges,
+    std::size_t ranges_size)
+{
+    BOOST_ALIGNMENT(16) char r[16] = {};
+    std::memcpy(r, ranges, ranges_size);
+    __m128i const r16 = _mm_load_si128(
+        reinterpret_cast<__m128i const*>(r));
+    int const rn = static_cast<int>(ranges_size);
+    while(buf_end - buf >= 16)
+    {
+        __m128i const b16 = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(buf));
+        int const i = _mm_cmpestri(
+            r16, rn, b16, 16,
+            _SIDD_LEAST_SIGNIFICANT |
+            _SIDD_CMP_RANGES |
+            _SIDD_UBYTE_OPS);
+        if(i != 16)
+            return {buf + i, true};
+        buf += 16;
+    }
+    return {buf, false};
+}
+
+BOOST_BEAST_TARGET_AVX2
+inline
+std::pair<char const*, bool>
+find_fast_avx2(
+    char const* buf,
+    char const* buf_end,
+    char const* ranges,
+    std::size_t ranges_size)
+{
+    __m256i lo[8];
+    __m256i span[8];
+    auto const n = ranges_size / 2;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        lo[i] = _mm256_set1_epi8(ranges[2 * i]);
+        span[i] = _mm256_set1_epi8(static_cast<char>(
+            ranges[2 * i + 1] - ranges[2 * i]));
+    }
+    while(buf_end - buf >= 32)
+    {
+        __m256i const v = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(buf));
+        __m256i m = _mm256_setzero_si256();
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            __m256i const d = _mm256_sub_epi8(v, lo[i]);
+            m = _mm256_or_si256(m, _mm256_cmpeq_epi8(
+                _mm256_min_epu8(d, span[i]), d));
+        }
+        auto const bits = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(m));
+        if(bits != 0)
+            return {buf + countr_zero(bits), true};
+        buf += 32;
+    }
+    return {buf, false};
+}
+
+BOOST_BEAST_TARGET_AVX512BW
+inline
+std::pair<char const*, bool>
+find_fast_avx512(
+    char const* buf,
+    char const* buf_end,
+    char const* ranges,
+    std::size_t ranges_size)
+{
+    __m512i lo[8];
+    __m512i span[8];
+    auto const n = ranges_size / 2;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        lo[i] = _mm512_set1_epi8(ranges[2 * i]);
+        span[i] = _mm512_set1_epi8(static_cast<char>(
+            ranges[2 * i + 1] - ranges[2 * i]));
+    }
+    while(buf_end - buf >= 64)
+    {
+        __m512i const v = _mm512_loadu_si512(buf);
+        std::uint64_t m = 0;
+        for(std::size_t i = 0; i < n; ++i)
+            m |= _mm512_cmple_epu8_mask(
+                _mm512_sub_epi8(v, lo[i]), span[i]);
+        if(m != 0)
+            return {buf + countr_zero(m), true};
+        buf += 64;
+    }
+    return {buf, false};
+}
+
+// Find "\r\n\r\n", comparing four shifted
+// loads so that every alignment is covered.
+
+BOOST_BEAST_TARGET_SSE42
+inline
+std::pair<char const*, bool>
+find_eom_sse42(char const* p, char const* last)
+{
+    __m128i const cr = _mm_set1_epi8('\r');
+    __m128i const lf = _mm_set1_epi8('\n');
+    while(last - p >= 16 + 3)
+    {
+        __m128i const v0 = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(p));
+        __m128i const v1 = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(p + 1));
+        __m128i const v2 = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(p + 2));
+        __m128i const v3 = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(p + 3));
+        __m128i const m = _mm_and_si128(
+            _mm_and_si128(
+                _mm_cmpeq_epi8(v0, cr),
+                _mm_cmpeq_epi8(v1, lf)),
+            _mm_and_si128(
+                _mm_cmpeq_epi8(v2, cr),
+                _mm_cmpeq_epi8(v3, lf)));
+        auto const bits = static_cast<std::uint32_t>(
+            _mm_movemask_epi8(m));
+        if(bits != 0)
+            return {p + countr_zero(bits) + 4, true};
+        p += 16;
+    }
+    return {p, false};
+}
+
+BOOST_BEAST_TARGET_AVX2
+inline
+std::pair<char const*, bool>
+find_eom_avx2(char const* p, char const* last)
+{
+    __m256i const cr = _mm256_set1_epi8('\r');
+    __m256i const lf = _mm256_set1_epi8('\n');
+    while(last - p >= 32 + 3)
+    {
+        __m256i const v0 = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(p));
+        __m256i const v1 = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(p + 1));
+        __m256i const v2 = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(p + 2));
+        __m256i const v3 = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(p + 3));
+        __m256i const m = _mm256_and_si256(
+            _mm256_and_si256(
+                _mm256_cmpeq_epi8(v0, cr),
+                _mm256_cmpeq_epi8(v1, lf)),
+            _mm256_and_si256(
+                _mm256_cmpeq_epi8(v2, cr),
+                _mm256_cmpeq_epi8(v3, lf)));
+        auto const bits = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(m));
+        if(bits != 0)
+            return {p + countr_zero(bits) + 4, true};
+        p += 32;
+    }
+    return {p, false};
+}
+
+BOOST_BEAST_TARGET_AVX512BW
+inline
+std::pair<char const*, bool>
+find_eom_avx512(char const* p, char const* last)
+{
+    __m512i const cr = _mm512_set1_epi8('\r');
+    __m512i const lf = _mm512_set1_epi8('\n');
+    while(last - p >= 64 + 3)
+    {
+        std::uint64_t const m =
+            _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(p), cr) &
+            _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(p + 1), lf) &
+            _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(p + 2), cr) &
+            _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(p + 3), lf);
+        if(m != 0)
+            return {p + countr_zero(m) + 4, true};
+        p += 64;
+    }
+    return {p, false};
+}
+
+} // simd
+
+#endif
+
 std::pair<char const*, bool>
 basic_parser_base::
 find_fast(
@@ -112,9 +363,60 @@ find_fast(
     char const* ranges,
     size_t ranges_size)
 {
-    bool found = false;
+    BOOST_ASSERT(ranges_size <= 16 && ranges_size % 2 == 0);
+#if ! BOOST_BEAST_NO_INTRINSICS
+    auto const& ci = beast::detail::get_cpu_info();
+    std::pair<char const*, bool> r{buf, false};
+    if(ci.avx512bw)
+    {
+        r = simd::find_fast_avx512(
+            r.first, buf_end, ranges, ranges_size);
+        if(r.second)
+            return r;
+    }
+    if(ci.avx2)
+    {
+        r = simd::find_fast_avx2(
+            r.first, buf_end, ranges, ranges_size);
+        if(r.second)
+            return r;
+    }
+    if(ci.sse42)
+        r = simd::find_fast_sse42(
+            r.first, buf_end, ranges, ranges_size);
+    return r;
+#else
     boost::ignore_unused(buf_end, ranges, ranges_size);
-    return {buf, found};
+    return {buf, false};
+#endif
+}
+
+std::pair<char const*, bool>
+basic_parser_base::
+find_eom_fast(char const* p, char const* last)
+{
+#if ! BOOST_BEAST_NO_INTRINSICS
+    auto const& ci = beast::detail::get_cpu_info();
+    std::pair<char const*, bool> r{p, false};
+    if(ci.avx512bw)
+    {
+        r = simd::find_eom_avx512(r.first, last);
+        if(r.second)
+            return r;
+    }
+    if(ci.avx2)
+    {
+        r = simd::find_eom_avx2(r.first, last);
+        if(r.second)
+            return r;
+    }
+    if(ci.sse42)
+        r = simd::find_eom_sse42(r.first, last);
+    return r;
+#else
+    boost::ignore_unused(last);
+    return {p, false};
+#endif
 }
 
 // VFALCO Can SIMD help this?
@@ -205,6 +507,10 @@ char const*
 basic_parser_base::
 find_eom(char const* p, char const* last)
 {
+    bool found;
+    std::tie(p, found) = find_eom_fast(p, last);
+    if(found)
+        return p;
     for(;;)
     {
         if(p + 4 > last)
@@ -245,6 +551,11 @@ parse_token_to_eol(
     char const*& token_last,
     error_code& ec)
 {
+    BOOST_ALIGNMENT(16) static const char ranges[] =
+        "\0\10"     /* control chars before HTAB */
+        "\12\37"    /* control chars after HTAB */
+        "\177\177"; /* DEL */
+    p = find_fast(p, last, ranges, sizeof(ranges)-1).first;
     for(;; ++p)
     {
         if(p >= last)
@@ -345,7 +656,11 @@ parse_target(
     string_view& result, error_code& ec)
 {
     // parse target SP
+    BOOST_ALIGNMENT(16) static const char ranges[] =
+        "\0 "        /* control chars and SP */
+        "\177\177"; /* DEL */
     auto const first = it;
+    it = find_fast(it, last, ranges, sizeof(ranges)-1).first;
     for(;; ++it)
     {
         if(it + 1 > last)
@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_DETAIL_FLAT_FIELDS_HPP
+#define BOOST_BEAST_HTTP_DETAIL_FLAT_FIELDS_HPP
+
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
+#include <boost/beast/core/detail/string.hpp>
+#include <boost/beast/http/field.hpp>
+#include <cstdint>
+
+// SSE2 is part of the baseline instruction set on x86-64,
+// so no runtime check is needed to compare keys eight at a time.
+#if ! BOOST_BEAST_NO_INTRINSICS && ( \
+    defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+# define BOOST_BEAST_FLAT_FIELDS_SSE2 1
+# include <emmintrin.h>
+#else
+# define BOOST_BEAST_FLAT_FIELDS_SSE2 0
+#endif
+
+namespace boost {
+namespace beast {
+namespace http {
+namespace detail {
+
+// Return the index of the first key equal to f, or n
+inline
+std::size_t
+find_field_key(
+    field const* keys, std::size_t n, field f)
+{
+    std::size_t i = 0;
+#if BOOST_BEAST_FLAT_FIELDS_SSE2
+    static_assert(sizeof(field) == 2, "");
+    __m128i const k = _mm_set1_epi16(
+        static_cast<short>(f));
+    for(; i + 8 <= n; i += 8)
+    {
+        __m128i const v = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(keys + i));
+        if(_mm_movemask_epi8(_mm_cmpeq_epi16(v, k)) != 0)
+            break;
+    }
+#endif
+    for(; i < n; ++i)
+        if(keys[i] == f)
+            return i;
+    return n;
+}
+
+// Case-insensitive hash of a field name
+inline
+std::uint32_t
+field_name_hash(field f, string_view s)
+{
+    if(f != field::unknown)
+        return static_cast<std::uint32_t>(f) * 0x9e3779b1;
+    std::uint32_t h = 2166136261;
+    for(auto c : s)
+    {
+        h ^= static_cast<unsigned char>(
+            beast::detail::ascii_tolower(c));
+        h *= 16777619;
+    }
+    return h ^ (h >> 15);
+}
+
+} // detail
+} // http
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,122 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_DETAIL_PERFECT_HASH_HPP
+#define BOOST_BEAST_HTTP_DETAIL_PERFECT_HASH_HPP
+
+#include <boost/beast/core/string.hpp>
+#include <cstdint>
+
+namespace boost {
+namespace beast {
+namespace http {
+namespace detail {
+
+/*  Digest used by the constant lookup tables for
+    string_to_field and string_to_verb.
+
+    Only the length and the first and last eight bytes are
+    mixed in, which is enough to tell every known name apart.
+    The tables are produced by tools/make_perfect_hash.py,
+    which implements the same functions; the two must be
+    changed together.
+*/
+struct perfect_hash
+{
+    static std::uint64_t constexpr seed = 0xd3f21dcc2be88b47;
+
+    // Or'ed into every byte to make the digest case-insensitive
+    static std::uint64_t constexpr fold = 0x2020202020202020;
+
+    static
+    std::uint64_t
+    load32(unsigned char const* p)
+    {
+        return
+            static_cast<std::uint64_t>(p[0])        |
+            (static_cast<std::uint64_t>(p[1]) <<  8) |
+            (static_cast<std::uint64_t>(p[2]) << 16) |
+            (static_cast<std::uint64_t>(p[3]) << 24);
+    }
+
+    static
+    std::uint64_t
+    load64(unsigned char const* p)
+    {
+        return load32(p) | (load32(p + 4) << 32);
+    }
+
+    static
+    std::uint64_t
+    digest(string_view s, std::uint64_t mask)
+    {
+        auto const n = s.size();
+        auto const p = reinterpret_cast<
+            unsigned char const*>(s.data());
+        std::uint64_t a;
+        std::uint64_t b;
+        if(n >= 8)
+        {
+            a = load64(p);
+            b = load64(p + n - 8);
+        }
+        else if(n >= 4)
+        {
+            a = load32(p);
+            b = load32(p + n - 4);
+        }
+        else if(n > 0)
+        {
+            a = p[0] |
+                (static_cast<std::uint64_t>(p[n / 2]) << 8) |
+                (static_cast<std::uint64_t>(p[n - 1]) << 16);
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+        a |= mask;
+        b |= mask;
+        std::uint64_t y = (a ^ (
+            static_cast<std::uint64_t>(n) << 58)) * seed;
+        y = ((y ^ (y >> 29)) + b) * seed;
+        return y ^ (y >> 32);
+    }
+
+    // Cheaper digest of the length and first four
+    // bytes, which is all it takes to tell verbs apart.
+    static
+    std::uint64_t
+    digest4(string_view s)
+    {
+        auto const n = s.size();
+        auto const p = reinterpret_cast<
+            unsigned char const*>(s.data());
+        std::uint64_t a;
+        if(n >= 4)
+            a = load32(p);
+        else if(n > 0)
+            a = p[0] |
+                (static_cast<std::uint64_t>(p[n / 2]) << 8) |
+                (static_cast<std::uint64_t>(p[n - 1]) << 16);
+        else
+            a = 0;
+        return (a ^ (
+            static_cast<std::uint64_t>(n) << 58)) * seed;
+    }
+};
+
+} // detail
+} // http
+} // beast
+} // boost
+
+#endif
@@ -42,8 +42,14 @@ namespace http {
     Field names are stored as-is, but comparisons are case-insensitive.
     The container behaves as a `std::multiset`; there will be a separate
     value for each occurrence of the same field name. When the container
-    is iterated the fields are presented in the order of insertion, with
-    fields having the same name following each other consecutively.
+    is iterated the fields are presented in the order of insertion, except
+    that fields having the same unknown name follow each other
+    consecutively.
+
+    Fields with a known name are located through a small hash table
+    keyed by the @ref field enumeration, so lookups of those fields
+    take constant time. Only fields with an unknown name are kept in
+    an ordered set.
 
     Meets the requirements of <em>Fields</em>
 
@@ -204,6 +210,12 @@ private:
     using size_type = typename
         beast::detail::allocator_traits<Allocator>::size_type;
 
+    using index_alloc_type = typename
+        beast::detail::allocator_traits<Allocator>::
+            template rebind_alloc<element*>;
+
+    using index_traits =
+        beast::detail::allocator_traits<index_alloc_type>;
 
 public:
     /// Destructor
@@ -276,7 +288,7 @@ public:
 #if BOOST_BEAST_DOXYGEN
     using const_iterator = __implementation_defined__;
 #else
-    using const_iterator = typename list_t::const_iterator;
+    class const_iterator;
 #endif
 
     /// A constant iterator to the field sequence.
@@ -597,6 +609,10 @@ public:
 
     /** Returns a range of iterators to the fields with the specified name.
 
+        The fields are visited in the order of insertion. Incrementing
+        or decrementing an iterator in the range skips the fields with
+        other names which were inserted between them.
+
         @param name The field name.
 
         @return A range of iterators to fields with the same name,
@@ -607,6 +623,10 @@ public:
 
     /** Returns a range of iterators to the fields with the specified name.
 
+        When the name is that of a known @ref field, this behaves
+        as `equal_range(string_to_field(name))`. Otherwise the fields
+        in the range follow each other consecutively.
+
         @param name The field name.
 
         @return A range of iterators to fields with the same name,
@@ -717,6 +737,30 @@ private:
     void
     set_element(element& e);
 
+    element*
+    first_element(field name) const;
+
+    element**
+    index_slot(field name) const;
+
+    void
+    index_erase(element** slot);
+
+    void
+    reserve_index(field name);
+
+    void
+    link_element(element& e);
+
+    void
+    unlink_element(element& e);
+
+    std::size_t
+    erase_known(field name);
+
+    void
+    free_index();
+
     void
     realloc_string(string_view& dest, string_view s);
 
@@ -752,8 +796,11 @@ private:
     void
     swap(basic_fields& other, std::false_type);
 
-    set_t set_;
+    set_t set_;                     // fields with unknown names
     list_t list_;
+    element** index_ = nullptr;     // first field for each known name
+    std::uint16_t index_used_ = 0;  // names in index_
+    std::uint8_t index_bits_ = 0;   // index_ has 2^index_bits_ slots
     string_view method_;
     string_view target_or_reason_;
 };
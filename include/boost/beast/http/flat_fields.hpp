@@ -0,0 +1,744 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_FLAT_FIELDS_HPP
+#define BOOST_BEAST_HTTP_FLAT_FIELDS_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/string_param.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/core/detail/allocator.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/core/empty_value.hpp>
+#include <boost/optional.hpp>
+#include <boost/type_traits/type_with_alignment.hpp>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A container for storing HTTP header fields in contiguous memory.
+
+    This container offers the same interface as @ref basic_fields,
+    and meets the requirements of <em>Fields</em>, but stores every
+    field in a single growable block instead of one allocation per
+    field. The block holds a small index entry for each field and
+    the serialized text of the fields, `name: value\r\n`, in the
+    order in which they are iterated, along with the request-method
+    and request-target or reason-phrase.
+
+    Headers totaling up to @ref inline_size bytes of storage fit in
+    the container itself and need no allocation at all. Lookup scans
+    the index linearly, comparing field enumerations several at a
+    time when the processor supports it. Once there are more than
+    @ref hash_threshold fields, a hash index is kept as well so
+    lookups stay constant-time for very large headers.
+
+    Field names are stored as-is, but comparisons are case-insensitive.
+    The container behaves as a `std::multiset`; there will be a separate
+    value for each occurrence of the same field name. When the container
+    is iterated the fields are presented in the order of insertion, with
+    fields having the same name following each other consecutively.
+
+    Unlike @ref basic_fields, fields having the same known name are
+    also kept together, and inserting or erasing a field invalidates
+    all iterators and all strings previously obtained from the container.
+
+    Meets the requirements of <em>Fields</em>
+
+    @tparam Allocator The allocator to use.
+*/
+template<class Allocator>
+class basic_flat_fields
+#if ! BOOST_BEAST_DOXYGEN
+    : private boost::empty_value<Allocator>
+#endif
+{
+    // Fancy pointers are not supported
+    static_assert(std::is_pointer<typename
+        std::allocator_traits<Allocator>::pointer>::value,
+        "Allocator must use regular pointers");
+
+    using off_t = std::uint16_t;
+
+public:
+    /// The type of allocator used.
+    using allocator_type = Allocator;
+
+    /// The number of bytes of storage held inside the container
+    static std::size_t constexpr inline_size = 1024;
+
+    /// The number of fields above which a hash index is maintained
+    static std::size_t constexpr hash_threshold = 32;
+
+    /// The type of element used to represent a field
+    class value_type
+    {
+        friend class basic_flat_fields;
+
+        template<class OtherAlloc>
+        friend class basic_flat_fields;
+
+        char const* p_;
+        off_t nlen_;
+        off_t vlen_;
+        field f_;
+
+    public:
+        /// Returns the field enum, which can be @ref field::unknown
+        field
+        name() const
+        {
+            return f_;
+        }
+
+        /// Returns the field name as a string
+        string_view const
+        name_string() const
+        {
+            return {p_, nlen_};
+        }
+
+        /// Returns the value of the field
+        string_view const
+        value() const
+        {
+            return {p_ + nlen_ + 2, vlen_};
+        }
+    };
+
+    /// The algorithm used to serialize the header
+#if BOOST_BEAST_DOXYGEN
+    using writer = __implementation_defined__;
+#else
+    class writer;
+#endif
+
+private:
+    using align_type = typename
+        boost::type_with_alignment<alignof(value_type)>::type;
+
+    using rebind_type = typename
+        beast::detail::allocator_traits<Allocator>::
+            template rebind_alloc<align_type>;
+
+    using alloc_traits =
+        beast::detail::allocator_traits<rebind_type>;
+
+    using index_alloc_type = typename
+        beast::detail::allocator_traits<Allocator>::
+            template rebind_alloc<std::uint32_t>;
+
+    using index_traits =
+        beast::detail::allocator_traits<index_alloc_type>;
+
+    // Fields held in inline storage before the first allocation
+    static std::size_t constexpr inline_fields = 16;
+
+public:
+    /// Destructor
+    ~basic_flat_fields();
+
+    /// Constructor.
+    basic_flat_fields();
+
+    /** Constructor.
+
+        @param alloc The allocator to use.
+    */
+    explicit
+    basic_flat_fields(Allocator const& alloc) noexcept;
+
+    /** Move constructor.
+
+        The state of the moved-from object is
+        as if constructed using the same allocator.
+    */
+    basic_flat_fields(basic_flat_fields&&) noexcept;
+
+    /** Move constructor.
+
+        The state of the moved-from object is
+        as if constructed using the same allocator.
+
+        @param alloc The allocator to use.
+    */
+    basic_flat_fields(basic_flat_fields&&, Allocator const& alloc);
+
+    /// Copy constructor.
+    basic_flat_fields(basic_flat_fields const&);
+
+    /** Copy constructor.
+
+        @param alloc The allocator to use.
+    */
+    basic_flat_fields(basic_flat_fields const&, Allocator const& alloc);
+
+    /// Copy constructor.
+    template<class OtherAlloc>
+    basic_flat_fields(basic_flat_fields<OtherAlloc> const&);
+
+    /** Copy constructor.
+
+        @param alloc The allocator to use.
+    */
+    template<class OtherAlloc>
+    basic_flat_fields(basic_flat_fields<OtherAlloc> const&,
+        Allocator const& alloc);
+
+    /** Move assignment.
+
+        The state of the moved-from object is
+        as if constructed using the same allocator.
+    */
+    basic_flat_fields& operator=(basic_flat_fields&&) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value);
+
+    /// Copy assignment.
+    basic_flat_fields& operator=(basic_flat_fields const&);
+
+    /// Copy assignment.
+    template<class OtherAlloc>
+    basic_flat_fields& operator=(basic_flat_fields<OtherAlloc> const&);
+
+public:
+    /// A constant iterator to the field sequence.
+#if BOOST_BEAST_DOXYGEN
+    using const_iterator = __implementation_defined__;
+#else
+    using const_iterator = value_type const*;
+#endif
+
+    /// A constant iterator to the field sequence.
+    using iterator = const_iterator;
+
+    /// Return a copy of the allocator associated with the container.
+    allocator_type
+    get_allocator() const
+    {
+        return this->get();
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // Element access
+    //
+    //--------------------------------------------------------------------------
+
+    /** Returns the value for a field, or throws an exception.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+
+        @return The field value.
+
+        @throws std::out_of_range if the field is not found.
+    */
+    string_view const
+    at(field name) const;
+
+    /** Returns the value for a field, or throws an exception.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+
+        @return The field value.
+
+        @throws std::out_of_range if the field is not found.
+    */
+    string_view const
+    at(string_view name) const;
+
+    /** Returns the value for a field, or `""` if it does not exist.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+    */
+    string_view const
+    operator[](field name) const;
+
+    /** Returns the value for a case-insensitive matching header, or `""` if it does not exist.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+    */
+    string_view const
+    operator[](string_view name) const;
+
+    //--------------------------------------------------------------------------
+    //
+    // Iterators
+    //
+    //--------------------------------------------------------------------------
+
+    /// Return a const iterator to the beginning of the field sequence.
+    const_iterator
+    begin() const
+    {
+        return list_;
+    }
+
+    /// Return a const iterator to the end of the field sequence.
+    const_iterator
+    end() const
+    {
+        return list_ + size_;
+    }
+
+    /// Return a const iterator to the beginning of the field sequence.
+    const_iterator
+    cbegin() const
+    {
+        return begin();
+    }
+
+    /// Return a const iterator to the end of the field sequence.
+    const_iterator
+    cend() const
+    {
+        return end();
+    }
+
+    //--------------------------------------------------------------------------
+    //
+    // Capacity
+    //
+    //--------------------------------------------------------------------------
+
+private:
+    // VFALCO Since the header and message derive from Fields,
+    //        what does the expression m.empty() mean? Its confusing.
+    bool
+    empty() const
+    {
+        return size_ == 0;
+    }
+public:
+
+    /** Reserve storage.
+
+        This function ensures that the container can hold at least
+        `fields` fields whose names and values total `bytes` octets
+        without allocating.
+
+        @param fields The number of fields.
+
+        @param bytes The total size of the field names and values.
+    */
+    void
+    reserve(std::size_t fields, std::size_t bytes);
+
+    //--------------------------------------------------------------------------
+    //
+    // Modifiers
+    //
+    //--------------------------------------------------------------------------
+
+    /** Remove all fields from the container
+
+        All references, pointers, or iterators referring to contained
+        elements are invalidated. All past-the-end iterators are also
+        invalidated. The storage is retained.
+
+        @par Postconditions:
+        @code
+            std::distance(this->begin(), this->end()) == 0
+        @endcode
+    */
+    void
+    clear();
+
+    /** Insert a field.
+
+        If one or more fields with the same name already exist,
+        the new field will be inserted after the last field with
+        the matching name, in serialization order.
+
+        @param name The field name.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    insert(field name, string_param const& value);
+
+    /** Insert a field.
+
+        If one or more fields with the same name already exist,
+        the new field will be inserted after the last field with
+        the matching name, in serialization order.
+
+        @param name The field name.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    insert(string_view name, string_param const& value);
+
+    /** Insert a field.
+
+        If one or more fields with the same name already exist,
+        the new field will be inserted after the last field with
+        the matching name, in serialization order.
+
+        @param name The field name.
+
+        @param name_string The literal text corresponding to the
+        field name. If `name != field::unknown`, then this value
+        must be equal to `to_string(name)` using a case-insensitive
+        comparison, otherwise the behavior is undefined.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    insert(field name, string_view name_string,
+        string_param const& value);
+
+    /** Set a field value, removing any other instances of that field.
+
+        First removes any values with matching field names, then
+        inserts the new field value.
+
+        @param name The field name.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    set(field name, string_param const& value);
+
+    /** Set a field value, removing any other instances of that field.
+
+        First removes any values with matching field names, then
+        inserts the new field value.
+
+        @param name The field name.
+
+        @param value The value of the field, as a @ref string_param
+    */
+    void
+    set(string_view name, string_param const& value);
+
+    /** Remove a field.
+
+        All references and iterators are invalidated.
+
+        @param pos An iterator to the element to remove.
+
+        @return An iterator following the last removed element.
+        If the iterator refers to the last element, the end()
+        iterator is returned.
+    */
+    const_iterator
+    erase(const_iterator pos);
+
+    /** Remove all fields with the specified name.
+
+        All fields with the same field name are erased from the
+        container. All references and iterators are invalidated.
+
+        @param name The field name.
+
+        @return The number of fields removed.
+    */
+    std::size_t
+    erase(field name);
+
+    /** Remove all fields with the specified name.
+
+        All fields with the same field name are erased from the
+        container. All references and iterators are invalidated.
+
+        @param name The field name.
+
+        @return The number of fields removed.
+    */
+    std::size_t
+    erase(string_view name);
+
+    /// Swap this container with another
+    void
+    swap(basic_flat_fields& other);
+
+    /// Swap two field containers
+    template<class Alloc>
+    friend
+    void
+    swap(basic_flat_fields<Alloc>& lhs, basic_flat_fields<Alloc>& rhs);
+
+    //--------------------------------------------------------------------------
+    //
+    // Lookup
+    //
+    //--------------------------------------------------------------------------
+
+    /** Return the number of fields with the specified name.
+
+        @param name The field name.
+    */
+    std::size_t
+    count(field name) const;
+
+    /** Return the number of fields with the specified name.
+
+        @param name The field name.
+    */
+    std::size_t
+    count(string_view name) const;
+
+    /** Returns an iterator to the case-insensitive matching field.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The field name.
+
+        @return An iterator to the matching field, or `end()` if
+        no match was found.
+    */
+    const_iterator
+    find(field name) const;
+
+    /** Returns an iterator to the case-insensitive matching field name.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The field name.
+
+        @return An iterator to the matching field, or `end()` if
+        no match was found.
+    */
+    const_iterator
+    find(string_view name) const;
+
+    /** Returns a range of iterators to the fields with the specified name.
+
+        @param name The field name.
+
+        @return A range of iterators to fields with the same name,
+        otherwise an empty range.
+    */
+    std::pair<const_iterator, const_iterator>
+    equal_range(field name) const;
+
+    /** Returns a range of iterators to the fields with the specified name.
+
+        @param name The field name.
+
+        @return A range of iterators to fields with the same name,
+        otherwise an empty range.
+    */
+    std::pair<const_iterator, const_iterator>
+    equal_range(string_view name) const;
+
+protected:
+    /** Returns the request-method string.
+
+        @note Only called for requests.
+    */
+    string_view
+    get_method_impl() const;
+
+    /** Returns the request-target string.
+
+        @note Only called for requests.
+    */
+    string_view
+    get_target_impl() const;
+
+    /** Returns the response reason-phrase string.
+
+        @note Only called for responses.
+    */
+    string_view
+    get_reason_impl() const;
+
+    /** Returns the chunked Transfer-Encoding setting
+    */
+    bool
+    get_chunked_impl() const;
+
+    /** Returns the keep-alive setting
+    */
+    bool
+    get_keep_alive_impl(unsigned version) const;
+
+    /** Returns `true` if the Content-Length field is present.
+    */
+    bool
+    has_content_length_impl() const;
+
+    /** Set or clear the method string.
+
+        @note Only called for requests.
+    */
+    void
+    set_method_impl(string_view s);
+
+    /** Set or clear the target string.
+
+        @note Only called for requests.
+    */
+    void
+    set_target_impl(string_view s);
+
+    /** Set or clear the reason string.
+
+        @note Only called for responses.
+    */
+    void
+    set_reason_impl(string_view s);
+
+    /** Adjusts the chunked Transfer-Encoding value
+    */
+    void
+    set_chunked_impl(bool value);
+
+    /** Sets or clears the Content-Length field
+    */
+    void
+    set_content_length_impl(
+        boost::optional<std::uint64_t> const& value);
+
+    /** Adjusts the Connection field
+    */
+    void
+    set_keep_alive_impl(
+        unsigned version, bool keep_alive);
+
+private:
+    template<class OtherAlloc>
+    friend class basic_flat_fields;
+
+    std::size_t
+    find_index(field name) const;
+
+    std::size_t
+    find_index(string_view name, field f) const;
+
+    std::size_t
+    run_length(std::size_t i) const;
+
+    bool
+    owns(string_view s) const;
+
+    bool
+    same_name(std::size_t i, std::size_t j) const;
+
+    bool
+    is_inline() const;
+
+    void
+    use_inline();
+
+    char*
+    fields_data() const
+    {
+        return buf_ + method_len_ + tor_len_;
+    }
+
+    void
+    grow(std::size_t fields, std::size_t bytes);
+
+    void
+    insert_at(std::size_t i, field name,
+        string_view sname, string_view value);
+
+    void
+    insert_field(field name,
+        string_view sname, string_view value, bool replace);
+
+    void
+    erase_at(std::size_t i, std::size_t n);
+
+    void
+    set_prefix(std::uint32_t& len,
+        string_view s, bool space);
+
+    void
+    index_insert(std::size_t i);
+
+    void
+    index_rebuild();
+
+    void
+    index_release();
+
+    template<class OtherAlloc>
+    void
+    copy_all(basic_flat_fields<OtherAlloc> const&);
+
+    void
+    clear_all();
+
+    void
+    release();
+
+    void
+    steal(basic_flat_fields& other);
+
+    void
+    move_assign(basic_flat_fields&, std::true_type);
+
+    void
+    move_assign(basic_flat_fields&, std::false_type);
+
+    void
+    copy_assign(basic_flat_fields const&, std::true_type);
+
+    void
+    copy_assign(basic_flat_fields const&, std::false_type);
+
+    void
+    swap(basic_flat_fields& other, std::true_type);
+
+    void
+    swap(basic_flat_fields& other, std::false_type);
+
+    // The block holds `cap_` index entries, then `cap_`
+    // field enums, then `room_` octets of text: the method,
+    // the target or reason, and the serialized fields.
+
+    value_type* list_;
+    field* keys_;
+    char* buf_;
+    std::uint32_t size_ = 0;            // number of fields
+    std::uint32_t cap_ = 0;             // capacity of list_ and keys_
+    std::uint32_t len_ = 0;             // octets used in buf_
+    std::uint32_t room_ = 0;            // capacity of buf_
+    std::uint32_t method_len_ = 0;
+    std::uint32_t tor_len_ = 0;         // target or reason
+    std::uint32_t* index_ = nullptr;    // hash index, or null
+    std::uint32_t index_size_ = 0;      // power of two
+    typename std::aligned_storage<
+        inline_size, alignof(value_type)>::type inline_;
+};
+
+/// A typical HTTP header fields container using contiguous storage
+using flat_fields = basic_flat_fields<std::allocator<char>>;
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/http/impl/flat_fields.hpp>
+
+#endif
@@ -0,0 +1,654 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_HEADER_PARSER_HPP
+#define BOOST_BEAST_HTTP_HEADER_PARSER_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/http/basic_parser.hpp>
+#include <boost/beast/http/buffer_body.hpp>
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/status.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+template<bool isRequest>
+class header_parser;
+
+/** A read-only view of the fields in a parsed HTTP header.
+
+    Objects of this type are produced by @ref header_parser. The
+    view holds no copies of field names or values. Each field is
+    recorded as an offset and length into the octets presented to
+    the parser, so building the view allocates nothing per field.
+
+    The interface mirrors the read-only members of @ref basic_fields.
+    Lookup by name is case-insensitive, and iteration visits fields
+    in the order in which they were received.
+*/
+class fields_view
+{
+    template<bool>
+    friend class header_parser;
+
+protected:
+    struct entry
+    {
+        std::uint32_t name_off;
+        std::uint32_t name_len;
+        std::uint32_t value_off;
+        std::uint32_t value_len;
+        field f;
+        unsigned char copied;       // copiedName | copiedValue
+    };
+
+    static unsigned char constexpr copiedName = 1;
+    static unsigned char constexpr copiedValue = 2;
+
+    string_view
+    name_of(entry const& e) const
+    {
+        return {((e.copied & copiedName) ?
+            copy_ : in_) + e.name_off, e.name_len};
+    }
+
+    string_view
+    value_of(entry const& e) const
+    {
+        return {((e.copied & copiedValue) ?
+            copy_ : in_) + e.value_off, e.value_len};
+    }
+
+private:
+    char const* in_ = nullptr;      // strings in the input
+    char const* copy_ = nullptr;    // strings in parser storage
+    entry const* list_ = nullptr;
+    std::size_t size_ = 0;
+
+public:
+    /// The type of element used to represent a field
+    class value_type
+    {
+        friend class fields_view;
+
+        fields_view const* v_ = nullptr;
+        entry const* e_ = nullptr;
+
+        value_type(
+            fields_view const* v,
+            entry const* e)
+            : v_(v)
+            , e_(e)
+        {
+        }
+
+    public:
+        /// Constructor
+        value_type() = default;
+
+        /// Returns the field enum, which can be @ref field::unknown
+        field
+        name() const
+        {
+            return e_->f;
+        }
+
+        /// Returns the field name as a string
+        string_view
+        name_string() const
+        {
+            return v_->name_of(*e_);
+        }
+
+        /// Returns the value of the field
+        string_view
+        value() const
+        {
+            return v_->value_of(*e_);
+        }
+    };
+
+    /// A constant iterator to the field sequence.
+#if BOOST_BEAST_DOXYGEN
+    using const_iterator = __implementation_defined__;
+#else
+    class const_iterator
+    {
+        friend class fields_view;
+
+        fields_view::value_type v_;
+
+        explicit
+        const_iterator(fields_view::value_type v)
+            : v_(v)
+        {
+        }
+
+    public:
+        using value_type = fields_view::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type const*;
+        using reference = value_type const&;
+        using iterator_category = std::forward_iterator_tag;
+
+        const_iterator() = default;
+
+        bool
+        operator==(const_iterator const& other) const
+        {
+            return v_.e_ == other.v_.e_;
+        }
+
+        bool
+        operator!=(const_iterator const& other) const
+        {
+            return v_.e_ != other.v_.e_;
+        }
+
+        reference
+        operator*() const
+        {
+            return v_;
+        }
+
+        pointer
+        operator->() const
+        {
+            return &v_;
+        }
+
+        const_iterator&
+        operator++()
+        {
+            ++v_.e_;
+            return *this;
+        }
+
+        const_iterator
+        operator++(int)
+        {
+            auto temp = *this;
+            ++(*this);
+            return temp;
+        }
+    };
+#endif
+
+    /// A constant iterator to the field sequence.
+    using iterator = const_iterator;
+
+    /// Constructor
+    fields_view() = default;
+
+    /// Return a const iterator to the beginning of the field sequence.
+    const_iterator
+    begin() const
+    {
+        return const_iterator{value_type{this, list_}};
+    }
+
+    /// Return a const iterator to the end of the field sequence.
+    const_iterator
+    end() const
+    {
+        return const_iterator{value_type{this, list_ + size_}};
+    }
+
+    /// Return a const iterator to the beginning of the field sequence.
+    const_iterator
+    cbegin() const
+    {
+        return begin();
+    }
+
+    /// Return a const iterator to the end of the field sequence.
+    const_iterator
+    cend() const
+    {
+        return end();
+    }
+
+    /// Return the number of fields, including duplicates
+    std::size_t
+    size() const
+    {
+        return size_;
+    }
+
+    /** Returns the value for a field, or throws an exception.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+
+        @return The field value.
+
+        @throws std::out_of_range if the field is not found.
+    */
+    BOOST_BEAST_DECL
+    string_view const
+    at(field name) const;
+
+    /** Returns the value for a field, or throws an exception.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+
+        @return The field value.
+
+        @throws std::out_of_range if the field is not found.
+    */
+    BOOST_BEAST_DECL
+    string_view const
+    at(string_view name) const;
+
+    /** Returns the value for a field, or `""` if it does not exist.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+    */
+    BOOST_BEAST_DECL
+    string_view const
+    operator[](field name) const;
+
+    /** Returns the value for a case-insensitive matching header, or `""` if it does not exist.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The name of the field.
+    */
+    BOOST_BEAST_DECL
+    string_view const
+    operator[](string_view name) const;
+
+    /** Return the number of fields with the specified name.
+
+        @param name The field name.
+    */
+    BOOST_BEAST_DECL
+    std::size_t
+    count(field name) const;
+
+    /** Return the number of fields with the specified name.
+
+        @param name The field name.
+    */
+    BOOST_BEAST_DECL
+    std::size_t
+    count(string_view name) const;
+
+    /** Returns an iterator to the case-insensitive matching field.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The field name.
+
+        @return An iterator to the matching field, or `end()` if
+        no match was found.
+    */
+    BOOST_BEAST_DECL
+    const_iterator
+    find(field name) const;
+
+    /** Returns an iterator to the case-insensitive matching field name.
+
+        If more than one field with the specified name exists, the
+        first field defined by insertion order is returned.
+
+        @param name The field name.
+
+        @return An iterator to the matching field, or `end()` if
+        no match was found.
+    */
+    BOOST_BEAST_DECL
+    const_iterator
+    find(string_view name) const;
+};
+
+/** A read-only view of a parsed HTTP header.
+
+    This holds the start-line and a @ref fields_view of a header
+    produced by @ref header_parser. Strings returned by its members
+    point into the same storage as the fields.
+
+    @tparam isRequest `true` if this represents a request header.
+*/
+template<bool isRequest>
+class header_view : public fields_view
+{
+    template<bool>
+    friend class header_parser;
+
+    entry line_{};      // name is the method, value the target
+    verb method_ = verb::unknown;
+    unsigned version_ = 11;
+
+public:
+    /// Indicates if the header is a request or response.
+    using is_request = std::true_type;
+
+    /// Constructor
+    header_view() = default;
+
+    /// Return the request-method verb.
+    verb
+    method() const
+    {
+        return method_;
+    }
+
+    /// Return the request-method as a string.
+    string_view
+    method_string() const
+    {
+        return name_of(line_);
+    }
+
+    /// Returns the request-target string.
+    string_view
+    target() const
+    {
+        return value_of(line_);
+    }
+
+    /// Return the HTTP-version, 10 for HTTP/1.0 and 11 for HTTP/1.1.
+    unsigned
+    version() const noexcept
+    {
+        return version_;
+    }
+};
+
+/** A read-only view of a parsed HTTP header.
+
+    This holds the start-line and a @ref fields_view of a header
+    produced by @ref header_parser. Strings returned by its members
+    point into the same storage as the fields.
+*/
+template<>
+class header_view<false> : public fields_view
+{
+    template<bool>
+    friend class header_parser;
+
+    entry line_{};      // value is the reason-phrase
+    unsigned result_ = 200;
+    unsigned version_ = 11;
+
+public:
+    /// Indicates if the header is a request or response.
+    using is_request = std::false_type;
+
+    /// Constructor
+    header_view() = default;
+
+    /// The response status-code result.
+    status
+    result() const
+    {
+        return int_to_status(result_);
+    }
+
+    /// Return the response status-code as an integer.
+    unsigned
+    result_int() const
+    {
+        return result_;
+    }
+
+    /// Return the response reason-phrase.
+    string_view
+    reason() const
+    {
+        return value_of(line_);
+    }
+
+    /// Return the HTTP-version, 10 for HTTP/1.0 and 11 for HTTP/1.1.
+    unsigned
+    version() const noexcept
+    {
+        return version_;
+    }
+};
+
+/** An HTTP/1 parser which indexes the header in place.
+
+    This class uses the basic HTTP/1 wire format parser to produce a
+    @ref header_view. Instead of copying each field name and value
+    into a container, the parser records the offset and length of
+    each field in the octets it was given. The index is kept in
+    storage inside the parser for headers with up to
+    @ref inline_fields fields, so parsing such a header performs no
+    memory allocation.
+
+    Strings in the view point into the buffer passed to @ref put,
+    and remain valid for as long as the caller leaves that memory
+    unchanged. After @ref read_header returns with a
+    @ref beast::flat_buffer, the octets of the header have been
+    consumed from the buffer but are not overwritten until the
+    buffer is next modified. When the input is not a single
+    contiguous buffer, or a field value contains obs-fold, the
+    affected strings are copied into storage owned by the parser
+    instead.
+
+    The parser waits until the whole header has been received
+    before it parses any of it, so all strings in the view point
+    into the same buffer.
+
+    The body, if any, is delivered in the same way as with a
+    @ref parser using @ref buffer_body: the caller points
+    @ref body at storage to receive octets, and @ref put returns
+    @ref error::need_buffer when that storage is full.
+
+    @tparam isRequest Indicates whether a request or response
+    will be parsed.
+
+    @note A new instance of the parser is required for each message.
+*/
+template<bool isRequest>
+class header_parser
+    : public basic_parser<isRequest>
+{
+    using entry = fields_view::entry;
+
+public:
+    /// The number of fields which can be indexed without allocating
+    static std::size_t constexpr inline_fields = 32;
+
+    /// The type of view returned by the parser
+    using value_type = header_view<isRequest>;
+
+private:
+    value_type h_;
+    buffer_body::value_type body_;
+    std::string copy_;
+    std::size_t capacity_ = inline_fields;
+    std::unique_ptr<entry[]> heap_;
+    entry inline_[inline_fields];
+
+public:
+    /// Destructor
+    ~header_parser() = default;
+
+    /// Constructor (disallowed)
+    header_parser(header_parser const&) = delete;
+
+    /// Assignment (disallowed)
+    header_parser& operator=(header_parser const&) = delete;
+
+    /// Constructor (disallowed)
+    header_parser(header_parser&&) = delete;
+
+    /// Constructor
+    header_parser();
+
+    /** Returns the parsed header.
+
+        @note The return value is undefined unless
+        @ref is_header_done would return `true`.
+    */
+    value_type const&
+    get() const
+    {
+        return h_;
+    }
+
+    /** Returns the storage which receives body octets.
+
+        The members have the same meaning as when parsing a
+        message with @ref buffer_body.
+    */
+    buffer_body::value_type&
+    body()
+    {
+        return body_;
+    }
+
+private:
+    entry*
+    list()
+    {
+        return heap_ ? heap_.get() : inline_;
+    }
+
+    void
+    record(
+        std::uint32_t& off,
+        std::uint32_t& len,
+        unsigned char& copied,
+        unsigned char bit,
+        string_view s);
+
+    std::size_t
+    put_body(string_view body, error_code& ec);
+
+    void
+    on_request_impl(
+        verb method,
+        string_view method_str,
+        string_view target,
+        int version,
+        error_code& ec,
+        std::true_type);
+
+    void
+    on_request_impl(
+        verb, string_view, string_view,
+        int, error_code&, std::false_type)
+    {
+    }
+
+    void
+    on_request_impl(
+        verb method,
+        string_view method_str,
+        string_view target,
+        int version,
+        error_code& ec) override
+    {
+        this->on_request_impl(
+            method, method_str, target, version, ec,
+            std::integral_constant<bool, isRequest>{});
+    }
+
+    void
+    on_response_impl(
+        int code,
+        string_view reason,
+        int version,
+        error_code& ec,
+        std::true_type);
+
+    void
+    on_response_impl(
+        int, string_view, int,
+        error_code&, std::false_type)
+    {
+    }
+
+    void
+    on_response_impl(
+        int code,
+        string_view reason,
+        int version,
+        error_code& ec) override
+    {
+        this->on_response_impl(
+            code, reason, version, ec,
+            std::integral_constant<bool, ! isRequest>{});
+    }
+
+    void
+    on_field_impl(
+        field name,
+        string_view name_string,
+        string_view value,
+        error_code& ec) override;
+
+    void
+    on_header_impl(error_code& ec) override;
+
+    void
+    on_body_init_impl(
+        boost::optional<std::uint64_t> const& content_length,
+        error_code& ec) override;
+
+    std::size_t
+    on_body_impl(
+        string_view body,
+        error_code& ec) override;
+
+    void
+    on_chunk_header_impl(
+        std::uint64_t size,
+        string_view extensions,
+        error_code& ec) override;
+
+    std::size_t
+    on_chunk_body_impl(
+        std::uint64_t remain,
+        string_view body,
+        error_code& ec) override;
+
+    void
+    on_finish_impl(error_code& ec) override;
+};
+
+/// An HTTP/1 parser which indexes a request header in place.
+using request_header_parser = header_parser<true>;
+
+/// An HTTP/1 parser which indexes a response header in place.
+using response_header_parser = header_parser<false>;
+
+} // http
+} // beast
+} // boost
+
+#include <boost/beast/http/impl/header_parser.hpp>
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/http/impl/header_parser.ipp>
+#endif
+
+#endif
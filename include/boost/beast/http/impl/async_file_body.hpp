@@ -0,0 +1,440 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_ASYNC_FILE_BODY_HPP
+#define BOOST_BEAST_HTTP_IMPL_ASYNC_FILE_BODY_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/make_unique.hpp>
+#include <algorithm>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+template<class File>
+void
+basic_async_file_body<File>::
+value_type::
+close()
+{
+    error_code ignored;
+    file_.close(ignored);
+    st_.reset();
+}
+
+template<class File>
+void
+basic_async_file_body<File>::
+value_type::
+open(char const* path, file_mode mode, error_code& ec)
+{
+    file_.open(path, mode, ec);
+    if(ec)
+        return;
+    file_size_ = file_.size(ec);
+    if(ec)
+    {
+        close();
+        return;
+    }
+    init_state();
+}
+
+template<class File>
+void
+basic_async_file_body<File>::
+value_type::
+reset(File&& file, error_code& ec)
+{
+    if(file_.is_open())
+    {
+        error_code ignored;
+        file_.close(ignored);
+    }
+    file_ = std::move(file);
+    file_size_ = file_.size(ec);
+    if(ec)
+        return;
+    init_state();
+}
+
+template<class File>
+void
+basic_async_file_body<File>::
+value_type::
+init_state()
+{
+    remain_ = file_size_;
+    st_ = boost::make_unique<state>();
+    if(remain_ == 0)
+        return;
+    auto const n = static_cast<std::size_t>((std::min)(
+        remain_, static_cast<std::uint64_t>(buffer_size_)));
+    st_->size = n;
+    st_->buf[0].reset(new char[n]);
+    if(remain_ > n)
+        st_->buf[1].reset(new char[n]);
+}
+
+// Read the next block into the buffer which the writer
+// is not using. This runs on the file executor during an
+// asynchronous write, and on the caller's thread otherwise.
+template<class File>
+void
+basic_async_file_body<File>::
+value_type::
+fill()
+{
+    BOOST_ASSERT(need_fill());
+    auto& st = *st_;
+    auto const i = st.cur ^ 1;
+    if(! st.buf[i])
+        std::swap(st.buf[0], st.buf[1]);
+    auto const amount = static_cast<std::size_t>((std::min)(
+        remain_, static_cast<std::uint64_t>(st.size)));
+    auto const nread = file_.read(
+        st.buf[i].get(), amount, st.ec);
+    if(st.ec)
+        return;
+    if(nread == 0)
+    {
+        // The file is shorter than its cached size
+        st.ec = net::error::eof;
+        return;
+    }
+    BOOST_ASSERT(nread <= remain_);
+    remain_ -= nread;
+    st.ready = nread;
+}
+
+// Reads one block on the file executor, then resumes
+// the suspended operation on its own executor if it
+// is the last of the parties to finish.
+template<class File>
+template<class Executor>
+struct basic_async_file_body<File>::value_type::fill_op
+{
+    value_type* body;
+    Executor ex;
+
+    struct resume
+    {
+        state* st;
+
+        void
+        operator()()
+        {
+            st->op.invoke();
+        }
+    };
+
+    void
+    operator()()
+    {
+        body->fill();
+        auto const st = body->st_.get();
+        if(st->pending.fetch_sub(1,
+                std::memory_order_acq_rel) == 1)
+            net::post(ex, resume{st});
+    }
+};
+
+template<class File>
+std::uint64_t
+basic_async_file_body<File>::
+size(value_type const& body)
+{
+    return body.size();
+}
+
+//------------------------------------------------------------------------------
+
+template<class File>
+class basic_async_file_body<File>::writer
+{
+    value_type& body_;
+
+public:
+    using const_buffers_type =
+        net::const_buffer;
+
+    template<bool isRequest, class Fields>
+    writer(header<isRequest, Fields>&, value_type& b)
+        : body_(b)
+    {
+        BOOST_ASSERT(body_.file_.is_open());
+    }
+
+    void
+    init(error_code& ec)
+    {
+        ec = {};
+    }
+
+    boost::optional<std::pair<const_buffers_type, bool>>
+    get(error_code& ec)
+    {
+        if(! body_.st_)
+        {
+            ec = {};
+            return boost::none;
+        }
+        auto& st = *body_.st_;
+        if(body_.need_fill())
+            body_.fill();
+        if(st.ec)
+        {
+            ec = st.ec;
+            return boost::none;
+        }
+        if(st.ready == 0)
+        {
+            ec = {};
+            return boost::none;
+        }
+        // The buffer returned previously has been
+        // consumed, so it can receive the next block.
+        st.cur ^= 1;
+        auto const n = st.ready;
+        st.ready = 0;
+        ec = {};
+        return {{
+            const_buffers_type{st.buf[st.cur].get(), n},
+            body_.remain_ > 0}};
+    }
+};
+
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+template<
+    class Handler,
+    class Stream,
+    bool isRequest, class File, class Fields>
+class write_some_async_file_op
+    : public beast::async_base<
+        Handler, beast::executor_type<Stream>>
+{
+    using body_type = basic_async_file_body<File>;
+
+    Stream& s_;
+    serializer<isRequest, body_type, Fields>& sr_;
+    error_code ec_;
+    std::size_t bytes_transferred_ = 0;
+    bool reading_ = false;
+
+    typename body_type::value_type&
+    body()
+    {
+        return sr_.get().body();
+    }
+
+    // Read the next block on the file executor. The last
+    // of `parties` to finish resumes the suspended operation.
+    static
+    void
+    start_fill(
+        typename body_type::value_type& b,
+        typename write_some_async_file_op::executor_type ex,
+        int parties)
+    {
+        b.st_->pending.store(parties,
+            std::memory_order_relaxed);
+        net::post(b.ex_, typename body_type::value_type::
+            template fill_op<typename write_some_async_file_op::
+                executor_type>{&b, std::move(ex)});
+    }
+
+    class lambda
+    {
+        write_some_async_file_op& op_;
+
+    public:
+        bool invoked = false;
+
+        explicit
+        lambda(write_some_async_file_op& op)
+            : op_(op)
+        {
+        }
+
+        template<class ConstBufferSequence>
+        void
+        operator()(
+            error_code& ec,
+            ConstBufferSequence const& buffers)
+        {
+            invoked = true;
+            ec = {};
+            // Read ahead while these buffers are sent
+            if(op_.body().need_fill())
+            {
+                op_.reading_ = true;
+                start_fill(op_.body(), op_.get_executor(), 2);
+            }
+            op_.s_.async_write_some(
+                buffers, std::move(op_));
+        }
+    };
+
+public:
+    template<class Handler_>
+    write_some_async_file_op(
+        Handler_&& h,
+        Stream& s,
+        serializer<isRequest, body_type, Fields>& sr)
+        : async_base<
+            Handler, beast::executor_type<Stream>>(
+                 std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+        , sr_(sr)
+    {
+        if(! sr_.is_done() && body().need_fill())
+        {
+            // Read the first block before serializing
+            auto& b = body();
+            auto ex = this->get_executor();
+            b.st_->op.emplace(std::move(*this));
+            start_fill(b, std::move(ex), 1);
+            return;
+        }
+        (*this)();
+    }
+
+    void
+    operator()()
+    {
+        if(reading_)
+        {
+            // Both the write and the read have finished
+            reading_ = false;
+            return this->complete_now(ec_, bytes_transferred_);
+        }
+        error_code ec;
+        if(! sr_.is_done())
+        {
+            lambda f{*this};
+            sr_.next(ec, f);
+            if(f.invoked)
+            {
+                // *this is now moved-from,
+                return;
+            }
+        }
+        return net::post(
+            s_.get_executor(),
+            beast::bind_front_handler(
+                std::move(*this), ec, 0));
+    }
+
+    void
+    operator()(
+        error_code ec,
+        std::size_t bytes_transferred)
+    {
+        if(! ec)
+            sr_.consume(bytes_transferred);
+        if(! reading_)
+            return this->complete_now(ec, bytes_transferred);
+
+        // Wait for the read ahead to finish
+        ec_ = ec;
+        bytes_transferred_ = bytes_transferred;
+        auto& st = *body().st_;
+        if(st.pending.load(std::memory_order_acquire) == 1)
+        {
+            reading_ = false;
+            return this->complete_now(ec_, bytes_transferred_);
+        }
+        st.op.emplace(std::move(*this));
+        if(st.pending.fetch_sub(1,
+                std::memory_order_acq_rel) == 1)
+            st.op.invoke();
+    }
+};
+
+struct run_write_some_async_file_op
+{
+    template<
+        class WriteHandler,
+        class Stream,
+        bool isRequest, class File, class Fields>
+    void
+    operator()(
+        WriteHandler&& h,
+        Stream* s,
+        serializer<isRequest,
+            basic_async_file_body<File>, Fields>* sr)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+            void(error_code, std::size_t)>::value,
+            "WriteHandler type requirements not met");
+
+        // Without a file executor the file is read in place
+        if(! sr->get().body().ex_)
+        {
+            write_some_op<
+                typename std::decay<WriteHandler>::type,
+                Stream,
+                isRequest, basic_async_file_body<File>, Fields>(
+                    std::forward<WriteHandler>(h), *s, *sr);
+            return;
+        }
+        write_some_async_file_op<
+            typename std::decay<WriteHandler>::type,
+            Stream,
+            isRequest, File, Fields>(
+                std::forward<WriteHandler>(h), *s, *sr);
+    }
+};
+
+} // detail
+
+//------------------------------------------------------------------------------
+
+template<
+    class AsyncWriteStream,
+    bool isRequest, class File, class Fields,
+    BOOST_BEAST_ASYNC_TPARAM2 WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+async_write_some(
+    AsyncWriteStream& stream,
+    serializer<isRequest,
+        basic_async_file_body<File>, Fields>& sr,
+    WriteHandler&& handler)
+{
+    static_assert(
+        is_async_write_stream<AsyncWriteStream>::value,
+        "AsyncWriteStream type requirements not met");
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code, std::size_t)>(
+            detail::run_write_some_async_file_op{},
+            handler,
+            &stream,
+            &sr);
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
@@ -52,8 +52,11 @@ put(ConstBufferSequence const& buffers,
     // flatten
     net::buffer_copy(net::buffer(
         buf_.get(), size), buffers);
-    return put(net::const_buffer{
+    f_ |= flagFlattened;
+    auto const n = put(net::const_buffer{
         buf_.get(), size}, ec);
+    f_ &= ~flagFlattened;
+    return n;
 }
 
 template<bool isRequest>
@@ -67,8 +70,11 @@ put_from_stack(std::size_t size,
     char buf[max_stack_buffer];
     net::buffer_copy(net::mutable_buffer(
         buf, sizeof(buf)), buffers);
-    return put(net::const_buffer{
+    f_ |= flagFlattened;
+    auto const n = put(net::const_buffer{
         buf, size}, ec);
+    f_ &= ~flagFlattened;
+    return n;
 }
 
 } // http
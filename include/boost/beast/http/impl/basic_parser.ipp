@@ -256,7 +256,9 @@ maybe_need_more(
     char const* p, std::size_t n,
         error_code& ec)
 {
-    if(skip_ == 0)
+    if(skip_ == 0 && (
+        state_ != state::start_line ||
+        ! (f_ & flagWholeHeader)))
         return;
     if( n > header_limit_)
         n = header_limit_;
@@ -428,7 +430,10 @@ parse_fields(char const*& in,
         do_field(f, value, ec);
         if(ec)
             return;
+        if(value.data() == buf.data() && ! value.empty())
+            f_ |= flagUnfolded;
         this->on_field_impl(f, name, value, ec);
+        f_ &= ~flagUnfolded;
         if(ec)
             return;
         in = p;
@@ -11,8 +11,8 @@
 #define BOOST_BEAST_HTTP_IMPL_FIELD_IPP
 
 #include <boost/beast/http/field.hpp>
-#include <algorithm>
-#include <array>
+#include <boost/beast/http/detail/perfect_hash.hpp>
+#include <boost/beast/core/detail/string.hpp>
 #include <cstring>
 #include <boost/assert.hpp>
 
@@ -24,57 +24,49 @@ namespace detail {
 
 struct field_table
 {
-    using array_type =
-        std::array<string_view, 353>;
+    using const_iterator =
+        string_view const*;
 
-    // Strings are converted to lowercase
-    static
-    std::uint32_t
-    digest(string_view s)
-    {
-        std::uint32_t r = 0;
-        std::size_t n = s.size();
-        unsigned char const* p =reinterpret_cast<
-            unsigned char const*>(s.data());
-        while(n >= 4)
-        {
-            std::uint32_t v;
-            std::memcpy(&v, p, 4);
-            r = r * 5 + ( v | 0x20202020 );
-            p += 4;
-            n -= 4;
-        }
-        while( n > 0 )
-        {
-            r = r * 5 + ( *p | 0x20 );
-            ++p;
-            --n;
-        }
-        return r;
-    }
+    enum { N = 353 };
 
     // This comparison is case-insensitive, and the
     // strings must contain only valid http field characters.
+    // Whole words are compared, the last one overlapping
+    // the previous when the size is not a multiple of 8.
     static
     bool
     equals(string_view lhs, string_view rhs)
     {
-        using Int = std::uint32_t; // or std::size_t
         auto n = lhs.size();
         if(n != rhs.size())
             return false;
         auto p1 = lhs.data();
         auto p2 = rhs.data();
-        auto constexpr S = sizeof(Int);
-        auto constexpr Mask = static_cast<Int>(
-            0xDFDFDFDFDFDFDFDF & ~Int{0});
-        for(; n >= S; p1 += S, p2 += S, n -= S)
+        if(n >= 8)
         {
-            Int v1, v2;
-            std::memcpy( &v1, p1, S );
-            std::memcpy( &v2, p2, S );
-            if((v1 ^ v2) & Mask)
-                return false;
+            auto constexpr Mask = 0xDFDFDFDFDFDFDFDFULL;
+            auto const last = n - 8;
+            std::uint64_t v1, v2;
+            for(std::size_t i = 0; i < last; i += 8)
+            {
+                std::memcpy(&v1, p1 + i, 8);
+                std::memcpy(&v2, p2 + i, 8);
+                if((v1 ^ v2) & Mask)
+                    return false;
+            }
+            std::memcpy(&v1, p1 + last, 8);
+            std::memcpy(&v2, p2 + last, 8);
+            return ((v1 ^ v2) & Mask) == 0;
+        }
+        if(n >= 4)
+        {
+            auto constexpr Mask = 0xDFDFDFDFU;
+            std::uint32_t v1, v2, w1, w2;
+            std::memcpy(&v1, p1, 4);
+            std::memcpy(&v2, p2, 4);
+            std::memcpy(&w1, p1 + n - 4, 4);
+            std::memcpy(&w2, p2 + n - 4, 4);
+            return (((v1 ^ v2) | (w1 ^ w2)) & Mask) == 0;
         }
         for(; n; ++p1, ++p2, --n)
             if(( *p1 ^ *p2) & 0xDF)
@@ -82,408 +74,443 @@ struct field_table
         return true;
     }
 
-    array_type by_name_;
-
-    enum { N = 5155 };
-    unsigned char map_[ N ][ 2 ] = {};
-
 /*
     From:
     
     https://www.iana.org/assignments/message-headers/message-headers.xhtml
 */
-    field_table()
-        : by_name_({{
-            "<unknown-field>",
-            "A-IM",
-            "Accept",
-            "Accept-Additions",
-            "Accept-Charset",
-            "Accept-Datetime",
-            "Accept-Encoding",
-            "Accept-Features",
-            "Accept-Language",
-            "Accept-Patch",
-            "Accept-Post",
-            "Accept-Ranges",
-            "Access-Control",
-            "Access-Control-Allow-Credentials",
-            "Access-Control-Allow-Headers",
-            "Access-Control-Allow-Methods",
-            "Access-Control-Allow-Origin",
-            "Access-Control-Expose-Headers",
-            "Access-Control-Max-Age",
-            "Access-Control-Request-Headers",
-            "Access-Control-Request-Method",
-            "Age",
-            "Allow",
-            "ALPN",
-            "Also-Control",
-            "Alt-Svc",
-            "Alt-Used",
-            "Alternate-Recipient",
-            "Alternates",
-            "Apparently-To",
-            "Apply-To-Redirect-Ref",
-            "Approved",
-            "Archive",
-            "Archived-At",
-            "Article-Names",
-            "Article-Updates",
-            "Authentication-Control",
-            "Authentication-Info",
-            "Authentication-Results",
-            "Authorization",
-            "Auto-Submitted",
-            "Autoforwarded",
-            "Autosubmitted",
-            "Base",
-            "Bcc",
-            "Body",
-            "C-Ext",
-            "C-Man",
-            "C-Opt",
-            "C-PEP",
-            "C-PEP-Info",
-            "Cache-Control",
-            "CalDAV-Timezones",
-            "Cancel-Key",
-            "Cancel-Lock",
-            "Cc",
-            "Close",
-            "Comments",
-            "Compliance",
-            "Connection",
-            "Content-Alternative",
-            "Content-Base",
-            "Content-Description",
-            "Content-Disposition",
-            "Content-Duration",
-            "Content-Encoding",
-            "Content-features",
-            "Content-ID",
-            "Content-Identifier",
-            "Content-Language",
-            "Content-Length",
-            "Content-Location",
-            "Content-MD5",
-            "Content-Range",
-            "Content-Return",
-            "Content-Script-Type",
-            "Content-Style-Type",
-            "Content-Transfer-Encoding",
-            "Content-Type",
-            "Content-Version",
-            "Control",
-            "Conversion",
-            "Conversion-With-Loss",
-            "Cookie",
-            "Cookie2",
-            "Cost",
-            "DASL",
-            "Date",
-            "Date-Received",
-            "DAV",
-            "Default-Style",
-            "Deferred-Delivery",
-            "Delivery-Date",
-            "Delta-Base",
-            "Depth",
-            "Derived-From",
-            "Destination",
-            "Differential-ID",
-            "Digest",
-            "Discarded-X400-IPMS-Extensions",
-            "Discarded-X400-MTS-Extensions",
-            "Disclose-Recipients",
-            "Disposition-Notification-Options",
-            "Disposition-Notification-To",
-            "Distribution",
-            "DKIM-Signature",
-            "DL-Expansion-History",
-            "Downgraded-Bcc",
-            "Downgraded-Cc",
-            "Downgraded-Disposition-Notification-To",
-            "Downgraded-Final-Recipient",
-            "Downgraded-From",
-            "Downgraded-In-Reply-To",
-            "Downgraded-Mail-From",
-            "Downgraded-Message-Id",
-            "Downgraded-Original-Recipient",
-            "Downgraded-Rcpt-To",
-            "Downgraded-References",
-            "Downgraded-Reply-To",
-            "Downgraded-Resent-Bcc",
-            "Downgraded-Resent-Cc",
-            "Downgraded-Resent-From",
-            "Downgraded-Resent-Reply-To",
-            "Downgraded-Resent-Sender",
-            "Downgraded-Resent-To",
-            "Downgraded-Return-Path",
-            "Downgraded-Sender",
-            "Downgraded-To",
-            "EDIINT-Features",
-            "Eesst-Version",
-            "Encoding",
-            "Encrypted",
-            "Errors-To",
-            "ETag",
-            "Expect",
-            "Expires",
-            "Expiry-Date",
-            "Ext",
-            "Followup-To",
-            "Forwarded",
-            "From",
-            "Generate-Delivery-Report",
-            "GetProfile",
-            "Hobareg",
-            "Host",
-            "HTTP2-Settings",
-            "If",
-            "If-Match",
-            "If-Modified-Since",
-            "If-None-Match",
-            "If-Range",
-            "If-Schedule-Tag-Match",
-            "If-Unmodified-Since",
-            "IM",
-            "Importance",
-            "In-Reply-To",
-            "Incomplete-Copy",
-            "Injection-Date",
-            "Injection-Info",
-            "Jabber-ID",
-            "Keep-Alive",
-            "Keywords",
-            "Label",
-            "Language",
-            "Last-Modified",
-            "Latest-Delivery-Time",
-            "Lines",
-            "Link",
-            "List-Archive",
-            "List-Help",
-            "List-ID",
-            "List-Owner",
-            "List-Post",
-            "List-Subscribe",
-            "List-Unsubscribe",
-            "List-Unsubscribe-Post",
-            "Location",
-            "Lock-Token",
-            "Man",
-            "Max-Forwards",
-            "Memento-Datetime",
-            "Message-Context",
-            "Message-ID",
-            "Message-Type",
-            "Meter",
-            "Method-Check",
-            "Method-Check-Expires",
-            "MIME-Version",
-            "MMHS-Acp127-Message-Identifier",
-            "MMHS-Authorizing-Users",
-            "MMHS-Codress-Message-Indicator",
-            "MMHS-Copy-Precedence",
-            "MMHS-Exempted-Address",
-            "MMHS-Extended-Authorisation-Info",
-            "MMHS-Handling-Instructions",
-            "MMHS-Message-Instructions",
-            "MMHS-Message-Type",
-            "MMHS-Originator-PLAD",
-            "MMHS-Originator-Reference",
-            "MMHS-Other-Recipients-Indicator-CC",
-            "MMHS-Other-Recipients-Indicator-To",
-            "MMHS-Primary-Precedence",
-            "MMHS-Subject-Indicator-Codes",
-            "MT-Priority",
-            "Negotiate",
-            "Newsgroups",
-            "NNTP-Posting-Date",
-            "NNTP-Posting-Host",
-            "Non-Compliance",
-            "Obsoletes",
-            "Opt",
-            "Optional",
-            "Optional-WWW-Authenticate",
-            "Ordering-Type",
-            "Organization",
-            "Origin",
-            "Original-Encoded-Information-Types",
-            "Original-From",
-            "Original-Message-ID",
-            "Original-Recipient",
-            "Original-Sender",
-            "Original-Subject",
-            "Originator-Return-Address",
-            "Overwrite",
-            "P3P",
-            "Path",
-            "PEP",
-            "Pep-Info",
-            "PICS-Label",
-            "Position",
-            "Posting-Version",
-            "Pragma",
-            "Prefer",
-            "Preference-Applied",
-            "Prevent-NonDelivery-Report",
-            "Priority",
-            "Privicon",
-            "ProfileObject",
-            "Protocol",
-            "Protocol-Info",
-            "Protocol-Query",
-            "Protocol-Request",
-            "Proxy-Authenticate",
-            "Proxy-Authentication-Info",
-            "Proxy-Authorization",
-            "Proxy-Connection",
-            "Proxy-Features",
-            "Proxy-Instruction",
-            "Public",
-            "Public-Key-Pins",
-            "Public-Key-Pins-Report-Only",
-            "Range",
-            "Received",
-            "Received-SPF",
-            "Redirect-Ref",
-            "References",
-            "Referer",
-            "Referer-Root",
-            "Relay-Version",
-            "Reply-By",
-            "Reply-To",
-            "Require-Recipient-Valid-Since",
-            "Resent-Bcc",
-            "Resent-Cc",
-            "Resent-Date",
-            "Resent-From",
-            "Resent-Message-ID",
-            "Resent-Reply-To",
-            "Resent-Sender",
-            "Resent-To",
-            "Resolution-Hint",
-            "Resolver-Location",
-            "Retry-After",
-            "Return-Path",
-            "Safe",
-            "Schedule-Reply",
-            "Schedule-Tag",
-            "Sec-WebSocket-Accept",
-            "Sec-WebSocket-Extensions",
-            "Sec-WebSocket-Key",
-            "Sec-WebSocket-Protocol",
-            "Sec-WebSocket-Version",
-            "Security-Scheme",
-            "See-Also",
-            "Sender",
-            "Sensitivity",
-            "Server",
-            "Set-Cookie",
-            "Set-Cookie2",
-            "SetProfile",
-            "SIO-Label",
-            "SIO-Label-History",
-            "SLUG",
-            "SoapAction",
-            "Solicitation",
-            "Status-URI",
-            "Strict-Transport-Security",
-            "Subject",
-            "SubOK",
-            "Subst",
-            "Summary",
-            "Supersedes",
-            "Surrogate-Capability",
-            "Surrogate-Control",
-            "TCN",
-            "TE",
-            "Timeout",
-            "Title",
-            "To",
-            "Topic",
-            "Trailer",
-            "Transfer-Encoding",
-            "TTL",
-            "UA-Color",
-            "UA-Media",
-            "UA-Pixels",
-            "UA-Resolution",
-            "UA-Windowpixels",
-            "Upgrade",
-            "Urgency",
-            "URI",
-            "User-Agent",
-            "Variant-Vary",
-            "Vary",
-            "VBR-Info",
-            "Version",
-            "Via",
-            "Want-Digest",
-            "Warning",
-            "WWW-Authenticate",
-            "X-Archived-At",
-            "X-Device-Accept",
-            "X-Device-Accept-Charset",
-            "X-Device-Accept-Encoding",
-            "X-Device-Accept-Language",
-            "X-Device-User-Agent",
-            "X-Frame-Options",
-            "X-Mittente",
-            "X-PGP-Sig",
-            "X-Ricevuta",
-            "X-Riferimento-Message-ID",
-            "X-TipoRicevuta",
-            "X-Trasporto",
-            "X-VerificaSicurezza",
-            "X400-Content-Identifier",
-            "X400-Content-Return",
-            "X400-Content-Type",
-            "X400-MTS-Identifier",
-            "X400-Originator",
-            "X400-Received",
-            "X400-Recipients",
-            "X400-Trace",
-            "Xref"
-        }})
+    static
+    const_iterator
+    by_name()
     {
-        for(std::size_t i = 1, n = 256; i < n; ++i)
-        {
-            auto sv = by_name_[ i ];
-            auto h = digest(sv);
-            auto j = h % N;
-            BOOST_ASSERT(map_[j][0] == 0);
-            map_[j][0] = static_cast<unsigned char>(i);
-        }
-
-        for(std::size_t i = 256, n = by_name_.size(); i < n; ++i)
-        {
-            auto sv = by_name_[i];
-            auto h = digest(sv);
-            auto j = h % N;
-            BOOST_ASSERT(map_[j][1] == 0);
-            map_[j][1] = static_cast<unsigned char>(i - 255);
-        }
+        using namespace beast::detail::string_literals;
+        static string_view constexpr tab[] = {
+            "<unknown-field>"_sv,
+            "A-IM"_sv,
+            "Accept"_sv,
+            "Accept-Additions"_sv,
+            "Accept-Charset"_sv,
+            "Accept-Datetime"_sv,
+            "Accept-Encoding"_sv,
+            "Accept-Features"_sv,
+            "Accept-Language"_sv,
+            "Accept-Patch"_sv,
+            "Accept-Post"_sv,
+            "Accept-Ranges"_sv,
+            "Access-Control"_sv,
+            "Access-Control-Allow-Credentials"_sv,
+            "Access-Control-Allow-Headers"_sv,
+            "Access-Control-Allow-Methods"_sv,
+            "Access-Control-Allow-Origin"_sv,
+            "Access-Control-Expose-Headers"_sv,
+            "Access-Control-Max-Age"_sv,
+            "Access-Control-Request-Headers"_sv,
+            "Access-Control-Request-Method"_sv,
+            "Age"_sv,
+            "Allow"_sv,
+            "ALPN"_sv,
+            "Also-Control"_sv,
+            "Alt-Svc"_sv,
+            "Alt-Used"_sv,
+            "Alternate-Recipient"_sv,
+            "Alternates"_sv,
+            "Apparently-To"_sv,
+            "Apply-To-Redirect-Ref"_sv,
+            "Approved"_sv,
+            "Archive"_sv,
+            "Archived-At"_sv,
+            "Article-Names"_sv,
+            "Article-Updates"_sv,
+            "Authentication-Control"_sv,
+            "Authentication-Info"_sv,
+            "Authentication-Results"_sv,
+            "Authorization"_sv,
+            "Auto-Submitted"_sv,
+            "Autoforwarded"_sv,
+            "Autosubmitted"_sv,
+            "Base"_sv,
+            "Bcc"_sv,
+            "Body"_sv,
+            "C-Ext"_sv,
+            "C-Man"_sv,
+            "C-Opt"_sv,
+            "C-PEP"_sv,
+            "C-PEP-Info"_sv,
+            "Cache-Control"_sv,
+            "CalDAV-Timezones"_sv,
+            "Cancel-Key"_sv,
+            "Cancel-Lock"_sv,
+            "Cc"_sv,
+            "Close"_sv,
+            "Comments"_sv,
+            "Compliance"_sv,
+            "Connection"_sv,
+            "Content-Alternative"_sv,
+            "Content-Base"_sv,
+            "Content-Description"_sv,
+            "Content-Disposition"_sv,
+            "Content-Duration"_sv,
+            "Content-Encoding"_sv,
+            "Content-features"_sv,
+            "Content-ID"_sv,
+            "Content-Identifier"_sv,
+            "Content-Language"_sv,
+            "Content-Length"_sv,
+            "Content-Location"_sv,
+            "Content-MD5"_sv,
+            "Content-Range"_sv,
+            "Content-Return"_sv,
+            "Content-Script-Type"_sv,
+            "Content-Style-Type"_sv,
+            "Content-Transfer-Encoding"_sv,
+            "Content-Type"_sv,
+            "Content-Version"_sv,
+            "Control"_sv,
+            "Conversion"_sv,
+            "Conversion-With-Loss"_sv,
+            "Cookie"_sv,
+            "Cookie2"_sv,
+            "Cost"_sv,
+            "DASL"_sv,
+            "Date"_sv,
+            "Date-Received"_sv,
+            "DAV"_sv,
+            "Default-Style"_sv,
+            "Deferred-Delivery"_sv,
+            "Delivery-Date"_sv,
+            "Delta-Base"_sv,
+            "Depth"_sv,
+            "Derived-From"_sv,
+            "Destination"_sv,
+            "Differential-ID"_sv,
+            "Digest"_sv,
+            "Discarded-X400-IPMS-Extensions"_sv,
+            "Discarded-X400-MTS-Extensions"_sv,
+            "Disclose-Recipients"_sv,
+            "Disposition-Notification-Options"_sv,
+            "Disposition-Notification-To"_sv,
+            "Distribution"_sv,
+            "DKIM-Signature"_sv,
+            "DL-Expansion-History"_sv,
+            "Downgraded-Bcc"_sv,
+            "Downgraded-Cc"_sv,
+            "Downgraded-Disposition-Notification-To"_sv,
+            "Downgraded-Final-Recipient"_sv,
+            "Downgraded-From"_sv,
+            "Downgraded-In-Reply-To"_sv,
+            "Downgraded-Mail-From"_sv,
+            "Downgraded-Message-Id"_sv,
+            "Downgraded-Original-Recipient"_sv,
+            "Downgraded-Rcpt-To"_sv,
+            "Downgraded-References"_sv,
+            "Downgraded-Reply-To"_sv,
+            "Downgraded-Resent-Bcc"_sv,
+            "Downgraded-Resent-Cc"_sv,
+            "Downgraded-Resent-From"_sv,
+            "Downgraded-Resent-Reply-To"_sv,
+            "Downgraded-Resent-Sender"_sv,
+            "Downgraded-Resent-To"_sv,
+            "Downgraded-Return-Path"_sv,
+            "Downgraded-Sender"_sv,
+            "Downgraded-To"_sv,
+            "EDIINT-Features"_sv,
+            "Eesst-Version"_sv,
+            "Encoding"_sv,
+            "Encrypted"_sv,
+            "Errors-To"_sv,
+            "ETag"_sv,
+            "Expect"_sv,
+            "Expires"_sv,
+            "Expiry-Date"_sv,
+            "Ext"_sv,
+            "Followup-To"_sv,
+            "Forwarded"_sv,
+            "From"_sv,
+            "Generate-Delivery-Report"_sv,
+            "GetProfile"_sv,
+            "Hobareg"_sv,
+            "Host"_sv,
+            "HTTP2-Settings"_sv,
+            "If"_sv,
+            "If-Match"_sv,
+            "If-Modified-Since"_sv,
+            "If-None-Match"_sv,
+            "If-Range"_sv,
+            "If-Schedule-Tag-Match"_sv,
+            "If-Unmodified-Since"_sv,
+            "IM"_sv,
+            "Importance"_sv,
+            "In-Reply-To"_sv,
+            "Incomplete-Copy"_sv,
+            "Injection-Date"_sv,
+            "Injection-Info"_sv,
+            "Jabber-ID"_sv,
+            "Keep-Alive"_sv,
+            "Keywords"_sv,
+            "Label"_sv,
+            "Language"_sv,
+            "Last-Modified"_sv,
+            "Latest-Delivery-Time"_sv,
+            "Lines"_sv,
+            "Link"_sv,
+            "List-Archive"_sv,
+            "List-Help"_sv,
+            "List-ID"_sv,
+            "List-Owner"_sv,
+            "List-Post"_sv,
+            "List-Subscribe"_sv,
+            "List-Unsubscribe"_sv,
+            "List-Unsubscribe-Post"_sv,
+            "Location"_sv,
+            "Lock-Token"_sv,
+            "Man"_sv,
+            "Max-Forwards"_sv,
+            "Memento-Datetime"_sv,
+            "Message-Context"_sv,
+            "Message-ID"_sv,
+            "Message-Type"_sv,
+            "Meter"_sv,
+            "Method-Check"_sv,
+            "Method-Check-Expires"_sv,
+            "MIME-Version"_sv,
+            "MMHS-Acp127-Message-Identifier"_sv,
+            "MMHS-Authorizing-Users"_sv,
+            "MMHS-Codress-Message-Indicator"_sv,
+            "MMHS-Copy-Precedence"_sv,
+            "MMHS-Exempted-Address"_sv,
+            "MMHS-Extended-Authorisation-Info"_sv,
+            "MMHS-Handling-Instructions"_sv,
+            "MMHS-Message-Instructions"_sv,
+            "MMHS-Message-Type"_sv,
+            "MMHS-Originator-PLAD"_sv,
+            "MMHS-Originator-Reference"_sv,
+            "MMHS-Other-Recipients-Indicator-CC"_sv,
+            "MMHS-Other-Recipients-Indicator-To"_sv,
+            "MMHS-Primary-Precedence"_sv,
+            "MMHS-Subject-Indicator-Codes"_sv,
+            "MT-Priority"_sv,
+            "Negotiate"_sv,
+            "Newsgroups"_sv,
+            "NNTP-Posting-Date"_sv,
+            "NNTP-Posting-Host"_sv,
+            "Non-Compliance"_sv,
+            "Obsoletes"_sv,
+            "Opt"_sv,
+            "Optional"_sv,
+            "Optional-WWW-Authenticate"_sv,
+            "Ordering-Type"_sv,
+            "Organization"_sv,
+            "Origin"_sv,
+            "Original-Encoded-Information-Types"_sv,
+            "Original-From"_sv,
+            "Original-Message-ID"_sv,
+            "Original-Recipient"_sv,
+            "Original-Sender"_sv,
+            "Original-Subject"_sv,
+            "Originator-Return-Address"_sv,
+            "Overwrite"_sv,
+            "P3P"_sv,
+            "Path"_sv,
+            "PEP"_sv,
+            "Pep-Info"_sv,
+            "PICS-Label"_sv,
+            "Position"_sv,
+            "Posting-Version"_sv,
+            "Pragma"_sv,
+            "Prefer"_sv,
+            "Preference-Applied"_sv,
+            "Prevent-NonDelivery-Report"_sv,
+            "Priority"_sv,
+            "Privicon"_sv,
+            "ProfileObject"_sv,
+            "Protocol"_sv,
+            "Protocol-Info"_sv,
+            "Protocol-Query"_sv,
+            "Protocol-Request"_sv,
+            "Proxy-Authenticate"_sv,
+            "Proxy-Authentication-Info"_sv,
+            "Proxy-Authorization"_sv,
+            "Proxy-Connection"_sv,
+            "Proxy-Features"_sv,
+            "Proxy-Instruction"_sv,
+            "Public"_sv,
+            "Public-Key-Pins"_sv,
+            "Public-Key-Pins-Report-Only"_sv,
+            "Range"_sv,
+            "Received"_sv,
+            "Received-SPF"_sv,
+            "Redirect-Ref"_sv,
+            "References"_sv,
+            "Referer"_sv,
+            "Referer-Root"_sv,
+            "Relay-Version"_sv,
+            "Reply-By"_sv,
+            "Reply-To"_sv,
+            "Require-Recipient-Valid-Since"_sv,
+            "Resent-Bcc"_sv,
+            "Resent-Cc"_sv,
+            "Resent-Date"_sv,
+            "Resent-From"_sv,
+            "Resent-Message-ID"_sv,
+            "Resent-Reply-To"_sv,
+            "Resent-Sender"_sv,
+            "Resent-To"_sv,
+            "Resolution-Hint"_sv,
+            "Resolver-Location"_sv,
+            "Retry-After"_sv,
+            "Return-Path"_sv,
+            "Safe"_sv,
+            "Schedule-Reply"_sv,
+            "Schedule-Tag"_sv,
+            "Sec-WebSocket-Accept"_sv,
+            "Sec-WebSocket-Extensions"_sv,
+            "Sec-WebSocket-Key"_sv,
+            "Sec-WebSocket-Protocol"_sv,
+            "Sec-WebSocket-Version"_sv,
+            "Security-Scheme"_sv,
+            "See-Also"_sv,
+            "Sender"_sv,
+            "Sensitivity"_sv,
+            "Server"_sv,
+            "Set-Cookie"_sv,
+            "Set-Cookie2"_sv,
+            "SetProfile"_sv,
+            "SIO-Label"_sv,
+            "SIO-Label-History"_sv,
+            "SLUG"_sv,
+            "SoapAction"_sv,
+            "Solicitation"_sv,
+            "Status-URI"_sv,
+            "Strict-Transport-Security"_sv,
+            "Subject"_sv,
+            "SubOK"_sv,
+            "Subst"_sv,
+            "Summary"_sv,
+            "Supersedes"_sv,
+            "Surrogate-Capability"_sv,
+            "Surrogate-Control"_sv,
+            "TCN"_sv,
+            "TE"_sv,
+            "Timeout"_sv,
+            "Title"_sv,
+            "To"_sv,
+            "Topic"_sv,
+            "Trailer"_sv,
+            "Transfer-Encoding"_sv,
+            "TTL"_sv,
+            "UA-Color"_sv,
+            "UA-Media"_sv,
+            "UA-Pixels"_sv,
+            "UA-Resolution"_sv,
+            "UA-Windowpixels"_sv,
+            "Upgrade"_sv,
+            "Urgency"_sv,
+            "URI"_sv,
+            "User-Agent"_sv,
+            "Variant-Vary"_sv,
+            "Vary"_sv,
+            "VBR-Info"_sv,
+            "Version"_sv,
+            "Via"_sv,
+            "Want-Digest"_sv,
+            "Warning"_sv,
+            "WWW-Authenticate"_sv,
+            "X-Archived-At"_sv,
+            "X-Device-Accept"_sv,
+            "X-Device-Accept-Charset"_sv,
+            "X-Device-Accept-Encoding"_sv,
+            "X-Device-Accept-Language"_sv,
+            "X-Device-User-Agent"_sv,
+            "X-Frame-Options"_sv,
+            "X-Mittente"_sv,
+            "X-PGP-Sig"_sv,
+            "X-Ricevuta"_sv,
+            "X-Riferimento-Message-ID"_sv,
+            "X-TipoRicevuta"_sv,
+            "X-Trasporto"_sv,
+            "X-VerificaSicurezza"_sv,
+            "X400-Content-Identifier"_sv,
+            "X400-Content-Return"_sv,
+            "X400-Content-Type"_sv,
+            "X400-MTS-Identifier"_sv,
+            "X400-Originator"_sv,
+            "X400-Received"_sv,
+            "X400-Recipients"_sv,
+            "X400-Trace"_sv,
+            "Xref"_sv
+        };
+        static_assert(sizeof(tab) / sizeof(tab[0]) == N, "");
+        return tab;
     }
 
+    static
     field
-    string_to_field(string_view s) const
+    string_to_field(string_view s)
     {
-        auto h = digest(s);
-        auto j = h % N;
-        int i = map_[j][0];
-        string_view s2 = by_name_[i];
-        if(i != 0 && equals(s, s2))
-            return static_cast<field>(i);
-        i = map_[j][1];
-        if(i == 0)
-            return field::unknown;
-        i += 255;
-        s2 = by_name_[i];
+        // Generated by tools/make_perfect_hash.py
+        static std::uint16_t constexpr disp[128] = {
+              0,   2,   0,   0,   0,   4,   0,   0,   0,   0,   0,   2,
+              0,   2,   0,   0,   0,   0,   8,   2,   0,   2,   0,   0,
+             25,   2,   4,   4,   2,   0,  10,   6,  10,   0,   5,   3,
+             13,   1,   0,   7,   2,   2,   1,   0,   0,   1,   0,  13,
+             18,   1,   0,   1,   1,   1,   2,   1,   2,   0,   8,   0,
+              0,   0,   2,   6,   0,  10,   3,   0,   4,   6,   4,   1,
+             11,   0,   1,   0,   0,   8,   0,   1,  11,  20,   2,   5,
+              8,  13,   6,  18,   4,   0,   4,   7,   2,   0,   2,   3,
+             29,  12,   6,   7,   0,   0,   2,  24,  15,   0,  12,   3,
+              0,  23,  12,   1,   0,   4,   1,   3,  19,   7,   0,   5,
+              0,  10,   0,   0,   0,   2,   4,   6
+        };
+        static std::uint16_t constexpr slot[512] = {
+            105, 227, 264, 241, 121, 277,  92,  14,   0,   0, 173,  74,
+              0,  61,   0,   0, 246,  16,  60, 321, 207, 298, 336, 314,
+            126,  88,   0, 178, 107,  53, 185,   0,   0, 161,   0,  29,
+            216,  66, 346,   0, 122, 330, 223,  84, 256, 163, 285,  19,
+            194,   0, 273, 118,  35,  81, 175, 328, 262, 291,   0,  80,
+              0, 168,   0, 212,   0, 140,   0,   0, 104, 151, 306, 171,
+            174, 333, 120, 263, 202, 295, 124, 181, 258,  93,   0, 203,
+            296,   0,  38, 205,  43,  21,   0,   0,  11, 135, 197, 193,
+             71,   0, 301, 271,   0,  94,   0, 113, 305,  95,   0,  18,
+             77, 109,   0,  40, 159, 146,  41,  99,  51,  56,   0, 243,
+              0, 281, 350, 195,   0,   0,   0, 112,   0, 268, 143, 347,
+            244,  25, 311, 134, 166,  24,  10, 211, 287, 188,   0,  55,
+             47,  72, 115, 139,  59,  89, 316, 339,  27, 116, 307,   0,
+            294,  68,  50, 196, 337, 172, 142,  28, 162, 317, 348, 351,
+            147,  90,   1,  62, 114, 152, 183, 261, 327, 283, 160,   9,
+            322, 220, 238, 229,  23, 275, 158, 284, 288, 315,   0,   0,
+              4, 250,  13,  65, 208,  54,   0, 123,   0, 332,   6,   0,
+             17,   0,   0, 259, 141, 252, 164,   0,  76,   0,   0, 341,
+              0,  26,  15, 154,   8, 290, 131,  12, 165,   0, 222,   0,
+            153, 249,  42,   0, 106,   0, 138, 176,   0, 286,  20,  97,
+              0,   0,   0, 137,   0, 334,  63,   0, 224, 179,  91, 221,
+            213,   0, 319, 192,   2, 335, 352,  87,   0, 217,  78,  48,
+             75,   3, 169, 155,  69, 257, 170, 338, 265,   0,   0,   0,
+             34, 219,   0, 232,  37,   0,   0, 326,   0,  96,   0,   0,
+            187, 180, 254,   0, 312,   0,  33,   0, 129, 226,   0, 149,
+            274,   0,  31, 300,   0, 276,   0,   0,   0, 302, 206, 279,
+              0,   0, 117,  57,   0, 133,   0, 325,   5, 150,   0, 101,
+              0,   0, 248, 184,  82,   0, 323,  83, 320, 293, 214,   0,
+            144, 267, 186, 125, 260, 225,   0,   0, 110,   0,   0, 182,
+            266, 255, 303, 157,   0, 308, 253, 242,  49, 313,   0, 228,
+              0,   0,   0,   0, 289, 148, 177,  64, 239,   0, 136, 349,
+              0,   0, 340,   0, 132, 201, 280,   0,   0,   0,   0,   0,
+              0,   0,   0,   0,  86,  32, 100,  67, 230, 156, 342,   0,
+            130,   0, 240,   0,   0, 190,   0,   0,   0,  85,   0,  44,
+            210,   0,   0,   0, 269,  30, 189, 278, 309,  22,   0, 251,
+            111,   0, 233, 215, 108, 310, 345,  98,  39, 299, 127,   0,
+            198, 344,   0, 282,   0, 247,   0,   0, 204, 102,   0, 167,
+            119,   0,   0,   0, 236,   0, 304,  45,   0,  58,   0,   0,
+            237, 145,   0, 318,  79,  73, 297,   0,   0,   0, 245,   0,
+              0,  36, 103,   0,   0,   0, 270,   0, 234,   0, 324,  52,
+             70, 343,   0, 292, 128,   0,   0, 218, 200, 199,   0,   0,
+            209,   7,   0,   0, 331,   0,   0, 329,   0,   0,   0, 231,
+              0, 235,   0,   0,   0, 191, 272,  46
+        };
 
-        if(equals(s, s2))
+        auto const h = perfect_hash::digest(
+            s, perfect_hash::fold);
+        auto const i = slot[(h ^ disp[h >> 57]) & 511];
+        if(equals(s, by_name()[i]))
             return static_cast<field>(i);
         return field::unknown;
     }
@@ -492,25 +519,22 @@ struct field_table
     // Deprecated
     //
 
-    using const_iterator =
-    array_type::const_iterator; 
-
     std::size_t
     size() const
     {
-        return by_name_.size();
+        return N;
     }
 
     const_iterator
     begin() const
     {
-        return by_name_.begin();
+        return by_name();
     }
 
     const_iterator
     end() const
     {
-        return by_name_.end();
+        return by_name() + size();
     }
 };
 
@@ -518,7 +542,7 @@ BOOST_BEAST_DECL
 field_table const&
 get_field_table()
 {
-    static field_table const tab;
+    static field_table const tab{};
     return tab;
 }
 
@@ -542,7 +566,7 @@ to_string(field f)
 field
 string_to_field(string_view s)
 {
-    return detail::get_field_table().string_to_field(s);
+    return detail::field_table::string_to_field(s);
 }
 
 } // http
@@ -21,6 +21,7 @@
 #include <boost/beast/http/chunk_encode.hpp>
 #include <boost/core/exchange.hpp>
 #include <boost/throw_exception.hpp>
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 
@@ -28,6 +29,99 @@ namespace boost {
 namespace beast {
 namespace http {
 
+template<class Allocator>
+class basic_fields<Allocator>::const_iterator
+{
+    friend class basic_fields;
+
+    using iter_type = typename list_t::const_iterator;
+
+    iter_type it_;
+    iter_type end_;
+    field f_ = field::unknown;  // when known, visit only these
+
+    const_iterator(iter_type it)
+        : it_(it)
+    {
+    }
+
+    const_iterator(iter_type it, iter_type end, field f)
+        : it_(it)
+        , end_(end)
+        , f_(f)
+    {
+    }
+
+public:
+    using value_type = typename basic_fields::value_type;
+    using pointer = value_type const*;
+    using reference = value_type const&;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category =
+        std::bidirectional_iterator_tag;
+
+    const_iterator() = default;
+
+    bool
+    operator==(const_iterator const& other) const
+    {
+        return it_ == other.it_;
+    }
+
+    bool
+    operator!=(const_iterator const& other) const
+    {
+        return !(*this == other);
+    }
+
+    reference
+    operator*() const
+    {
+        return *it_;
+    }
+
+    pointer
+    operator->() const
+    {
+        return &*it_;
+    }
+
+    const_iterator&
+    operator++()
+    {
+        do
+            ++it_;
+        while(f_ != field::unknown &&
+            it_ != end_ && it_->f_ != f_);
+        return *this;
+    }
+
+    const_iterator
+    operator++(int)
+    {
+        auto temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+    const_iterator&
+    operator--()
+    {
+        do
+            --it_;
+        while(f_ != field::unknown && it_->f_ != f_);
+        return *this;
+    }
+
+    const_iterator
+    operator--(int)
+    {
+        auto temp = *this;
+        --(*this);
+        return temp;
+    }
+};
+
 template<class Allocator>
 class basic_fields<Allocator>::writer
 {
@@ -350,6 +444,7 @@ basic_fields<Allocator>::
 ~basic_fields()
 {
     delete_list();
+    free_index();
     realloc_string(method_, {});
     realloc_string(
         target_or_reason_, {});
@@ -369,6 +464,9 @@ basic_fields(basic_fields&& other) noexcept
         std::move(other.get()))
     , set_(std::move(other.set_))
     , list_(std::move(other.list_))
+    , index_(boost::exchange(other.index_, nullptr))
+    , index_used_(boost::exchange(other.index_used_, 0))
+    , index_bits_(boost::exchange(other.index_bits_, 0))
     , method_(boost::exchange(other.method_, {}))
     , target_or_reason_(boost::exchange(other.target_or_reason_, {}))
 {
@@ -388,6 +486,9 @@ basic_fields(basic_fields&& other, Allocator const& alloc)
     {
         set_ = std::move(other.set_);
         list_ = std::move(other.list_);
+        index_ = boost::exchange(other.index_, nullptr);
+        index_used_ = boost::exchange(other.index_used_, 0);
+        index_bits_ = boost::exchange(other.index_bits_, 0);
         method_ = other.method_;
         target_or_reason_ = other.target_or_reason_;
     }
@@ -533,6 +634,12 @@ void
 basic_fields<Allocator>::
 clear()
 {
+    if(index_)
+    {
+        std::fill(index_, index_ +
+            (std::size_t{1} << index_bits_), nullptr);
+        index_used_ = 0;
+    }
     delete_list();
     set_.clear();
     list_.clear();
@@ -566,6 +673,11 @@ insert(field name,
 {
     auto& e = new_element(name, sname,
         static_cast<string_view>(value));
+    if(e.f_ != field::unknown)
+    {
+        link_element(e);
+        return;
+    }
     auto const before =
         set_.upper_bound(sname, key_compare{});
     if(before == set_.begin())
@@ -616,10 +728,10 @@ erase(const_iterator pos) ->
     const_iterator
 {
     auto next = pos;
-    auto& e = *next++;
-    set_.erase(e);
-    list_.erase(pos);
-    delete_element(const_cast<element&>(e));
+    ++next;
+    auto& e = const_cast<element&>(*pos.it_);
+    unlink_element(e);
+    delete_element(e);
     return next;
 }
 
@@ -629,7 +741,7 @@ basic_fields<Allocator>::
 erase(field name)
 {
     BOOST_ASSERT(name != field::unknown);
-    return erase(to_string(name));
+    return erase_known(name);
 }
 
 template<class Allocator>
@@ -637,6 +749,9 @@ std::size_t
 basic_fields<Allocator>::
 erase(string_view name)
 {
+    auto const f = string_to_field(name);
+    if(f != field::unknown)
+        return erase_known(f);
     std::size_t n =0;
     set_.erase_and_dispose(name, key_compare{},
         [&](element* e)
@@ -673,13 +788,14 @@ swap(
 //------------------------------------------------------------------------------
 
 template<class Allocator>
-inline
 std::size_t
 basic_fields<Allocator>::
 count(field name) const
 {
     BOOST_ASSERT(name != field::unknown);
-    return count(to_string(name));
+    auto const r = equal_range(name);
+    return static_cast<std::size_t>(
+        std::distance(r.first, r.second));
 }
 
 template<class Allocator>
@@ -687,6 +803,9 @@ std::size_t
 basic_fields<Allocator>::
 count(string_view name) const
 {
+    auto const f = string_to_field(name);
+    if(f != field::unknown)
+        return count(f);
     return set_.count(name, key_compare{});
 }
 
@@ -698,7 +817,10 @@ find(field name) const ->
     const_iterator
 {
     BOOST_ASSERT(name != field::unknown);
-    return find(to_string(name));
+    auto const p = first_element(name);
+    if(! p)
+        return list_.end();
+    return list_.iterator_to(*p);
 }
 
 template<class Allocator>
@@ -707,6 +829,9 @@ basic_fields<Allocator>::
 find(string_view name) const ->
     const_iterator
 {
+    auto const f = string_to_field(name);
+    if(f != field::unknown)
+        return find(f);
     auto const it = set_.find(
         name, key_compare{});
     if(it == set_.end())
@@ -715,14 +840,18 @@ find(string_view name) const ->
 }
 
 template<class Allocator>
-inline
 auto
 basic_fields<Allocator>::
 equal_range(field name) const ->
     std::pair<const_iterator, const_iterator>
 {
     BOOST_ASSERT(name != field::unknown);
-    return equal_range(to_string(name));
+    auto const p = first_element(name);
+    if(! p)
+        return {end(), end()};
+    return {
+        const_iterator(list_.iterator_to(*p), list_.end(), name),
+        const_iterator(list_.end(), list_.end(), name)};
 }
 
 template<class Allocator>
@@ -731,13 +860,16 @@ basic_fields<Allocator>::
 equal_range(string_view name) const ->
     std::pair<const_iterator, const_iterator>
 {
+    auto const f = string_to_field(name);
+    if(f != field::unknown)
+        return equal_range(f);
     auto result =
         set_.equal_range(name, key_compare{});
     if(result.first == result.second)
-        return {list_.end(), list_.end()};
+        return {end(), end()};
     return {
-        list_.iterator_to(*result.first),
-        ++list_.iterator_to(*(--result.second))};
+        const_iterator(list_.iterator_to(*result.first)),
+        const_iterator(++list_.iterator_to(*(--result.second)))};
 }
 
 //------------------------------------------------------------------------------
@@ -848,7 +980,7 @@ bool
 basic_fields<Allocator>::
 has_content_length_impl() const
 {
-    return count(field::content_length) > 0;
+    return find(field::content_length) != end();
 }
 
 template<class Allocator>
@@ -969,6 +1101,10 @@ new_element(field name,
         BOOST_THROW_EXCEPTION(std::length_error{
             "field value too large"});
     value = detail::trim(value);
+    if(name == field::unknown)
+        name = string_to_field(sname);
+    if(name != field::unknown)
+        reserve_index(name);
     std::uint16_t const off =
         static_cast<off_t>(sname.size() + 2);
     std::uint16_t const len =
@@ -999,6 +1135,12 @@ void
 basic_fields<Allocator>::
 set_element(element& e)
 {
+    if(e.f_ != field::unknown)
+    {
+        erase_known(e.f_);
+        link_element(e);
+        return;
+    }
     auto it = set_.lower_bound(
         e.name_string(), key_compare{});
     if(it == set_.end() || ! beast::iequals(
@@ -1024,6 +1166,190 @@ set_element(element& e)
     list_.push_back(e);
 }
 
+template<class Allocator>
+auto
+basic_fields<Allocator>::
+first_element(field name) const ->
+    element*
+{
+    if(! index_)
+        return nullptr;
+    return *index_slot(name);
+}
+
+// Returns the slot holding the first field with
+// `name`, or the empty slot where it belongs
+template<class Allocator>
+auto
+basic_fields<Allocator>::
+index_slot(field name) const ->
+    element**
+{
+    BOOST_ASSERT(index_);
+    std::size_t const mask =
+        (std::size_t{1} << index_bits_) - 1;
+    // Fibonacci hashing spreads out adjacent enums
+    std::size_t i = static_cast<std::uint32_t>(
+        static_cast<std::uint32_t>(name) * 0x9e3779b1) >>
+            (32 - index_bits_);
+    for(;;)
+    {
+        auto const slot = index_ + i;
+        if(! *slot || (*slot)->f_ == name)
+            return slot;
+        i = (i + 1) & mask;
+    }
+}
+
+// Empties a slot, moving back the entries
+// which would no longer be reachable
+template<class Allocator>
+void
+basic_fields<Allocator>::
+index_erase(element** slot)
+{
+    BOOST_ASSERT(*slot);
+    std::size_t const mask =
+        (std::size_t{1} << index_bits_) - 1;
+    auto i = static_cast<std::size_t>(slot - index_);
+    auto j = i;
+    index_[i] = nullptr;
+    for(;;)
+    {
+        j = (j + 1) & mask;
+        if(! index_[j])
+            break;
+        auto const e = index_[j];
+        index_[j] = nullptr;
+        // Lands either in the hole or back in place
+        auto const to = index_slot(e->f_);
+        *to = e;
+        if(to == index_ + i)
+            i = j;
+    }
+    --index_used_;
+}
+
+// Makes room in the index for `name`, so
+// that linking its field cannot throw
+template<class Allocator>
+void
+basic_fields<Allocator>::
+reserve_index(field name)
+{
+    if(index_)
+    {
+        if(*index_slot(name))
+            return;
+        if((index_used_ + 1u) * 2 <=
+                (std::size_t{1} << index_bits_))
+            return;
+    }
+    // Kept at most half full
+    std::uint8_t const bits = index_ ?
+        static_cast<std::uint8_t>(index_bits_ + 1) : 3;
+    auto a = index_alloc_type{this->get()};
+    auto const p = index_traits::allocate(
+        a, std::size_t{1} << bits);
+    std::fill(p, p + (std::size_t{1} << bits), nullptr);
+    auto const old = index_;
+    auto const old_bits = index_bits_;
+    index_ = p;
+    index_bits_ = bits;
+    if(old)
+    {
+        for(std::size_t i = 0;
+            i < (std::size_t{1} << old_bits); ++i)
+            if(old[i])
+                *index_slot(old[i]->f_) = old[i];
+        index_traits::deallocate(
+            a, old, std::size_t{1} << old_bits);
+    }
+}
+
+template<class Allocator>
+void
+basic_fields<Allocator>::
+link_element(element& e)
+{
+    BOOST_ASSERT(e.f_ != field::unknown);
+    auto const slot = index_slot(e.f_);
+    if(! *slot)
+    {
+        *slot = &e;
+        ++index_used_;
+    }
+    list_.push_back(e);
+}
+
+template<class Allocator>
+void
+basic_fields<Allocator>::
+unlink_element(element& e)
+{
+    auto const it = list_.iterator_to(e);
+    if(e.f_ == field::unknown)
+    {
+        set_.erase(set_.iterator_to(e));
+    }
+    else
+    {
+        auto const slot = index_slot(e.f_);
+        if(*slot == &e)
+        {
+            auto next = std::next(it);
+            while(next != list_.end() && next->f_ != e.f_)
+                ++next;
+            if(next != list_.end())
+                *slot = &*next;
+            else
+                index_erase(slot);
+        }
+    }
+    list_.erase(it);
+}
+
+template<class Allocator>
+std::size_t
+basic_fields<Allocator>::
+erase_known(field name)
+{
+    auto const p = first_element(name);
+    if(! p)
+        return 0;
+    index_erase(index_slot(name));
+    std::size_t n = 0;
+    auto it = list_.iterator_to(*p);
+    while(it != list_.end())
+    {
+        if(it->f_ != name)
+        {
+            ++it;
+            continue;
+        }
+        auto& e = *it;
+        it = list_.erase(it);
+        delete_element(e);
+        ++n;
+    }
+    return n;
+}
+
+template<class Allocator>
+void
+basic_fields<Allocator>::
+free_index()
+{
+    if(! index_)
+        return;
+    auto a = index_alloc_type{this->get()};
+    index_traits::deallocate(
+        a, index_, std::size_t{1} << index_bits_);
+    index_ = nullptr;
+    index_used_ = 0;
+    index_bits_ = 0;
+}
+
 template<class Allocator>
 void
 basic_fields<Allocator>::
@@ -1120,8 +1446,12 @@ basic_fields<Allocator>::
 move_assign(basic_fields& other, std::true_type)
 {
     clear_all();
+    free_index();
     set_ = std::move(other.set_);
     list_ = std::move(other.list_);
+    index_ = boost::exchange(other.index_, nullptr);
+    index_used_ = boost::exchange(other.index_used_, 0);
+    index_bits_ = boost::exchange(other.index_bits_, 0);
     method_ = other.method_;
     target_or_reason_ = other.target_or_reason_;
     other.method_ = {};
@@ -1143,8 +1473,12 @@ move_assign(basic_fields& other, std::false_type)
     }
     else
     {
+        free_index();
         set_ = std::move(other.set_);
         list_ = std::move(other.list_);
+        index_ = boost::exchange(other.index_, nullptr);
+        index_used_ = boost::exchange(other.index_used_, 0);
+        index_bits_ = boost::exchange(other.index_bits_, 0);
         method_ = other.method_;
         target_or_reason_ = other.target_or_reason_;
         other.method_ = {};
@@ -1159,6 +1493,7 @@ basic_fields<Allocator>::
 copy_assign(basic_fields const& other, std::true_type)
 {
     clear_all();
+    free_index();
     this->get() = other.get();
     copy_all(other);
 }
@@ -1183,6 +1518,9 @@ swap(basic_fields& other, std::true_type)
     swap(this->get(), other.get());
     swap(set_, other.set_);
     swap(list_, other.list_);
+    swap(index_, other.index_);
+    swap(index_used_, other.index_used_);
+    swap(index_bits_, other.index_bits_);
     swap(method_, other.method_);
     swap(target_or_reason_, other.target_or_reason_);
 }
@@ -1197,6 +1535,9 @@ swap(basic_fields& other, std::false_type)
     using std::swap;
     swap(set_, other.set_);
     swap(list_, other.list_);
+    swap(index_, other.index_);
+    swap(index_used_, other.index_used_);
+    swap(index_bits_, other.index_bits_);
     swap(method_, other.method_);
     swap(target_or_reason_, other.target_or_reason_);
 }
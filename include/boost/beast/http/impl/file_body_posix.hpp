@@ -0,0 +1,885 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_FILE_BODY_POSIX_HPP
+#define BOOST_BEAST_HTTP_IMPL_FILE_BODY_POSIX_HPP
+
+#include <boost/beast/core/file_posix.hpp>
+
+#if ! defined(BOOST_BEAST_USE_POSIX_SENDFILE)
+# if BOOST_BEAST_USE_POSIX_FILE && defined(__linux__)
+#  define BOOST_BEAST_USE_POSIX_SENDFILE 1
+# else
+#  define BOOST_BEAST_USE_POSIX_SENDFILE 0
+# endif
+#endif
+
+#if BOOST_BEAST_USE_POSIX_SENDFILE
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/basic_stream.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/buffers_range.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/basic_stream_socket.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace boost {
+namespace beast {
+
+template<class NextLayer>
+class ssl_stream;
+
+namespace http {
+
+namespace detail {
+template<bool isRequest, class Fields>
+std::size_t
+sendfile_some(int sock, serializer<isRequest,
+    basic_file_body<file_posix>, Fields>& sr, error_code& ec);
+} // detail
+
+/** A message body represented by a file on the filesystem.
+
+    This specialization behaves exactly like @ref basic_file_body,
+    and additionally lets @ref write_some and @ref async_write_some
+    send the body with `sendfile(2)` when the stream is a socket.
+    Synchronous writes to a @ref basic_stream use it as well, and so
+    do writes to an @ref ssl_stream whose records are encrypted by the
+    kernel. The octets then go from the page cache to the socket
+    without being copied through user space.
+
+    Asynchronous writes to a @ref basic_stream with the default
+    rate policy use it too. Whenever the socket is full, one write
+    goes through the stream instead, so that the wait for room is
+    bounded by the stream's timeout.
+*/
+template<>
+struct basic_file_body<file_posix>
+{
+    using file_type = file_posix;
+
+    class writer;
+    class reader;
+
+    //--------------------------------------------------------------------------
+
+    class value_type
+    {
+        friend class writer;
+        friend class reader;
+        friend struct basic_file_body<file_posix>;
+
+        template<bool isRequest, class Fields>
+        friend
+        std::size_t
+        detail::sendfile_some(int sock, serializer<isRequest,
+            basic_file_body<file_posix>, Fields>& sr, error_code& ec);
+
+        file_posix file_;
+        std::uint64_t file_size_ = 0;   // cached file size
+
+    public:
+        ~value_type() = default;
+        value_type() = default;
+        value_type(value_type&& other) = default;
+        value_type& operator=(value_type&& other) = default;
+
+        file_posix& file()
+        {
+            return file_;
+        }
+
+        bool
+        is_open() const
+        {
+            return file_.is_open();
+        }
+
+        std::uint64_t
+        size() const
+        {
+            return file_size_;
+        }
+
+        void
+        close();
+
+        void
+        open(char const* path, file_mode mode, error_code& ec);
+
+        void
+        reset(file_posix&& file, error_code& ec);
+    };
+
+    //--------------------------------------------------------------------------
+
+    class writer
+    {
+        template<bool isRequest, class Fields>
+        friend
+        std::size_t
+        detail::sendfile_some(int sock, serializer<isRequest,
+            basic_file_body<file_posix>, Fields>& sr, error_code& ec);
+
+        value_type& body_;      // The body we are reading from
+        std::uint64_t remain_;  // The number of unread bytes
+        char buf_[4096];        // Small buffer for reading
+
+    public:
+        using const_buffers_type =
+            net::const_buffer;
+
+        template<bool isRequest, class Fields>
+        writer(header<isRequest, Fields>&, value_type& b)
+            : body_(b)
+        {
+            BOOST_ASSERT(body_.file_.is_open());
+            remain_ = body_.file_size_;
+        }
+
+        void
+        init(error_code& ec)
+        {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>>
+        get(error_code& ec)
+        {
+            auto const amount =  remain_ > sizeof(buf_) ?
+                sizeof(buf_) : static_cast<std::size_t>(remain_);
+            if(amount == 0)
+            {
+                ec = {};
+                return boost::none;
+            }
+            auto const nread = body_.file_.read(buf_, amount, ec);
+            if(ec)
+                return boost::none;
+            BOOST_ASSERT(nread != 0);
+            BOOST_ASSERT(nread <= remain_);
+            remain_ -= nread;
+            ec = {};
+            return {{
+                const_buffers_type{buf_, nread},
+                remain_ > 0}};
+        }
+    };
+
+    //--------------------------------------------------------------------------
+
+    class reader
+    {
+        value_type& body_;
+
+    public:
+        template<bool isRequest, class Fields>
+        explicit
+        reader(header<isRequest, Fields>&, value_type& b)
+            : body_(b)
+        {
+        }
+
+        void
+        init(boost::optional<
+            std::uint64_t> const& content_length,
+                error_code& ec)
+        {
+            boost::ignore_unused(content_length);
+            BOOST_ASSERT(body_.file_.is_open());
+            ec = {};
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        put(ConstBufferSequence const& buffers,
+            error_code& ec)
+        {
+            std::size_t nwritten = 0;
+            for(auto buffer : beast::buffers_range_ref(buffers))
+            {
+                nwritten += body_.file_.write(
+                    buffer.data(), buffer.size(), ec);
+                if(ec)
+                    return nwritten;
+            }
+            ec = {};
+            return nwritten;
+        }
+
+        void
+        finish(error_code& ec)
+        {
+            ec = {};
+        }
+    };
+
+    //--------------------------------------------------------------------------
+
+    static
+    std::uint64_t
+    size(value_type const& body)
+    {
+        return body.size();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+inline
+void
+basic_file_body<file_posix>::
+value_type::
+close()
+{
+    error_code ignored;
+    file_.close(ignored);
+}
+
+inline
+void
+basic_file_body<file_posix>::
+value_type::
+open(char const* path, file_mode mode, error_code& ec)
+{
+    file_.open(path, mode, ec);
+    if(ec)
+        return;
+    file_size_ = file_.size(ec);
+    if(ec)
+    {
+        close();
+        return;
+    }
+}
+
+inline
+void
+basic_file_body<file_posix>::
+value_type::
+reset(file_posix&& file, error_code& ec)
+{
+    if(file_.is_open())
+    {
+        error_code ignored;
+        file_.close(ignored);
+    }
+    file_ = std::move(file);
+    file_size_ = file_.size(ec);
+}
+
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+class null_lambda
+{
+public:
+    template<class ConstBufferSequence>
+    void
+    operator()(error_code&,
+        ConstBufferSequence const&) const
+    {
+        BOOST_ASSERT(false);
+    }
+};
+
+// Returns `true` if the header should be sent with
+// MSG_MORE, because the body will follow immediately.
+template<bool isRequest, class Fields>
+bool
+sendfile_cork(serializer<isRequest,
+    basic_file_body<file_posix>, Fields>& sr)
+{
+    // When the caller asked for the header alone, it may
+    // wait for a reply (Expect: 100-continue) before sending
+    // the body, so the header must not be held back.
+    return
+        ! sr.split() &&
+        ! sr.get().chunked() &&
+        sr.get().body().size() > 0;
+}
+
+// Send the next piece of the body from the file to the
+// socket, and finish the serializer after the last one.
+template<bool isRequest, class Fields>
+std::size_t
+sendfile_some(int sock, serializer<isRequest,
+    basic_file_body<file_posix>, Fields>& sr, error_code& ec)
+{
+    if(sr.is_done())
+    {
+        ec = {};
+        return 0;
+    }
+    auto& w = sr.writer_impl();
+    // Linux transfers at most this many bytes per call
+    std::uint64_t const max_sendfile = 0x7ffff000;
+    auto const n = static_cast<std::size_t>(
+        (std::min)((std::min)(w.remain_,
+            static_cast<std::uint64_t>(sr.limit())), max_sendfile));
+    std::size_t bytes_transferred = 0;
+    if(n > 0)
+    {
+        ::ssize_t result;
+        do
+        {
+            result = ::sendfile(sock,
+                w.body_.file_.native_handle(), nullptr, n);
+        }
+        while(result < 0 && errno == EINTR);
+        if(result < 0)
+        {
+            ec.assign(errno, system_category());
+            return 0;
+        }
+        if(result == 0)
+        {
+            // The file is shorter than its cached size
+            ec = net::error::eof;
+            return 0;
+        }
+        bytes_transferred = static_cast<std::size_t>(result);
+        BOOST_ASSERT(bytes_transferred <= w.remain_);
+        w.remain_ -= bytes_transferred;
+    }
+    if(w.remain_ > 0)
+    {
+        ec = {};
+        return bytes_transferred;
+    }
+    sr.next(ec, null_lambda{});
+    BOOST_ASSERT(! ec);
+    BOOST_ASSERT(sr.is_done());
+    return bytes_transferred;
+}
+
+template<class Socket>
+class send_more_lambda
+{
+    Socket& sock_;
+
+public:
+    bool invoked = false;
+    std::size_t bytes_transferred = 0;
+
+    explicit
+    send_more_lambda(Socket& sock)
+        : sock_(sock)
+    {
+    }
+
+    template<class ConstBufferSequence>
+    void
+    operator()(error_code& ec,
+        ConstBufferSequence const& buffers)
+    {
+        invoked = true;
+        bytes_transferred =
+            sock_.send(buffers, MSG_MORE, ec);
+    }
+};
+
+// Like send_more_lambda, but fails with
+// would_block instead of waiting for room.
+class send_more_now_lambda
+{
+    int sock_;
+
+public:
+    bool invoked = false;
+    std::size_t bytes_transferred = 0;
+
+    explicit
+    send_more_now_lambda(int sock)
+        : sock_(sock)
+    {
+    }
+
+    template<class ConstBufferSequence>
+    void
+    operator()(error_code& ec,
+        ConstBufferSequence const& buffers)
+    {
+        invoked = true;
+        ::iovec iov[16];
+        std::size_t n = 0;
+        for(auto b : beast::buffers_range_ref(buffers))
+        {
+            if(n == sizeof(iov) / sizeof(iov[0]))
+                break;
+            iov[n].iov_base = const_cast<void*>(b.data());
+            iov[n].iov_len = b.size();
+            ++n;
+        }
+        ::msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+        ::ssize_t result;
+        do
+        {
+            result = ::sendmsg(sock_, &msg,
+                MSG_MORE | MSG_DONTWAIT | MSG_NOSIGNAL);
+        }
+        while(result < 0 && errno == EINTR);
+        if(result < 0)
+        {
+            ec.assign(errno, system_category());
+            return;
+        }
+        ec = {};
+        bytes_transferred = static_cast<std::size_t>(result);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+template<
+    class Protocol, class Executor,
+    bool isRequest, class Fields,
+    class Handler>
+class write_some_posix_op
+    : public beast::async_base<Handler, Executor>
+{
+    net::basic_stream_socket<
+        Protocol, Executor>& sock_;
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr_;
+    bool consume_ = false;
+    bool split_ = false;
+
+    class lambda
+    {
+        write_some_posix_op& op_;
+
+    public:
+        bool invoked = false;
+
+        explicit
+        lambda(write_some_posix_op& op)
+            : op_(op)
+        {
+        }
+
+        template<class ConstBufferSequence>
+        void
+        operator()(
+            error_code& ec,
+            ConstBufferSequence const& buffers)
+        {
+            invoked = true;
+            ec = {};
+            op_.consume_ = true;
+            op_.sock_.async_send(
+                buffers, MSG_MORE, std::move(op_));
+        }
+    };
+
+    void
+    send_file(bool cont)
+    {
+        error_code ec;
+        std::size_t bytes_transferred = 0;
+        if(! sock_.native_non_blocking())
+            sock_.native_non_blocking(true, ec);
+        if(! ec)
+            bytes_transferred = detail::sendfile_some(
+                sock_.native_handle(), sr_, ec);
+        if( ec == net::error::would_block ||
+            ec == net::error::try_again)
+            return sock_.async_wait(
+                net::socket_base::wait_write,
+                    std::move(*this));
+        this->complete(cont, ec, bytes_transferred);
+    }
+
+public:
+    template<class Handler_>
+    write_some_posix_op(
+        Handler_&& h,
+        net::basic_stream_socket<
+            Protocol, Executor>& s,
+        serializer<isRequest,
+            basic_file_body<file_posix>,Fields>& sr)
+        : async_base<
+            Handler, Executor>(
+                std::forward<Handler_>(h),
+                s.get_executor())
+        , sock_(s)
+        , sr_(sr)
+    {
+        (*this)();
+    }
+
+    void
+    operator()()
+    {
+        if(! sr_.is_header_done())
+        {
+            if(! sendfile_cork(sr_))
+                return detail::async_write_some_impl(
+                    sock_, sr_, std::move(*this));
+            // Send the header alone, and put the caller's
+            // setting back once it has been consumed.
+            sr_.split(true);
+            split_ = true;
+            error_code ec;
+            lambda f{*this};
+            sr_.next(ec, f);
+            if(f.invoked)
+            {
+                // *this is now moved-from
+                return;
+            }
+            return net::post(
+                sock_.get_executor(),
+                beast::bind_front_handler(
+                    std::move(*this), ec, 0));
+        }
+        if(sr_.get().chunked())
+        {
+            return detail::async_write_some_impl(
+                sock_, sr_, std::move(*this));
+        }
+        send_file(false);
+    }
+
+    void
+    operator()(error_code ec)
+    {
+        // The socket is writable again
+        if(ec)
+            return this->complete_now(ec, 0);
+        send_file(true);
+    }
+
+    void
+    operator()(
+        error_code ec,
+        std::size_t bytes_transferred)
+    {
+        if(! ec && consume_)
+            sr_.consume(bytes_transferred);
+        if(split_)
+            sr_.split(false);
+        this->complete_now(ec, bytes_transferred);
+    }
+};
+
+struct run_write_some_posix_op
+{
+    template<
+        class Protocol, class Executor,
+        bool isRequest, class Fields,
+        class WriteHandler>
+    void
+    operator()(
+        WriteHandler&& h,
+        net::basic_stream_socket<
+            Protocol, Executor>* s,
+        serializer<isRequest,
+            basic_file_body<file_posix>, Fields>* sr)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+            void(error_code, std::size_t)>::value,
+            "WriteHandler type requirements not met");
+
+        write_some_posix_op<
+            Protocol, Executor,
+            isRequest, Fields,
+            typename std::decay<WriteHandler>::type>(
+                std::forward<WriteHandler>(h), *s, *sr);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/*  Writes to a basic_stream go straight to its socket
+    while the socket has room. When it would block, the
+    write goes through the stream instead, which waits
+    for the socket under the stream's timeout.
+*/
+template<
+    class Protocol, class Executor,
+    bool isRequest, class Fields,
+    class Handler>
+class write_some_stream_op
+    : public beast::async_base<Handler, Executor>
+{
+    basic_stream<Protocol, Executor,
+        unlimited_rate_policy>& stream_;
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr_;
+
+public:
+    template<class Handler_>
+    write_some_stream_op(
+        Handler_&& h,
+        basic_stream<Protocol, Executor,
+            unlimited_rate_policy>& s,
+        serializer<isRequest,
+            basic_file_body<file_posix>,Fields>& sr)
+        : async_base<
+            Handler, Executor>(
+                std::forward<Handler_>(h),
+                s.get_executor())
+        , stream_(s)
+        , sr_(sr)
+    {
+        (*this)();
+    }
+
+    void
+    operator()()
+    {
+        if( sr_.get().chunked() || (
+            ! sr_.is_header_done() && ! sendfile_cork(sr_)))
+            return detail::async_write_some_impl(
+                stream_, sr_, std::move(*this));
+        auto& sock = stream_.socket();
+        error_code ec;
+        std::size_t bytes_transferred = 0;
+        if(! sock.native_non_blocking())
+            sock.native_non_blocking(true, ec);
+        if(! ec)
+        {
+            if(! sr_.is_header_done())
+            {
+                // Send the header alone, and put the caller's
+                // setting back once it has been consumed.
+                sr_.split(true);
+                send_more_now_lambda f{sock.native_handle()};
+                sr_.next(ec, f);
+                if(! ec && f.invoked)
+                    sr_.consume(f.bytes_transferred);
+                sr_.split(false);
+                bytes_transferred = f.bytes_transferred;
+            }
+            else
+            {
+                bytes_transferred = detail::sendfile_some(
+                    sock.native_handle(), sr_, ec);
+            }
+        }
+        if( ec == net::error::would_block ||
+            ec == net::error::try_again)
+            return detail::async_write_some_impl(
+                stream_, sr_, std::move(*this));
+        net::post(
+            stream_.get_executor(),
+            beast::bind_front_handler(
+                std::move(*this), ec, bytes_transferred));
+    }
+
+    void
+    operator()(
+        error_code ec,
+        std::size_t bytes_transferred)
+    {
+        this->complete_now(ec, bytes_transferred);
+    }
+};
+
+struct run_write_some_stream_op
+{
+    template<
+        class Protocol, class Executor,
+        bool isRequest, class Fields,
+        class WriteHandler>
+    void
+    operator()(
+        WriteHandler&& h,
+        basic_stream<Protocol, Executor,
+            unlimited_rate_policy>* s,
+        serializer<isRequest,
+            basic_file_body<file_posix>, Fields>* sr)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+            void(error_code, std::size_t)>::value,
+            "WriteHandler type requirements not met");
+
+        write_some_stream_op<
+            Protocol, Executor,
+            isRequest, Fields,
+            typename std::decay<WriteHandler>::type>(
+                std::forward<WriteHandler>(h), *s, *sr);
+    }
+};
+
+} // detail
+
+//------------------------------------------------------------------------------
+
+template<
+    class Protocol, class Executor,
+    bool isRequest, class Fields>
+std::size_t
+write_some(
+    net::basic_stream_socket<
+        Protocol, Executor>& sock,
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr,
+    error_code& ec)
+{
+    if(! sr.is_header_done())
+    {
+        if(! detail::sendfile_cork(sr))
+            return detail::write_some_impl(sock, sr, ec);
+        // Send the header alone, and put the caller's
+        // setting back once it has been consumed.
+        sr.split(true);
+        detail::send_more_lambda<net::basic_stream_socket<
+            Protocol, Executor>> f{sock};
+        sr.next(ec, f);
+        if(! ec && f.invoked)
+            sr.consume(f.bytes_transferred);
+        sr.split(false);
+        return f.bytes_transferred;
+    }
+    if(sr.get().chunked())
+        return detail::write_some_impl(sock, sr, ec);
+    for(;;)
+    {
+        auto const bytes_transferred = detail::sendfile_some(
+            sock.native_handle(), sr, ec);
+        if( ec != net::error::would_block &&
+            ec != net::error::try_again)
+            return bytes_transferred;
+        // A non-blocking socket reports the error, while
+        // a blocking one waits like the socket's own write.
+        if(sock.non_blocking())
+            return 0;
+        sock.wait(net::socket_base::wait_write, ec);
+        if(ec)
+            return 0;
+    }
+}
+
+template<
+    class Protocol, class Executor, class RatePolicy,
+    bool isRequest, class Fields>
+std::size_t
+write_some(
+    basic_stream<Protocol, Executor, RatePolicy>& stream,
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr,
+    error_code& ec)
+{
+    // Synchronous operations on the stream
+    // go straight to the socket.
+    return http::write_some(stream.socket(), sr, ec);
+}
+
+template<
+    class Protocol, class Executor,
+    bool isRequest, class Fields,
+    class WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+async_write_some(
+    net::basic_stream_socket<
+        Protocol, Executor>& sock,
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr,
+    WriteHandler&& handler)
+{
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code, std::size_t)>(
+            detail::run_write_some_posix_op{},
+            handler,
+            &sock,
+            &sr);
+}
+
+template<
+    class Protocol, class Executor,
+    bool isRequest, class Fields,
+    class WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+async_write_some(
+    basic_stream<Protocol, Executor,
+        unlimited_rate_policy>& stream,
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr,
+    WriteHandler&& handler)
+{
+    // Other rate policies keep the generic path,
+    // which meters every byte through the stream.
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code, std::size_t)>(
+            detail::run_write_some_stream_op{},
+            handler,
+            &stream,
+            &sr);
+}
+
+template<
+    class NextLayer,
+    bool isRequest, class Fields>
+std::size_t
+write_some(
+    ssl_stream<NextLayer>& stream,
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr,
+    error_code& ec)
+{
+    // With kernel TLS the socket encrypts what it sends,
+    // so the file can go to the next layer unchanged.
+    if(stream.ktls_send())
+        return http::write_some(stream.next_layer(), sr, ec);
+    return detail::write_some_impl(stream, sr, ec);
+}
+
+template<
+    class NextLayer,
+    bool isRequest, class Fields,
+    class WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+async_write_some(
+    ssl_stream<NextLayer>& stream,
+    serializer<isRequest,
+        basic_file_body<file_posix>, Fields>& sr,
+    WriteHandler&& handler)
+{
+    if(stream.ktls_send())
+        return http::async_write_some(stream.next_layer(), sr,
+            std::forward<WriteHandler>(handler));
+    return detail::async_write_some_impl(stream, sr,
+        std::forward<WriteHandler>(handler));
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
+
+#endif
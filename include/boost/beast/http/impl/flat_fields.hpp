@@ -0,0 +1,1276 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_FLAT_FIELDS_HPP
+#define BOOST_BEAST_HTTP_IMPL_FLAT_FIELDS_HPP
+
+#include <boost/beast/core/buffers_cat.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/core/detail/buffers_ref.hpp>
+#include <boost/beast/core/detail/temporary_buffer.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/beast/http/rfc7230.hpp>
+#include <boost/beast/http/status.hpp>
+#include <boost/beast/http/chunk_encode.hpp>
+#include <boost/beast/http/detail/flat_fields.hpp>
+#include <boost/core/exchange.hpp>
+#include <boost/throw_exception.hpp>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+template<class Allocator>
+class basic_flat_fields<Allocator>::writer
+{
+public:
+    using view_type = buffers_cat_view<
+        net::const_buffer,
+        net::const_buffer,
+        net::const_buffer,
+        net::const_buffer,
+        chunk_crlf>;
+
+    basic_flat_fields const& f_;
+    boost::optional<view_type> view_;
+    char buf_[13];
+
+    net::const_buffer
+    fields() const
+    {
+        return {f_.fields_data(), f_.len_ -
+            f_.method_len_ - f_.tor_len_};
+    }
+
+public:
+    using const_buffers_type =
+        beast::detail::buffers_ref<view_type>;
+
+    writer(basic_flat_fields const& f,
+        unsigned version, verb v);
+
+    writer(basic_flat_fields const& f,
+        unsigned version, unsigned code);
+
+    writer(basic_flat_fields const& f);
+
+    const_buffers_type
+    get() const
+    {
+        return const_buffers_type(*view_);
+    }
+};
+
+template<class Allocator>
+basic_flat_fields<Allocator>::writer::
+writer(basic_flat_fields const& f)
+    : f_(f)
+{
+    view_.emplace(
+        net::const_buffer{nullptr, 0},
+        net::const_buffer{nullptr, 0},
+        net::const_buffer{nullptr, 0},
+        fields(),
+        chunk_crlf());
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::writer::
+writer(basic_flat_fields const& f,
+        unsigned version, verb v)
+    : f_(f)
+{
+/*
+    request
+        "<method>"
+        " <target>"
+        " HTTP/X.Y\r\n" (11 chars)
+*/
+    string_view sv;
+    if(v == verb::unknown)
+        sv = f_.get_method_impl();
+    else
+        sv = to_string(v);
+
+    // the target has a leading SP
+
+    buf_[0] = ' ';
+    buf_[1] = 'H';
+    buf_[2] = 'T';
+    buf_[3] = 'T';
+    buf_[4] = 'P';
+    buf_[5] = '/';
+    buf_[6] = '0' + static_cast<char>(version / 10);
+    buf_[7] = '.';
+    buf_[8] = '0' + static_cast<char>(version % 10);
+    buf_[9] = '\r';
+    buf_[10]= '\n';
+
+    view_.emplace(
+        net::const_buffer{sv.data(), sv.size()},
+        net::const_buffer{
+            f_.buf_ + f_.method_len_, f_.tor_len_},
+        net::const_buffer{buf_, 11},
+        fields(),
+        chunk_crlf());
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::writer::
+writer(basic_flat_fields const& f,
+        unsigned version, unsigned code)
+    : f_(f)
+{
+/*
+    response
+        "HTTP/X.Y ### " (13 chars)
+        "<reason>"
+        "\r\n"
+*/
+    buf_[0] = 'H';
+    buf_[1] = 'T';
+    buf_[2] = 'T';
+    buf_[3] = 'P';
+    buf_[4] = '/';
+    buf_[5] = '0' + static_cast<char>(version / 10);
+    buf_[6] = '.';
+    buf_[7] = '0' + static_cast<char>(version % 10);
+    buf_[8] = ' ';
+    buf_[9] = '0' + static_cast<char>(code / 100);
+    buf_[10]= '0' + static_cast<char>((code / 10) % 10);
+    buf_[11]= '0' + static_cast<char>(code % 10);
+    buf_[12]= ' ';
+
+    string_view sv = f_.get_reason_impl();
+    if(sv.empty())
+        sv = obsolete_reason(static_cast<status>(code));
+
+    view_.emplace(
+        net::const_buffer{buf_, 13},
+        net::const_buffer{sv.data(), sv.size()},
+        net::const_buffer{"\r\n", 2},
+        fields(),
+        chunk_crlf{});
+}
+
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+~basic_flat_fields()
+{
+    release();
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields()
+{
+    use_inline();
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(Allocator const& alloc) noexcept
+    : boost::empty_value<Allocator>(boost::empty_init_t(), alloc)
+{
+    use_inline();
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields&& other) noexcept
+    : boost::empty_value<Allocator>(boost::empty_init_t(),
+        std::move(other.get()))
+{
+    use_inline();
+    steal(other);
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields&& other, Allocator const& alloc)
+    : boost::empty_value<Allocator>(boost::empty_init_t(), alloc)
+{
+    use_inline();
+    if(this->get() != other.get())
+    {
+        copy_all(other);
+        other.clear_all();
+    }
+    else
+    {
+        steal(other);
+    }
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields const& other)
+    : boost::empty_value<Allocator>(boost::empty_init_t(), alloc_traits::
+        select_on_container_copy_construction(other.get()))
+{
+    use_inline();
+    copy_all(other);
+}
+
+template<class Allocator>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields const& other,
+        Allocator const& alloc)
+    : boost::empty_value<Allocator>(boost::empty_init_t(), alloc)
+{
+    use_inline();
+    copy_all(other);
+}
+
+template<class Allocator>
+template<class OtherAlloc>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields<OtherAlloc> const& other)
+{
+    use_inline();
+    copy_all(other);
+}
+
+template<class Allocator>
+template<class OtherAlloc>
+basic_flat_fields<Allocator>::
+basic_flat_fields(basic_flat_fields<OtherAlloc> const& other,
+        Allocator const& alloc)
+    : boost::empty_value<Allocator>(boost::empty_init_t(), alloc)
+{
+    use_inline();
+    copy_all(other);
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+operator=(basic_flat_fields&& other) noexcept(
+    alloc_traits::propagate_on_container_move_assignment::value)
+      -> basic_flat_fields&
+{
+    static_assert(is_nothrow_move_assignable<Allocator>::value,
+        "Allocator must be noexcept assignable.");
+    if(this == &other)
+        return *this;
+    move_assign(other, std::integral_constant<bool,
+        alloc_traits:: propagate_on_container_move_assignment::value>{});
+    return *this;
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+operator=(basic_flat_fields const& other) ->
+    basic_flat_fields&
+{
+    if(this == &other)
+        return *this;
+    copy_assign(other, std::integral_constant<bool,
+        alloc_traits::propagate_on_container_copy_assignment::value>{});
+    return *this;
+}
+
+template<class Allocator>
+template<class OtherAlloc>
+auto
+basic_flat_fields<Allocator>::
+operator=(basic_flat_fields<OtherAlloc> const& other) ->
+    basic_flat_fields&
+{
+    clear_all();
+    copy_all(other);
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//
+// Element access
+//
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+string_view const
+basic_flat_fields<Allocator>::
+at(field name) const
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto const it = find(name);
+    if(it == end())
+        BOOST_THROW_EXCEPTION(std::out_of_range{
+            "field not found"});
+    return it->value();
+}
+
+template<class Allocator>
+string_view const
+basic_flat_fields<Allocator>::
+at(string_view name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        BOOST_THROW_EXCEPTION(std::out_of_range{
+            "field not found"});
+    return it->value();
+}
+
+template<class Allocator>
+string_view const
+basic_flat_fields<Allocator>::
+operator[](field name) const
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto const it = find(name);
+    if(it == end())
+        return {};
+    return it->value();
+}
+
+template<class Allocator>
+string_view const
+basic_flat_fields<Allocator>::
+operator[](string_view name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        return {};
+    return it->value();
+}
+
+//------------------------------------------------------------------------------
+//
+// Capacity
+//
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+reserve(std::size_t fields, std::size_t bytes)
+{
+    grow(fields, method_len_ + tor_len_ + bytes + 4 * fields);
+}
+
+//------------------------------------------------------------------------------
+//
+// Modifiers
+//
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+clear()
+{
+    index_release();
+    size_ = 0;
+    len_ = method_len_ + tor_len_;
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+insert(field name, string_param const& value)
+{
+    BOOST_ASSERT(name != field::unknown);
+    insert(name, to_string(name), value);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+insert(string_view sname, string_param const& value)
+{
+    auto const name =
+        string_to_field(sname);
+    insert(name, sname, value);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+insert(field name,
+    string_view sname, string_param const& value)
+{
+    insert_field(name, sname,
+        static_cast<string_view>(value), false);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set(field name, string_param const& value)
+{
+    BOOST_ASSERT(name != field::unknown);
+    insert_field(name, to_string(name),
+        static_cast<string_view>(value), true);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set(string_view sname, string_param const& value)
+{
+    insert_field(string_to_field(sname), sname,
+        static_cast<string_view>(value), true);
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+erase(const_iterator pos) ->
+    const_iterator
+{
+    auto const i = static_cast<std::size_t>(pos - list_);
+    erase_at(i, 1);
+    return list_ + i;
+}
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+erase(field name)
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto const i = find_index(name);
+    if(i == size_)
+        return 0;
+    auto const n = run_length(i);
+    erase_at(i, n);
+    return n;
+}
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+erase(string_view name)
+{
+    auto const i = find_index(
+        name, string_to_field(name));
+    if(i == size_)
+        return 0;
+    auto const n = run_length(i);
+    erase_at(i, n);
+    return n;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+swap(basic_flat_fields<Allocator>& other)
+{
+    swap(other, std::integral_constant<bool,
+        alloc_traits::propagate_on_container_swap::value>{});
+}
+
+template<class Allocator>
+void
+swap(
+    basic_flat_fields<Allocator>& lhs,
+    basic_flat_fields<Allocator>& rhs)
+{
+    lhs.swap(rhs);
+}
+
+//------------------------------------------------------------------------------
+//
+// Lookup
+//
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+count(field name) const
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto const i = find_index(name);
+    if(i == size_)
+        return 0;
+    return run_length(i);
+}
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+count(string_view name) const
+{
+    auto const i = find_index(
+        name, string_to_field(name));
+    if(i == size_)
+        return 0;
+    return run_length(i);
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+find(field name) const ->
+    const_iterator
+{
+    BOOST_ASSERT(name != field::unknown);
+    return list_ + find_index(name);
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+find(string_view name) const ->
+    const_iterator
+{
+    return list_ + find_index(
+        name, string_to_field(name));
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+equal_range(field name) const ->
+    std::pair<const_iterator, const_iterator>
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto const i = find_index(name);
+    if(i == size_)
+        return {end(), end()};
+    return {list_ + i, list_ + i + run_length(i)};
+}
+
+template<class Allocator>
+auto
+basic_flat_fields<Allocator>::
+equal_range(string_view name) const ->
+    std::pair<const_iterator, const_iterator>
+{
+    auto const i = find_index(
+        name, string_to_field(name));
+    if(i == size_)
+        return {end(), end()};
+    return {list_ + i, list_ + i + run_length(i)};
+}
+
+//------------------------------------------------------------------------------
+
+// Fields
+
+template<class Allocator>
+inline
+string_view
+basic_flat_fields<Allocator>::
+get_method_impl() const
+{
+    return {buf_, method_len_};
+}
+
+template<class Allocator>
+inline
+string_view
+basic_flat_fields<Allocator>::
+get_target_impl() const
+{
+    // The target is stored with a leading SP
+    if(tor_len_ == 0)
+        return {};
+    return {buf_ + method_len_ + 1, tor_len_ - 1};
+}
+
+template<class Allocator>
+inline
+string_view
+basic_flat_fields<Allocator>::
+get_reason_impl() const
+{
+    return {buf_ + method_len_, tor_len_};
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+get_chunked_impl() const
+{
+    auto const te = token_list{
+        (*this)[field::transfer_encoding]};
+    for(auto it = te.begin(); it != te.end();)
+    {
+        auto const next = std::next(it);
+        if(next == te.end())
+            return beast::iequals(*it, "chunked");
+        it = next;
+    }
+    return false;
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+get_keep_alive_impl(unsigned version) const
+{
+    auto const it = find(field::connection);
+    if(version < 11)
+    {
+        if(it == end())
+            return false;
+        return token_list{
+            it->value()}.exists("keep-alive");
+    }
+    if(it == end())
+        return true;
+    return ! token_list{
+        it->value()}.exists("close");
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+has_content_length_impl() const
+{
+    return find_index(field::content_length) != size_;
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+set_method_impl(string_view s)
+{
+    set_prefix(method_len_, s, false);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+set_target_impl(string_view s)
+{
+    set_prefix(tor_len_, s, true);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+set_reason_impl(string_view s)
+{
+    set_prefix(tor_len_, s, false);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set_chunked_impl(bool value)
+{
+    beast::detail::temporary_buffer buf;
+    auto it = find(field::transfer_encoding);
+    if(value)
+    {
+        // append "chunked"
+        if(it == end())
+        {
+            set(field::transfer_encoding, "chunked");
+            return;
+        }
+        auto const te = token_list{it->value()};
+        for(auto itt = te.begin();;)
+        {
+            auto const next = std::next(itt);
+            if(next == te.end())
+            {
+                if(beast::iequals(*itt, "chunked"))
+                    return; // already set
+                break;
+            }
+            itt = next;
+        }
+
+        buf.append(it->value(), ", chunked");
+        set(field::transfer_encoding, buf.view());
+        return;
+    }
+    // filter "chunked"
+    if(it == end())
+        return;
+
+    detail::filter_token_list_last(buf, it->value(), {"chunked", {}});
+    if(! buf.empty())
+        set(field::transfer_encoding, buf.view());
+    else
+        erase(field::transfer_encoding);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set_content_length_impl(
+    boost::optional<std::uint64_t> const& value)
+{
+    if(! value)
+        erase(field::content_length);
+    else
+        set(field::content_length, *value);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set_keep_alive_impl(
+    unsigned version, bool keep_alive)
+{
+    // VFALCO What about Proxy-Connection ?
+    auto const value = (*this)[field::connection];
+    beast::detail::temporary_buffer buf;
+    detail::keep_alive_impl(buf, value, version, keep_alive);
+    if(buf.empty())
+        erase(field::connection);
+    else
+        set(field::connection, buf.view());
+}
+
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+find_index(field name) const
+{
+    if(! index_)
+        return detail::find_field_key(keys_, size_, name);
+    auto const mask = index_size_ - 1;
+    for(auto h = detail::field_name_hash(name, {});; ++h)
+    {
+        auto const v = index_[h & mask];
+        if(v == 0)
+            return size_;
+        if(keys_[v - 1] == name)
+            return v - 1;
+    }
+}
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+find_index(string_view name, field f) const
+{
+    if(f != field::unknown)
+        return find_index(f);
+    if(! index_)
+    {
+        std::size_t i = 0;
+        for(; i < size_; ++i)
+            if( keys_[i] == field::unknown &&
+                list_[i].nlen_ == name.size() &&
+                beast::iequals(list_[i].name_string(), name))
+                break;
+        return i;
+    }
+    auto const mask = index_size_ - 1;
+    for(auto h = detail::field_name_hash(f, name);; ++h)
+    {
+        auto const v = index_[h & mask];
+        if(v == 0)
+            return size_;
+        if( keys_[v - 1] == field::unknown &&
+            beast::iequals(list_[v - 1].name_string(), name))
+            return v - 1;
+    }
+}
+
+template<class Allocator>
+std::size_t
+basic_flat_fields<Allocator>::
+run_length(std::size_t i) const
+{
+    // Fields with the same name are always adjacent
+    auto j = i + 1;
+    while(j < size_ && same_name(i, j))
+        ++j;
+    return j - i;
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+same_name(std::size_t i, std::size_t j) const
+{
+    if(keys_[i] != keys_[j])
+        return false;
+    if(keys_[i] != field::unknown)
+        return true;
+    return beast::iequals(
+        list_[i].name_string(), list_[j].name_string());
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+owns(string_view s) const
+{
+    std::less<char const*> less;
+    return
+        ! less(s.data(), buf_) &&
+        less(s.data(), buf_ + room_);
+}
+
+template<class Allocator>
+bool
+basic_flat_fields<Allocator>::
+is_inline() const
+{
+    return static_cast<void const*>(list_) ==
+        static_cast<void const*>(&inline_);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+use_inline()
+{
+    static_assert(inline_size > inline_fields * (
+        sizeof(value_type) + sizeof(field)),
+        "inline_size is too small");
+    cap_ = inline_fields;
+    room_ = static_cast<std::uint32_t>(inline_size -
+        inline_fields * (sizeof(value_type) + sizeof(field)));
+    list_ = reinterpret_cast<value_type*>(&inline_);
+    keys_ = reinterpret_cast<field*>(list_ + cap_);
+    buf_ = reinterpret_cast<char*>(keys_ + cap_);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+grow(std::size_t fields, std::size_t bytes)
+{
+    if(fields <= cap_ && bytes <= room_)
+        return;
+    std::size_t cap = cap_;
+    while(cap < fields)
+        cap *= 2;
+    std::size_t room = room_;
+    while(room < bytes)
+        room *= 2;
+    auto const size = cap * (
+        sizeof(value_type) + sizeof(field)) + room;
+    if(size > (std::numeric_limits<std::uint32_t>::max)())
+        BOOST_THROW_EXCEPTION(std::length_error{
+            "fields too large"});
+    auto a = rebind_type{this->get()};
+    auto const p = reinterpret_cast<value_type*>(
+        alloc_traits::allocate(a, (size +
+            sizeof(align_type) - 1) / sizeof(align_type)));
+    auto const keys = reinterpret_cast<field*>(p + cap);
+    auto const buf = reinterpret_cast<char*>(keys + cap);
+    for(std::size_t i = 0; i < size_; ++i)
+    {
+        p[i] = list_[i];
+        p[i].p_ = buf + (list_[i].p_ - buf_);
+    }
+    std::memcpy(keys, keys_, size_ * sizeof(field));
+    std::memcpy(buf, buf_, len_);
+    auto const n = size_;
+    auto const len = len_;
+    auto const method_len = method_len_;
+    auto const tor_len = tor_len_;
+    auto const index = boost::exchange(index_, nullptr);
+    auto const index_size = index_size_;
+    release();
+    list_ = p;
+    keys_ = keys;
+    buf_ = buf;
+    cap_ = static_cast<std::uint32_t>(cap);
+    room_ = static_cast<std::uint32_t>(room);
+    size_ = n;
+    len_ = len;
+    method_len_ = method_len;
+    tor_len_ = tor_len;
+    index_ = index;
+    index_size_ = index_size;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+insert_at(std::size_t i, field name,
+    string_view sname, string_view value)
+{
+    // Each field is stored as "<name>: <value>\r\n"
+    auto const n = static_cast<std::uint32_t>(
+        sname.size() + value.size() + 4);
+    grow(size_ + 1, len_ + n);
+    char* p = i < size_ ?
+        const_cast<char*>(list_[i].p_) : buf_ + len_;
+    std::memmove(p + n, p, buf_ + len_ - p);
+    for(auto j = i; j < size_; ++j)
+        list_[j].p_ += n;
+    std::memmove(list_ + i + 1, list_ + i,
+        (size_ - i) * sizeof(value_type));
+    std::memmove(keys_ + i + 1, keys_ + i,
+        (size_ - i) * sizeof(field));
+    sname.copy(p, sname.size());
+    p[sname.size()] = ':';
+    p[sname.size() + 1] = ' ';
+    value.copy(p + sname.size() + 2, value.size());
+    p[n - 2] = '\r';
+    p[n - 1] = '\n';
+    auto& e = list_[i];
+    e.p_ = p;
+    e.nlen_ = static_cast<off_t>(sname.size());
+    e.vlen_ = static_cast<off_t>(value.size());
+    e.f_ = name;
+    keys_[i] = name;
+    ++size_;
+    len_ += n;
+    index_insert(i);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+insert_field(field name,
+    string_view sname, string_view value, bool replace)
+{
+    if(sname.size() + 2 >
+            (std::numeric_limits<off_t>::max)())
+        BOOST_THROW_EXCEPTION(std::length_error{
+            "field name too large"});
+    if(value.size() + 2 >
+            (std::numeric_limits<off_t>::max)())
+        BOOST_THROW_EXCEPTION(std::length_error{
+            "field value too large"});
+    value = detail::trim(value);
+    if(owns(sname) || owns(value))
+    {
+        // The strings would move during the insertion
+        beast::detail::temporary_buffer buf;
+        buf.append(sname, value);
+        auto const s = buf.view();
+        return insert_field(name,
+            s.substr(0, sname.size()),
+            s.substr(sname.size()), replace);
+    }
+    auto i = find_index(sname, name);
+    if(replace)
+    {
+        if(i != size_)
+            erase_at(i, run_length(i));
+        i = size_;
+    }
+    else if(i != size_)
+    {
+        // keep duplicate fields together
+        i += run_length(i);
+    }
+    insert_at(i, name, sname, value);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+erase_at(std::size_t i, std::size_t n)
+{
+    BOOST_ASSERT(i + n <= size_);
+    auto const first = const_cast<char*>(list_[i].p_);
+    auto const last = i + n < size_ ?
+        const_cast<char*>(list_[i + n].p_) : buf_ + len_;
+    auto const len = static_cast<std::uint32_t>(last - first);
+    std::memmove(first, last, buf_ + len_ - last);
+    for(auto j = i + n; j < size_; ++j)
+        list_[j].p_ -= len;
+    std::memmove(list_ + i, list_ + i + n,
+        (size_ - i - n) * sizeof(value_type));
+    std::memmove(keys_ + i, keys_ + i + n,
+        (size_ - i - n) * sizeof(field));
+    size_ -= static_cast<std::uint32_t>(n);
+    len_ -= len;
+    if(size_ > hash_threshold)
+        index_rebuild();
+    else
+        index_release();
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+set_prefix(std::uint32_t& len,
+    string_view s, bool space)
+{
+    if(owns(s))
+    {
+        beast::detail::temporary_buffer buf;
+        buf.append(s);
+        return set_prefix(len, buf.view(), space);
+    }
+    auto const n = static_cast<std::uint32_t>(
+        s.empty() ? 0 : s.size() + space);
+    if(n > len)
+        grow(size_, len_ + n - len);
+    char* const p = buf_ + (&len == &method_len_ ? 0 : method_len_);
+    std::memmove(p + n, p + len, buf_ + len_ - (p + len));
+    auto const d = static_cast<std::ptrdiff_t>(n) -
+        static_cast<std::ptrdiff_t>(len);
+    for(std::size_t i = 0; i < size_; ++i)
+        list_[i].p_ += d;
+    if(n > 0)
+    {
+        if(space)
+            p[0] = ' ';
+        s.copy(p + space, s.size());
+    }
+    len_ = len_ + n - len;
+    len = n;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+index_insert(std::size_t i)
+{
+    if(! index_)
+    {
+        if(size_ > hash_threshold)
+            index_rebuild();
+        return;
+    }
+    if(size_ * 2 > index_size_ || i + 1 < size_)
+    {
+        // Rebuild when full, or when
+        // the positions after i shifted
+        index_rebuild();
+        return;
+    }
+    if(i > 0 && same_name(i - 1, i))
+        return;
+    auto const mask = index_size_ - 1;
+    auto h = detail::field_name_hash(
+        keys_[i], list_[i].name_string());
+    while(index_[h & mask] != 0)
+        ++h;
+    index_[h & mask] = static_cast<std::uint32_t>(i + 1);
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+index_rebuild()
+{
+    std::uint32_t n = 64;
+    while(n < size_ * 2)
+        n *= 2;
+    if(n != index_size_)
+    {
+        index_release();
+        auto a = index_alloc_type{this->get()};
+        index_ = index_traits::allocate(a, n);
+        index_size_ = n;
+    }
+    std::memset(index_, 0, n * sizeof(std::uint32_t));
+    auto const mask = n - 1;
+    for(std::size_t i = 0; i < size_; ++i)
+    {
+        if(i > 0 && same_name(i - 1, i))
+            continue;
+        auto h = detail::field_name_hash(
+            keys_[i], list_[i].name_string());
+        while(index_[h & mask] != 0)
+            ++h;
+        index_[h & mask] = static_cast<std::uint32_t>(i + 1);
+    }
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+index_release()
+{
+    if(! index_)
+        return;
+    auto a = index_alloc_type{this->get()};
+    index_traits::deallocate(a, index_, index_size_);
+    index_ = nullptr;
+    index_size_ = 0;
+}
+
+template<class Allocator>
+template<class OtherAlloc>
+void
+basic_flat_fields<Allocator>::
+copy_all(basic_flat_fields<OtherAlloc> const& other)
+{
+    BOOST_ASSERT(size_ == 0 && len_ == 0);
+    grow(other.size_, other.len_);
+    for(std::size_t i = 0; i < other.size_; ++i)
+    {
+        auto const& e = other.list_[i];
+        list_[i].p_ = buf_ + (e.p_ - other.buf_);
+        list_[i].nlen_ = e.nlen_;
+        list_[i].vlen_ = e.vlen_;
+        list_[i].f_ = e.f_;
+    }
+    std::memcpy(keys_, other.keys_, other.size_ * sizeof(field));
+    std::memcpy(buf_, other.buf_, other.len_);
+    size_ = other.size_;
+    len_ = other.len_;
+    method_len_ = other.method_len_;
+    tor_len_ = other.tor_len_;
+    if(size_ > hash_threshold)
+        index_rebuild();
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+clear_all()
+{
+    clear();
+    method_len_ = 0;
+    tor_len_ = 0;
+    len_ = 0;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+release()
+{
+    index_release();
+    if(! is_inline())
+    {
+        auto a = rebind_type{this->get()};
+        alloc_traits::deallocate(a,
+            reinterpret_cast<align_type*>(list_),
+            (cap_ * (sizeof(value_type) + sizeof(field)) +
+                room_ + sizeof(align_type) - 1) / sizeof(align_type));
+        use_inline();
+    }
+    size_ = 0;
+    len_ = 0;
+    method_len_ = 0;
+    tor_len_ = 0;
+}
+
+template<class Allocator>
+void
+basic_flat_fields<Allocator>::
+steal(basic_flat_fields& other)
+{
+    BOOST_ASSERT(is_inline() && size_ == 0 && len_ == 0);
+    if(other.is_inline())
+    {
+        for(std::size_t i = 0; i < other.size_; ++i)
+        {
+            list_[i] = other.list_[i];
+            list_[i].p_ = buf_ + (other.list_[i].p_ - other.buf_);
+        }
+        std::memcpy(keys_, other.keys_, other.size_ * sizeof(field));
+        std::memcpy(buf_, other.buf_, other.len_);
+    }
+    else
+    {
+        list_ = other.list_;
+        keys_ = other.keys_;
+        buf_ = other.buf_;
+        cap_ = other.cap_;
+        room_ = other.room_;
+        other.use_inline();
+    }
+    size_ = boost::exchange(other.size_, 0);
+    len_ = boost::exchange(other.len_, 0);
+    method_len_ = boost::exchange(other.method_len_, 0);
+    tor_len_ = boost::exchange(other.tor_len_, 0);
+    index_ = boost::exchange(other.index_, nullptr);
+    index_size_ = boost::exchange(other.index_size_, 0);
+}
+
+//------------------------------------------------------------------------------
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+move_assign(basic_flat_fields& other, std::true_type)
+{
+    release();
+    this->get() = other.get();
+    steal(other);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+move_assign(basic_flat_fields& other, std::false_type)
+{
+    release();
+    if(this->get() != other.get())
+    {
+        copy_all(other);
+        other.clear_all();
+    }
+    else
+    {
+        steal(other);
+    }
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+copy_assign(basic_flat_fields const& other, std::true_type)
+{
+    release();
+    this->get() = other.get();
+    copy_all(other);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+copy_assign(basic_flat_fields const& other, std::false_type)
+{
+    clear_all();
+    copy_all(other);
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+swap(basic_flat_fields& other, std::true_type)
+{
+    basic_flat_fields temp(std::move(*this));
+    steal(other);
+    other.steal(temp);
+    using std::swap;
+    swap(this->get(), other.get());
+}
+
+template<class Allocator>
+inline
+void
+basic_flat_fields<Allocator>::
+swap(basic_flat_fields& other, std::false_type)
+{
+    BOOST_ASSERT(this->get() == other.get());
+    basic_flat_fields temp(std::move(*this));
+    steal(other);
+    other.steal(temp);
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,203 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_HEADER_PARSER_HPP
+#define BOOST_BEAST_HTTP_IMPL_HEADER_PARSER_HPP
+
+#include <boost/beast/http/error.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+template<bool isRequest>
+header_parser<isRequest>::
+header_parser()
+{
+    this->whole_header(true);
+}
+
+template<bool isRequest>
+void
+header_parser<isRequest>::
+record(
+    std::uint32_t& off,
+    std::uint32_t& len,
+    unsigned char& copied,
+    unsigned char bit,
+    string_view s)
+{
+    len = static_cast<std::uint32_t>(s.size());
+    if(this->in_place())
+    {
+        BOOST_ASSERT(h_.in_ && s.data() >= h_.in_);
+        off = static_cast<std::uint32_t>(s.data() - h_.in_);
+        return;
+    }
+    off = static_cast<std::uint32_t>(copy_.size());
+    copy_.append(s.data(), s.size());
+    copied |= bit;
+}
+
+template<bool isRequest>
+std::size_t
+header_parser<isRequest>::
+put_body(string_view body, error_code& ec)
+{
+    if(! body_.data)
+    {
+        ec = error::need_buffer;
+        return 0;
+    }
+    auto const n = (std::min)(body_.size, body.size());
+    std::memcpy(body_.data, body.data(), n);
+    body_.data = static_cast<char*>(body_.data) + n;
+    body_.size -= n;
+    if(n == body.size())
+        ec = {};
+    else
+        ec = error::need_buffer;
+    return n;
+}
+
+template<bool isRequest>
+void
+header_parser<isRequest>::
+on_request_impl(
+    verb method,
+    string_view method_str,
+    string_view target,
+    int version,
+    error_code& ec,
+    std::true_type)
+{
+    h_.method_ = method;
+    h_.version_ = version;
+    if(this->in_place())
+        h_.in_ = method_str.data();
+    record(h_.line_.name_off, h_.line_.name_len,
+        h_.line_.copied, fields_view::copiedName, method_str);
+    record(h_.line_.value_off, h_.line_.value_len,
+        h_.line_.copied, fields_view::copiedValue, target);
+    ec = {};
+}
+
+template<bool isRequest>
+void
+header_parser<isRequest>::
+on_response_impl(
+    int code,
+    string_view reason,
+    int version,
+    error_code& ec,
+    std::true_type)
+{
+    h_.result_ = code;
+    h_.version_ = version;
+    if(this->in_place())
+        h_.in_ = reason.data();
+    record(h_.line_.value_off, h_.line_.value_len,
+        h_.line_.copied, fields_view::copiedValue, reason);
+    ec = {};
+}
+
+template<bool isRequest>
+void
+header_parser<isRequest>::
+on_field_impl(
+    field name,
+    string_view name_string,
+    string_view value,
+    error_code& ec)
+{
+    if(h_.size_ == capacity_)
+    {
+        std::unique_ptr<entry[]> p(new entry[capacity_ * 2]);
+        std::copy(list(), list() + h_.size_, p.get());
+        heap_ = std::move(p);
+        capacity_ *= 2;
+    }
+    auto& e = list()[h_.size_];
+    e.f = name;
+    e.copied = 0;
+    record(e.name_off, e.name_len,
+        e.copied, fields_view::copiedName, name_string);
+    record(e.value_off, e.value_len,
+        e.copied, fields_view::copiedValue, value);
+    ++h_.size_;
+    ec = {};
+}
+
+template<bool isRequest>
+void
+header_parser<isRequest>::
+on_header_impl(error_code& ec)
+{
+    h_.list_ = list();
+    h_.copy_ = copy_.data();
+    ec = {};
+}
+
+template<bool isRequest>
+void
+header_parser<isRequest>::
+on_body_init_impl(
+    boost::optional<std::uint64_t> const&,
+    error_code& ec)
+{
+    ec = {};
+}
+
+template<bool isRequest>
+std::size_t
+header_parser<isRequest>::
+on_body_impl(
+    string_view body,
+    error_code& ec)
+{
+    return put_body(body, ec);
+}
+
+template<bool isRequest>
+void
+header_parser<isRequest>::
+on_chunk_header_impl(
+    std::uint64_t,
+    string_view,
+    error_code& ec)
+{
+    ec = {};
+}
+
+template<bool isRequest>
+std::size_t
+header_parser<isRequest>::
+on_chunk_body_impl(
+    std::uint64_t,
+    string_view body,
+    error_code& ec)
+{
+    return put_body(body, ec);
+}
+
+template<bool isRequest>
+void
+header_parser<isRequest>::
+on_finish_impl(error_code& ec)
+{
+    ec = {};
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
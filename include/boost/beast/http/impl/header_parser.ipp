@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_HEADER_PARSER_IPP
+#define BOOST_BEAST_HTTP_IMPL_HEADER_PARSER_IPP
+
+#include <boost/beast/http/header_parser.hpp>
+#include <boost/throw_exception.hpp>
+#include <stdexcept>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+string_view const
+fields_view::
+at(field name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        BOOST_THROW_EXCEPTION(std::out_of_range{
+            "field not found"});
+    return it->value();
+}
+
+string_view const
+fields_view::
+at(string_view name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        BOOST_THROW_EXCEPTION(std::out_of_range{
+            "field not found"});
+    return it->value();
+}
+
+string_view const
+fields_view::
+operator[](field name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        return {};
+    return it->value();
+}
+
+string_view const
+fields_view::
+operator[](string_view name) const
+{
+    auto const it = find(name);
+    if(it == end())
+        return {};
+    return it->value();
+}
+
+std::size_t
+fields_view::
+count(field name) const
+{
+    BOOST_ASSERT(name != field::unknown);
+    std::size_t n = 0;
+    for(auto e = list_, last = list_ + size_; e != last; ++e)
+        if(e->f == name)
+            ++n;
+    return n;
+}
+
+std::size_t
+fields_view::
+count(string_view name) const
+{
+    auto const f = string_to_field(name);
+    if(f != field::unknown)
+        return count(f);
+    std::size_t n = 0;
+    for(auto e = list_, last = list_ + size_; e != last; ++e)
+        if(e->f == field::unknown &&
+                beast::iequals(name_of(*e), name))
+            ++n;
+    return n;
+}
+
+auto
+fields_view::
+find(field name) const ->
+    const_iterator
+{
+    BOOST_ASSERT(name != field::unknown);
+    auto e = list_;
+    for(auto const last = list_ + size_; e != last; ++e)
+        if(e->f == name)
+            break;
+    return const_iterator{value_type{this, e}};
+}
+
+auto
+fields_view::
+find(string_view name) const ->
+    const_iterator
+{
+    auto const f = string_to_field(name);
+    if(f != field::unknown)
+        return find(f);
+    auto e = list_;
+    for(auto const last = list_ + size_; e != last; ++e)
+        if(e->f == field::unknown &&
+                beast::iequals(name_of(*e), name))
+            break;
+    return const_iterator{value_type{this, e}};
+}
+
+} // http
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_IMPL_MAPPED_FILE_BODY_IPP
+#define BOOST_BEAST_HTTP_IMPL_MAPPED_FILE_BODY_IPP
+
+#include <boost/beast/http/mapped_file_body.hpp>
+#include <limits>
+
+#if BOOST_BEAST_USE_POSIX_FILE
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+namespace boost {
+namespace beast {
+namespace http {
+
+#if BOOST_BEAST_USE_POSIX_FILE
+
+struct mapped_file_body::value_type::mapping
+{
+    void* p = nullptr;
+    std::size_t n = 0;
+
+    mapping() = default;
+    mapping(mapping const&) = delete;
+    mapping& operator=(mapping const&) = delete;
+
+    ~mapping()
+    {
+        if(p)
+            ::munmap(p, n);
+    }
+};
+
+void
+mapped_file_body::value_type::
+open(char const* path, error_code& ec)
+{
+    close();
+    // Allocate first, so nothing can throw while fd is open
+    auto m = std::make_shared<mapping>();
+    int fd;
+    for(;;)
+    {
+        fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if(fd != -1)
+            break;
+        auto const ev = errno;
+        if(ev != EINTR)
+        {
+            ec.assign(ev, system_category());
+            return;
+        }
+    }
+    auto const close_fd =
+        [fd]
+        {
+            ::close(fd);
+        };
+    struct stat st;
+    if(::fstat(fd, &st) != 0)
+    {
+        ec.assign(errno, system_category());
+        close_fd();
+        return;
+    }
+    if(static_cast<std::uint64_t>(st.st_size) >
+        (std::numeric_limits<std::size_t>::max)())
+    {
+        ec = make_error_code(errc::file_too_large);
+        close_fd();
+        return;
+    }
+    m->n = static_cast<std::size_t>(st.st_size);
+    if(m->n > 0)
+    {
+        auto const p = ::mmap(nullptr, m->n,
+            PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED)
+        {
+            ec.assign(errno, system_category());
+            close_fd();
+            return;
+        }
+        m->p = p;
+    #ifdef MADV_SEQUENTIAL
+        ::madvise(p, m->n, MADV_SEQUENTIAL);
+    #endif
+    }
+    // The mapping remains valid after the descriptor is closed
+    close_fd();
+    data_ = static_cast<char const*>(m->p);
+    size_ = m->n;
+    map_ = std::move(m);
+    ec = {};
+}
+
+#else
+
+struct mapped_file_body::value_type::mapping
+{
+    std::unique_ptr<char[]> p;
+};
+
+void
+mapped_file_body::value_type::
+open(char const* path, error_code& ec)
+{
+    close();
+    file f;
+    f.open(path, file_mode::scan, ec);
+    if(ec)
+        return;
+    auto const size = f.size(ec);
+    if(ec)
+        return;
+    if(size > (std::numeric_limits<std::size_t>::max)())
+    {
+        ec = make_error_code(errc::file_too_large);
+        return;
+    }
+    auto m = std::make_shared<mapping>();
+    auto const n = static_cast<std::size_t>(size);
+    if(n > 0)
+    {
+        m->p.reset(new char[n]);
+        std::size_t pos = 0;
+        while(pos < n)
+        {
+            auto const bytes = f.read(
+                m->p.get() + pos, n - pos, ec);
+            if(ec)
+                return;
+            if(bytes == 0)
+            {
+                ec = make_error_code(errc::io_error);
+                return;
+            }
+            pos += bytes;
+        }
+    }
+    data_ = m->p.get();
+    size_ = n;
+    map_ = std::move(m);
+}
+
+#endif
+
+} // http
+} // beast
+} // boost
+
+#endif
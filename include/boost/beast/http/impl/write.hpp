@@ -198,8 +198,10 @@ public:
             }
             for(;;)
             {
+                // Unqualified, so that overloads for
+                // particular body types are found.
                 BOOST_ASIO_CORO_YIELD
-                beast::http::async_write_some(
+                async_write_some(
                     s_, sr_, std::move(*this));
                 bytes_transferred_ += bytes_transferred;
                 if(ec)
@@ -0,0 +1,221 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_HTTP_MAPPED_FILE_BODY_HPP
+#define BOOST_BEAST_HTTP_MAPPED_FILE_BODY_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+/** A <em>Body</em> which serializes a read-only memory-mapped file
+
+    The file is mapped into memory when it is opened, and the
+    writer returns buffers which point directly into the mapping.
+    No copy of the file is made in user space, and the operating
+    system is advised that the mapping will be read sequentially.
+
+    The mapping is reference counted. Copies of a body share
+    the same mapping, so a single open file may be used as the
+    payload of any number of responses, including responses
+    which are being serialized concurrently. The mapping is
+    released when the last body referring to it is destroyed.
+
+    Each call to write a serializer transfers at most
+    @ref serializer::limit bytes from the mapping.
+
+    Messages using this body type may only be serialized.
+
+    @note On platforms without POSIX `mmap`, the file is read
+    into a shared block of memory when it is opened instead.
+
+    @note The file must not be truncated while it is mapped.
+    Reading pages beyond the new end of the file raises `SIGBUS`,
+    which terminates the process during serialization. Replace
+    files by renaming a new one into place instead.
+*/
+struct mapped_file_body
+{
+    class value_type;
+
+    /** Returns the size of the body
+
+        @param body The file body to use
+    */
+    static
+    std::uint64_t
+    size(value_type const& body);
+
+    /** Algorithm for storing buffers when parsing.
+
+        This body is read-only, so no reader is provided.
+    */
+
+    /** Algorithm for retrieving buffers when serializing.
+
+        Objects of this type are created during serialization
+        to extract the buffers representing the body.
+    */
+#if BOOST_BEAST_DOXYGEN
+    using writer = __implementation_defined__;
+#else
+    class writer;
+#endif
+};
+
+/** The type of the @ref message::body member.
+
+    Messages declared using `mapped_file_body` will have this
+    type for the body member. Objects of this type hold a
+    shared reference to a read-only mapping of a file.
+*/
+class mapped_file_body::value_type
+{
+    struct mapping;
+
+    std::shared_ptr<mapping const> map_;
+    char const* data_ = nullptr;
+    std::size_t size_ = 0;
+
+    friend class writer;
+    friend struct mapped_file_body;
+
+public:
+    /// Constructor
+    value_type() = default;
+
+    /// Constructor
+    value_type(value_type const&) = default;
+
+    /// Constructor
+    value_type(value_type&&) = default;
+
+    /// Assignment
+    value_type& operator=(value_type const&) = default;
+
+    /// Assignment
+    value_type& operator=(value_type&&) = default;
+
+    /// Returns `true` if a file is mapped
+    bool
+    is_open() const
+    {
+        return map_ != nullptr;
+    }
+
+    /// Returns a pointer to the first byte of the mapped file
+    char const*
+    data() const
+    {
+        return data_;
+    }
+
+    /// Returns the size of the mapped file
+    std::size_t
+    size() const
+    {
+        return size_;
+    }
+
+    /** Release the reference to the mapping.
+
+        The mapping itself is released when no other
+        body refers to it.
+    */
+    void
+    close()
+    {
+        map_.reset();
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    /** Open and map a file for reading.
+
+        Any previously held mapping is released first.
+        The file descriptor is not kept open once the
+        mapping has been established.
+
+        @param path The utf-8 encoded path to the file
+
+        @param ec Set to the error, if any occurred
+    */
+    BOOST_BEAST_DECL
+    void
+    open(char const* path, error_code& ec);
+};
+
+inline
+std::uint64_t
+mapped_file_body::
+size(value_type const& body)
+{
+    return body.size();
+}
+
+#if ! BOOST_BEAST_DOXYGEN
+
+class mapped_file_body::writer
+{
+    value_type const& body_;
+
+public:
+    using const_buffers_type =
+        net::const_buffer;
+
+    template<bool isRequest, class Fields>
+    writer(header<isRequest, Fields> const&, value_type const& b)
+        : body_(b)
+    {
+    }
+
+    void
+    init(error_code& ec)
+    {
+        if(! body_.is_open())
+        {
+            ec = make_error_code(errc::bad_file_descriptor);
+            return;
+        }
+        ec = {};
+    }
+
+    boost::optional<std::pair<const_buffers_type, bool>>
+    get(error_code& ec)
+    {
+        ec = {};
+        // The serializer consumes this buffer in
+        // pieces of at most serializer::limit bytes.
+        return {{
+            { body_.data_, body_.size_ },
+            false}};
+    }
+};
+
+#endif
+
+} // http
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/http/impl/mapped_file_body.ipp>
+#endif
+
+#endif
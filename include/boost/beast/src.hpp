@@ -25,6 +25,10 @@ the program, with the macro BOOST_BEAST_SEPARATE_COMPILATION defined.
 # error Do not compile Beast library source with BOOST_BEAST_HEADER_ONLY defined
 #endif
 
+#include <boost/beast/_experimental/core/detail/uring.ipp>
+#include <boost/beast/_experimental/core/detail/uring_service.ipp>
+#include <boost/beast/_experimental/core/impl/file_uring.ipp>
+
 #include <boost/beast/_experimental/test/impl/error.ipp>
 #include <boost/beast/_experimental/test/impl/fail_count.ipp>
 #include <boost/beast/_experimental/test/impl/stream.ipp>
@@ -47,6 +51,8 @@ the program, with the macro BOOST_BEAST_SEPARATE_COMPILATION defined.
 #include <boost/beast/http/impl/error.ipp>
 #include <boost/beast/http/impl/field.ipp>
 #include <boost/beast/http/impl/fields.ipp>
+#include <boost/beast/http/impl/header_parser.ipp>
+#include <boost/beast/http/impl/mapped_file_body.ipp>
 #include <boost/beast/http/impl/rfc7230.ipp>
 #include <boost/beast/http/impl/status.ipp>
 #include <boost/beast/http/impl/verb.ipp>
@@ -54,13 +60,18 @@ the program, with the macro BOOST_BEAST_SEPARATE_COMPILATION defined.
 #include <boost/beast/websocket/detail/hybi13.ipp>
 #include <boost/beast/websocket/detail/mask.ipp>
 #include <boost/beast/websocket/detail/pmd_extension.ipp>
+#include <boost/beast/websocket/detail/pmd_pool.ipp>
 #include <boost/beast/websocket/detail/prng.ipp>
 #include <boost/beast/websocket/detail/service.ipp>
 #include <boost/beast/websocket/detail/utf8_checker.ipp>
+#include <boost/beast/websocket/impl/deflate_budget.ipp>
 #include <boost/beast/websocket/impl/error.ipp>
+#include <boost/beast/websocket/impl/prepared_message.ipp>
 
+#include <boost/beast/zlib/detail/checksum.ipp>
 #include <boost/beast/zlib/detail/deflate_stream.ipp>
 #include <boost/beast/zlib/detail/inflate_stream.ipp>
 #include <boost/beast/zlib/impl/error.ipp>
+#include <boost/beast/zlib/impl/parallel_deflate_stream.ipp>
 
 #endif
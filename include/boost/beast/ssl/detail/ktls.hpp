@@ -0,0 +1,998 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_SSL_DETAIL_KTLS_HPP
+#define BOOST_BEAST_SSL_DETAIL_KTLS_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/asio/ssl/context.hpp>
+
+// Kernel TLS requires the Linux headers which describe
+// ChaCha20-Poly1305 (Linux 5.11), and OpenSSL 1.1.1 or
+// later for TLS 1.3 and the key logging callback.
+#if ! defined(BOOST_BEAST_USE_KTLS)
+# if defined(__linux__) && defined(__has_include) && \
+    ! defined(LIBRESSL_VERSION_NUMBER) && \
+    OPENSSL_VERSION_NUMBER >= 0x10101000L
+#  if __has_include(<linux/tls.h>)
+#   include <linux/tls.h>
+#   if defined(TLS_CIPHER_CHACHA20_POLY1305) && \
+       defined(TLS_GET_RECORD_TYPE)
+#    define BOOST_BEAST_USE_KTLS 1
+#   endif
+#  endif
+# endif
+#endif
+#if ! defined(BOOST_BEAST_USE_KTLS)
+# define BOOST_BEAST_USE_KTLS 0
+#endif
+
+#if BOOST_BEAST_USE_KTLS
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/basic_stream.hpp>
+#include <boost/beast/core/bind_handler.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/asio/basic_stream_socket.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/ssl/error.hpp>
+#include <boost/asio/ssl/stream_base.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <errno.h>
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+namespace boost {
+namespace beast {
+namespace detail {
+
+// Which directions are handled by the kernel
+struct ktls_state
+{
+    bool tx = false;
+    bool rx = false;
+    bool tls13 = false;
+    bool eof = false;           // close_notify received
+};
+
+// tls12_crypto_info_chacha20_poly1305 has an empty salt
+// array, which is not allowed in a union in C++
+struct ktls_chacha20_poly1305
+{
+    tls_crypto_info info;
+    unsigned char iv[TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE];
+    unsigned char key[TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE];
+    unsigned char rec_seq[TLS_CIPHER_CHACHA20_POLY1305_REC_SEQ_SIZE];
+};
+
+BOOST_STATIC_ASSERT(sizeof(ktls_chacha20_poly1305) ==
+    sizeof(tls12_crypto_info_chacha20_poly1305));
+BOOST_STATIC_ASSERT(offsetof(ktls_chacha20_poly1305, rec_seq) ==
+    offsetof(tls12_crypto_info_chacha20_poly1305, rec_seq));
+
+// The keys for one direction, in the form setsockopt expects
+struct ktls_crypto_info
+{
+    union
+    {
+        tls_crypto_info info;
+        tls12_crypto_info_aes_gcm_128 aes_gcm_128;
+        tls12_crypto_info_aes_gcm_256 aes_gcm_256;
+        ktls_chacha20_poly1305 chacha20_poly1305;
+    };
+    socklen_t size;
+};
+
+// TLS 1.3 application traffic secrets captured from the key log
+struct ktls_secrets
+{
+    unsigned char client[EVP_MAX_MD_SIZE];
+    unsigned char server[EVP_MAX_MD_SIZE];
+    std::size_t client_size = 0;
+    std::size_t server_size = 0;
+};
+
+// The key log callback which was installed before ours
+struct ktls_keylog
+{
+    SSL_CTX_keylog_cb_func prev = nullptr;
+};
+
+inline
+void
+ktls_free_secrets(void*, void* p,
+    CRYPTO_EX_DATA*, int, long, void*)
+{
+    if(p)
+    {
+        OPENSSL_cleanse(p, sizeof(ktls_secrets));
+        delete static_cast<ktls_secrets*>(p);
+    }
+}
+
+inline
+void
+ktls_free_keylog(void*, void* p,
+    CRYPTO_EX_DATA*, int, long, void*)
+{
+    delete static_cast<ktls_keylog*>(p);
+}
+
+inline
+int
+ktls_ssl_index()
+{
+    static int const index = SSL_get_ex_new_index(
+        0, nullptr, nullptr, nullptr, &ktls_free_secrets);
+    return index;
+}
+
+inline
+int
+ktls_ctx_index()
+{
+    static int const index = SSL_CTX_get_ex_new_index(
+        0, nullptr, nullptr, nullptr, &ktls_free_keylog);
+    return index;
+}
+
+inline
+int
+ktls_unhex(char c)
+{
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// Parse "<label> <client_random> <secret>" and store the
+// secret if the label names an application traffic secret.
+inline
+void
+ktls_keylog_line(SSL* ssl, char const* line)
+{
+    static char const client_label[] = "CLIENT_TRAFFIC_SECRET_0 ";
+    static char const server_label[] = "SERVER_TRAFFIC_SECRET_0 ";
+    bool is_client;
+    if(std::strncmp(line, client_label,
+            sizeof(client_label) - 1) == 0)
+        is_client = true;
+    else if(std::strncmp(line, server_label,
+            sizeof(server_label) - 1) == 0)
+        is_client = false;
+    else
+        return;
+    auto p = std::strchr(line + sizeof(client_label) - 1, ' ');
+    if(! p)
+        return;
+    ++p;
+    unsigned char secret[EVP_MAX_MD_SIZE];
+    std::size_t n = 0;
+    for(;;)
+    {
+        auto const hi = ktls_unhex(p[0]);
+        if(hi < 0)
+            break;
+        auto const lo = ktls_unhex(p[1]);
+        if(lo < 0 || n == sizeof(secret))
+            return;
+        secret[n++] = static_cast<unsigned char>(hi * 16 + lo);
+        p += 2;
+    }
+    auto s = static_cast<ktls_secrets*>(
+        SSL_get_ex_data(ssl, ktls_ssl_index()));
+    if(! s)
+    {
+        s = new ktls_secrets;
+        if(! SSL_set_ex_data(ssl, ktls_ssl_index(), s))
+        {
+            delete s;
+            return;
+        }
+    }
+    if(is_client)
+    {
+        std::memcpy(s->client, secret, n);
+        s->client_size = n;
+    }
+    else
+    {
+        std::memcpy(s->server, secret, n);
+        s->server_size = n;
+    }
+    OPENSSL_cleanse(secret, sizeof(secret));
+}
+
+inline
+void
+ktls_keylog_callback(SSL const* ssl, char const* line)
+{
+    auto const ctx = SSL_get_SSL_CTX(ssl);
+    ktls_keylog_line(const_cast<SSL*>(ssl), line);
+    auto const k = static_cast<ktls_keylog*>(
+        SSL_CTX_get_ex_data(ctx, ktls_ctx_index()));
+    if(k && k->prev)
+        k->prev(ssl, line);
+}
+
+// Returns `true` if enable_ktls was called on the context
+inline
+bool
+ktls_is_enabled(SSL* ssl)
+{
+    return SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl),
+        ktls_ctx_index()) != nullptr;
+}
+
+inline
+void
+ktls_enable(SSL_CTX* ctx)
+{
+    if(SSL_CTX_get_ex_data(ctx, ktls_ctx_index()))
+        return;
+    auto k = new ktls_keylog;
+    k->prev = SSL_CTX_get_keylog_callback(ctx);
+    if(! SSL_CTX_set_ex_data(ctx, ktls_ctx_index(), k))
+    {
+        delete k;
+        return;
+    }
+    SSL_CTX_set_keylog_callback(ctx, &ktls_keylog_callback);
+    // A TLS 1.3 server encrypts its session tickets with
+    // the application keys, before the kernel could take
+    // them over, and OpenSSL does not report the record
+    // sequence numbers this consumes.
+    SSL_CTX_set_num_tickets(ctx, 0);
+}
+
+// HKDF-Expand-Label from RFC 8446, with an empty context
+inline
+bool
+ktls_expand_label(
+    EVP_MD const* md,
+    unsigned char const* secret, std::size_t secret_size,
+    char const* label,
+    unsigned char* out, std::size_t size)
+{
+    unsigned char info[2 + 1 + 255 + 1];
+    auto const label_size = std::strlen(label);
+    info[0] = static_cast<unsigned char>(size >> 8);
+    info[1] = static_cast<unsigned char>(size & 0xff);
+    info[2] = static_cast<unsigned char>(6 + label_size);
+    std::memcpy(info + 3, "tls13 ", 6);
+    std::memcpy(info + 9, label, label_size);
+    info[9 + label_size] = 0;
+    auto const pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, nullptr);
+    if(! pctx)
+        return false;
+    auto outlen = size;
+    bool const ok =
+        EVP_PKEY_derive_init(pctx) > 0 &&
+        EVP_PKEY_CTX_hkdf_mode(pctx,
+            EVP_PKEY_HKDEF_MODE_EXPAND_ONLY) > 0 &&
+        EVP_PKEY_CTX_set_hkdf_md(pctx, md) > 0 &&
+        EVP_PKEY_CTX_set1_hkdf_key(pctx, secret,
+            static_cast<int>(secret_size)) > 0 &&
+        EVP_PKEY_CTX_add1_hkdf_info(pctx, info,
+            static_cast<int>(10 + label_size)) > 0 &&
+        EVP_PKEY_derive(pctx, out, &outlen) > 0 &&
+        outlen == size;
+    EVP_PKEY_CTX_free(pctx);
+    return ok;
+}
+
+// The TLS 1.2 key block from RFC 5246 section 6.3
+inline
+bool
+ktls_key_block(
+    SSL* ssl, EVP_MD const* md,
+    unsigned char* out, std::size_t size)
+{
+    unsigned char master[SSL_MAX_MASTER_KEY_LENGTH];
+    unsigned char client_random[SSL3_RANDOM_SIZE];
+    unsigned char server_random[SSL3_RANDOM_SIZE];
+    auto const master_size = SSL_SESSION_get_master_key(
+        SSL_get_session(ssl), master, sizeof(master));
+    if( master_size == 0 ||
+        SSL_get_client_random(ssl, client_random,
+            sizeof(client_random)) != sizeof(client_random) ||
+        SSL_get_server_random(ssl, server_random,
+            sizeof(server_random)) != sizeof(server_random))
+        return false;
+    auto const pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, nullptr);
+    if(! pctx)
+        return false;
+    auto outlen = size;
+    bool const ok =
+        EVP_PKEY_derive_init(pctx) > 0 &&
+        EVP_PKEY_CTX_set_tls1_prf_md(pctx, md) > 0 &&
+        EVP_PKEY_CTX_set1_tls1_prf_secret(pctx, master,
+            static_cast<int>(master_size)) > 0 &&
+        EVP_PKEY_CTX_add1_tls1_prf_seed(pctx,
+            reinterpret_cast<unsigned char const*>(
+                "key expansion"), 13) > 0 &&
+        EVP_PKEY_CTX_add1_tls1_prf_seed(pctx,
+            server_random, sizeof(server_random)) > 0 &&
+        EVP_PKEY_CTX_add1_tls1_prf_seed(pctx,
+            client_random, sizeof(client_random)) > 0 &&
+        EVP_PKEY_derive(pctx, out, &outlen) > 0 &&
+        outlen == size;
+    EVP_PKEY_CTX_free(pctx);
+    OPENSSL_cleanse(master, sizeof(master));
+    return ok;
+}
+
+/*  Compute the kernel parameters for one direction of
+    a connection whose handshake has just completed.
+
+    Returns `false` if the protocol version or cipher
+    is not supported by the kernel, or the keys are
+    not available.
+*/
+inline
+bool
+ktls_make_crypto_info(
+    SSL* ssl, bool tx, ktls_crypto_info& ci)
+{
+    std::memset(&ci, 0, sizeof(ci));
+    auto const cipher = SSL_get_current_cipher(ssl);
+    if(! cipher)
+        return false;
+    auto const md = SSL_CIPHER_get_handshake_digest(cipher);
+    if(! md)
+        return false;
+    int const version = SSL_version(ssl);
+    bool const tls13 = version == TLS1_3_VERSION;
+    if(! tls13 && version != TLS1_2_VERSION)
+        return false;
+
+    std::size_t key_size;
+    std::size_t salt_size;
+    std::size_t iv_size;
+    unsigned char* key;
+    unsigned char* salt;
+    unsigned char* iv;
+    unsigned char* rec_seq;
+    switch(SSL_CIPHER_get_cipher_nid(cipher))
+    {
+    case NID_aes_128_gcm:
+        ci.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        ci.size = sizeof(ci.aes_gcm_128);
+        key_size = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+        salt_size = TLS_CIPHER_AES_GCM_128_SALT_SIZE;
+        iv_size = TLS_CIPHER_AES_GCM_128_IV_SIZE;
+        key = ci.aes_gcm_128.key;
+        salt = ci.aes_gcm_128.salt;
+        iv = ci.aes_gcm_128.iv;
+        rec_seq = ci.aes_gcm_128.rec_seq;
+        break;
+
+    case NID_aes_256_gcm:
+        ci.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        ci.size = sizeof(ci.aes_gcm_256);
+        key_size = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+        salt_size = TLS_CIPHER_AES_GCM_256_SALT_SIZE;
+        iv_size = TLS_CIPHER_AES_GCM_256_IV_SIZE;
+        key = ci.aes_gcm_256.key;
+        salt = ci.aes_gcm_256.salt;
+        iv = ci.aes_gcm_256.iv;
+        rec_seq = ci.aes_gcm_256.rec_seq;
+        break;
+
+    case NID_chacha20_poly1305:
+        ci.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+        ci.size = sizeof(ci.chacha20_poly1305);
+        key_size = TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE;
+        salt_size = 0;
+        iv_size = TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE;
+        key = ci.chacha20_poly1305.key;
+        salt = nullptr;
+        iv = ci.chacha20_poly1305.iv;
+        rec_seq = ci.chacha20_poly1305.rec_seq;
+        break;
+
+    default:
+        return false;
+    }
+
+    // The client writes with the client keys
+    bool const client_keys = (SSL_is_server(ssl) == 0) == tx;
+    // salt followed by iv, as the nonce is laid out
+    unsigned char nonce[12];
+    std::uint64_t seq;
+    if(tls13)
+    {
+        ci.info.version = TLS_1_3_VERSION;
+        auto const s = static_cast<ktls_secrets*>(
+            SSL_get_ex_data(ssl, ktls_ssl_index()));
+        if(! s)
+            return false;
+        auto const secret = client_keys ? s->client : s->server;
+        auto const secret_size =
+            client_keys ? s->client_size : s->server_size;
+        if(secret_size == 0)
+            return false;
+        if( ! ktls_expand_label(md, secret, secret_size,
+                "key", key, key_size) ||
+            ! ktls_expand_label(md, secret, secret_size,
+                "iv", nonce, sizeof(nonce)))
+            return false;
+        // The Finished messages use the handshake keys
+        seq = 0;
+    }
+    else
+    {
+        ci.info.version = TLS_1_2_VERSION;
+        // client key, server key, client iv, server iv
+        std::size_t const fixed_iv_size =
+            salt_size > 0 ? salt_size : iv_size;
+        unsigned char block[2 * (32 + 12)];
+        auto const block_size = 2 * (key_size + fixed_iv_size);
+        if(! ktls_key_block(ssl, md, block, block_size))
+            return false;
+        std::memcpy(key, block +
+            (client_keys ? 0 : key_size), key_size);
+        std::memcpy(nonce, block + 2 * key_size +
+            (client_keys ? 0 : fixed_iv_size), fixed_iv_size);
+        OPENSSL_cleanse(block, sizeof(block));
+        // The Finished message is the first
+        // record protected by these keys.
+        seq = 1;
+    }
+    for(int i = 7; i >= 0; --i)
+    {
+        rec_seq[i] = static_cast<unsigned char>(seq & 0xff);
+        seq >>= 8;
+    }
+    if(salt_size > 0)
+    {
+        std::memcpy(salt, nonce, salt_size);
+        if(tls13)
+            std::memcpy(iv, nonce + salt_size, iv_size);
+        else
+            // The explicit part of the nonce is sent with each
+            // record; the kernel starts from this value.
+            std::memcpy(iv, rec_seq, iv_size);
+    }
+    else
+    {
+        std::memcpy(iv, nonce, iv_size);
+    }
+    OPENSSL_cleanse(nonce, sizeof(nonce));
+    return true;
+}
+
+/*  Move record protection for the connection into the kernel.
+
+    Each direction is moved independently. Receiving is only
+    moved when OpenSSL holds no buffered input, since the kernel
+    would not see those bytes.
+*/
+inline
+void
+ktls_attach(SSL* ssl, int fd, ktls_state& st)
+{
+    st = {};
+    if(fd == -1 || ! ktls_is_enabled(ssl))
+        return;
+    if(::setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) != 0 &&
+        errno != EEXIST)
+        return;
+    st.tls13 = SSL_version(ssl) == TLS1_3_VERSION;
+    ktls_crypto_info ci;
+    if( SSL_has_pending(ssl) == 0 &&
+        BIO_ctrl_pending(SSL_get_rbio(ssl)) == 0 &&
+        ktls_make_crypto_info(ssl, false, ci))
+        st.rx = ::setsockopt(fd, SOL_TLS, TLS_RX,
+            &ci, ci.size) == 0;
+    if(ktls_make_crypto_info(ssl, true, ci))
+        st.tx = ::setsockopt(fd, SOL_TLS, TLS_TX,
+            &ci, ci.size) == 0;
+    OPENSSL_cleanse(&ci, sizeof(ci));
+}
+
+//------------------------------------------------------------------------------
+
+// Returns the socket descriptor for a stream, or -1
+
+template<class Protocol, class Executor>
+int
+ktls_native_handle(
+    net::basic_stream_socket<Protocol, Executor>& sock)
+{
+    return sock.native_handle();
+}
+
+template<class Protocol, class Executor, class RatePolicy>
+int
+ktls_native_handle(
+    basic_stream<Protocol, Executor, RatePolicy>& stream)
+{
+    return stream.socket().native_handle();
+}
+
+template<class Stream>
+int
+ktls_native_handle(Stream&)
+{
+    return -1;
+}
+
+// Wait until the stream's socket is writable
+
+template<class Protocol, class Executor, class Handler>
+void
+ktls_async_wait_write(
+    net::basic_stream_socket<Protocol, Executor>& sock,
+    Handler&& handler)
+{
+    sock.async_wait(net::socket_base::wait_write,
+        std::forward<Handler>(handler));
+}
+
+template<
+    class Protocol, class Executor, class RatePolicy,
+    class Handler>
+void
+ktls_async_wait_write(
+    basic_stream<Protocol, Executor, RatePolicy>& stream,
+    Handler&& handler)
+{
+    stream.socket().async_wait(net::socket_base::wait_write,
+        std::forward<Handler>(handler));
+}
+
+template<class Stream, class Handler>
+void
+ktls_async_wait_write(Stream& stream, Handler&& handler)
+{
+    // kTLS is never attached without a socket
+    BOOST_ASSERT(false);
+    net::post(stream.get_executor(),
+        beast::bind_front_handler(std::forward<Handler>(handler),
+            error_code(net::error::operation_not_supported)));
+}
+
+//------------------------------------------------------------------------------
+
+inline
+bool
+ktls_is_control(error_code const& ec)
+{
+    // The kernel fails an ordinary read with EIO
+    // when the next record does not hold data.
+    return ec.value() == EIO &&
+        ec.category() == system_category();
+}
+
+// Send a close_notify alert through the kernel
+inline
+void
+ktls_send_close_notify(int fd, error_code& ec)
+{
+    unsigned char data[2] = { 1, 0 }; // warning, close_notify
+    iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = sizeof(data);
+    char cbuf[CMSG_SPACE(sizeof(unsigned char))];
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    std::memset(cbuf, 0, sizeof(cbuf));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    auto const cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(unsigned char));
+    *CMSG_DATA(cmsg) = 21; // alert
+    msg.msg_controllen = cmsg->cmsg_len;
+    for(;;)
+    {
+        if(::sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL) >= 0)
+            break;
+        if(errno == EINTR)
+            continue;
+        if(errno == EAGAIN || errno == EWOULDBLOCK)
+            ec = net::error::would_block;
+        else
+            ec.assign(errno, system_category());
+        return;
+    }
+    ec = {};
+}
+
+// Blocking form, for synchronous operations
+inline
+void
+ktls_send_close_notify_sync(int fd, error_code& ec)
+{
+    for(;;)
+    {
+        ktls_send_close_notify(fd, ec);
+        if(ec != net::error::would_block)
+            return;
+        pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        if(::poll(&pfd, 1, -1) < 0 && errno != EINTR)
+        {
+            ec.assign(errno, system_category());
+            return;
+        }
+    }
+}
+
+/*  Consume the record at the head of the socket, which
+    does not hold application data, and set `ec` to the
+    result for the read which encountered it.
+
+    Session tickets are discarded and leave `ec` clear, so
+    the read is retried. A close_notify alert sets eof.
+*/
+inline
+void
+ktls_read_control(int fd, ktls_state& st, error_code& ec)
+{
+    unsigned char data[16384];
+    iovec iov;
+    iov.iov_base = data;
+    iov.iov_len = sizeof(data);
+    char cbuf[CMSG_SPACE(sizeof(unsigned char))];
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    ssize_t n;
+    do
+    {
+        n = ::recvmsg(fd, &msg, MSG_DONTWAIT);
+    }
+    while(n < 0 && errno == EINTR);
+    if(n < 0)
+    {
+        ec.assign(errno, system_category());
+        return;
+    }
+    int type = 23; // application_data
+    auto const cmsg = CMSG_FIRSTHDR(&msg);
+    if( cmsg &&
+        cmsg->cmsg_level == SOL_TLS &&
+        cmsg->cmsg_type == TLS_GET_RECORD_TYPE)
+        type = *CMSG_DATA(cmsg);
+    if(type == 21 && n >= 2)
+    {
+        if(data[1] == 0)
+        {
+            st.eof = true;
+            ec = net::error::eof;
+            return;
+        }
+        // Report the alert the way OpenSSL would
+        ec.assign(static_cast<int>(ERR_PACK(ERR_LIB_SSL, 0,
+            SSL_AD_REASON_OFFSET + data[1])),
+                net::error::get_ssl_category());
+        return;
+    }
+    if(type == 22 && n >= 1 && st.tls13 && data[0] == 4)
+    {
+        // NewSessionTicket
+        ec = {};
+        return;
+    }
+    // Key updates and renegotiation are not supported
+    ec = net::ssl::error::unexpected_result;
+}
+
+// Translate the result of a read from the socket
+inline
+void
+ktls_on_read(error_code& ec, ktls_state& st)
+{
+    if(ec == net::error::eof && ! st.eof)
+    {
+        // The peer closed without sending close_notify
+        ec = net::ssl::error::stream_truncated;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template<class NextLayer, class Buffers, class Handler>
+class ktls_read_op
+    : public async_base<Handler,
+        beast::executor_type<NextLayer>>
+{
+    NextLayer& s_;
+    ktls_state& st_;
+    Buffers b_;
+
+public:
+    template<class Handler_>
+    ktls_read_op(
+        Handler_&& h,
+        NextLayer& s,
+        ktls_state& st,
+        Buffers const& b)
+        : async_base<Handler, beast::executor_type<NextLayer>>(
+            std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+        , st_(st)
+        , b_(b)
+    {
+        if(st_.eof)
+            net::post(s_.get_executor(),
+                beast::bind_front_handler(std::move(*this),
+                    error_code(net::error::eof), 0));
+        else
+            s_.async_read_some(b_, std::move(*this));
+    }
+
+    void
+    operator()(error_code ec, std::size_t bytes_transferred)
+    {
+        if(ktls_is_control(ec))
+        {
+            ktls_read_control(ktls_native_handle(s_), st_, ec);
+            if(! ec)
+                return s_.async_read_some(b_, std::move(*this));
+        }
+        ktls_on_read(ec, st_);
+        this->complete_now(ec, bytes_transferred);
+    }
+};
+
+struct run_ktls_read_op
+{
+    template<class ReadHandler, class NextLayer, class Buffers>
+    void
+    operator()(
+        ReadHandler&& h,
+        NextLayer* s,
+        ktls_state* st,
+        Buffers const& b)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<ReadHandler,
+                void(error_code, std::size_t)>::value,
+            "ReadHandler type requirements not met");
+
+        ktls_read_op<
+            NextLayer,
+            Buffers,
+            typename std::decay<ReadHandler>::type>(
+                std::forward<ReadHandler>(h), *s, *st, b);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/*  Shut down a stream which sends through the kernel.
+
+    A close_notify alert is sent, then data is read and
+    discarded until the peer's close_notify arrives.
+*/
+template<class Stream, class Handler>
+class ktls_shutdown_op
+    : public async_base<Handler,
+        beast::executor_type<Stream>>
+    , public net::coroutine
+{
+    Stream& s_;
+    ktls_state& st_;
+    std::unique_ptr<char[]> buf_;
+
+public:
+    static std::size_t constexpr buffer_size = 1024;
+
+    template<class Handler_>
+    ktls_shutdown_op(
+        Handler_&& h,
+        Stream& s,
+        ktls_state& st)
+        : async_base<Handler, beast::executor_type<Stream>>(
+            std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+        , st_(st)
+    {
+        (*this)({}, 0, false);
+    }
+
+    void
+    operator()(error_code ec)
+    {
+        (*this)(ec, 0);
+    }
+
+    void
+    operator()(
+        error_code ec,
+        std::size_t bytes_transferred,
+        bool cont = true)
+    {
+        boost::ignore_unused(bytes_transferred);
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            for(;;)
+            {
+                ktls_send_close_notify(
+                    ktls_native_handle(s_.next_layer()), ec);
+                if(ec != net::error::would_block)
+                    break;
+                BOOST_ASIO_CORO_YIELD
+                ktls_async_wait_write(
+                    s_.next_layer(), std::move(*this));
+                if(ec)
+                    goto upcall;
+            }
+            if(ec)
+                goto upcall;
+            buf_.reset(new char[buffer_size]);
+            while(! st_.eof)
+            {
+                BOOST_ASIO_CORO_YIELD
+                s_.async_read_some(net::mutable_buffer(
+                    buf_.get(), buffer_size), std::move(*this));
+                if(ec == net::error::eof)
+                {
+                    ec = {};
+                    break;
+                }
+                if(ec)
+                    goto upcall;
+            }
+        upcall:
+            if(! cont)
+            {
+                BOOST_ASIO_CORO_YIELD
+                net::post(s_.get_executor(),
+                    beast::bind_front_handler(
+                        std::move(*this), ec, 0));
+            }
+            buf_.reset();
+            this->complete_now(ec);
+        }
+    }
+};
+
+struct run_ktls_shutdown_op
+{
+    template<class ShutdownHandler, class Stream>
+    void
+    operator()(
+        ShutdownHandler&& h,
+        Stream* s,
+        ktls_state* st)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<ShutdownHandler,
+                void(error_code)>::value,
+            "ShutdownHandler type requirements not met");
+
+        ktls_shutdown_op<
+            Stream,
+            typename std::decay<ShutdownHandler>::type>(
+                std::forward<ShutdownHandler>(h), *s, *st);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+/*  Perform the handshake on an ssl_stream, then move
+    record protection into the kernel if it succeeded.
+*/
+template<class Stream, class Handler>
+class ktls_handshake_op
+    : public async_base<Handler,
+        beast::executor_type<Stream>>
+{
+    Stream& s_;
+
+public:
+    template<class Handler_>
+    ktls_handshake_op(
+        Handler_&& h,
+        Stream& s,
+        net::ssl::stream_base::handshake_type type)
+        : async_base<Handler, beast::executor_type<Stream>>(
+            std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+    {
+        s_.p_->next_layer().async_handshake(type, std::move(*this));
+    }
+
+    template<class Handler_, class ConstBufferSequence>
+    ktls_handshake_op(
+        Handler_&& h,
+        Stream& s,
+        net::ssl::stream_base::handshake_type type,
+        ConstBufferSequence const& buffers)
+        : async_base<Handler, beast::executor_type<Stream>>(
+            std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+    {
+        s_.p_->next_layer().async_handshake(
+            type, buffers, std::move(*this));
+    }
+
+    void
+    operator()(error_code ec)
+    {
+        if(! ec)
+            s_.attach_ktls();
+        this->complete_now(ec);
+    }
+
+    void
+    operator()(error_code ec, std::size_t bytes_transferred)
+    {
+        if(! ec)
+            s_.attach_ktls();
+        this->complete_now(ec, bytes_transferred);
+    }
+};
+
+struct run_ktls_handshake_op
+{
+    template<class HandshakeHandler, class Stream, class... Args>
+    void
+    operator()(
+        HandshakeHandler&& h,
+        Stream* s,
+        Args const&... args)
+    {
+        ktls_handshake_op<
+            Stream,
+            typename std::decay<HandshakeHandler>::type>(
+                std::forward<HandshakeHandler>(h), *s, args...);
+    }
+};
+
+} // detail
+} // beast
+} // boost
+
+#endif
+
+#endif
@@ -16,12 +16,15 @@
 #include <boost/beast/websocket/ssl.hpp>
 
 #include <boost/beast/core/flat_stream.hpp>
+#include <boost/beast/ssl/detail/ktls.hpp>
 
 // VFALCO We include this because anyone who uses ssl will
 //        very likely need to check for ssl::error::stream_truncated
 #include <boost/asio/ssl/error.hpp>
 
 #include <boost/asio/ssl/stream.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <boost/throw_exception.hpp>
 #include <cstddef>
 #include <memory>
 #include <type_traits>
@@ -62,6 +65,9 @@ namespace beast {
         limitation of `net::ssl::stream` when writing buffer sequences
         having length greater than one.
 
+    @li Hands record encryption to the operating system after the
+        handshake, when @ref enable_ktls was called on the context.
+
     @par Concepts:
         @li AsyncReadStream
         @li AsyncWriteStream
@@ -78,6 +84,47 @@ class ssl_stream
 
     std::unique_ptr<stream_type> p_;
 
+#if BOOST_BEAST_USE_KTLS
+    std::unique_ptr<detail::ktls_state> k_;
+
+    template<class, class>
+    friend class detail::ktls_handshake_op;
+
+    void
+    attach_ktls()
+    {
+        k_.reset(new detail::ktls_state);
+        detail::ktls_attach(native_handle(),
+            detail::ktls_native_handle(next_layer()), *k_);
+        if(! k_->tx && ! k_->rx)
+            k_.reset();
+    }
+
+    bool
+    is_ktls_rx() const noexcept
+    {
+        return k_ && k_->rx;
+    }
+
+    bool
+    is_ktls_tx() const noexcept
+    {
+        return k_ && k_->tx;
+    }
+#else
+    bool
+    is_ktls_rx() const noexcept
+    {
+        return false;
+    }
+
+    bool
+    is_ktls_tx() const noexcept
+    {
+        return false;
+    }
+#endif
+
 public:
     /// The native handle type of the SSL stream.
     using native_handle_type =
@@ -187,6 +234,33 @@ public:
         return p_->next_layer().next_layer();
     }
 
+    /** Returns `true` if the kernel encrypts data written to the stream.
+
+        This becomes `true` after a successful handshake, when
+        @ref enable_ktls was called on the SSL context and the
+        operating system accepted the negotiated keys. Writes
+        then go directly to the next layer, and a file body
+        may be sent with `sendfile`.
+    */
+    bool
+    ktls_send() const noexcept
+    {
+        return is_ktls_tx();
+    }
+
+    /** Returns `true` if the kernel decrypts data read from the stream.
+
+        This becomes `true` after a successful handshake, when
+        @ref enable_ktls was called on the SSL context and the
+        operating system accepted the negotiated keys. Reads
+        then go directly to the next layer.
+    */
+    bool
+    ktls_receive() const noexcept
+    {
+        return is_ktls_rx();
+    }
+
     /** Set the peer verification mode.
 
         This function may be used to configure the peer verification mode used by
@@ -325,6 +399,9 @@ public:
     handshake(handshake_type type)
     {
         p_->next_layer().handshake(type);
+#if BOOST_BEAST_USE_KTLS
+        attach_ktls();
+#endif
     }
 
     /** Perform SSL handshaking.
@@ -342,6 +419,10 @@ public:
         boost::system::error_code& ec)
     {
         p_->next_layer().handshake(type, ec);
+#if BOOST_BEAST_USE_KTLS
+        if(! ec)
+            attach_ktls();
+#endif
     }
 
     /** Perform SSL handshaking.
@@ -362,6 +443,9 @@ public:
         handshake_type type, ConstBufferSequence const& buffers)
     {
         p_->next_layer().handshake(type, buffers);
+#if BOOST_BEAST_USE_KTLS
+        attach_ktls();
+#endif
     }
 
     /** Perform SSL handshaking.
@@ -383,6 +467,10 @@ public:
             boost::system::error_code& ec)
     {
         p_->next_layer().handshake(type, buffers, ec);
+#if BOOST_BEAST_USE_KTLS
+        if(! ec)
+            attach_ktls();
+#endif
     }
 
     /** Start an asynchronous SSL handshake.
@@ -405,8 +493,18 @@ public:
     async_handshake(handshake_type type,
         BOOST_ASIO_MOVE_ARG(HandshakeHandler) handler)
     {
+#if BOOST_BEAST_USE_KTLS
+        return net::async_initiate<
+            HandshakeHandler,
+            void(boost::system::error_code)>(
+                detail::run_ktls_handshake_op{},
+                handler,
+                this,
+                type);
+#else
         return p_->next_layer().async_handshake(type,
             BOOST_ASIO_MOVE_CAST(HandshakeHandler)(handler));
+#endif
     }
 
     /** Start an asynchronous SSL handshake.
@@ -435,8 +533,19 @@ public:
     async_handshake(handshake_type type, ConstBufferSequence const& buffers,
         BOOST_ASIO_MOVE_ARG(BufferedHandshakeHandler) handler)
     {
+#if BOOST_BEAST_USE_KTLS
+        return net::async_initiate<
+            BufferedHandshakeHandler,
+            void(boost::system::error_code, std::size_t)>(
+                detail::run_ktls_handshake_op{},
+                handler,
+                this,
+                type,
+                buffers);
+#else
         return p_->next_layer().async_handshake(type, buffers,
             BOOST_ASIO_MOVE_CAST(BufferedHandshakeHandler)(handler));
+#endif
     }
 
     /** Shut down SSL on the stream.
@@ -449,7 +558,10 @@ public:
     void
     shutdown()
     {
-        p_->next_layer().shutdown();
+        boost::system::error_code ec;
+        shutdown(ec);
+        if(ec)
+            BOOST_THROW_EXCEPTION(boost::system::system_error{ec});
     }
 
     /** Shut down SSL on the stream.
@@ -462,6 +574,26 @@ public:
     void
     shutdown(boost::system::error_code& ec)
     {
+#if BOOST_BEAST_USE_KTLS
+        if(is_ktls_tx())
+        {
+            detail::ktls_send_close_notify_sync(
+                detail::ktls_native_handle(next_layer()), ec);
+            if(ec)
+                return;
+            char buf[1024];
+            while(! k_->eof)
+            {
+                read_some(net::buffer(buf), ec);
+                if(ec == net::error::eof)
+                    break;
+                if(ec)
+                    return;
+            }
+            ec = {};
+            return;
+        }
+#endif
         p_->next_layer().shutdown(ec);
     }
 
@@ -481,6 +613,16 @@ public:
     BOOST_ASIO_INITFN_RESULT_TYPE(ShutdownHandler, void(boost::system::error_code))
     async_shutdown(BOOST_ASIO_MOVE_ARG(ShutdownHandler) handler)
     {
+#if BOOST_BEAST_USE_KTLS
+        if(is_ktls_tx())
+            return net::async_initiate<
+                ShutdownHandler,
+                void(boost::system::error_code)>(
+                    detail::run_ktls_shutdown_op{},
+                    handler,
+                    this,
+                    k_.get());
+#endif
         return p_->next_layer().async_shutdown(
             BOOST_ASIO_MOVE_CAST(ShutdownHandler)(handler));
     }
@@ -505,6 +647,8 @@ public:
     std::size_t
     write_some(ConstBufferSequence const& buffers)
     {
+        if(is_ktls_tx())
+            return next_layer().write_some(buffers);
         return p_->write_some(buffers);
     }
 
@@ -529,6 +673,8 @@ public:
     write_some(ConstBufferSequence const& buffers,
         boost::system::error_code& ec)
     {
+        if(is_ktls_tx())
+            return next_layer().write_some(buffers, ec);
         return p_->write_some(buffers, ec);
     }
 
@@ -560,6 +706,9 @@ public:
     async_write_some(ConstBufferSequence const& buffers,
         BOOST_ASIO_MOVE_ARG(WriteHandler) handler)
     {
+        if(is_ktls_tx())
+            return next_layer().async_write_some(buffers,
+                BOOST_ASIO_MOVE_CAST(WriteHandler)(handler));
         return p_->async_write_some(buffers,
             BOOST_ASIO_MOVE_CAST(WriteHandler)(handler));
     }
@@ -585,6 +734,14 @@ public:
     std::size_t
     read_some(MutableBufferSequence const& buffers)
     {
+        if(is_ktls_rx())
+        {
+            boost::system::error_code ec;
+            auto const n = read_some(buffers, ec);
+            if(ec)
+                BOOST_THROW_EXCEPTION(boost::system::system_error{ec});
+            return n;
+        }
         return p_->read_some(buffers);
     }
 
@@ -610,6 +767,30 @@ public:
     read_some(MutableBufferSequence const& buffers,
         boost::system::error_code& ec)
     {
+#if BOOST_BEAST_USE_KTLS
+        if(is_ktls_rx())
+        {
+            if(k_->eof)
+            {
+                ec = net::error::eof;
+                return 0;
+            }
+            for(;;)
+            {
+                auto const n = next_layer().read_some(buffers, ec);
+                if(detail::ktls_is_control(ec))
+                {
+                    detail::ktls_read_control(
+                        detail::ktls_native_handle(next_layer()),
+                        *k_, ec);
+                    if(! ec)
+                        continue;
+                }
+                detail::ktls_on_read(ec, *k_);
+                return n;
+            }
+        }
+#endif
         return p_->read_some(buffers, ec);
     }
 
@@ -641,6 +822,17 @@ public:
     async_read_some(MutableBufferSequence const& buffers,
         BOOST_ASIO_MOVE_ARG(ReadHandler) handler)
     {
+#if BOOST_BEAST_USE_KTLS
+        if(is_ktls_rx())
+            return net::async_initiate<
+                ReadHandler,
+                void(boost::system::error_code, std::size_t)>(
+                    detail::run_ktls_read_op{},
+                    handler,
+                    &next_layer(),
+                    k_.get(),
+                    buffers);
+#endif
         return p_->async_read_some(buffers,
             BOOST_ASIO_MOVE_CAST(ReadHandler)(handler));
     }
@@ -675,6 +867,9 @@ teardown(
     ssl_stream<SyncStream>& stream,
     boost::system::error_code& ec)
 {
+    // With kernel TLS the stream shuts itself down
+    if(stream.is_ktls_tx())
+        return stream.shutdown(ec);
     // Just forward it to the underlying ssl::stream
     using boost::beast::websocket::teardown;
     teardown(role, *stream.p_, ec);
@@ -687,6 +882,10 @@ async_teardown(
     ssl_stream<AsyncStream>& stream,
     TeardownHandler&& handler)
 {
+    // With kernel TLS the stream shuts itself down
+    if(stream.is_ktls_tx())
+        return stream.async_shutdown(
+            std::forward<TeardownHandler>(handler));
     // Just forward it to the underlying ssl::stream
     using boost::beast::websocket::async_teardown;
     async_teardown(role, *stream.p_,
@@ -694,6 +893,41 @@ async_teardown(
 }
 #endif
 
+/** Enable kernel TLS for streams using an SSL context.
+
+    After this call, each @ref ssl_stream constructed with the
+    context tries to hand record encryption and decryption to
+    the operating system once its handshake completes. Reads and
+    writes then go directly to the socket, and file bodies may
+    be sent with `sendfile`. If the kernel, the protocol version
+    or the cipher is not supported, the stream keeps using OpenSSL
+    without reporting an error; see @ref ssl_stream::ktls_send and
+    @ref ssl_stream::ktls_receive.
+
+    Kernel TLS is used with TLS 1.2 and TLS 1.3, the AES-GCM and
+    ChaCha20-Poly1305 ciphers, and a next layer which is a TCP
+    socket or a @ref basic_stream, on Linux.
+
+    This function installs a key logging callback on the context,
+    which also calls any callback installed earlier, and stops a
+    TLS 1.3 server from sending session tickets. Like other context
+    settings, it should be called before the context is used.
+    TLS 1.3 key updates and TLS 1.2 renegotiation are not supported
+    on a stream using kernel TLS.
+
+    @param ctx The SSL context to modify.
+*/
+inline
+void
+enable_ktls(net::ssl::context& ctx)
+{
+#if BOOST_BEAST_USE_KTLS
+    detail::ktls_enable(ctx.native_handle());
+#else
+    boost::ignore_unused(ctx);
+#endif
+}
+
 } // beast
 } // boost
 
@@ -0,0 +1,182 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_DEFLATE_BUDGET_HPP
+#define BOOST_BEAST_WEBSOCKET_DEFLATE_BUDGET_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <cstddef>
+#include <mutex>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+namespace detail {
+template<bool deflateSupported>
+struct impl_base;
+} // detail
+
+/** A memory budget for permessage-deflate shared by many streams.
+
+    The memory used by permessage-deflate on one connection is
+    dominated by the sliding windows and hash tables, whose
+    sizes follow from the negotiated window bits and from the
+    memory level. With the defaults this is about 170KB per
+    connection, which does not scale to a server with a
+    very large number of connections.
+
+    A stream whose @ref permessage_deflate options refer to a
+    budget takes a share of it for its compression state.
+    The share is the smaller of the memory not yet in use and
+    the limit divided evenly between the streams holding a
+    share, counting the new one, or between the number of
+    streams expected when that is larger. Streams keep their
+    share until they close, so without an expectation the
+    first streams may take most of the budget. To fit in its
+    share a stream:
+
+    @li In the server role, answers an offer with smaller
+        `server_max_window_bits`, and with smaller
+        `client_max_window_bits` when the client allows it.
+
+    @li In the client role, offers smaller window bits.
+
+    @li When permessage-deflate is opened, compresses with a
+        smaller window and memory level than were negotiated,
+        which the peer can always decompress.
+
+    The window and hash table sizes are halved, largest first,
+    until they fit or reach their minimums: 9 window bits and
+    a memory level of 1. The share is held until the stream
+    is closed or destroyed.
+
+    The budget is soft. A stream is never refused compression,
+    and when there is no room left it holds the minimum, so
+    the usage may exceed the limit when there are more than
+    about `limit / 3584` streams. A budget is usually created
+    once for the whole process and given to every stream.
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Safe.
+
+    @see permessage_deflate::budget
+*/
+class deflate_budget
+{
+    template<bool>
+    friend struct detail::impl_base;
+
+    mutable std::mutex m_;
+    std::size_t limit_;
+    std::size_t expected_;
+    std::size_t usage_ = 0;
+    std::size_t connections_ = 0;
+
+    BOOST_BEAST_DECL
+    std::size_t
+    share() const noexcept;
+
+    BOOST_BEAST_DECL
+    static
+    void
+    fit(
+        std::size_t share,
+        int& deflate_bits,
+        int& inflate_bits,
+        int& mem_level,
+        bool inflate_fixed) noexcept;
+
+    // Lower the window bits and memory level
+    // to what a new stream may negotiate
+    BOOST_BEAST_DECL
+    void
+    narrow(
+        int& deflate_bits,
+        int& inflate_bits,
+        int& mem_level,
+        bool inflate_fixed) const;
+
+    // Take a share for a stream whose inflate
+    // window is fixed, returning the size held
+    BOOST_BEAST_DECL
+    std::size_t
+    reserve(
+        int& deflate_bits,
+        int inflate_bits,
+        int& mem_level);
+
+    BOOST_BEAST_DECL
+    void
+    release(std::size_t bytes) noexcept;
+
+public:
+    /** Constructor
+
+        @param limit The number of bytes to share between streams.
+
+        @param expected The number of streams expected to hold
+        a share at the same time.
+    */
+    BOOST_BEAST_DECL
+    explicit
+    deflate_budget(
+        std::size_t limit,
+        std::size_t expected = 1) noexcept;
+
+    deflate_budget(deflate_budget const&) = delete;
+    deflate_budget& operator=(deflate_budget const&) = delete;
+
+    /// Returns the number of bytes shared between streams
+    BOOST_BEAST_DECL
+    std::size_t
+    limit() const noexcept;
+
+    /// Returns the number of bytes held by streams
+    BOOST_BEAST_DECL
+    std::size_t
+    usage() const;
+
+    /// Returns the number of streams holding a share
+    BOOST_BEAST_DECL
+    std::size_t
+    connections() const;
+
+    /** Returns the memory used by a deflate stream
+
+        This is the size of the window, hash tables and
+        literal buffers allocated by @ref zlib::deflate_stream
+        for the given parameters.
+    */
+    BOOST_BEAST_DECL
+    static
+    std::size_t
+    deflate_size(int window_bits, int mem_level) noexcept;
+
+    /** Returns the memory used by an inflate stream
+
+        This is the size of the window allocated by
+        @ref zlib::inflate_stream for the given parameter.
+    */
+    BOOST_BEAST_DECL
+    static
+    std::size_t
+    inflate_size(int window_bits) noexcept;
+};
+
+} // websocket
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/websocket/impl/deflate_budget.ipp>
+#endif
+
+#endif
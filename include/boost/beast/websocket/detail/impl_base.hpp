@@ -13,7 +13,9 @@
 #include <boost/beast/websocket/option.hpp>
 #include <boost/beast/websocket/detail/frame.hpp>
 #include <boost/beast/websocket/detail/pmd_extension.hpp>
+#include <boost/beast/websocket/detail/pmd_pool.hpp>
 #include <boost/beast/core/buffer_traits.hpp>
+#include <boost/beast/core/buffers_range.hpp>
 #include <boost/beast/core/role.hpp>
 #include <boost/beast/http/empty_body.hpp>
 #include <boost/beast/http/message.hpp>
@@ -24,6 +26,8 @@
 #include <boost/beast/core/error.hpp>
 #include <boost/beast/core/detail/clamp.hpp>
 #include <boost/asio/buffer.hpp>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <stdexcept>
@@ -35,6 +39,43 @@ namespace detail {
 
 //------------------------------------------------------------------------------
 
+// Returns `true` if the first kilobyte of a buffer
+// sequence has the byte entropy of random data
+template<class ConstBufferSequence>
+bool
+is_incompressible(ConstBufferSequence const& buffers)
+{
+    std::size_t constexpr sample = 1024;
+    std::uint32_t counts[256] = {};
+    std::size_t n = 0;
+    for(auto b : beast::buffers_range_ref(buffers))
+    {
+        auto p = static_cast<unsigned char const*>(b.data());
+        auto const end = p + (std::min)(b.size(), sample - n);
+        n += end - p;
+        while(p != end)
+            ++counts[*p++];
+        if(n == sample)
+            break;
+    }
+    // Too little to tell
+    if(n < 256)
+        return false;
+    double h = 0;
+    for(auto c : counts)
+    {
+        if(c == 0)
+            continue;
+        double const p = double(c) / n;
+        h -= p * std::log2(p);
+    }
+    // A sample of 1024 random bytes measures about
+    // 7.8 bits; text is usually below 5.5 bits.
+    return h > 7.2;
+}
+
+//------------------------------------------------------------------------------
+
 template<bool deflateSupported>
 struct impl_base;
 
@@ -47,8 +88,37 @@ struct impl_base<true>
         // `true` if current read message is compressed
         bool rd_set = false;
 
-        zlib::deflate_stream zo;
-        zlib::inflate_stream zi;
+        // A direction which is reset after every message
+        // borrows its stream from `pool` for one message,
+        // otherwise the stream is owned for the lifetime
+        // of the connection.
+        std::unique_ptr<zlib::deflate_stream> zo;
+        std::unique_ptr<zlib::inflate_stream> zi;
+        pmd_pool* pool = nullptr;
+        int zo_bits;
+        int zi_bits;
+
+        // Adaptive compression level, and the
+        // cost of the last message compressed
+        int level;
+        std::uint64_t msg_in = 0;
+        std::chrono::nanoseconds msg_time{0};
+        deflate_stats stats;
+
+        // Memory level, and the share of
+        // the budget held while open
+        int mem_level;
+        std::shared_ptr<deflate_budget> budget;
+        std::size_t reserved = 0;
+
+        // Preset dictionary, or nullptr
+        std::shared_ptr<std::string const> dict;
+
+        ~pmd_type()
+        {
+            if(budget)
+                budget->release(reserved);
+        }
     };
 
     std::unique_ptr<pmd_type>   pmd_;           // pmd settings or nullptr
@@ -86,9 +156,34 @@ struct impl_base<true>
         bool fin,
         std::size_t& total_in,
         error_code& ec)
+    {
+        using clock_type = std::chrono::steady_clock;
+        auto const start = clock_type::now();
+        auto const more =
+            do_deflate(out, cb, fin, total_in, ec);
+        if(ec)
+            return more;
+        auto const elapsed = std::chrono::duration_cast<
+            std::chrono::nanoseconds>(clock_type::now() - start);
+        pmd_->msg_in += total_in;
+        pmd_->msg_time += elapsed;
+        pmd_->stats.bytes_in += total_in;
+        pmd_->stats.bytes_out += out.size();
+        pmd_->stats.time += elapsed;
+        return more;
+    }
+
+    template<class ConstBufferSequence>
+    bool
+    do_deflate(
+        net::mutable_buffer& out,
+        buffers_suffix<ConstBufferSequence>& cb,
+        bool fin,
+        std::size_t& total_in,
+        error_code& ec)
     {
         BOOST_ASSERT(out.size() >= 6);
-        auto& zo = this->pmd_->zo;
+        auto& zo = deflater();
         zlib::z_params zs;
         zs.avail_in = 0;
         zs.next_in = nullptr;
@@ -151,16 +246,177 @@ struct impl_base<true>
         return true;
     }
 
+    // Returns `true` if our compressor
+    // is reset after every message
+    bool
+    no_context_takeover_write(role_type role) const
+    {
+        return
+            (role == role_type::client &&
+                pmd_config_.client_no_context_takeover) ||
+            (role == role_type::server &&
+                pmd_config_.server_no_context_takeover);
+    }
+
+    // Returns `true` if our decompressor
+    // is reset after every message
+    bool
+    no_context_takeover_read(role_type role) const
+    {
+        return
+            (role == role_type::client &&
+                pmd_config_.server_no_context_takeover) ||
+            (role == role_type::server &&
+                pmd_config_.client_no_context_takeover);
+    }
+
+    // Reset the compressor, and prime it
+    // with the preset dictionary if any
+    void
+    reset_deflater()
+    {
+        pmd_->zo->reset(
+            pmd_->level,
+            pmd_->zo_bits,
+            pmd_->mem_level,
+            zlib::Strategy::normal);
+        if(pmd_->dict)
+        {
+            error_code ec;
+            pmd_->zo->dictionary(pmd_->dict->data(),
+                pmd_->dict->size(), ec);
+            BOOST_ASSERT(! ec);
+        }
+    }
+
+    // Reset the decompressor, and prime it
+    // with the preset dictionary if any
+    void
+    reset_inflater()
+    {
+        pmd_->zi->reset(pmd_->zi_bits);
+        if(pmd_->dict)
+        {
+            error_code ec;
+            pmd_->zi->dictionary(pmd_->dict->data(),
+                pmd_->dict->size(), ec);
+            BOOST_ASSERT(! ec);
+        }
+    }
+
+    // Returns the compressor, borrowing
+    // one from the pool if needed
+    zlib::deflate_stream&
+    deflater()
+    {
+        if(! pmd_->zo)
+        {
+            pmd_->zo = pmd_->pool->get_deflate();
+            reset_deflater();
+        }
+        return *pmd_->zo;
+    }
+
+    // Returns the decompressor, borrowing
+    // one from the pool if needed
+    zlib::inflate_stream&
+    inflater()
+    {
+        if(! pmd_->zi)
+        {
+            pmd_->zi = pmd_->pool->get_inflate();
+            reset_inflater();
+        }
+        return *pmd_->zi;
+    }
+
     void
     do_context_takeover_write(role_type role)
     {
-        if((role == role_type::client &&
-            this->pmd_config_.client_no_context_takeover) ||
-           (role == role_type::server &&
-            this->pmd_config_.server_no_context_takeover))
+        if( no_context_takeover_write(role) &&
+            pmd_->zo)
+        {
+            pmd_->pool->put(std::move(pmd_->zo));
+        }
+    }
+
+    // Decide whether to compress the message which starts
+    // with `buffers`, which hold all of it when `whole`.
+    template<class ConstBufferSequence>
+    bool
+    compress_msg(
+        ConstBufferSequence const& buffers,
+        bool whole)
+    {
+        if(! pmd_)
+            return false;
+        adapt_level();
+        if( (whole && buffer_bytes(buffers) <
+                pmd_opts_.msg_size_threshold) ||
+            (pmd_opts_.skip_incompressible &&
+                is_incompressible(buffers)))
         {
-            this->pmd_->zo.reset();
+            ++pmd_->stats.messages_skipped;
+            return false;
         }
+        ++pmd_->stats.messages_compressed;
+        return true;
+    }
+
+    // Move the level one step toward the time
+    // budget, based on the last message compressed
+    void
+    adapt_level()
+    {
+        if( pmd_opts_.max_ns_per_byte == 0 ||
+            pmd_->msg_in == 0)
+            return;
+        auto const cost = static_cast<std::uint64_t>(
+            pmd_->msg_time.count()) / pmd_->msg_in;
+        pmd_->msg_in = 0;
+        pmd_->msg_time = {};
+        // Never below level 1, unless compLevel is lower
+        int level = pmd_->level;
+        if(cost > pmd_opts_.max_ns_per_byte)
+            level = (std::max)(level - 1,
+                (std::min)(1, pmd_opts_.compLevel));
+        else if(cost * 2 < pmd_opts_.max_ns_per_byte)
+            level = (std::min)(level + 1, pmd_opts_.compLevel);
+        if(level == pmd_->level)
+            return;
+        pmd_->level = level;
+        // A borrowed stream is reset with the new level
+        // when it is taken. Between messages there is
+        // no pending input, so nothing is flushed here.
+        if(pmd_->zo)
+        {
+            zlib::z_params zs;
+            error_code ec;
+            pmd_->zo->params(zs,
+                level, zlib::Strategy::normal, ec);
+            BOOST_ASSERT(! ec);
+        }
+    }
+
+    deflate_stats
+    deflate_stats_pmd() const
+    {
+        if(! pmd_)
+            return {};
+        auto stats = pmd_->stats;
+        stats.level = pmd_->level;
+        return stats;
+    }
+
+    // Returns `true` if a message compressed on its own,
+    // with a window of `window_bits`, may be sent as-is
+    bool
+    can_send_prepared_deflated(int window_bits) const
+    {
+        return pmd_ &&
+            pmd_config_.server_no_context_takeover &&
+            window_bits <= pmd_config_.server_max_window_bits &&
+            window_bits <= pmd_opts_.server_max_window_bits;
     }
 
     void
@@ -169,21 +425,35 @@ struct impl_base<true>
         zlib::Flush flush,
         error_code& ec)
     {
-        pmd_->zi.write(zs, flush, ec);
+        inflater().write(zs, flush, ec);
     }
 
     void
     do_context_takeover_read(role_type role)
     {
-        if((role == role_type::client &&
-                pmd_config_.server_no_context_takeover) ||
-           (role == role_type::server &&
-                pmd_config_.client_no_context_takeover))
+        if( no_context_takeover_read(role) &&
+            pmd_->zi)
         {
-            pmd_->zi.clear();
+            pmd_->pool->put(std::move(pmd_->zi));
         }
     }
 
+    // Counts borrowed streams while they are held
+    std::size_t
+    memory_usage_pmd() const
+    {
+        if(! pmd_)
+            return 0;
+        std::size_t n = sizeof(pmd_type);
+        if(pmd_->zo)
+            n += sizeof(zlib::deflate_stream) +
+                pmd_->zo->allocated_size();
+        if(pmd_->zi)
+            n += sizeof(zlib::inflate_stream) +
+                pmd_->zi->allocated_size();
+        return n;
+    }
+
     template<class Body, class Allocator>
     void
     build_response_pmd(
@@ -254,12 +524,22 @@ struct impl_base<true>
                 pmd_opts_.server_no_context_takeover;
             config.client_no_context_takeover =
                 pmd_opts_.client_no_context_takeover;
+            if(pmd_opts_.budget)
+            {
+                int mem_level = pmd_opts_.memLevel;
+                pmd_opts_.budget->narrow(
+                    config.client_max_window_bits,
+                    config.server_max_window_bits,
+                    mem_level, false);
+            }
             detail::pmd_write(req, config);
         }
     }
 
     void
-    open_pmd(role_type role)
+    open_pmd(
+        role_type role,
+        net::execution_context& ctx)
     {
         if(((role == role_type::client &&
                 pmd_opts_.client_enable) ||
@@ -269,25 +549,50 @@ struct impl_base<true>
         {
             detail::pmd_normalize(pmd_config_);
             pmd_.reset(::new pmd_type);
+            pmd_->level = pmd_opts_.compLevel;
             if(role == role_type::client)
             {
-                pmd_->zi.reset(
-                    pmd_config_.server_max_window_bits);
-                pmd_->zo.reset(
-                    pmd_opts_.compLevel,
-                    pmd_config_.client_max_window_bits,
-                    pmd_opts_.memLevel,
-                    zlib::Strategy::normal);
+                pmd_->zi_bits =
+                    pmd_config_.server_max_window_bits;
+                pmd_->zo_bits =
+                    pmd_config_.client_max_window_bits;
             }
             else
             {
-                pmd_->zi.reset(
-                    pmd_config_.client_max_window_bits);
-                pmd_->zo.reset(
-                    pmd_opts_.compLevel,
-                    pmd_config_.server_max_window_bits,
-                    pmd_opts_.memLevel,
-                    zlib::Strategy::normal);
+                pmd_->zi_bits =
+                    pmd_config_.client_max_window_bits;
+                pmd_->zo_bits =
+                    pmd_config_.server_max_window_bits;
+            }
+            pmd_->mem_level = pmd_opts_.memLevel;
+            if( pmd_opts_.dictionary &&
+                ! pmd_opts_.dictionary->empty())
+                pmd_->dict = pmd_opts_.dictionary;
+            // A smaller window than negotiated may
+            // be used to compress, but not to inflate
+            if(pmd_opts_.budget)
+            {
+                pmd_->reserved = pmd_opts_.budget->reserve(
+                    pmd_->zo_bits, pmd_->zi_bits, pmd_->mem_level);
+                pmd_->budget = pmd_opts_.budget;
+            }
+            bool const pool_zo =
+                no_context_takeover_write(role);
+            bool const pool_zi =
+                no_context_takeover_read(role);
+            if(pool_zo || pool_zi)
+                pmd_->pool = &net::use_service<pmd_pool>(ctx);
+            // Streams which keep their window
+            // between messages are owned
+            if(! pool_zo)
+            {
+                pmd_->zo.reset(new zlib::deflate_stream);
+                reset_deflater();
+            }
+            if(! pool_zi)
+            {
+                pmd_->zi.reset(new zlib::inflate_stream);
+                reset_inflater();
             }
         }
     }
@@ -375,6 +680,25 @@ struct impl_base<false>
     {
     }
 
+    template<class ConstBufferSequence>
+    bool
+    compress_msg(ConstBufferSequence const&, bool)
+    {
+        return false;
+    }
+
+    deflate_stats
+    deflate_stats_pmd() const
+    {
+        return {};
+    }
+
+    bool
+    can_send_prepared_deflated(int) const
+    {
+        return false;
+    }
+
     void
     inflate(
         zlib::z_params&,
@@ -388,6 +712,12 @@ struct impl_base<false>
     {
     }
 
+    std::size_t
+    memory_usage_pmd() const
+    {
+        return 0;
+    }
+
     template<class Body, class Allocator>
     void
     build_response_pmd(
@@ -434,7 +764,7 @@ struct impl_base<false>
     {
     }
 
-    void open_pmd(role_type)
+    void open_pmd(role_type, net::execution_context&)
     {
     }
 
@@ -11,6 +11,12 @@
 #define BOOST_BEAST_WEBSOCKET_DETAIL_MASK_IPP
 
 #include <boost/beast/websocket/detail/mask.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
+#include <cstring>
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+#include <immintrin.h>
+#endif
 
 namespace boost {
 namespace beast {
@@ -26,13 +32,108 @@ prepare_key(prepared_key& prepared, std::uint32_t key)
     prepared[3] = (key >> 24) & 0xff;
 }
 
+//------------------------------------------------------------------------------
+
+/*  The kernels below mask whole steps only and return the
+    number of bytes they processed. Each step is a multiple
+    of four bytes, so the key does not rotate across steps.
+    `m` holds eight bytes of the key, already rotated to
+    line up with `p`, in memory order.
+*/
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+
+BOOST_BEAST_TARGET_SSE2
 inline
-void
-rol(prepared_key& v, std::size_t n)
+std::size_t
+mask_sse2(
+    unsigned char* p,
+    std::size_t n,
+    unsigned char const* m)
+{
+    std::uint32_t w;
+    std::memcpy(&w, m, 4);
+    __m128i const k = _mm_set1_epi32(static_cast<int>(w));
+    auto const p0 = p;
+    while(n >= 64)
+    {
+        auto const q = reinterpret_cast<__m128i*>(p);
+        __m128i const v0 = _mm_loadu_si128(q + 0);
+        __m128i const v1 = _mm_loadu_si128(q + 1);
+        __m128i const v2 = _mm_loadu_si128(q + 2);
+        __m128i const v3 = _mm_loadu_si128(q + 3);
+        _mm_storeu_si128(q + 0, _mm_xor_si128(v0, k));
+        _mm_storeu_si128(q + 1, _mm_xor_si128(v1, k));
+        _mm_storeu_si128(q + 2, _mm_xor_si128(v2, k));
+        _mm_storeu_si128(q + 3, _mm_xor_si128(v3, k));
+        p += 64;
+        n -= 64;
+    }
+    while(n >= 16)
+    {
+        auto const q = reinterpret_cast<__m128i*>(p);
+        _mm_storeu_si128(q,
+            _mm_xor_si128(_mm_loadu_si128(q), k));
+        p += 16;
+        n -= 16;
+    }
+    return static_cast<std::size_t>(p - p0);
+}
+
+BOOST_BEAST_TARGET_AVX2
+inline
+std::size_t
+mask_avx2(
+    unsigned char* p,
+    std::size_t n,
+    unsigned char const* m)
+{
+    std::uint32_t w;
+    std::memcpy(&w, m, 4);
+    __m256i const k = _mm256_set1_epi32(static_cast<int>(w));
+    auto const p0 = p;
+    while(n >= 64)
+    {
+        auto const q = reinterpret_cast<__m256i*>(p);
+        __m256i const v0 = _mm256_loadu_si256(q + 0);
+        __m256i const v1 = _mm256_loadu_si256(q + 1);
+        _mm256_storeu_si256(q + 0, _mm256_xor_si256(v0, k));
+        _mm256_storeu_si256(q + 1, _mm256_xor_si256(v1, k));
+        p += 64;
+        n -= 64;
+    }
+    if(n >= 32)
+    {
+        auto const q = reinterpret_cast<__m256i*>(p);
+        _mm256_storeu_si256(q,
+            _mm256_xor_si256(_mm256_loadu_si256(q), k));
+        p += 32;
+    }
+    return static_cast<std::size_t>(p - p0);
+}
+
+#endif
+
+inline
+std::size_t
+mask_word(
+    unsigned char* p,
+    std::size_t n,
+    unsigned char const* m)
 {
-    auto v0 = v;
-    for(std::size_t i = 0; i < v.size(); ++i )
-        v[i] = v0[(i + n) % v.size()];
+    std::uint64_t k;
+    std::memcpy(&k, m, 8);
+    auto const p0 = p;
+    while(n >= 8)
+    {
+        std::uint64_t v;
+        std::memcpy(&v, p, 8);
+        v ^= k;
+        std::memcpy(p, &v, 8);
+        p += 8;
+        n -= 8;
+    }
+    return static_cast<std::size_t>(p - p0);
 }
 
 // Apply mask in place
@@ -43,19 +144,48 @@ mask_inplace(net::mutable_buffer const& b, prepared_key& key)
     auto n = b.size();
     auto const mask = key; // avoid aliasing
     auto p = static_cast<unsigned char*>(b.data());
-    while(n >= 4)
+
+    // Mask single bytes until the wide steps are aligned.
+    // `i` is the key offset for the next byte.
+    std::size_t i = 0;
+    if(n >= 32)
     {
-        for(int i = 0; i < 4; ++i)
-            p[i] ^= mask[i];
-        p += 4;
-        n -= 4;
+        while(reinterpret_cast<std::uintptr_t>(p) & 15)
+        {
+            *p++ ^= mask[i];
+            i = (i + 1) & 3;
+            --n;
+        }
     }
-    if(n > 0)
+    unsigned char m[8];
+    for(std::size_t j = 0; j < 8; ++j)
+        m[j] = mask[(i + j) & 3];
+
+    std::size_t done;
+#if ! BOOST_BEAST_NO_INTRINSICS
+    if(n >= 32)
     {
-        for(std::size_t i = 0; i < n; ++i)
-            p[i] ^= mask[i];
-        rol(key, n);
+        auto const& ci = beast::detail::get_cpu_info();
+        if(ci.avx2)
+            done = mask_avx2(p, n, m);
+        else if(ci.sse2)
+            done = mask_sse2(p, n, m);
+        else
+            done = 0;
+        p += done;
+        n -= done;
     }
+#endif
+    done = mask_word(p, n, m);
+    p += done;
+    n -= done;
+    for(std::size_t j = 0; j < n; ++j)
+        p[j] ^= m[j];
+
+    // The next buffer starts where this one left off
+    auto const r = b.size() & 3;
+    for(std::size_t j = 0; j < 4; ++j)
+        key[j] = mask[(j + r) & 3];
 }
 
 } // detail
@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_DETAIL_PMD_POOL_HPP
+#define BOOST_BEAST_WEBSOCKET_DETAIL_PMD_POOL_HPP
+
+#include <boost/beast/core/detail/service_base.hpp>
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/beast/zlib/inflate_stream.hpp>
+#include <boost/asio/execution_context.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+/*  Compression contexts shared by the streams of one
+    execution context.
+
+    When the negotiated permessage-deflate parameters reset
+    a direction after every message, a stream borrows the
+    context for that direction when a message starts and
+    gives it back when the message ends. The number of
+    contexts is then bounded by the number of messages in
+    flight rather than by the number of open streams.
+
+    Contexts are handed out in an unspecified state, and
+    must be reset by the borrower before use. At most
+    max_idle contexts per direction are kept for reuse,
+    so that a burst of messages does not pin its peak
+    memory for the life of the execution context.
+*/
+class pmd_pool
+    : public beast::detail::service_base<pmd_pool>
+{
+    std::mutex m_;
+    std::vector<std::unique_ptr<zlib::deflate_stream>> zo_;
+    std::vector<std::unique_ptr<zlib::inflate_stream>> zi_;
+    std::size_t max_idle_ = 16;
+
+    BOOST_BEAST_DECL
+    void
+    shutdown() override;
+
+public:
+    BOOST_BEAST_DECL
+    explicit
+    pmd_pool(net::execution_context& ctx);
+
+    BOOST_BEAST_DECL
+    std::unique_ptr<zlib::deflate_stream>
+    get_deflate();
+
+    BOOST_BEAST_DECL
+    std::unique_ptr<zlib::inflate_stream>
+    get_inflate();
+
+    BOOST_BEAST_DECL
+    void
+    put(std::unique_ptr<zlib::deflate_stream> zo);
+
+    BOOST_BEAST_DECL
+    void
+    put(std::unique_ptr<zlib::inflate_stream> zi);
+
+    // Returns the number of contexts waiting to be borrowed
+    BOOST_BEAST_DECL
+    std::size_t
+    idle_deflate();
+
+    BOOST_BEAST_DECL
+    std::size_t
+    idle_inflate();
+
+    // Set the number of idle contexts kept per direction
+    BOOST_BEAST_DECL
+    void
+    max_idle(std::size_t n);
+};
+
+} // detail
+} // websocket
+} // beast
+} // boost
+
+#if BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/websocket/detail/pmd_pool.ipp>
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_DETAIL_PMD_POOL_IPP
+#define BOOST_BEAST_WEBSOCKET_DETAIL_PMD_POOL_IPP
+
+#include <boost/beast/websocket/detail/pmd_pool.hpp>
+#include <boost/smart_ptr/make_unique.hpp>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+pmd_pool::
+pmd_pool(net::execution_context& ctx)
+    : beast::detail::service_base<pmd_pool>(ctx)
+{
+}
+
+void
+pmd_pool::
+shutdown()
+{
+}
+
+std::unique_ptr<zlib::deflate_stream>
+pmd_pool::
+get_deflate()
+{
+    {
+        std::lock_guard<std::mutex> g(m_);
+        if(! zo_.empty())
+        {
+            auto zo = std::move(zo_.back());
+            zo_.pop_back();
+            return zo;
+        }
+    }
+    return boost::make_unique<zlib::deflate_stream>();
+}
+
+std::unique_ptr<zlib::inflate_stream>
+pmd_pool::
+get_inflate()
+{
+    {
+        std::lock_guard<std::mutex> g(m_);
+        if(! zi_.empty())
+        {
+            auto zi = std::move(zi_.back());
+            zi_.pop_back();
+            return zi;
+        }
+    }
+    return boost::make_unique<zlib::inflate_stream>();
+}
+
+void
+pmd_pool::
+put(std::unique_ptr<zlib::deflate_stream> zo)
+{
+    std::lock_guard<std::mutex> g(m_);
+    if(zo_.size() < max_idle_)
+        zo_.emplace_back(std::move(zo));
+}
+
+void
+pmd_pool::
+put(std::unique_ptr<zlib::inflate_stream> zi)
+{
+    std::lock_guard<std::mutex> g(m_);
+    if(zi_.size() < max_idle_)
+        zi_.emplace_back(std::move(zi));
+}
+
+std::size_t
+pmd_pool::
+idle_deflate()
+{
+    std::lock_guard<std::mutex> g(m_);
+    return zo_.size();
+}
+
+std::size_t
+pmd_pool::
+idle_inflate()
+{
+    std::lock_guard<std::mutex> g(m_);
+    return zi_.size();
+}
+
+void
+pmd_pool::
+max_idle(std::size_t n)
+{
+    std::lock_guard<std::mutex> g(m_);
+    max_idle_ = n;
+    if(zo_.size() > n)
+        zo_.resize(n);
+    if(zi_.size() > n)
+        zi_.resize(n);
+}
+
+} // detail
+} // websocket
+} // beast
+} // boost
+
+#endif
@@ -12,13 +12,274 @@
 
 #include <boost/beast/websocket/detail/utf8_checker.hpp>
 
+#include <boost/beast/core/detail/cpu_info.hpp>
 #include <boost/assert.hpp>
 
+#if ! BOOST_BEAST_NO_INTRINSICS
+#include <immintrin.h>
+#endif
+
 namespace boost {
 namespace beast {
 namespace websocket {
 namespace detail {
 
+#if ! BOOST_BEAST_NO_INTRINSICS
+
+namespace utf8 {
+
+/*  Vectorized validation using the lookup algorithm of
+    Keiser and Lemire, "Validating UTF-8 In Less Than One
+    Instruction Per Byte".
+
+    Each byte is classified together with the byte before it
+    by three table lookups, indexed by the high and low nibble
+    of the previous byte and the high nibble of the current
+    byte. A bit survives the AND of the three results only for
+    an error, except for two_conts, which must be set exactly
+    where the byte is the third or fourth of a sequence.
+
+    An error at a position depends only on that byte and the
+    three bytes before it, so whole blocks can be checked
+    without looking past their end.
+*/
+
+std::uint8_t constexpr too_short   = 1 << 0; // 11______ 0_______
+                                              // 11______ 11______
+std::uint8_t constexpr too_long    = 1 << 1; // 0_______ 10______
+std::uint8_t constexpr overlong_3  = 1 << 2; // 11100000 100_____
+std::uint8_t constexpr too_large   = 1 << 3; // 11110100 1001____
+                                              // 11110100 101_____
+                                              // 111101__ 10______
+                                              // 11111___ 10______
+std::uint8_t constexpr surrogate   = 1 << 4; // 11101101 101_____
+std::uint8_t constexpr overlong_2  = 1 << 5; // 1100000_ 10______
+std::uint8_t constexpr too_large_1000 = 1 << 6; // 111101__ 1000____
+                                                 // 11111___ 1000____
+std::uint8_t constexpr overlong_4  = 1 << 6; // 11110000 1000____
+std::uint8_t constexpr two_conts   = 1 << 7; // 10______ 10______
+
+std::uint8_t constexpr carry = too_short | too_long | two_conts;
+
+struct lookup_tables
+{
+    std::uint8_t byte_1_high[16]; // high nibble of the previous byte
+    std::uint8_t byte_1_low[16];  // low nibble of the previous byte
+    std::uint8_t byte_2_high[16]; // high nibble of the current byte
+};
+
+inline
+lookup_tables const&
+get_lookup_tables()
+{
+    static lookup_tables const t = {
+    {
+        // 0_______ ________ <ASCII in byte 1>
+        too_long, too_long, too_long, too_long,
+        too_long, too_long, too_long, too_long,
+        // 10______ ________ <continuation in byte 1>
+        two_conts, two_conts, two_conts, two_conts,
+        // 1100____ ________ <two byte lead in byte 1>
+        too_short | overlong_2,
+        // 1101____ ________ <two byte lead in byte 1>
+        too_short,
+        // 1110____ ________ <three byte lead in byte 1>
+        too_short | overlong_3 | surrogate,
+        // 1111____ ________ <four+ byte lead in byte 1>
+        too_short | too_large | too_large_1000 | overlong_4
+    },
+    {
+        // ____0000 ________
+        carry | overlong_3 | overlong_2 | overlong_4,
+        // ____0001 ________
+        carry | overlong_2,
+        // ____001_ ________
+        carry,
+        carry,
+        // ____0100 ________
+        carry | too_large,
+        // ____0101 ________
+        carry | too_large | too_large_1000,
+        // ____011_ ________
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        // ____1___ ________
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        // ____1101 ________
+        carry | too_large | too_large_1000 | surrogate,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000
+    },
+    {
+        // ________ 0_______ <ASCII in byte 2>
+        too_short, too_short, too_short, too_short,
+        too_short, too_short, too_short, too_short,
+        // ________ 1000____
+        too_long | overlong_2 | two_conts |
+            overlong_3 | too_large_1000 | overlong_4,
+        // ________ 1001____
+        too_long | overlong_2 | two_conts | overlong_3 | too_large,
+        // ________ 101_____
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        // ________ 11______
+        too_short, too_short, too_short, too_short
+    }};
+    return t;
+}
+
+/*  Return the start of the code point which contains
+    `last`, given that [first, last) was validated.
+    The scalar loop resumes from there.
+*/
+inline
+std::uint8_t const*
+resume_point(
+    std::uint8_t const* first,
+    std::uint8_t const* last)
+{
+    for(std::ptrdiff_t k = 1; k <= 3 && last - k >= first; ++k)
+    {
+        auto const c = last[-k];
+        if((c & 0xc0) == 0x80)
+            continue;
+        if(c >= 0xc0)
+        {
+            std::ptrdiff_t const need =
+                c >= 0xf0 ? 4 : (c >= 0xe0 ? 3 : 2);
+            if(need > k)
+                return last - k;
+        }
+        break;
+    }
+    return last;
+}
+
+// Returns nullptr on an error
+BOOST_BEAST_TARGET_SSE42
+inline
+std::uint8_t const*
+validate_sse42(
+    std::uint8_t const* first,
+    std::uint8_t const* last)
+{
+    auto const& t = get_lookup_tables();
+    __m128i const t1h = _mm_loadu_si128(
+        reinterpret_cast<__m128i const*>(t.byte_1_high));
+    __m128i const t1l = _mm_loadu_si128(
+        reinterpret_cast<__m128i const*>(t.byte_1_low));
+    __m128i const t2h = _mm_loadu_si128(
+        reinterpret_cast<__m128i const*>(t.byte_2_high));
+    __m128i const nibble = _mm_set1_epi8(0x0f);
+    __m128i const third = _mm_set1_epi8(0x60);  // 0xe0 - 0x80
+    __m128i const fourth = _mm_set1_epi8(0x70); // 0xf0 - 0x80
+    __m128i const high = _mm_set1_epi8(
+        static_cast<char>(0x80));
+    __m128i prev = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+    bool prev_ascii = true;
+    auto p = first;
+    while(last - p >= 16)
+    {
+        __m128i const v = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(p));
+        bool const ascii = _mm_movemask_epi8(v) == 0;
+        if(! ascii || ! prev_ascii)
+        {
+            __m128i const prev1 = _mm_alignr_epi8(v, prev, 15);
+            __m128i const sc = _mm_and_si128(_mm_and_si128(
+                _mm_shuffle_epi8(t1h, _mm_and_si128(
+                    _mm_srli_epi16(prev1, 4), nibble)),
+                _mm_shuffle_epi8(t1l, _mm_and_si128(
+                    prev1, nibble))),
+                _mm_shuffle_epi8(t2h, _mm_and_si128(
+                    _mm_srli_epi16(v, 4), nibble)));
+            __m128i const must23 = _mm_and_si128(_mm_or_si128(
+                _mm_subs_epu8(_mm_alignr_epi8(v, prev, 14), third),
+                _mm_subs_epu8(_mm_alignr_epi8(v, prev, 13), fourth)),
+                high);
+            error = _mm_or_si128(error, _mm_xor_si128(must23, sc));
+            if(! _mm_testz_si128(error, error))
+                return nullptr;
+        }
+        prev = v;
+        prev_ascii = ascii;
+        p += 16;
+    }
+    return resume_point(first, p);
+}
+
+// Returns nullptr on an error
+BOOST_BEAST_TARGET_AVX2
+inline
+std::uint8_t const*
+validate_avx2(
+    std::uint8_t const* first,
+    std::uint8_t const* last)
+{
+    auto const& t = get_lookup_tables();
+    __m256i const t1h = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+        reinterpret_cast<__m128i const*>(t.byte_1_high)));
+    __m256i const t1l = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+        reinterpret_cast<__m128i const*>(t.byte_1_low)));
+    __m256i const t2h = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+        reinterpret_cast<__m128i const*>(t.byte_2_high)));
+    __m256i const nibble = _mm256_set1_epi8(0x0f);
+    __m256i const third = _mm256_set1_epi8(0x60);
+    __m256i const fourth = _mm256_set1_epi8(0x70);
+    __m256i const high = _mm256_set1_epi8(
+        static_cast<char>(0x80));
+    __m256i prev = _mm256_setzero_si256();
+    __m256i error = _mm256_setzero_si256();
+    bool prev_ascii = true;
+    auto p = first;
+    while(last - p >= 32)
+    {
+        __m256i const v = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(p));
+        bool const ascii = _mm256_movemask_epi8(v) == 0;
+        if(! ascii || ! prev_ascii)
+        {
+            // The upper half of `prev` followed by the
+            // lower half of `v`, so that the per-lane
+            // alignr sees the bytes which precede each lane.
+            __m256i const shifted =
+                _mm256_permute2x128_si256(prev, v, 0x21);
+            __m256i const prev1 =
+                _mm256_alignr_epi8(v, shifted, 15);
+            __m256i const sc = _mm256_and_si256(_mm256_and_si256(
+                _mm256_shuffle_epi8(t1h, _mm256_and_si256(
+                    _mm256_srli_epi16(prev1, 4), nibble)),
+                _mm256_shuffle_epi8(t1l, _mm256_and_si256(
+                    prev1, nibble))),
+                _mm256_shuffle_epi8(t2h, _mm256_and_si256(
+                    _mm256_srli_epi16(v, 4), nibble)));
+            __m256i const must23 = _mm256_and_si256(_mm256_or_si256(
+                _mm256_subs_epu8(
+                    _mm256_alignr_epi8(v, shifted, 14), third),
+                _mm256_subs_epu8(
+                    _mm256_alignr_epi8(v, shifted, 13), fourth)),
+                high);
+            error = _mm256_or_si256(
+                error, _mm256_xor_si256(must23, sc));
+            if(! _mm256_testz_si256(error, error))
+                return nullptr;
+        }
+        prev = v;
+        prev_ascii = ascii;
+        p += 32;
+    }
+    return resume_point(first, p);
+}
+
+} // utf8
+
+#endif
+
 void
 utf8_checker::
 reset()
@@ -205,6 +466,25 @@ write(std::uint8_t const* in, std::size_t size)
         p_ = cp_;
     }
 
+#if ! BOOST_BEAST_NO_INTRINSICS
+    // Validate whole vectors, then let the loops
+    // below finish from the last code point boundary.
+    if(size >= 64)
+    {
+        auto const& ci = beast::detail::get_cpu_info();
+        if(ci.avx2 || ci.sse42)
+        {
+            auto const p = ci.avx2 ?
+                utf8::validate_avx2(in, end) :
+                utf8::validate_sse42(in, end);
+            if(! p)
+                return false;
+            size -= p - in;
+            in = p;
+        }
+    }
+#endif
+
     if(size <= sizeof(std::size_t))
         goto slow;
 
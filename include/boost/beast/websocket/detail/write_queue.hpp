@@ -0,0 +1,192 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_DETAIL_WRITE_QUEUE_HPP
+#define BOOST_BEAST_WEBSOCKET_DETAIL_WRITE_QUEUE_HPP
+
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/saved_handler.hpp>
+#include <boost/beast/websocket/detail/frame.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/assert.hpp>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+/*  Messages waiting to be sent with async_write_queued.
+
+    Each message owns a copy of its payload. The operation
+    which queued the front message writes it, together with
+    as many of the messages behind it as fit in one batch,
+    with a single gather write. The operations of the other
+    messages in the batch are suspended in their entries
+    and resumed when the batch is written.
+*/
+class write_queue
+{
+public:
+    struct entry
+    {
+        flat_buffer data;       // payload, as sent
+        fh_buffer fb;           // frame header
+        saved_handler op;       // suspended operation
+        error_code ec;          // result, once done
+        std::size_t size;       // payload size
+        opcode code;            // text or binary
+        bool done = false;      // `true` once written or failed
+    };
+
+    // Most messages and bytes written together
+    static std::size_t constexpr batch_messages = 64;
+    static std::size_t constexpr batch_bytes = 64 * 1024;
+
+    std::size_t max_bytes = 16 * 1024 * 1024;
+    std::size_t max_messages = 4096;
+
+private:
+    std::deque<std::unique_ptr<entry>> q_;
+    std::vector<net::const_buffer> bufs_;
+    std::size_t bytes_ = 0;
+    std::size_t batch_ = 0;
+
+public:
+    bool
+    empty() const noexcept
+    {
+        return q_.empty();
+    }
+
+    std::size_t
+    size() const noexcept
+    {
+        return q_.size();
+    }
+
+    std::size_t
+    bytes() const noexcept
+    {
+        return bytes_;
+    }
+
+    // Returns `true` if a message of `n` bytes stays within the
+    // limits. A message is always accepted into an empty queue.
+    bool
+    accept(std::size_t n) const noexcept
+    {
+        return q_.empty() || (
+            q_.size() < max_messages &&
+            bytes_ <= max_bytes &&
+            n <= max_bytes - bytes_);
+    }
+
+    entry&
+    push(std::size_t n, opcode code)
+    {
+        q_.emplace_back(new entry);
+        auto& e = *q_.back();
+        e.size = n;
+        e.code = code;
+        bytes_ += n;
+        return e;
+    }
+
+    entry&
+    front() noexcept
+    {
+        BOOST_ASSERT(! q_.empty());
+        return *q_.front();
+    }
+
+    entry&
+    operator[](std::size_t i) noexcept
+    {
+        BOOST_ASSERT(i < q_.size());
+        return *q_[i];
+    }
+
+    // Choose the messages at the front which are written
+    // together, and return how many there are.
+    std::size_t
+    begin_batch() noexcept
+    {
+        BOOST_ASSERT(! q_.empty());
+        std::size_t n = 0;
+        batch_ = 0;
+        while(batch_ < q_.size() && batch_ < batch_messages)
+        {
+            auto const size = q_[batch_]->size;
+            if(batch_ > 0 && n + size > batch_bytes)
+                break;
+            n += size;
+            ++batch_;
+        }
+        return batch_;
+    }
+
+    // Returns the frames of the batch, once framed
+    std::vector<net::const_buffer> const&
+    buffers()
+    {
+        bufs_.clear();
+        for(std::size_t i = 0; i < batch_; ++i)
+        {
+            auto& e = *q_[i];
+            bufs_.push_back(e.fb.data());
+            if(e.data.size() > 0)
+                bufs_.push_back(e.data.data());
+        }
+        return bufs_;
+    }
+
+    // Remove the batch from the queue, resuming the suspended
+    // operations of its messages. On error, every message in
+    // the queue fails.
+    void
+    end_batch(error_code const& ec)
+    {
+        auto n = ec ? q_.size() : batch_;
+        batch_ = 0;
+        while(n--)
+        {
+            auto e = std::move(q_.front());
+            q_.pop_front();
+            bytes_ -= e->size;
+            if(e->op.has_value())
+            {
+                e->ec = ec;
+                e->done = true;
+                e->op.invoke();
+            }
+        }
+    }
+
+    // Destroy the queued messages and
+    // their suspended operations
+    void
+    clear() noexcept
+    {
+        q_.clear();
+        bytes_ = 0;
+        batch_ = 0;
+    }
+};
+
+} // detail
+} // websocket
+} // beast
+} // boost
+
+#endif
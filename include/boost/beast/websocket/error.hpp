@@ -222,7 +222,11 @@ enum class error
 
         Error codes with this value will compare equal to @ref condition::protocol_violation
     */
-    bad_close_payload
+    bad_close_payload,
+
+    /** The WebSocket write queue was above its limit
+    */
+    write_queue_full
 };
 
 /// Error conditions corresponding to sets of error codes.
@@ -48,6 +48,20 @@ build_response_pmd(
     pmd_offer offer;
     pmd_offer unused;
     pmd_read(offer, req);
+    if(pmd_opts_.budget)
+    {
+        // The client's window may only be
+        // limited when the client allows it
+        auto o = pmd_opts_;
+        int mem_level = o.memLevel;
+        o.budget->narrow(
+            o.server_max_window_bits,
+            o.client_max_window_bits,
+            mem_level,
+            offer.client_max_window_bits == 0);
+        pmd_negotiate(res, unused, offer, o);
+        return;
+    }
     pmd_negotiate(res, unused, offer, pmd_opts_);
 }
 
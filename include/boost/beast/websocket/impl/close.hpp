@@ -226,7 +226,8 @@ public:
             impl.op_rd.maybe_invoke()
                 || impl.op_idle_ping.maybe_invoke()
                 || impl.op_ping.maybe_invoke()
-                || impl.op_wr.maybe_invoke();
+                || impl.op_wr.maybe_invoke()
+                || impl.op_wq.maybe_invoke();
             this->complete(cont, ec);
         }
     }
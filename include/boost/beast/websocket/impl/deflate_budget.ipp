@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_IMPL_DEFLATE_BUDGET_IPP
+#define BOOST_BEAST_WEBSOCKET_IMPL_DEFLATE_BUDGET_IPP
+
+#include <boost/beast/websocket/deflate_budget.hpp>
+#include <boost/assert.hpp>
+#include <algorithm>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+deflate_budget::
+deflate_budget(
+    std::size_t limit,
+    std::size_t expected) noexcept
+    : limit_(limit)
+    , expected_(expected)
+{
+}
+
+std::size_t
+deflate_budget::
+limit() const noexcept
+{
+    return limit_;
+}
+
+std::size_t
+deflate_budget::
+usage() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return usage_;
+}
+
+std::size_t
+deflate_budget::
+connections() const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    return connections_;
+}
+
+std::size_t
+deflate_budget::
+deflate_size(int window_bits, int mem_level) noexcept
+{
+    // window (2x), prev, head and the literal buffers,
+    // see deflate_stream::init
+    return
+        (std::size_t{1} << (window_bits + 2)) +
+        (std::size_t{1} << (mem_level + 9));
+}
+
+std::size_t
+deflate_budget::
+inflate_size(int window_bits) noexcept
+{
+    return std::size_t{1} << window_bits;
+}
+
+std::size_t
+deflate_budget::
+share() const noexcept
+{
+    auto const even = limit_ /
+        (std::max)(connections_ + 1, expected_);
+    auto const left = usage_ < limit_ ? limit_ - usage_ : 0;
+    return (std::min)(even, left);
+}
+
+void
+deflate_budget::
+fit(
+    std::size_t share,
+    int& deflate_bits,
+    int& inflate_bits,
+    int& mem_level,
+    bool inflate_fixed) noexcept
+{
+    for(;;)
+    {
+        auto const window = std::size_t{1} << (deflate_bits + 2);
+        auto const hash = std::size_t{1} << (mem_level + 9);
+        auto const in = inflate_size(inflate_bits);
+        if(window + hash + in <= share)
+            break;
+        // Halve the largest part which can still shrink
+        int* p = nullptr;
+        std::size_t largest = 0;
+        if(deflate_bits > 9 && window > largest)
+        {
+            p = &deflate_bits;
+            largest = window;
+        }
+        if(mem_level > 1 && hash > largest)
+        {
+            p = &mem_level;
+            largest = hash;
+        }
+        if(! inflate_fixed && inflate_bits > 9 && in > largest)
+            p = &inflate_bits;
+        if(! p)
+            break;
+        --*p;
+    }
+}
+
+void
+deflate_budget::
+narrow(
+    int& deflate_bits,
+    int& inflate_bits,
+    int& mem_level,
+    bool inflate_fixed) const
+{
+    std::lock_guard<std::mutex> lock(m_);
+    fit(share(), deflate_bits,
+        inflate_bits, mem_level, inflate_fixed);
+}
+
+std::size_t
+deflate_budget::
+reserve(
+    int& deflate_bits,
+    int inflate_bits,
+    int& mem_level)
+{
+    std::lock_guard<std::mutex> lock(m_);
+    fit(share(), deflate_bits,
+        inflate_bits, mem_level, true);
+    auto const n =
+        deflate_size(deflate_bits, mem_level) +
+        inflate_size(inflate_bits);
+    usage_ += n;
+    ++connections_;
+    return n;
+}
+
+void
+deflate_budget::
+release(std::size_t bytes) noexcept
+{
+    std::lock_guard<std::mutex> lock(m_);
+    BOOST_ASSERT(connections_ > 0);
+    BOOST_ASSERT(usage_ >= bytes);
+    usage_ -= bytes;
+    --connections_;
+}
+
+} // websocket
+} // beast
+} // boost
+
+#endif
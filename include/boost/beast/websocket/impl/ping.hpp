@@ -103,7 +103,8 @@ public:
             impl.op_close.maybe_invoke()
                 || impl.op_idle_ping.maybe_invoke()
                 || impl.op_rd.maybe_invoke()
-                || impl.op_wr.maybe_invoke();
+                || impl.op_wr.maybe_invoke()
+                || impl.op_wq.maybe_invoke();
             this->complete(cont, ec);
         }
     }
@@ -198,7 +199,8 @@ public:
             impl.op_close.maybe_invoke()
                 || impl.op_ping.maybe_invoke()
                 || impl.op_rd.maybe_invoke()
-                || impl.op_wr.maybe_invoke();
+                || impl.op_wr.maybe_invoke()
+                || impl.op_wq.maybe_invoke();
         }
     }
 };
@@ -0,0 +1,47 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_IMPL_PREPARED_MESSAGE_HPP
+#define BOOST_BEAST_WEBSOCKET_IMPL_PREPARED_MESSAGE_HPP
+
+#include <boost/beast/core/buffer_traits.hpp>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+template<class ConstBufferSequence>
+prepared_message::
+prepared_message(
+    bool binary,
+    ConstBufferSequence const& payload)
+{
+    static_assert(net::is_const_buffer_sequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence type requirements not met");
+    net::buffer_copy(construct(binary,
+        buffer_bytes(payload)), payload);
+}
+
+template<class ConstBufferSequence>
+prepared_message::
+prepared_message(
+    bool binary,
+    ConstBufferSequence const& payload,
+    permessage_deflate const& opts)
+    : prepared_message(binary, payload)
+{
+    construct_deflated(opts);
+}
+
+} // websocket
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_IMPL_PREPARED_MESSAGE_IPP
+#define BOOST_BEAST_WEBSOCKET_IMPL_PREPARED_MESSAGE_IPP
+
+#include <boost/beast/websocket/prepared_message.hpp>
+#include <boost/beast/core/flat_static_buffer.hpp>
+#include <boost/beast/websocket/detail/frame.hpp>
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/assert.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/smart_ptr/make_unique.hpp>
+#include <cstring>
+#include <memory>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+/*  Each frame is stored in a buffer with room for the largest
+    unmasked frame header in front of the payload. The header
+    is written immediately before the payload once its length
+    is known, so that the frame is one contiguous buffer.
+*/
+struct prepared_message::impl_type
+{
+    static std::size_t constexpr max_header = 10;
+
+    std::unique_ptr<unsigned char[]> plain_buf;
+    std::unique_ptr<unsigned char[]> deflated_buf;
+    net::const_buffer plain;
+    net::const_buffer deflated;
+    std::size_t size;
+    int window_bits = 0;
+    bool binary;
+
+    // Write the header for a payload of `n` bytes at `p`,
+    // and return the complete frame.
+    static
+    net::const_buffer
+    make_frame(
+        unsigned char* p,
+        std::size_t n,
+        bool binary,
+        bool rsv1)
+    {
+        detail::frame_header fh;
+        fh.op = binary ?
+            detail::opcode::binary :
+            detail::opcode::text;
+        fh.fin = true;
+        fh.rsv1 = rsv1;
+        fh.rsv2 = false;
+        fh.rsv3 = false;
+        fh.mask = false;
+        fh.len = n;
+        detail::fh_buffer fb;
+        detail::write<flat_static_buffer_base>(fb, fh);
+        auto const h = fb.data();
+        BOOST_ASSERT(h.size() <= max_header);
+        std::memcpy(p - h.size(), h.data(), h.size());
+        return {p - h.size(), h.size() + n};
+    }
+};
+
+net::mutable_buffer
+prepared_message::
+construct(bool binary, std::size_t size)
+{
+    auto sp = boost::make_shared<impl_type>();
+    sp->plain_buf = boost::make_unique_noinit<
+        unsigned char[]>(impl_type::max_header + size);
+    auto const p = sp->plain_buf.get() + impl_type::max_header;
+    sp->plain = impl_type::make_frame(p, size, binary, false);
+    sp->size = size;
+    sp->binary = binary;
+    impl_ = std::move(sp);
+    return {p, size};
+}
+
+void
+prepared_message::
+construct_deflated(permessage_deflate const& opts)
+{
+    auto& impl = *impl_;
+    if(impl.size == 0)
+        return;
+    zlib::deflate_stream zo;
+    zo.reset(
+        opts.compLevel,
+        opts.server_max_window_bits,
+        opts.memLevel,
+        zlib::Strategy::normal);
+    // Room for the empty stored block
+    // which ends a sync flush
+    auto const capacity =
+        zo.upper_bound(impl.size) + 16;
+    auto buf = boost::make_unique_noinit<
+        unsigned char[]>(impl_type::max_header + capacity);
+    auto const p = buf.get() + impl_type::max_header;
+    zlib::z_params zs;
+    zs.next_in = static_cast<
+        unsigned char const*>(impl.plain.data()) +
+            (impl.plain.size() - impl.size);
+    zs.avail_in = impl.size;
+    zs.next_out = p;
+    zs.avail_out = capacity;
+    error_code ec;
+    zo.write(zs, zlib::Flush::sync, ec);
+    if(ec || zs.avail_in != 0 || zs.total_out < 4)
+        return;
+    // Remove the flush marker, as
+    // permessage-deflate requires
+    auto const n = zs.total_out - 4;
+    if(std::memcmp(p + n, "\x00\x00\xff\xff", 4) != 0)
+        return;
+    // Only worth sending if it saves something
+    if(n >= impl.size)
+        return;
+    impl.deflated = impl_type::make_frame(
+        p, n, impl.binary, true);
+    impl.deflated_buf = std::move(buf);
+    impl.window_bits = opts.server_max_window_bits;
+}
+
+bool
+prepared_message::
+binary() const noexcept
+{
+    return impl_->binary;
+}
+
+std::size_t
+prepared_message::
+size() const noexcept
+{
+    return impl_->size;
+}
+
+bool
+prepared_message::
+deflated() const noexcept
+{
+    return impl_->deflated_buf != nullptr;
+}
+
+net::const_buffer
+prepared_message::
+frame(bool deflated) const noexcept
+{
+    if(deflated)
+    {
+        BOOST_ASSERT(impl_->deflated_buf);
+        return impl_->deflated;
+    }
+    return impl_->plain;
+}
+
+int
+prepared_message::
+window_bits() const noexcept
+{
+    return impl_->window_bits;
+}
+
+} // websocket
+} // beast
+} // boost
+
+#endif
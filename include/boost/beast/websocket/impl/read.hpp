@@ -162,6 +162,7 @@ public:
                         goto close;
                     }
                     BOOST_ASSERT(impl.rd_block.is_locked(this));
+                    impl.release_read();
                     BOOST_ASIO_CORO_YIELD
                     impl.stream().async_read_some(
                         impl.rd_buf.prepare(read_size(
@@ -263,7 +264,8 @@ public:
                         impl.op_close.maybe_invoke()
                             || impl.op_idle_ping.maybe_invoke()
                             || impl.op_ping.maybe_invoke()
-                            || impl.op_wr.maybe_invoke();
+                            || impl.op_wr.maybe_invoke()
+                            || impl.op_wq.maybe_invoke();
                         goto acquire_read_lock;
                     }
 
@@ -606,7 +608,8 @@ public:
                 impl.op_close.maybe_invoke()
                     || impl.op_idle_ping.maybe_invoke()
                     || impl.op_ping.maybe_invoke()
-                    || impl.op_wr.maybe_invoke();
+                    || impl.op_wr.maybe_invoke()
+                    || impl.op_wq.maybe_invoke();
             this->complete(cont, ec, bytes_written_);
         }
     }
@@ -964,6 +967,7 @@ loop:
                 do_fail(code, result, ec);
                 return bytes_written;
             }
+            impl.release_read();
             auto const bytes_transferred =
                 impl.stream().read_some(
                     impl.rd_buf.prepare(read_size(
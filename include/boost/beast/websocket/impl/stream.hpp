@@ -117,6 +117,22 @@ reason() const noexcept
     return impl_->cr;
 }
 
+template<class NextLayer, bool deflateSupported>
+std::size_t
+stream<NextLayer, deflateSupported>::
+memory_usage() const noexcept
+{
+    return impl_->memory_usage();
+}
+
+template<class NextLayer, bool deflateSupported>
+deflate_stats
+stream<NextLayer, deflateSupported>::
+deflate_statistics() const noexcept
+{
+    return impl_->deflate_stats_pmd();
+}
+
 template<class NextLayer, bool deflateSupported>
 std::size_t
 stream<NextLayer, deflateSupported>::
@@ -243,6 +259,22 @@ control_callback()
     impl_->ctrl_cb = {};
 }
 
+template<class NextLayer, bool deflateSupported>
+void
+stream<NextLayer, deflateSupported>::
+hibernate(bool value)
+{
+    impl_->hibernate_opt = value;
+}
+
+template<class NextLayer, bool deflateSupported>
+bool
+stream<NextLayer, deflateSupported>::
+hibernate() const
+{
+    return impl_->hibernate_opt;
+}
+
 template<class NextLayer, bool deflateSupported>
 void
 stream<NextLayer, deflateSupported>::
@@ -259,6 +291,31 @@ read_message_max() const
     return impl_->rd_msg_max;
 }
 
+template<class NextLayer, bool deflateSupported>
+void
+stream<NextLayer, deflateSupported>::
+write_queue_limit(std::size_t bytes, std::size_t messages)
+{
+    impl_->wr_queue.max_bytes = bytes;
+    impl_->wr_queue.max_messages = messages;
+}
+
+template<class NextLayer, bool deflateSupported>
+std::size_t
+stream<NextLayer, deflateSupported>::
+write_queue_bytes() const noexcept
+{
+    return impl_->wr_queue.bytes();
+}
+
+template<class NextLayer, bool deflateSupported>
+std::size_t
+stream<NextLayer, deflateSupported>::
+write_queue_size() const noexcept
+{
+    return impl_->wr_queue.size();
+}
+
 template<class NextLayer, bool deflateSupported>
 void
 stream<NextLayer, deflateSupported>::
@@ -19,12 +19,15 @@
 #include <boost/beast/websocket/detail/service.hpp>
 #include <boost/beast/websocket/detail/soft_mutex.hpp>
 #include <boost/beast/websocket/detail/utf8_checker.hpp>
+#include <boost/beast/websocket/detail/write_queue.hpp>
 #include <boost/beast/http/read.hpp>
 #include <boost/beast/http/write.hpp>
 #include <boost/beast/http/rfc7230.hpp>
 #include <boost/beast/core/buffers_cat.hpp>
 #include <boost/beast/core/buffers_prefix.hpp>
+#include <boost/beast/core/buffers_range.hpp>
 #include <boost/beast/core/buffers_suffix.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
 #include <boost/beast/core/flat_static_buffer.hpp>
 #include <boost/beast/core/saved_handler.hpp>
 #include <boost/beast/core/static_buffer.hpp>
@@ -36,6 +39,8 @@
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/optional.hpp>
+#include <iterator>
+#include <vector>
 
 namespace boost {
 namespace beast {
@@ -105,12 +110,17 @@ struct stream<NextLayer, deflateSupported>::impl_type
     std::size_t             wr_buf_size     /* write buffer size (current message) */ = 0;
     std::size_t             wr_buf_opt      /* write buffer size option setting */ = 4096;
     detail::fh_buffer       wr_fb;          // header buffer used for writes
+    detail::write_queue     wr_queue;       // messages from async_write_queued
+    flat_buffer             wr_batch;       // frame headers and copied payloads of a batch
+    std::vector<
+        net::const_buffer>  wr_batch_bufs;  // buffers of a batch, in order
 
     saved_handler           op_rd;          // paused read op
     saved_handler           op_wr;          // paused write op
     saved_handler           op_ping;        // paused ping op
     saved_handler           op_idle_ping;   // paused idle ping op
     saved_handler           op_close;       // paused close op
+    saved_handler           op_wq;          // paused write queue op
     saved_handler           op_r_rd;        // paused read op (async read)
     saved_handler           op_r_close;     // paused close op (async read)
 
@@ -118,6 +128,7 @@ struct stream<NextLayer, deflateSupported>::impl_type
     bool    secure_prng_ = true;
     bool    ec_delivered = false;
     bool    timed_out = false;
+    bool    hibernate_opt = false;
     int     idle_counter = 0;
 
     detail::decorator       decorator_opt;  // Decorator for HTTP messages
@@ -145,8 +156,10 @@ struct stream<NextLayer, deflateSupported>::impl_type
         op_ping.reset();
         op_idle_ping.reset();
         op_close.reset();
+        op_wq.reset();
         op_r_rd.reset();
         op_r_close.reset();
+        wr_queue.clear();
     }
 
     void
@@ -175,7 +188,8 @@ struct stream<NextLayer, deflateSupported>::impl_type
         wr_cont = false;
         wr_buf_size = 0;
 
-        this->open_pmd(role);
+        this->open_pmd(role,
+            stream().get_executor().context());
     }
 
     void
@@ -218,6 +232,222 @@ struct stream<NextLayer, deflateSupported>::impl_type
         close_socket(get_lowest_layer(stream()));
     }
 
+    // Returns `true` to send the compressed
+    // frame of a prepared message
+    bool
+    send_prepared_deflated(prepared_message const& m) const
+    {
+        return m.deflated() && wr_compress_opt &&
+            this->can_send_prepared_deflated(m.window_bits());
+    }
+
+    // Frame the messages at the front of the write
+    // queue which are sent together. Each message is
+    // sent as one frame, compressed and masked as
+    // required.
+    void
+    frame_queued(error_code& ec)
+    {
+        auto const n = wr_queue.begin_batch();
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            auto& e = wr_queue[i];
+            detail::frame_header fh;
+            fh.op = e.code;
+            fh.fin = true;
+            fh.rsv1 = false;
+            fh.rsv2 = false;
+            fh.rsv3 = false;
+            if( wr_compress_opt &&
+                e.size > 0 &&
+                this->compress_msg(e.data.data(), true))
+            {
+                deflate_queued(e.data, ec);
+                if(ec)
+                    return;
+                fh.rsv1 = true;
+            }
+            fh.len = e.data.size();
+            fh.mask = role == role_type::client;
+            if(fh.mask)
+            {
+                fh.key = create_mask();
+                detail::prepared_key key;
+                detail::prepare_key(key, fh.key);
+                detail::mask_inplace(e.data.data(), key);
+            }
+            e.fb.clear();
+            detail::write<flat_static_buffer_base>(e.fb, fh);
+        }
+    }
+
+    // Replace a queued payload with its compressed form
+    void
+    deflate_queued(flat_buffer& b, error_code& ec)
+    {
+        flat_buffer z;
+        deflate_msg(b.data(), z, ec);
+        if(ec)
+            return;
+        b = std::move(z);
+    }
+
+    // Append the compressed form of a complete message
+    template<class ConstBufferSequence>
+    void
+    deflate_msg(
+        ConstBufferSequence const& buffers,
+        flat_buffer& z,
+        error_code& ec)
+    {
+        buffers_suffix<ConstBufferSequence> cb(buffers);
+        std::size_t const chunk = (std::max)(
+            buffer_bytes(buffers) / 2, std::size_t{1024});
+        for(;;)
+        {
+            net::mutable_buffer out = z.prepare(chunk);
+            std::size_t n;
+            auto const more =
+                this->deflate(out, cb, true, n, ec);
+            if(ec)
+                return;
+            z.commit(out.size());
+            if(! more)
+                break;
+        }
+        this->do_context_takeover_write(role);
+    }
+
+    // Frame a range of complete messages for write_batch,
+    // returning the total payload size. The frame headers
+    // go into one arena, which also holds the payloads
+    // when they are compressed or masked; otherwise the
+    // caller's buffers are sent as they are. The caller
+    // must hold the write lock.
+    template<class MessageRange>
+    std::size_t
+    frame_batch(
+        MessageRange const& messages,
+        detail::opcode op,
+        error_code& ec)
+    {
+        begin_msg();
+        wr_batch.clear();
+        wr_batch_bufs.clear();
+        bool const copy =
+            wr_compress || role == role_type::client;
+        if(! copy)
+        {
+            // Headers must not move once referenced
+            using std::begin;
+            using std::end;
+            wr_batch.reserve(sizeof(detail::fh_buffer) *
+                static_cast<std::size_t>(std::distance(
+                    begin(messages), end(messages))));
+        }
+        std::size_t bytes = 0;
+        flat_buffer z;
+        for(auto const& m : messages)
+        {
+            detail::frame_header fh;
+            fh.op = op;
+            fh.fin = true;
+            fh.rsv1 = false;
+            fh.rsv2 = false;
+            fh.rsv3 = false;
+            fh.mask = role == role_type::client;
+            auto const n = buffer_bytes(m);
+            bytes += n;
+            if(! copy)
+            {
+                fh.len = n;
+                auto const pos = wr_batch.size();
+                detail::write(wr_batch, fh);
+                wr_batch_bufs.emplace_back(
+                    static_cast<char const*>(
+                        wr_batch.data().data()) + pos,
+                    wr_batch.size() - pos);
+                for(auto b : beast::buffers_range_ref(m))
+                    if(b.size() > 0)
+                        wr_batch_bufs.push_back(b);
+                continue;
+            }
+            net::mutable_buffer b;
+            if( wr_compress && n > 0 &&
+                this->compress_msg(m, true))
+            {
+                z.clear();
+                deflate_msg(m, z, ec);
+                if(ec)
+                    return 0;
+                fh.rsv1 = true;
+                fh.len = z.size();
+                if(fh.mask)
+                    fh.key = create_mask();
+                detail::write(wr_batch, fh);
+                b = wr_batch.prepare(z.size());
+                net::buffer_copy(b, z.data());
+            }
+            else
+            {
+                fh.len = n;
+                if(fh.mask)
+                    fh.key = create_mask();
+                detail::write(wr_batch, fh);
+                b = wr_batch.prepare(n);
+                net::buffer_copy(b, m);
+            }
+            if(fh.mask)
+            {
+                detail::prepared_key key;
+                detail::prepare_key(key, fh.key);
+                detail::mask_inplace(b, key);
+            }
+            wr_batch.commit(b.size());
+        }
+        if(copy)
+            wr_batch_bufs.push_back(wr_batch.data());
+        return bytes;
+    }
+
+    // Called after the last frame of a message is
+    // written. When hibernating, release the write
+    // buffer until the next message.
+    void
+    release_write()
+    {
+        if(! hibernate_opt)
+            return;
+        wr_buf.reset();
+        wr_batch = flat_buffer{};
+        wr_batch_bufs = {};
+    }
+
+    // Called before waiting for the next message.
+    // When hibernating, release the write buffer
+    // if no write is in progress.
+    void
+    release_read()
+    {
+        if( ! hibernate_opt ||
+            ! rd_done ||
+            rd_buf.size() > 0)
+            return;
+        if( ! wr_cont &&
+            ! wr_block.is_locked() &&
+            ! op_wr.has_value())
+            wr_buf.reset();
+    }
+
+    std::size_t
+    memory_usage() const
+    {
+        return sizeof(*this) +
+            (wr_buf ? wr_buf_size : 0) +
+            wr_batch.capacity() +
+            this->memory_usage_pmd();
+    }
+
     // Called just before sending
     // the first frame of each message
     void
@@ -248,6 +478,20 @@ struct stream<NextLayer, deflateSupported>::impl_type
         //
     }
 
+    // Called just before sending the first frame of
+    // each message, with the first of its payload.
+    // Applies the adaptive compression policy.
+    template<class ConstBufferSequence>
+    void
+    begin_msg(
+        ConstBufferSequence const& buffers,
+        bool fin)
+    {
+        begin_msg();
+        if(wr_compress)
+            wr_compress = this->compress_msg(buffers, fin);
+    }
+
     //--------------------------------------------------------------------------
 
     template<class Decorator>
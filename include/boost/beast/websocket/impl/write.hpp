@@ -19,18 +19,23 @@
 #include <boost/beast/core/buffers_range.hpp>
 #include <boost/beast/core/buffers_suffix.hpp>
 #include <boost/beast/core/flat_static_buffer.hpp>
+#include <boost/beast/core/span.hpp>
 #include <boost/beast/core/stream_traits.hpp>
 #include <boost/beast/core/detail/bind_continuation.hpp>
+#include <boost/beast/core/detail/buffers_ref.hpp>
 #include <boost/beast/core/detail/clamp.hpp>
 #include <boost/beast/core/detail/config.hpp>
 #include <boost/beast/websocket/detail/frame.hpp>
+#include <boost/beast/websocket/prepared_message.hpp>
 #include <boost/beast/websocket/impl/stream_impl.hpp>
 #include <boost/asio/coroutine.hpp>
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
+#include <boost/core/ignore_unused.hpp>
 #include <boost/throw_exception.hpp>
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 namespace boost {
 namespace beast {
@@ -86,7 +91,7 @@ public:
         // Set up the outgoing frame header
         if(! impl.wr_cont)
         {
-            impl.begin_msg();
+            impl.begin_msg(bs, fin);
             fh_.rsv1 = impl.wr_compress;
         }
         else
@@ -424,11 +429,14 @@ operator()(
     //--------------------------------------------------------------------------
 
     upcall:
+        if(fin_)
+            impl.release_write();
         impl.wr_block.unlock(this);
         impl.op_close.maybe_invoke()
             || impl.op_idle_ping.maybe_invoke()
             || impl.op_rd.maybe_invoke()
-            || impl.op_ping.maybe_invoke();
+            || impl.op_ping.maybe_invoke()
+            || impl.op_wq.maybe_invoke();
         this->complete(cont, ec, bytes_transferred_);
     }
 }
@@ -508,7 +516,7 @@ write_some(bool fin,
     detail::frame_header fh;
     if(! impl.wr_cont)
     {
-        impl.begin_msg();
+        impl.begin_msg(buffers, fin);
         fh.rsv1 = impl.wr_compress;
     }
     else
@@ -696,6 +704,8 @@ write_some(bool fin,
             cb.consume(n);
         }
     }
+    if(fin)
+        impl.release_write();
     return bytes_transferred;
 }
 
@@ -777,6 +787,577 @@ async_write(
             bs);
 }
 
+//------------------------------------------------------------------------------
+
+template<class NextLayer, bool deflateSupported>
+template<class Handler>
+class stream<NextLayer, deflateSupported>::write_prepared_op
+    : public beast::async_base<
+        Handler, beast::executor_type<stream>>
+    , public asio::coroutine
+{
+    boost::weak_ptr<impl_type> wp_;
+    prepared_message m_;
+    std::size_t bytes_transferred_ = 0;
+
+public:
+    static constexpr int id = 6; // for soft_mutex
+
+    template<class Handler_>
+    write_prepared_op(
+        Handler_&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        prepared_message const& m)
+        : beast::async_base<Handler,
+            beast::executor_type<stream>>(
+                std::forward<Handler_>(h),
+                    sp->stream().get_executor())
+        , wp_(sp)
+        , m_(m)
+    {
+        (*this)({}, 0, false);
+    }
+
+    void operator()(
+        error_code ec = {},
+        std::size_t bytes_transferred = 0,
+        bool cont = true)
+    {
+        boost::ignore_unused(bytes_transferred);
+        auto sp = wp_.lock();
+        if(! sp)
+        {
+            ec = net::error::operation_aborted;
+            bytes_transferred_ = 0;
+            return this->complete(cont, ec, bytes_transferred_);
+        }
+        auto& impl = *sp;
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            // Acquire the write lock
+            if(! impl.wr_block.try_lock(this))
+            {
+                BOOST_ASIO_CORO_YIELD
+                impl.op_wr.emplace(std::move(*this));
+                impl.wr_block.lock(this);
+                BOOST_ASIO_CORO_YIELD
+                net::post(std::move(*this));
+                BOOST_ASSERT(impl.wr_block.is_locked(this));
+            }
+            if(impl.check_stop_now(ec))
+                goto upcall;
+
+            // Client frames must be masked
+            if(impl.role != role_type::server)
+            {
+                ec = net::error::operation_not_supported;
+                goto upcall;
+            }
+
+            // A message started with write_some is unfinished
+            if(impl.wr_cont)
+            {
+                ec = net::error::in_progress;
+                goto upcall;
+            }
+
+            // Send the frame exactly as it was prepared
+            BOOST_ASIO_CORO_YIELD
+            net::async_write(impl.stream(),
+                m_.frame(impl.send_prepared_deflated(m_)),
+                    beast::detail::bind_continuation(std::move(*this)));
+            if(impl.check_stop_now(ec))
+                goto upcall;
+            bytes_transferred_ = m_.size();
+
+        upcall:
+            impl.wr_block.unlock(this);
+            impl.op_close.maybe_invoke()
+                || impl.op_idle_ping.maybe_invoke()
+                || impl.op_rd.maybe_invoke()
+                || impl.op_ping.maybe_invoke()
+                || impl.op_wq.maybe_invoke();
+            this->complete(cont, ec, bytes_transferred_);
+        }
+    }
+};
+
+template<class NextLayer, bool deflateSupported>
+struct stream<NextLayer, deflateSupported>::
+    run_write_prepared_op
+{
+    template<class WriteHandler>
+    void
+    operator()(
+        WriteHandler&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        prepared_message const& m)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+                void(error_code, std::size_t)>::value,
+            "WriteHandler type requirements not met");
+
+        write_prepared_op<
+            typename std::decay<WriteHandler>::type>(
+                std::forward<WriteHandler>(h),
+                sp,
+                m);
+    }
+};
+
+template<class NextLayer, bool deflateSupported>
+std::size_t
+stream<NextLayer, deflateSupported>::
+write_prepared(prepared_message const& message)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream type requirements not met");
+    error_code ec;
+    auto const bytes_transferred =
+        write_prepared(message, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    return bytes_transferred;
+}
+
+template<class NextLayer, bool deflateSupported>
+std::size_t
+stream<NextLayer, deflateSupported>::
+write_prepared(
+    prepared_message const& message,
+    error_code& ec)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream type requirements not met");
+    auto& impl = *impl_;
+    ec = {};
+    if(impl.check_stop_now(ec))
+        return 0;
+    if(impl.role != role_type::server)
+    {
+        ec = net::error::operation_not_supported;
+        return 0;
+    }
+    if(impl.wr_cont)
+    {
+        ec = net::error::in_progress;
+        return 0;
+    }
+    net::write(impl.stream(), message.frame(
+        impl.send_prepared_deflated(message)), ec);
+    if(impl.check_stop_now(ec))
+        return 0;
+    return message.size();
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+stream<NextLayer, deflateSupported>::
+async_write_prepared(
+    prepared_message const& message,
+    WriteHandler&& handler)
+{
+    static_assert(is_async_stream<next_layer_type>::value,
+        "AsyncStream type requirements not met");
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code, std::size_t)>(
+            run_write_prepared_op{},
+            handler,
+            impl_,
+            message);
+}
+
+//------------------------------------------------------------------------------
+
+template<class NextLayer, bool deflateSupported>
+template<class Handler>
+class stream<NextLayer, deflateSupported>::write_batch_op
+    : public beast::async_base<
+        Handler, beast::executor_type<stream>>
+    , public asio::coroutine
+{
+    boost::weak_ptr<impl_type> wp_;
+    std::vector<net::const_buffer> bufs_;
+    std::vector<span<net::const_buffer const>> msgs_;
+    detail::opcode op_;
+    std::size_t bytes_ = 0;
+    std::size_t bytes_transferred_ = 0;
+
+public:
+    static constexpr int id = 8; // for soft_mutex
+
+    template<class Handler_, class MessageRange>
+    write_batch_op(
+        Handler_&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        MessageRange const& messages)
+        : beast::async_base<Handler,
+            beast::executor_type<stream>>(
+                std::forward<Handler_>(h),
+                    sp->stream().get_executor())
+        , wp_(sp)
+        , op_(sp->wr_opcode)
+    {
+        // Copy the range, so it need not outlive this call.
+        // Framing waits for the write lock, because it uses
+        // the write buffers and the compressor of the stream.
+        for(auto const& m : messages)
+        {
+            auto const n = bufs_.size();
+            for(auto b : beast::buffers_range_ref(m))
+                bufs_.push_back(b);
+            msgs_.emplace_back(nullptr, bufs_.size() - n);
+        }
+        auto p = bufs_.data();
+        for(auto& m : msgs_)
+        {
+            m = {p, m.size()};
+            p += m.size();
+        }
+        (*this)({}, 0, false);
+    }
+
+    void operator()(
+        error_code ec = {},
+        std::size_t bytes_transferred = 0,
+        bool cont = true)
+    {
+        boost::ignore_unused(bytes_transferred);
+        auto sp = wp_.lock();
+        if(! sp)
+        {
+            ec = net::error::operation_aborted;
+            bytes_transferred_ = 0;
+            return this->complete(cont, ec, bytes_transferred_);
+        }
+        auto& impl = *sp;
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            // Acquire the write lock
+            if(! impl.wr_block.try_lock(this))
+            {
+                BOOST_ASIO_CORO_YIELD
+                impl.op_wr.emplace(std::move(*this));
+                impl.wr_block.lock(this);
+                BOOST_ASIO_CORO_YIELD
+                net::post(std::move(*this));
+                BOOST_ASSERT(impl.wr_block.is_locked(this));
+            }
+            if(impl.check_stop_now(ec))
+                goto upcall;
+
+            // A message started with write_some is unfinished
+            if(impl.wr_cont)
+            {
+                ec = net::error::in_progress;
+                goto upcall;
+            }
+            bytes_ = impl.frame_batch(msgs_, op_, ec);
+            if(impl.check_stop_now(ec))
+                goto upcall;
+
+            // Send every frame with one gather write
+            BOOST_ASIO_CORO_YIELD
+            net::async_write(impl.stream(),
+                beast::detail::make_buffers_ref(
+                    impl.wr_batch_bufs),
+                beast::detail::bind_continuation(std::move(*this)));
+            if(impl.check_stop_now(ec))
+                goto upcall;
+            bytes_transferred_ = bytes_;
+            impl.release_write();
+
+        upcall:
+            impl.wr_block.unlock(this);
+            impl.op_close.maybe_invoke()
+                || impl.op_idle_ping.maybe_invoke()
+                || impl.op_rd.maybe_invoke()
+                || impl.op_ping.maybe_invoke()
+                || impl.op_wq.maybe_invoke();
+            this->complete(cont, ec, bytes_transferred_);
+        }
+    }
+};
+
+template<class NextLayer, bool deflateSupported>
+struct stream<NextLayer, deflateSupported>::
+    run_write_batch_op
+{
+    template<class WriteHandler, class MessageRange>
+    void
+    operator()(
+        WriteHandler&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        MessageRange const* messages)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+                void(error_code, std::size_t)>::value,
+            "WriteHandler type requirements not met");
+
+        write_batch_op<
+            typename std::decay<WriteHandler>::type>(
+                std::forward<WriteHandler>(h),
+                sp,
+                *messages);
+    }
+};
+
+template<class NextLayer, bool deflateSupported>
+template<class MessageRange>
+std::size_t
+stream<NextLayer, deflateSupported>::
+write_batch(MessageRange const& messages)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream type requirements not met");
+    error_code ec;
+    auto const bytes_transferred =
+        write_batch(messages, ec);
+    if(ec)
+        BOOST_THROW_EXCEPTION(system_error{ec});
+    return bytes_transferred;
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class MessageRange>
+std::size_t
+stream<NextLayer, deflateSupported>::
+write_batch(MessageRange const& messages, error_code& ec)
+{
+    static_assert(is_sync_stream<next_layer_type>::value,
+        "SyncStream type requirements not met");
+    auto& impl = *impl_;
+    ec = {};
+    if(impl.check_stop_now(ec))
+        return 0;
+    if(impl.wr_cont)
+    {
+        ec = net::error::in_progress;
+        return 0;
+    }
+    auto const bytes = impl.frame_batch(
+        messages, impl.wr_opcode, ec);
+    if(impl.check_stop_now(ec))
+        return 0;
+    net::write(impl.stream(), impl.wr_batch_bufs, ec);
+    if(impl.check_stop_now(ec))
+        return 0;
+    impl.release_write();
+    return bytes;
+}
+
+template<class NextLayer, bool deflateSupported>
+template<class MessageRange, class WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+stream<NextLayer, deflateSupported>::
+async_write_batch(
+    MessageRange const& messages,
+    WriteHandler&& handler)
+{
+    static_assert(is_async_stream<next_layer_type>::value,
+        "AsyncStream type requirements not met");
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code, std::size_t)>(
+            run_write_batch_op{},
+            handler,
+            impl_,
+            &messages);
+}
+
+//------------------------------------------------------------------------------
+
+template<class NextLayer, bool deflateSupported>
+template<class Handler>
+class stream<NextLayer, deflateSupported>::write_queued_op
+    : public beast::async_base<
+        Handler, beast::executor_type<stream>>
+    , public asio::coroutine
+{
+    boost::weak_ptr<impl_type> wp_;
+    detail::write_queue::entry* e_ = nullptr;
+    std::size_t bytes_transferred_ = 0;
+    bool queued_ = false;
+
+public:
+    static constexpr int id = 7; // for soft_mutex
+
+    template<class Handler_, class Buffers>
+    write_queued_op(
+        Handler_&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        Buffers const& bs)
+        : beast::async_base<Handler,
+            beast::executor_type<stream>>(
+                std::forward<Handler_>(h),
+                    sp->stream().get_executor())
+        , wp_(sp)
+    {
+        auto& impl = *sp;
+        auto const n = buffer_bytes(bs);
+        if(! impl.wr_queue.accept(n))
+        {
+            error_code ec = error::write_queue_full;
+            this->complete(false, ec, bytes_transferred_);
+            return;
+        }
+        auto& e = impl.wr_queue.push(n, impl.wr_opcode);
+        e_ = &e;
+        e.data.commit(net::buffer_copy(
+            e.data.prepare(n), bs));
+        if(impl.wr_queue.size() > 1)
+        {
+            // Wait behind the messages ahead of this one
+            queued_ = true;
+            e.op.emplace(std::move(*this));
+            return;
+        }
+        (*this)({}, 0, false);
+    }
+
+    void operator()(
+        error_code ec = {},
+        std::size_t bytes_transferred = 0,
+        bool cont = true)
+    {
+        boost::ignore_unused(bytes_transferred);
+        auto sp = wp_.lock();
+        if(! sp)
+        {
+            ec = net::error::operation_aborted;
+            bytes_transferred_ = 0;
+            return this->complete(cont, ec, bytes_transferred_);
+        }
+        auto& impl = *sp;
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            if(queued_)
+            {
+                // Resumed either because the message was sent
+                // in a batch written by another operation, or
+                // because it is now at the front of the queue.
+                queued_ = false;
+                if(e_->done)
+                {
+                    ec = e_->ec;
+                    if(! ec)
+                        bytes_transferred_ = e_->size;
+                    return this->complete(
+                        false, ec, bytes_transferred_);
+                }
+                BOOST_ASIO_CORO_YIELD
+                net::post(std::move(*this));
+            }
+
+            // Acquire the write lock, once any message
+            // started with write_some is finished
+            if( (impl.wr_cont && impl.status_ == status::open) ||
+                ! impl.wr_block.try_lock(this))
+            {
+            do_suspend:
+                BOOST_ASIO_CORO_YIELD
+                impl.op_wq.emplace(std::move(*this));
+                if(impl.wr_cont && impl.status_ == status::open)
+                    goto do_suspend;
+                impl.wr_block.lock(this);
+                BOOST_ASIO_CORO_YIELD
+                net::post(std::move(*this));
+                BOOST_ASSERT(impl.wr_block.is_locked(this));
+            }
+            if(impl.check_stop_now(ec))
+                goto upcall;
+
+            // Send this message and the ones behind it
+            BOOST_ASSERT(&impl.wr_queue.front() == e_);
+            impl.frame_queued(ec);
+            if(impl.check_stop_now(ec))
+                goto upcall;
+            BOOST_ASIO_CORO_YIELD
+            net::async_write(impl.stream(),
+                beast::detail::make_buffers_ref(
+                    impl.wr_queue.buffers()),
+                beast::detail::bind_continuation(std::move(*this)));
+            if(impl.check_stop_now(ec))
+                goto upcall;
+            bytes_transferred_ = e_->size;
+
+        upcall:
+            impl.wr_block.unlock(this);
+            impl.wr_queue.end_batch(ec);
+            impl.op_close.maybe_invoke()
+                || impl.op_idle_ping.maybe_invoke()
+                || impl.op_rd.maybe_invoke()
+                || impl.op_ping.maybe_invoke()
+                || impl.op_wr.maybe_invoke();
+            // The next message's operation writes the next batch
+            if(! impl.wr_queue.empty())
+                impl.wr_queue.front().op.invoke();
+            this->complete(cont, ec, bytes_transferred_);
+        }
+    }
+};
+
+template<class NextLayer, bool deflateSupported>
+struct stream<NextLayer, deflateSupported>::
+    run_write_queued_op
+{
+    template<class WriteHandler, class Buffers>
+    void
+    operator()(
+        WriteHandler&& h,
+        boost::shared_ptr<impl_type> const& sp,
+        Buffers const& b)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+                void(error_code, std::size_t)>::value,
+            "WriteHandler type requirements not met");
+
+        write_queued_op<
+            typename std::decay<WriteHandler>::type>(
+                std::forward<WriteHandler>(h),
+                sp,
+                b);
+    }
+};
+
+template<class NextLayer, bool deflateSupported>
+template<class ConstBufferSequence, class WriteHandler>
+BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+stream<NextLayer, deflateSupported>::
+async_write_queued(
+    ConstBufferSequence const& bs, WriteHandler&& handler)
+{
+    static_assert(is_async_stream<next_layer_type>::value,
+        "AsyncStream type requirements not met");
+    static_assert(net::is_const_buffer_sequence<
+        ConstBufferSequence>::value,
+            "ConstBufferSequence type requirements not met");
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code, std::size_t)>(
+            run_write_queued_op{},
+            handler,
+            impl_,
+            bs);
+}
+
 } // websocket
 } // beast
 } // boost
@@ -11,6 +11,12 @@
 #define BOOST_BEAST_WEBSOCKET_OPTION_HPP
 
 #include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/websocket/deflate_budget.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
 
 namespace boost {
 namespace beast {
@@ -55,6 +61,94 @@ struct permessage_deflate
 
     /// Deflate memory level, 1..9
     int memLevel = 4;
+
+    /** Smallest message payload to compress
+
+        Complete messages smaller than this are sent uncompressed.
+        The size is only known when the first frame of a message
+        is also its last, so messages written in pieces with
+        @ref stream::write_some are compressed regardless.
+    */
+    std::size_t msg_size_threshold = 0;
+
+    /** `true` to send messages which look incompressible uncompressed
+
+        The byte entropy of the first kilobyte of each message is
+        measured, and when it is close to that of random data, as
+        with most images, archives and encrypted payloads, the
+        message is sent uncompressed.
+    */
+    bool skip_incompressible = false;
+
+    /** Most time spent compressing, in nanoseconds per input byte
+
+        When not zero, the time taken to compress each message is
+        measured. When the cost of the last message was above this
+        budget, the level used for the next message is lowered by
+        one, down to 1. When it was below half of the budget, the
+        level is raised by one, up to `compLevel`. A `compLevel` of
+        0 is never changed. The cost grows when the CPU is busy, so
+        this lowers the level under load.
+    */
+    std::size_t max_ns_per_byte = 0;
+
+    /** A memory budget shared with other streams, or `nullptr`
+
+        When set, the window bits offered or accepted, and the
+        window bits and memory level used to compress, are
+        lowered as needed for the stream to fit in its share
+        of the budget.
+
+        @see deflate_budget
+    */
+    std::shared_ptr<deflate_budget> budget;
+
+    /** A preset dictionary, or `nullptr`
+
+        When set, the compressor and the decompressor are primed
+        with this dictionary when they start, and again before
+        each message in a direction without context takeover.
+        Small messages which share strings with the dictionary,
+        such as JSON documents of a known schema, then compress
+        far better. Only the last window of the dictionary is
+        used.
+
+        The extension negotiation does not convey a dictionary,
+        so this must only be set when both peers are known to
+        use the same one, as in a private protocol. Otherwise
+        the peer fails to decompress messages.
+
+        @see zlib::deflate_stream::dictionary
+    */
+    std::shared_ptr<std::string const> dictionary;
+};
+
+/** permessage-deflate statistics for one stream.
+
+    These values describe the messages sent on a stream since
+    permessage-deflate was negotiated.
+
+    @see stream::deflate_statistics
+*/
+struct deflate_stats
+{
+    /// The number of messages sent compressed
+    std::uint64_t messages_compressed = 0;
+
+    /// The number of messages sent uncompressed by the adaptive policy
+    std::uint64_t messages_skipped = 0;
+
+    /// The number of payload bytes given to the compressor
+    std::uint64_t bytes_in = 0;
+
+    /// The number of compressed bytes produced
+    std::uint64_t bytes_out = 0;
+
+    /// The total time spent compressing
+    std::chrono::nanoseconds time{0};
+
+    /// The compression level in use for the next message
+    int level = 0;
 };
 
 } // websocket
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_WEBSOCKET_PREPARED_MESSAGE_HPP
+#define BOOST_BEAST_WEBSOCKET_PREPARED_MESSAGE_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/websocket/option.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+template<
+    class NextLayer,
+    bool deflateSupported>
+class stream;
+
+/** A complete message framed once for sending to many streams.
+
+    Objects of this type hold a message payload already encoded
+    as a single, final, unmasked WebSocket frame, as a server
+    sends it. When constructed with @ref permessage_deflate
+    options, the payload is also compressed once, from an empty
+    window, and the compressed frame is kept alongside the plain
+    one if it is smaller.
+
+    The frames are immutable and shared between copies, so
+    copying a prepared message is cheap. A server broadcasting
+    the same message to many sessions constructs it once and
+    passes a copy to @ref stream::async_write_prepared for each
+    session, which writes the stored bytes without framing,
+    compressing, or copying the payload again.
+
+    The compressed frame is only sent on connections where the
+    negotiated permessage-deflate parameters include
+    `server_no_context_takeover` and allow the window size used
+    here. On any other connection the plain frame is sent.
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Safe.
+*/
+class prepared_message
+{
+    template<class, bool>
+    friend class stream;
+
+    struct impl_type;
+
+    boost::shared_ptr<impl_type> impl_;
+
+public:
+    /** Constructor
+
+        The payload is copied and framed as a text or binary message.
+
+        @param binary `true` for a binary message, `false` for text.
+
+        @param payload The message payload.
+    */
+    template<class ConstBufferSequence>
+    prepared_message(
+        bool binary,
+        ConstBufferSequence const& payload);
+
+    /** Constructor
+
+        The payload is copied and framed as a text or binary message.
+        It is then compressed with the level, memory level, and server
+        window size in `opts`.
+
+        @param binary `true` for a binary message, `false` for text.
+
+        @param payload The message payload.
+
+        @param opts The permessage-deflate settings used by the
+        streams which will send this message.
+    */
+    template<class ConstBufferSequence>
+    prepared_message(
+        bool binary,
+        ConstBufferSequence const& payload,
+        permessage_deflate const& opts);
+
+    /// Returns `true` if this is a binary message
+    BOOST_BEAST_DECL
+    bool
+    binary() const noexcept;
+
+    /// Returns the size of the payload in bytes
+    BOOST_BEAST_DECL
+    std::size_t
+    size() const noexcept;
+
+    /// Returns `true` if a compressed frame is available
+    BOOST_BEAST_DECL
+    bool
+    deflated() const noexcept;
+
+private:
+    BOOST_BEAST_DECL
+    net::mutable_buffer
+    construct(bool binary, std::size_t size);
+
+    BOOST_BEAST_DECL
+    void
+    construct_deflated(permessage_deflate const& opts);
+
+    BOOST_BEAST_DECL
+    net::const_buffer
+    frame(bool deflated) const noexcept;
+
+    BOOST_BEAST_DECL
+    int
+    window_bits() const noexcept;
+};
+
+} // websocket
+} // beast
+} // boost
+
+#include <boost/beast/websocket/impl/prepared_message.hpp>
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/websocket/impl/prepared_message.ipp>
+#endif
+
+#endif
@@ -13,6 +13,7 @@
 #include <boost/beast/core/detail/config.hpp>
 #include <boost/beast/websocket/error.hpp>
 #include <boost/beast/websocket/option.hpp>
+#include <boost/beast/websocket/prepared_message.hpp>
 #include <boost/beast/websocket/rfc6455.hpp>
 #include <boost/beast/websocket/stream_base.hpp>
 #include <boost/beast/websocket/stream_fwd.hpp>
@@ -295,6 +296,29 @@ public:
     close_reason const&
     reason() const noexcept;
 
+    /** Returns the number of bytes of memory used by the stream.
+
+        This includes the stream's state and the next layer object,
+        along with the write buffer and permessage-deflate state
+        currently allocated or borrowed. It does not include memory owned by
+        the next layer, or by pending asynchronous operations.
+
+        The value may be used to measure the effect of the
+        @ref hibernate option.
+    */
+    std::size_t
+    memory_usage() const noexcept;
+
+    /** Returns permessage-deflate statistics for messages sent.
+
+        The statistics cover messages written since the extension
+        was negotiated, and may be used to tune the adaptive
+        compression settings in @ref permessage_deflate. When the
+        extension is not in use, every value is zero.
+    */
+    deflate_stats
+    deflate_statistics() const noexcept;
+
     /** Returns a suggested maximum buffer size for the next call to read.
 
         This function returns a reasonable upper limit on the number
@@ -475,6 +499,39 @@ public:
     void
     control_callback();
 
+    /** Set the hibernation option.
+
+        When this option is set, the stream releases its write
+        buffer when a complete message has been written, and when
+        the stream waits for the next message with no received data
+        buffered and no write in progress. The buffer is allocated
+        again when the next message is sent. This trades some time
+        for each message against a smaller footprint for connections
+        which are mostly idle.
+
+        Permessage-deflate compressors and decompressors which the
+        negotiated parameters reset after every message are not
+        held between messages whether or not this option is set.
+        They are borrowed from a pool shared by the streams of the
+        same execution context, for the length of one message.
+
+        The default setting is off.
+
+        @param value `true` if the stream should release idle memory.
+
+        @par Example
+        Enabling hibernation:
+        @code
+            ws.hibernate(true);
+        @endcode
+    */
+    void
+    hibernate(bool value);
+
+    /// Returns `true` if the hibernation option is set.
+    bool
+    hibernate() const;
+
     /** Set the maximum incoming message size option.
 
         Sets the largest permissible incoming message size. Message
@@ -499,6 +556,46 @@ public:
     std::size_t
     read_message_max() const;
 
+    /** Set the write queue limits.
+
+        These limits apply to messages sent with
+        @ref async_write_queued. When a message would bring the
+        queue over either limit, the operation completes with
+        @ref error::write_queue_full and the message is not sent.
+        A message is always accepted when the queue is empty, so
+        a single message larger than the byte limit can be sent.
+
+        The defaults are 16 megabytes and 4096 messages.
+
+        @par Example
+        Allowing at most one megabyte of queued messages:
+        @code
+            ws.write_queue_limit(1024 * 1024, 4096);
+        @endcode
+
+        @param bytes The most payload bytes which may be queued.
+
+        @param messages The most messages which may be queued.
+    */
+    void
+    write_queue_limit(std::size_t bytes, std::size_t messages);
+
+    /** Returns the number of payload bytes in the write queue.
+
+        This counts messages sent with @ref async_write_queued
+        whose operations have not yet completed.
+    */
+    std::size_t
+    write_queue_bytes() const noexcept;
+
+    /** Returns the number of messages in the write queue.
+
+        This counts messages sent with @ref async_write_queued
+        whose operations have not yet completed.
+    */
+    std::size_t
+    write_queue_size() const noexcept;
+
     /** Set whether the PRNG is cryptographically secure
 
         This controls whether or not the source of pseudo-random
@@ -2413,6 +2510,372 @@ public:
             net::default_completion_token_t<
                 executor_type>{});
 
+    /** Write a prepared message.
+
+        This function is used to write a message which was framed
+        ahead of time, usually to send the same message to many
+        streams.
+
+        The call blocks until one of the following is true:
+
+        @li The message is written.
+
+        @li An error occurs.
+
+        The algorithm, known as a <em>composed operation</em>, is implemented
+        in terms of calls to the next layer's `write_some` function.
+
+        The message is sent as a single frame with the opcode chosen
+        when it was prepared; the @ref binary and @ref auto_fragment
+        options are not used. The compressed frame of the message is
+        sent if it has one and the negotiated permessage-deflate
+        parameters allow it. Otherwise the uncompressed frame is sent.
+
+        On a stream in the client role, which must mask its frames,
+        the operation fails with `net::error::operation_not_supported`.
+        If a message started with @ref write_some is not finished, it
+        fails with `net::error::in_progress`. Nothing is sent in either
+        case.
+
+        @param message The message to send.
+
+        @return The size of the message payload.
+
+        @throws system_error Thrown on failure.
+    */
+    std::size_t
+    write_prepared(prepared_message const& message);
+
+    /** Write a prepared message.
+
+        This function is used to write a message which was framed
+        ahead of time, usually to send the same message to many
+        streams.
+
+        The call blocks until one of the following is true:
+
+        @li The message is written.
+
+        @li An error occurs.
+
+        The algorithm, known as a <em>composed operation</em>, is implemented
+        in terms of calls to the next layer's `write_some` function.
+
+        The message is sent as a single frame with the opcode chosen
+        when it was prepared; the @ref binary and @ref auto_fragment
+        options are not used. The compressed frame of the message is
+        sent if it has one and the negotiated permessage-deflate
+        parameters allow it. Otherwise the uncompressed frame is sent.
+
+        On a stream in the client role, which must mask its frames,
+        the operation fails with `net::error::operation_not_supported`.
+        If a message started with @ref write_some is not finished, it
+        fails with `net::error::in_progress`. Nothing is sent in either
+        case.
+
+        @param message The message to send.
+
+        @param ec Set to indicate what error occurred, if any.
+
+        @return The size of the message payload.
+    */
+    std::size_t
+    write_prepared(
+        prepared_message const& message,
+        error_code& ec);
+
+    /** Write a prepared message asynchronously.
+
+        This function is used to asynchronously write a message which
+        was framed ahead of time, usually to send the same message to
+        many streams.
+
+        This call always returns immediately. The asynchronous operation
+        will continue until one of the following conditions is true:
+
+        @li The message is written.
+
+        @li An error occurs.
+
+        The algorithm, known as a <em>composed asynchronous operation</em>,
+        is implemented in terms of calls to the next layer's
+        `async_write_some` function. The program must ensure that no other
+        calls to @ref write, @ref write_some, @ref write_prepared,
+        @ref async_write, @ref async_write_some, or
+        @ref async_write_prepared are performed until this operation
+        completes.
+
+        The message is sent as a single frame with the opcode chosen
+        when it was prepared; the @ref binary and @ref auto_fragment
+        options are not used. The compressed frame of the message is
+        sent if it has one and the negotiated permessage-deflate
+        parameters allow it. Otherwise the uncompressed frame is sent.
+
+        On a stream in the client role, which must mask its frames,
+        the operation fails with `net::error::operation_not_supported`.
+        If a message started with @ref write_some is not finished, it
+        fails with `net::error::in_progress`. Nothing is sent in either
+        case.
+
+        @param message The message to send. The operation keeps a
+        copy, which shares the frame bytes with the caller's object.
+
+        @param handler The completion handler to invoke when the operation
+        completes. The implementation takes ownership of the handler by
+        performing a decay-copy. The equivalent function signature of
+        the handler must be:
+        @code
+        void handler(
+            error_code const& ec,           // Result of operation
+            std::size_t bytes_transferred   // The size of the message
+                                            // payload, or zero if an
+                                            // error occurred.
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        BOOST_BEAST_ASYNC_TPARAM2 WriteHandler =
+            net::default_completion_token_t<
+                executor_type>>
+    BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+    async_write_prepared(
+        prepared_message const& message,
+        WriteHandler&& handler =
+            net::default_completion_token_t<
+                executor_type>{});
+
+    /** Write several complete messages.
+
+        This function is used to write many small messages at once.
+        Each element of the range is the payload of one complete
+        message. The frame headers of all of the messages are built
+        into a single buffer owned by the stream, and the frames are
+        sent with one gather write to the next layer.
+
+        The call blocks until one of the following is true:
+
+        @li All of the messages are written.
+
+        @li An error occurs.
+
+        The algorithm, known as a <em>composed operation</em>, is implemented
+        in terms of calls to the next layer's `write_some` function.
+
+        The current setting of the @ref binary option controls whether
+        the message opcodes are set to text or binary. Each message is
+        sent as a single frame; the @ref auto_fragment option is not
+        used. When permessage-deflate was negotiated, each message is
+        compressed. In the client role, or when compressing, the
+        payloads are copied into the stream's buffer and masked there.
+        Otherwise the payloads are sent from the caller's buffers.
+
+        If a message started with @ref write_some is not finished,
+        the operation fails with `net::error::in_progress` and
+        nothing is sent.
+
+        @param messages A forward range whose elements each satisfy
+        <em>ConstBufferSequence</em>, such as
+        `std::vector<net::const_buffer>`. Each element is the entire
+        payload of one message.
+
+        @return The total size of the message payloads.
+
+        @throws system_error Thrown on failure.
+    */
+    template<class MessageRange>
+    std::size_t
+    write_batch(MessageRange const& messages);
+
+    /** Write several complete messages.
+
+        This function is used to write many small messages at once.
+        Each element of the range is the payload of one complete
+        message. The frame headers of all of the messages are built
+        into a single buffer owned by the stream, and the frames are
+        sent with one gather write to the next layer.
+
+        The call blocks until one of the following is true:
+
+        @li All of the messages are written.
+
+        @li An error occurs.
+
+        The algorithm, known as a <em>composed operation</em>, is implemented
+        in terms of calls to the next layer's `write_some` function.
+
+        The current setting of the @ref binary option controls whether
+        the message opcodes are set to text or binary. Each message is
+        sent as a single frame; the @ref auto_fragment option is not
+        used. When permessage-deflate was negotiated, each message is
+        compressed. In the client role, or when compressing, the
+        payloads are copied into the stream's buffer and masked there.
+        Otherwise the payloads are sent from the caller's buffers.
+
+        If a message started with @ref write_some is not finished,
+        the operation fails with `net::error::in_progress` and
+        nothing is sent.
+
+        @param messages A forward range whose elements each satisfy
+        <em>ConstBufferSequence</em>, such as
+        `std::vector<net::const_buffer>`. Each element is the entire
+        payload of one message.
+
+        @param ec Set to indicate what error occurred, if any.
+
+        @return The total size of the message payloads.
+    */
+    template<class MessageRange>
+    std::size_t
+    write_batch(MessageRange const& messages, error_code& ec);
+
+    /** Write several complete messages asynchronously.
+
+        This function is used to asynchronously write many small
+        messages at once. Each element of the range is the payload of
+        one complete message. The frame headers of all of the messages
+        are built into a single buffer owned by the stream, and the
+        frames are sent with one gather write to the next layer.
+
+        This call always returns immediately. The asynchronous operation
+        will continue until one of the following conditions is true:
+
+        @li All of the messages are written.
+
+        @li An error occurs.
+
+        The algorithm, known as a <em>composed asynchronous operation</em>,
+        is implemented in terms of calls to the next layer's
+        `async_write_some` function. The program must ensure that no other
+        calls to @ref write, @ref write_some, @ref write_batch,
+        @ref async_write, @ref async_write_some, or
+        @ref async_write_batch are performed until this operation
+        completes.
+
+        The current setting of the @ref binary option controls whether
+        the message opcodes are set to text or binary. Each message is
+        sent as a single frame; the @ref auto_fragment option is not
+        used. When permessage-deflate was negotiated, each message is
+        compressed. In the client role, or when compressing, the
+        payloads are copied into the stream's buffer and masked there.
+        Otherwise the payloads are sent from the caller's buffers.
+
+        If a message started with @ref write_some is not finished,
+        the operation fails with `net::error::in_progress` and
+        nothing is sent.
+
+        @param messages A forward range whose elements each satisfy
+        <em>ConstBufferSequence</em>, such as
+        `std::vector<net::const_buffer>`. Each element is the entire
+        payload of one message. The range is read before this function
+        returns, but the memory referenced by its buffers must remain
+        valid until the completion handler is called.
+
+        @param handler The completion handler to invoke when the operation
+        completes. The implementation takes ownership of the handler by
+        performing a decay-copy. The equivalent function signature of
+        the handler must be:
+        @code
+        void handler(
+            error_code const& ec,           // Result of operation
+            std::size_t bytes_transferred   // The total size of the
+                                            // message payloads, or zero
+                                            // if an error occurred.
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        class MessageRange,
+        BOOST_BEAST_ASYNC_TPARAM2 WriteHandler =
+            net::default_completion_token_t<
+                executor_type>>
+    BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+    async_write_batch(
+        MessageRange const& messages,
+        WriteHandler&& handler =
+            net::default_completion_token_t<
+                executor_type>{});
+
+    /** Queue a complete message to be written asynchronously.
+
+        This function is used to asynchronously write a complete message
+        through a queue owned by the stream. Unlike @ref async_write,
+        it may be called again before earlier calls complete. Messages
+        are sent in the order they were queued.
+
+        This call always returns immediately. The asynchronous operation
+        will continue until one of the following conditions is true:
+
+        @li The complete message is written.
+
+        @li An error occurs.
+
+        The payload is copied into the queue, so the caller's buffers
+        do not need to remain valid. Messages at the front of the queue
+        are sent together, with a single call to the next layer's
+        `async_write_some` where it accepts all of the data, up to a
+        total of 64 messages or 64 kilobytes. Ping, pong, and close
+        frames, and messages sent with @ref async_write, are written
+        between those batches, ahead of messages still queued.
+
+        If queueing the message would bring the queue over the limits
+        set with @ref write_queue_limit, the operation completes with
+        @ref error::write_queue_full, without sending the message. The
+        program can check @ref write_queue_bytes to hold back messages
+        before the limit is reached.
+
+        When an error occurs while writing, every message in the queue
+        completes with that error.
+
+        The current setting of the @ref binary option, at the time of
+        the call, controls whether the message opcode is set to text or
+        binary. Each message is sent as a single frame; the
+        @ref auto_fragment option is not used. The message is compressed
+        if permessage-deflate was negotiated.
+
+        The program must not call @ref write or @ref write_some while
+        queued messages are outstanding. A message started with
+        @ref async_write_some is finished before queued messages are sent.
+
+        @param buffers A buffer sequence containing the entire message
+        payload, which is copied.
+
+        @param handler The completion handler to invoke when the operation
+        completes. The implementation takes ownership of the handler by
+        performing a decay-copy. The equivalent function signature of
+        the handler must be:
+        @code
+        void handler(
+            error_code const& ec,           // Result of operation
+            std::size_t bytes_transferred   // The size of the message
+                                            // payload, or zero if an
+                                            // error occurred.
+        );
+        @endcode
+        Regardless of whether the asynchronous operation completes
+        immediately or not, the handler will not be invoked from within
+        this function. Invocation of the handler will be performed in a
+        manner equivalent to using `net::post`.
+    */
+    template<
+        class ConstBufferSequence,
+        BOOST_BEAST_ASYNC_TPARAM2 WriteHandler =
+            net::default_completion_token_t<
+                executor_type>>
+    BOOST_BEAST_ASYNC_RESULT2(WriteHandler)
+    async_write_queued(
+        ConstBufferSequence const& buffers,
+        WriteHandler&& handler =
+            net::default_completion_token_t<
+                executor_type>{});
+
     /** Write some message data.
 
         This function is used to send part of a message.
@@ -2676,6 +3139,9 @@ private:
     template<class>         class response_op;
     template<class, class>  class write_some_op;
     template<class, class>  class write_op;
+    template<class>         class write_prepared_op;
+    template<class>         class write_batch_op;
+    template<class>         class write_queued_op;
 
     struct run_accept_op;
     struct run_close_op;
@@ -2687,6 +3153,9 @@ private:
     struct run_response_op;
     struct run_write_some_op;
     struct run_write_op;
+    struct run_write_prepared_op;
+    struct run_write_batch_op;
+    struct run_write_queued_op;
 
     static void default_decorate_req(request_type&) {}
     static void default_decorate_res(response_type&) {}
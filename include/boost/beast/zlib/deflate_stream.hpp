@@ -52,9 +52,11 @@ namespace zlib {
     (zlib format), rfc1951 (deflate format) and rfc1952 (gzip format).
 */
 
-/** Raw deflate compressor.
+/** Deflate compressor.
 
     This is a port of zlib's "deflate" functionality to C++.
+    By default the stream produces raw deflate data; @ref reset
+    can select the zlib or gzip format instead.
 */
 class deflate_stream
     : private detail::deflate_stream
@@ -91,6 +93,12 @@ public:
         after a reset, any required internal buffers are not
         dynamically allocated until needed.
 
+        @param wrap The container format of the output. For
+        the zlib and gzip formats, the header is written
+        before the compressed data, the check value is updated
+        as input is consumed, and the trailer is written when
+        the stream is finished with `Flush::finish`.
+
         @note Any unprocessed input or pending output from
         previous calls are discarded.
     */
@@ -99,15 +107,17 @@ public:
         int level,
         int windowBits,
         int memLevel,
-        Strategy strategy)
+        Strategy strategy,
+        Wrap wrap = Wrap::none)
     {
-        doReset(level, windowBits, memLevel, strategy);
+        doReset(level, windowBits, memLevel, strategy, wrap);
     }
 
     /** Reset the stream without deallocating memory.
 
         This function performs the equivalent of calling `clear`
-        followed by `reset` with the same compression settings,
+        followed by `reset` with the same compression settings
+        and container format,
         without deallocating the internal buffers.
 
         @note Any unprocessed input or pending output from
@@ -134,6 +144,18 @@ public:
         doClear();
     }
 
+    /** Returns the number of bytes of dynamically allocated memory.
+
+        This is the size of the window, hash chains and pending
+        output allocated by the stream, which is zero until the
+        first call to `write` after construction or `clear`.
+    */
+    std::size_t
+    allocated_size() const
+    {
+        return doAllocatedSize();
+    }
+
     /** Returns the upper limit on the size of a compressed block.
 
         This function makes a conservative estimate of the maximum number
@@ -170,6 +192,40 @@ public:
         doTune(good_length, max_lazy, nice_length, max_chain);
     }
 
+    /** Set the preset dictionary.
+
+        This function primes the compressor with data which is
+        likely to occur in the input, such as the common strings
+        of small messages in the same protocol, so that matches
+        may refer to it from the first byte. The most likely
+        strings should be at the end of the dictionary. Only the
+        last window of the dictionary is used. The decompressor
+        must be given the same dictionary.
+
+        For the zlib format, this must be called after a reset
+        and before the first call to @ref write, and the header
+        identifies the dictionary by its Adler-32 check value.
+        For raw deflate it may also be called after a flush
+        which consumed all the input. The gzip format does not
+        support a dictionary.
+
+        @param dict A pointer to the dictionary.
+
+        @param size The size of the dictionary in bytes.
+
+        @param ec Set to `error::stream_error` if a dictionary
+        cannot be set at this point of the stream.
+    */
+    void
+    dictionary(
+        void const* dict,
+        std::size_t size,
+        error_code& ec)
+    {
+        doDictionary(static_cast<Byte const*>(dict),
+            static_cast<uInt>(size), ec);
+    }
+
     /** Compress input and write output.
 
         This function compresses as much data as possible, and stops when
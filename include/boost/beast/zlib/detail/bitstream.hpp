@@ -78,6 +78,15 @@ public:
         v_ = 0;
     }
 
+    // replace the contents of the reservoir
+    void
+    assign(value_type v, unsigned n)
+    {
+        BOOST_ASSERT(n <= sizeof(v_)*8);
+        v_ = v;
+        n_ = n;
+    }
+
     // flush to the next byte boundary
     void
     flush_byte()
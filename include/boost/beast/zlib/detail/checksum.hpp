@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+// This is a derivative work based on Zlib, copyright below:
+/*
+    Copyright (C) 1995-2013 Jean-loup Gailly and Mark Adler
+
+    This software is provided 'as-is', without any express or implied
+    warranty.  In no event will the authors be held liable for any damages
+    arising from the use of this software.
+
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+       claim that you wrote the original software. If you use this software
+       in a product, an acknowledgment in the product documentation would be
+       appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be
+       misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+
+    Jean-loup Gailly        Mark Adler
+    jloup@gzip.org          madler@alumni.caltech.edu
+
+    The data format used by the zlib library is described by RFCs (Request for
+    Comments) 1950 to 1952 in the files http://tools.ietf.org/html/rfc1950
+    (zlib format), rfc1951 (deflate format) and rfc1952 (gzip format).
+*/
+
+#ifndef BOOST_BEAST_ZLIB_DETAIL_CHECKSUM_HPP
+#define BOOST_BEAST_ZLIB_DETAIL_CHECKSUM_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace boost {
+namespace beast {
+namespace zlib {
+namespace detail {
+
+/*  The check values of the zlib (RFC 1950) and gzip (RFC 1952)
+    formats. Each returns the check value of the bytes so far,
+    given the check value of the bytes before them, which is 1
+    for Adler-32 and 0 for CRC-32 at the start of a stream.
+
+    Wide-vector kernels are selected at runtime: CRC-32 folds
+    with carry-less multiplication (PCLMULQDQ) and Adler-32 sums
+    with SSSE3, with portable code for the rest.
+*/
+
+BOOST_BEAST_DECL
+std::uint32_t
+adler32(std::uint32_t adler, void const* data, std::size_t n);
+
+BOOST_BEAST_DECL
+std::uint32_t
+crc32(std::uint32_t crc, void const* data, std::size_t n);
+
+} // detail
+} // zlib
+} // beast
+} // boost
+
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/zlib/detail/checksum.ipp>
+#endif
+
+#endif
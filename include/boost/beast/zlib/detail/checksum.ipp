@@ -0,0 +1,354 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+// This is a derivative work based on Zlib, copyright below:
+/*
+    Copyright (C) 1995-2013 Jean-loup Gailly and Mark Adler
+
+    This software is provided 'as-is', without any express or implied
+    warranty.  In no event will the authors be held liable for any damages
+    arising from the use of this software.
+
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+       claim that you wrote the original software. If you use this software
+       in a product, an acknowledgment in the product documentation would be
+       appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be
+       misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+
+    Jean-loup Gailly        Mark Adler
+    jloup@gzip.org          madler@alumni.caltech.edu
+
+    The data format used by the zlib library is described by RFCs (Request for
+    Comments) 1950 to 1952 in the files http://tools.ietf.org/html/rfc1950
+    (zlib format), rfc1951 (deflate format) and rfc1952 (gzip format).
+*/
+
+#ifndef BOOST_BEAST_ZLIB_DETAIL_CHECKSUM_IPP
+#define BOOST_BEAST_ZLIB_DETAIL_CHECKSUM_IPP
+
+#include <boost/beast/zlib/detail/checksum.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
+#include <boost/endian/conversion.hpp>
+#include <cstring>
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+#include <immintrin.h>
+#endif
+
+namespace boost {
+namespace beast {
+namespace zlib {
+namespace detail {
+
+// Largest prime smaller than 65536
+static std::uint32_t constexpr adler_base = 65521;
+
+// Largest n such that 255n(n+1)/2 + (n+1)(base-1) fits in 32 bits
+static std::size_t constexpr adler_nmax = 5552;
+
+inline
+std::uint32_t
+adler32_scalar(
+    std::uint32_t adler,
+    unsigned char const* p,
+    std::size_t n)
+{
+    std::uint32_t s1 = adler & 0xffff;
+    std::uint32_t s2 = adler >> 16;
+    while(n > 0)
+    {
+        auto k = n < adler_nmax ? n : adler_nmax;
+        n -= k;
+        while(k >= 8)
+        {
+            s1 += p[0]; s2 += s1;
+            s1 += p[1]; s2 += s1;
+            s1 += p[2]; s2 += s1;
+            s1 += p[3]; s2 += s1;
+            s1 += p[4]; s2 += s1;
+            s1 += p[5]; s2 += s1;
+            s1 += p[6]; s2 += s1;
+            s1 += p[7]; s2 += s1;
+            p += 8;
+            k -= 8;
+        }
+        while(k--)
+        {
+            s1 += *p++;
+            s2 += s1;
+        }
+        s1 %= adler_base;
+        s2 %= adler_base;
+    }
+    return (s2 << 16) | s1;
+}
+
+/*  CRC-32 with the reflected polynomial 0xedb88320, eight
+    bytes at a time. The tables are built on first use.
+*/
+struct crc32_tables
+{
+    std::uint32_t t[8][256];
+
+    crc32_tables()
+    {
+        for(std::uint32_t i = 0; i < 256; ++i)
+        {
+            auto c = i;
+            for(int k = 0; k < 8; ++k)
+                c = (c & 1) ? (c >> 1) ^ 0xedb88320 : c >> 1;
+            t[0][i] = c;
+        }
+        for(std::uint32_t i = 0; i < 256; ++i)
+            for(int k = 1; k < 8; ++k)
+                t[k][i] = (t[k - 1][i] >> 8) ^
+                    t[0][t[k - 1][i] & 0xff];
+    }
+};
+
+inline
+crc32_tables const&
+get_crc32_tables()
+{
+    static crc32_tables const tables;
+    return tables;
+}
+
+// `crc` is the inverted check value
+inline
+std::uint32_t
+crc32_scalar(
+    std::uint32_t crc,
+    unsigned char const* p,
+    std::size_t n)
+{
+    auto const& t = get_crc32_tables().t;
+    while(n >= 8)
+    {
+        std::uint64_t w;
+        std::memcpy(&w, p, 8);
+        w = endian::little_to_native(w);
+        auto const lo = static_cast<std::uint32_t>(w) ^ crc;
+        auto const hi = static_cast<std::uint32_t>(w >> 32);
+        crc =
+            t[7][ lo        & 0xff] ^
+            t[6][(lo >>  8) & 0xff] ^
+            t[5][(lo >> 16) & 0xff] ^
+            t[4][ lo >> 24        ] ^
+            t[3][ hi        & 0xff] ^
+            t[2][(hi >>  8) & 0xff] ^
+            t[1][(hi >> 16) & 0xff] ^
+            t[0][ hi >> 24        ];
+        p += 8;
+        n -= 8;
+    }
+    while(n--)
+        crc = t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+//------------------------------------------------------------------------------
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+
+/*  Adler-32 on 32 bytes per step. Within a run of at most
+    nmax bytes, s1 is the plain sum of the bytes and s2 adds
+    each byte weighted by its distance from the end of the
+    run, plus 32 times the value s1 had before each step.
+    Returns the number of bytes processed, a multiple of 32.
+*/
+BOOST_BEAST_TARGET_SSSE3
+inline
+std::size_t
+adler32_ssse3(
+    std::uint32_t& adler,
+    unsigned char const* p,
+    std::size_t n)
+{
+    std::uint32_t s1 = adler & 0xffff;
+    std::uint32_t s2 = adler >> 16;
+    auto blocks = n / 32;
+    auto const done = blocks * 32;
+    __m128i const tap1 = _mm_setr_epi8(
+        32, 31, 30, 29, 28, 27, 26, 25,
+        24, 23, 22, 21, 20, 19, 18, 17);
+    __m128i const tap2 = _mm_setr_epi8(
+        16, 15, 14, 13, 12, 11, 10,  9,
+         8,  7,  6,  5,  4,  3,  2,  1);
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const ones = _mm_set1_epi16(1);
+    while(blocks)
+    {
+        auto k = adler_nmax / 32;
+        if(k > blocks)
+            k = blocks;
+        blocks -= k;
+        __m128i v_ps = _mm_set_epi32(
+            0, 0, 0, static_cast<int>(s1 * k));
+        __m128i v_s2 = _mm_set_epi32(
+            0, 0, 0, static_cast<int>(s2));
+        __m128i v_s1 = _mm_setzero_si128();
+        do
+        {
+            auto const q = reinterpret_cast<__m128i const*>(p);
+            __m128i const b1 = _mm_loadu_si128(q);
+            __m128i const b2 = _mm_loadu_si128(q + 1);
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(b1, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(
+                _mm_maddubs_epi16(b1, tap1), ones));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(b2, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(
+                _mm_maddubs_epi16(b2, tap2), ones));
+            p += 32;
+        }
+        while(--k);
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+        v_s1 = _mm_add_epi32(v_s1,
+            _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += static_cast<std::uint32_t>(_mm_cvtsi128_si32(v_s1));
+        v_s2 = _mm_add_epi32(v_s2,
+            _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2,
+            _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = static_cast<std::uint32_t>(_mm_cvtsi128_si32(v_s2));
+        s1 %= adler_base;
+        s2 %= adler_base;
+    }
+    adler = (s2 << 16) | s1;
+    return done;
+}
+
+// Returns x folded forward by the distance in k, plus y
+BOOST_BEAST_TARGET_PCLMUL
+inline
+__m128i
+crc32_fold(__m128i x, __m128i k, __m128i y)
+{
+    return _mm_xor_si128(
+        _mm_xor_si128(
+            _mm_clmulepi64_si128(x, k, 0x00),
+            _mm_clmulepi64_si128(x, k, 0x11)),
+        y);
+}
+
+/*  CRC-32 by folding 64 bytes per step with carry-less
+    multiplication, then reducing to 32 bits with Barrett's
+    method. See "Fast CRC Computation for Generic Polynomials
+    Using PCLMULQDQ Instruction", Intel, 2009. `n` is at
+    least 64 and a multiple of 16, and `crc` is the inverted
+    check value.
+*/
+BOOST_BEAST_TARGET_PCLMUL
+inline
+std::uint32_t
+crc32_pclmul(
+    std::uint32_t crc,
+    unsigned char const* p,
+    std::size_t n)
+{
+    auto q = reinterpret_cast<__m128i const*>(p);
+    __m128i x1 = _mm_xor_si128(_mm_loadu_si128(q),
+        _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = _mm_loadu_si128(q + 1);
+    __m128i x3 = _mm_loadu_si128(q + 2);
+    __m128i x4 = _mm_loadu_si128(q + 3);
+    q += 4;
+    n -= 64;
+
+    // Fold four lanes in parallel
+    __m128i k = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    while(n >= 64)
+    {
+        x1 = crc32_fold(x1, k, _mm_loadu_si128(q));
+        x2 = crc32_fold(x2, k, _mm_loadu_si128(q + 1));
+        x3 = crc32_fold(x3, k, _mm_loadu_si128(q + 2));
+        x4 = crc32_fold(x4, k, _mm_loadu_si128(q + 3));
+        q += 4;
+        n -= 64;
+    }
+
+    // Fold into one lane, then the remaining input
+    k = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    x1 = crc32_fold(x1, k, x2);
+    x1 = crc32_fold(x1, k, x3);
+    x1 = crc32_fold(x1, k, x4);
+    while(n >= 16)
+    {
+        x1 = crc32_fold(x1, k, _mm_loadu_si128(q));
+        ++q;
+        n -= 16;
+    }
+
+    // Fold 128 bits to 64
+    __m128i const mask = _mm_setr_epi32(-1, 0, -1, 0);
+    x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    k = _mm_set_epi64x(0, 0x0163cd6124);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x00), x2);
+
+    // Barrett reduction to 32 bits
+    k = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    x2 = _mm_and_si128(x1, mask);
+    x2 = _mm_clmulepi64_si128(x2, k, 0x10);
+    x2 = _mm_and_si128(x2, mask);
+    x2 = _mm_clmulepi64_si128(x2, k, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return static_cast<std::uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+std::uint32_t
+adler32(std::uint32_t adler, void const* data, std::size_t n)
+{
+    auto p = static_cast<unsigned char const*>(data);
+#if ! BOOST_BEAST_NO_INTRINSICS
+    if(n >= 64 && beast::detail::get_cpu_info().ssse3)
+    {
+        auto const done = adler32_ssse3(adler, p, n);
+        p += done;
+        n -= done;
+    }
+#endif
+    return adler32_scalar(adler, p, n);
+}
+
+std::uint32_t
+crc32(std::uint32_t crc, void const* data, std::size_t n)
+{
+    auto p = static_cast<unsigned char const*>(data);
+    crc = ~crc;
+#if ! BOOST_BEAST_NO_INTRINSICS
+    if(n >= 64 && beast::detail::get_cpu_info().pclmul)
+    {
+        auto const done = n & ~std::size_t{15};
+        crc = crc32_pclmul(crc, p, done);
+        p += done;
+        n -= done;
+    }
+#endif
+    return ~crc32_scalar(crc, p, n);
+}
+
+} // detail
+} // zlib
+} // beast
+} // boost
+
+#endif
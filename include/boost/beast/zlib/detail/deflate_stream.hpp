@@ -39,9 +39,11 @@
 
 #include <boost/beast/zlib/error.hpp>
 #include <boost/beast/zlib/zlib.hpp>
+#include <boost/beast/zlib/detail/checksum.hpp>
 #include <boost/beast/zlib/detail/ranges.hpp>
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
+#include <boost/endian/conversion.hpp>
 #include <boost/optional.hpp>
 #include <boost/throw_exception.hpp>
 #include <cstdint>
@@ -51,6 +53,31 @@
 #include <stdexcept>
 #include <type_traits>
 
+/*  Strings are hashed with the CRC32-C instruction when the
+    target architecture guarantees it, and with a multiplicative
+    hash otherwise. Define to 0 to always use the latter.
+*/
+#ifndef BOOST_BEAST_ZLIB_CRC32_HASH
+# if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32) || \
+     (defined(BOOST_MSVC) && defined(__AVX__))
+#  define BOOST_BEAST_ZLIB_CRC32_HASH 1
+# else
+#  define BOOST_BEAST_ZLIB_CRC32_HASH 0
+# endif
+#endif
+
+#if BOOST_BEAST_ZLIB_CRC32_HASH
+# if defined(__ARM_FEATURE_CRC32)
+#  include <arm_acle.h>
+# else
+#  include <nmmintrin.h>
+# endif
+#endif
+
+#if defined(BOOST_MSVC) && defined(_M_X64)
+# include <intrin.h> // _BitScanForward64
+#endif
+
 namespace boost {
 namespace beast {
 namespace zlib {
@@ -121,7 +148,7 @@ protected:
     static std::uint16_t constexpr HEAP_SIZE = 2 * lCodes + 1;
 
     // size of bit buffer in bi_buf
-    static std::uint8_t constexpr Buf_size = 16;
+    static std::uint8_t constexpr Buf_size = 64;
 
     // Matches of length 3 are discarded if their distance exceeds kTooFar
     static std::size_t constexpr kTooFar = 4096;
@@ -229,6 +256,7 @@ protected:
     // VFALCO This might not be needed, e.g. for zip/gzip
     enum StreamStatus
     {
+        INIT_STATE = 42,
         EXTRA_STATE = 69,
         NAME_STATE = 73,
         COMMENT_STATE = 91,
@@ -262,6 +290,11 @@ protected:
     boost::optional<Flush>
         last_flush_;                // value of flush param for previous deflate call
 
+    Wrap wrap_ = Wrap::none;        // container format
+    bool trailer_;                  // true once the trailer is pending
+    std::uint32_t check_;           // Adler-32 or CRC-32 of the input so far
+    std::uint32_t in_size_;         // input size modulo 2^32, for gzip
+
     uInt w_size_;                   // LZ77 window size (32K by default)
     uInt w_bits_;                   // log2(w_size)  (8..16)
     uInt w_mask_;                   // w_size - 1
@@ -289,18 +322,10 @@ protected:
 
     std::uint16_t* head_;           // Heads of the hash chains or 0
 
-    uInt  ins_h_;                   // hash index of string to be inserted
     uInt  hash_size_;               // number of elements in hash table
     uInt  hash_bits_;               // log2(hash_size)
     uInt  hash_mask_;               // hash_size-1
 
-    /*  Number of bits by which ins_h must be shifted at each input
-        step. It must be such that after minMatch steps,
-        the oldest byte no longer takes part in the hash key, that is:
-        hash_shift * minMatch >= hash_bits
-    */
-    uInt hash_shift_;
-
     /*  Window position at the beginning of the current output block.
         Gets negative when the window is moved backwards.
     */
@@ -405,9 +430,10 @@ protected:
     uInt insert_;                   // bytes at end of window left to insert
 
     /*  Output buffer.
-        Bits are inserted starting at the bottom (least significant bits).
+        Bits are inserted starting at the bottom (least significant bits),
+        and written out eight bytes at a time when the buffer is full.
      */
-    std::uint16_t bi_buf_;
+    std::uint64_t bi_buf_;
 
     /*  Number of valid bits in bi_buf._  All bits above the last valid
         bit are always zero.
@@ -450,24 +476,35 @@ protected:
         put_byte(w >> 8);
     }
 
+    void
+    put_uint64(std::uint64_t w)
+    {
+        w = endian::native_to_little(w);
+        std::memcpy(&pending_buf_[pending_], &w, sizeof(w));
+        pending_ += sizeof(w);
+    }
+
     /*  Send a value on a given number of bits.
         IN assertion: length <= 16 and value fits in length bits.
+        Only whole bytes of output are ever written to pending_buf_,
+        so the output never overtakes the symbols overlaid on it.
     */
     void
     send_bits(int value, int length)
     {
-        if(bi_valid_ > (int)Buf_size - length)
-        {
-            bi_buf_ |= (std::uint16_t)value << bi_valid_;
-            put_short(bi_buf_);
-            bi_buf_ = (std::uint16_t)value >> (Buf_size - bi_valid_);
-            bi_valid_ += length - Buf_size;
-        }
-        else
+        BOOST_ASSERT(bi_valid_ < Buf_size);
+        auto const v = static_cast<std::uint64_t>(
+            static_cast<unsigned>(value));
+        bi_buf_ |= v << bi_valid_;
+        if(bi_valid_ + length < Buf_size)
         {
-            bi_buf_ |= (std::uint16_t)(value) << bi_valid_;
             bi_valid_ += length;
+            return;
         }
+        // length <= 16 so bi_valid_ > 0 here
+        put_uint64(bi_buf_);
+        bi_buf_ = v >> (Buf_size - bi_valid_);
+        bi_valid_ += length - Buf_size;
     }
 
     // Send a code of the given tree
@@ -489,16 +526,72 @@ protected:
         return lut_.dist_code[256+(dist>>7)];
     }
 
-    /*  Update a hash value with the given input byte
-        IN  assertion: all calls to to update_hash are made with
-            consecutive input characters, so that a running hash
-            key can be computed from the previous key instead of
-            complete recalculation each time.
+    /*  Return the hash of the minMatch bytes at window offset str.
+        Unlike the rolling hash of zlib, equal keys do not imply that
+        the third bytes are equal, so longest_match compares them.
+        IN  assertion: window_[str + minMatch-1] is valid. The fourth
+            byte is loaded but does not take part in the hash; it is
+            inside the window, or at worst the first byte of prev_.
     */
-    void
-    update_hash(uInt& h, std::uint8_t c)
+    uInt
+    hash_at(uInt str) const
     {
-        h = ((h << hash_shift_) ^ c) & hash_mask_;
+        std::uint32_t v;
+        std::memcpy(&v, window_ + str, sizeof(v));
+        v = endian::little_to_native(v) & 0xffffff;
+#if ! BOOST_BEAST_ZLIB_CRC32_HASH
+        return (v * 2654435761U) >> (32 - hash_bits_);
+#elif defined(__ARM_FEATURE_CRC32)
+        return __crc32cw(0, v) & hash_mask_;
+#else
+        return _mm_crc32_u32(0, v) & hash_mask_;
+#endif
+    }
+
+    // Returns the number of trailing zero bits, v must not be zero
+    static
+    unsigned
+    countr_zero(std::uint64_t v)
+    {
+        BOOST_ASSERT(v != 0);
+#if defined(BOOST_MSVC) && defined(_M_X64)
+        unsigned long n;
+        _BitScanForward64(&n, v);
+        return static_cast<unsigned>(n);
+#elif defined(BOOST_GCC) || defined(BOOST_CLANG)
+        return static_cast<unsigned>(__builtin_ctzll(v));
+#else
+        unsigned n = 0;
+        while((v & 1) == 0)
+        {
+            v >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    /*  Return the number of leading bytes which are equal in a and b,
+        at most n, comparing eight bytes at a time.
+        IN  assertion: n is a multiple of 8, and n bytes are readable
+            at a and at b.
+    */
+    static
+    std::size_t
+    match_length(Byte const* a, Byte const* b, std::size_t n)
+    {
+        BOOST_ASSERT(n % 8 == 0);
+        for(std::size_t i = 0; i < n; i += 8)
+        {
+            std::uint64_t x;
+            std::uint64_t y;
+            std::memcpy(&x, a + i, sizeof(x));
+            std::memcpy(&y, b + i, sizeof(y));
+            auto const d = endian::little_to_native(x ^ y);
+            if(d != 0)
+                return i + countr_zero(d) / 8;
+        }
+        return n;
     }
 
     /*  Initialize the hash table (avoiding 64K overflow for 16
@@ -529,17 +622,15 @@ protected:
         same hash key). Return the previous length of the hash chain.
         If this file is compiled with -DFASTEST, the compression level
         is forced to 1, and no hash chains are maintained.
-        IN  assertion: all calls to to INSERT_STRING are made with
-            consecutive input characters and the first minMatch
-            bytes of str are valid (except for the last minMatch-1
-            bytes of the input file).
+        IN  assertion: the first minMatch bytes of str are valid
+            (except for the last minMatch-1 bytes of the input file).
     */
     void
     insert_string(IPos& hash_head)
     {
-        update_hash(ins_h_, window_[strstart_ + (minMatch-1)]);
-        hash_head = prev_[strstart_ & w_mask_] = head_[ins_h_];
-        head_[ins_h_] = (std::uint16_t)strstart_;
+        auto const h = hash_at(strstart_);
+        hash_head = prev_[strstart_ & w_mask_] = head_[h];
+        head_[h] = (std::uint16_t)strstart_;
     }
 
     //--------------------------------------------------------------------------
@@ -615,10 +706,11 @@ protected:
     lut_type const&
     get_lut();
 
-    BOOST_BEAST_DECL void doReset             (int level, int windowBits, int memLevel, Strategy strategy);
+    BOOST_BEAST_DECL void doReset             (int level, int windowBits, int memLevel, Strategy strategy, Wrap wrap);
     BOOST_BEAST_DECL void doReset             ();
     BOOST_BEAST_DECL void doClear             ();
     BOOST_BEAST_DECL std::size_t doUpperBound (std::size_t sourceLen) const;
+    BOOST_BEAST_DECL std::size_t doAllocatedSize () const;
     BOOST_BEAST_DECL void doTune              (int good_length, int max_lazy, int nice_length, int max_chain);
     BOOST_BEAST_DECL void doParams            (z_params& zs, int level, Strategy strategy, error_code& ec);
     BOOST_BEAST_DECL void doWrite             (z_params& zs, boost::optional<Flush> flush, error_code& ec);
@@ -627,6 +719,8 @@ protected:
     BOOST_BEAST_DECL void doPending           (unsigned* value, int* bits);
 
     BOOST_BEAST_DECL void init                ();
+    BOOST_BEAST_DECL void put_header          ();
+    BOOST_BEAST_DECL void put_trailer         ();
     BOOST_BEAST_DECL void lm_init             ();
     BOOST_BEAST_DECL void init_block          ();
     BOOST_BEAST_DECL void pqdownheap          (ct_data const* tree, int k);
@@ -230,7 +230,8 @@ doReset(
     int level,
     int windowBits,
     int memLevel,
-    Strategy strategy)
+    Strategy strategy,
+    Wrap wrap)
 {
     if(level == default_size)
         level = 6;
@@ -261,6 +262,7 @@ doReset(
 
     level_ = level;
     strategy_ = strategy;
+    wrap_ = wrap;
     inited_ = false;
 }
 
@@ -279,6 +281,13 @@ doClear()
     buf_.reset();
 }
 
+std::size_t
+deflate_stream::
+doAllocatedSize() const
+{
+    return buf_ ? buf_size_ : 0;
+}
+
 std::size_t
 deflate_stream::
 doUpperBound(std::size_t sourceLen) const
@@ -291,7 +300,19 @@ doUpperBound(std::size_t sourceLen) const
               ((sourceLen + 7) >> 3) + ((sourceLen + 63) >> 6) + 5;
 
     /* compute wrapper length */
-    wraplen = 0;
+    switch(wrap_)
+    {
+    case Wrap::zlib:
+        // Four more for the dictionary ID
+        wraplen = 6 + (inited_ && strstart_ != 0 ? 4 : 0);
+        break;
+    case Wrap::gzip:
+        wraplen = 18;
+        break;
+    default:
+        wraplen = 0;
+        break;
+    }
 
     /* if not default parameters, return conservative bound */
     if(w_bits_ != 15 || hash_bits_ != 8 + 7)
@@ -375,6 +396,12 @@ doWrite(z_params& zs, boost::optional<Flush> flush, error_code& ec)
         return;
     }
 
+    if(status_ == INIT_STATE)
+    {
+        put_header();
+        status_ = BUSY_STATE;
+    }
+
     // value of flush param for previous deflate call
     auto old_flush = boost::make_optional<Flush>(
         last_flush_.is_initialized(),
@@ -493,23 +520,43 @@ doWrite(z_params& zs, boost::optional<Flush> flush, error_code& ec)
 
     if(flush == Flush::finish)
     {
+        if(wrap_ != Wrap::none)
+        {
+            if(! trailer_)
+            {
+                put_trailer();
+                flush_pending(zs);
+            }
+            if(pending_ != 0)
+                return;
+        }
         ec = error::end_of_stream;
         return;
     }
 }
 
-// VFALCO Warning: untested
 void
 deflate_stream::
 doDictionary(Byte const* dict, uInt dictLength, error_code& ec)
 {
-    if(lookahead_)
+    maybe_init();
+
+    // A zlib stream may only have a dictionary before its
+    // header is written, and a gzip stream cannot have one
+    if(dict == nullptr || lookahead_ ||
+        wrap_ == Wrap::gzip ||
+        (wrap_ == Wrap::zlib && status_ != INIT_STATE))
     {
         ec = error::stream_error;
         return;
     }
 
-    maybe_init();
+    // The header identifies the dictionary by its Adler-32,
+    // which must not be counted in the check value
+    auto const wrap = wrap_;
+    if(wrap == Wrap::zlib)
+        check_ = adler32(1, dict, dictLength);
+    wrap_ = Wrap::none;
 
     /* if dict would fill window, just replace the history */
     if(dictLength >= w_size_)
@@ -535,9 +582,9 @@ doDictionary(Byte const* dict, uInt dictLength, error_code& ec)
         uInt n = lookahead_ - (minMatch-1);
         do
         {
-            update_hash(ins_h_, window_[str + minMatch-1]);
-            prev_[str & w_mask_] = head_[ins_h_];
-            head_[ins_h_] = (std::uint16_t)str;
+            auto const h = hash_at(str);
+            prev_[str & w_mask_] = head_[h];
+            head_[h] = (std::uint16_t)str;
             str++;
         }
         while(--n);
@@ -551,6 +598,7 @@ doDictionary(Byte const* dict, uInt dictLength, error_code& ec)
     lookahead_ = 0;
     match_length_ = prev_length_ = minMatch-1;
     match_available_ = 0;
+    wrap_ = wrap;
 }
 
 void
@@ -571,7 +619,8 @@ doPrime(int bits, int value, error_code& ec)
         int put = Buf_size - bi_valid_;
         if(put > bits)
             put = bits;
-        bi_buf_ |= (std::uint16_t)((value & ((1 << put) - 1)) << bi_valid_);
+        bi_buf_ |= static_cast<std::uint64_t>(
+            value & ((1 << put) - 1)) << bi_valid_;
         bi_valid_ += put;
         tr_flush_bits();
         value >>= put;
@@ -609,7 +658,6 @@ init()
 
     hash_size_ = 1 << hash_bits_;
     hash_mask_ = hash_size_ - 1;
-    hash_shift_ =  ((hash_bits_+minMatch-1)/minMatch);
 
     auto const nwindow  = w_size_ * 2*sizeof(Byte);
     auto const nprev    = w_size_ * sizeof(std::uint16_t);
@@ -651,15 +699,107 @@ init()
     pending_ = 0;
     pending_out_ = pending_buf_;
 
-    status_ = BUSY_STATE;
+    status_ = INIT_STATE;
     last_flush_ = Flush::none;
 
     tr_init();
     lm_init();
 
+    check_ = wrap_ == Wrap::zlib ? 1 : 0;
+    in_size_ = 0;
+    trailer_ = false;
+
     inited_ = true;
 }
 
+// Write the zlib or gzip header to the pending output
+void
+deflate_stream::
+put_header()
+{
+    std::uint8_t level_flags;
+    if(strategy_ >= Strategy::huffman || level_ < 2)
+        level_flags = 0;
+    else if(level_ < 6)
+        level_flags = 1;
+    else if(level_ == 6)
+        level_flags = 2;
+    else
+        level_flags = 3;
+
+    switch(wrap_)
+    {
+    case Wrap::zlib:
+    {
+        // CMF is the method and window size, and FLG makes
+        // the pair a multiple of 31 (RFC 1950 section 2.2)
+        unsigned header = (8 + ((w_bits_ - 8) << 4)) << 8;
+        header |= unsigned{level_flags} << 6;
+        if(strstart_ != 0)
+            header |= 0x20; // FDICT
+        header += 31 - (header % 31);
+        put_byte(static_cast<std::uint8_t>(header >> 8));
+        put_byte(static_cast<std::uint8_t>(header & 0xff));
+        if(strstart_ != 0)
+        {
+            // DICTID, then start the check value over
+            put_byte(static_cast<std::uint8_t>(check_ >> 24));
+            put_byte(static_cast<std::uint8_t>(check_ >> 16));
+            put_byte(static_cast<std::uint8_t>(check_ >> 8));
+            put_byte(static_cast<std::uint8_t>(check_));
+            check_ = 1;
+        }
+        break;
+    }
+
+    case Wrap::gzip:
+        // No optional fields and no modification
+        // time (RFC 1952 section 2.3)
+        put_byte(0x1f);
+        put_byte(0x8b);
+        put_byte(8);    // CM = deflate
+        put_byte(0);    // FLG
+        put_byte(0);    // MTIME
+        put_byte(0);
+        put_byte(0);
+        put_byte(0);
+        put_byte(level_ == 9 ? 2 :
+            level_flags == 0 ? 4 : 0); // XFL
+        put_byte(255);  // OS = unknown
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Write the zlib or gzip trailer to the pending output
+void
+deflate_stream::
+put_trailer()
+{
+    switch(wrap_)
+    {
+    case Wrap::zlib:
+        put_byte(static_cast<std::uint8_t>(check_ >> 24));
+        put_byte(static_cast<std::uint8_t>(check_ >> 16));
+        put_byte(static_cast<std::uint8_t>(check_ >> 8));
+        put_byte(static_cast<std::uint8_t>(check_));
+        break;
+
+    case Wrap::gzip:
+        put_short(static_cast<std::uint16_t>(check_));
+        put_short(static_cast<std::uint16_t>(check_ >> 16));
+        put_short(static_cast<std::uint16_t>(in_size_));
+        put_short(static_cast<std::uint16_t>(in_size_ >> 16));
+        break;
+
+    default:
+        break;
+    }
+    trailer_ = true;
+}
+
 /*  Initialize the "longest match" routines for a new zlib stream
 */
 void
@@ -684,7 +824,6 @@ lm_init()
     insert_ = 0;
     match_length_ = prev_length_ = minMatch-1;
     match_available_ = 0;
-    ins_h_ = 0;
 }
 
 // Initialize a new block.
@@ -1254,10 +1393,12 @@ void
 deflate_stream::
 bi_windup()
 {
-    if(bi_valid_ > 8)
-        put_short(bi_buf_);
-    else if(bi_valid_ > 0)
+    while(bi_valid_ > 0)
+    {
         put_byte((Byte)bi_buf_);
+        bi_buf_ >>= 8;
+        bi_valid_ -= 8;
+    }
     bi_buf_ = 0;
     bi_valid_ = 0;
 }
@@ -1268,13 +1409,7 @@ void
 deflate_stream::
 bi_flush()
 {
-    if(bi_valid_ == 16)
-    {
-        put_short(bi_buf_);
-        bi_buf_ = 0;
-        bi_valid_ = 0;
-    }
-    else if(bi_valid_ >= 8)
+    while(bi_valid_ >= 8)
     {
         put_byte((Byte)bi_buf_);
         bi_buf_ >>= 8;
@@ -1574,26 +1709,21 @@ fill_window(z_params& zs)
         n = read_buf(zs, window_ + strstart_ + lookahead_, more);
         lookahead_ += n;
 
-        // Initialize the hash value now that we have some input:
+        // Insert the strings left over now that we have some input:
         if(lookahead_ + insert_ >= minMatch)
         {
             uInt str = strstart_ - insert_;
-            ins_h_ = window_[str];
-            update_hash(ins_h_, window_[str + 1]);
             while(insert_)
             {
-                update_hash(ins_h_, window_[str + minMatch-1]);
-                prev_[str & w_mask_] = head_[ins_h_];
-                head_[ins_h_] = (std::uint16_t)str;
+                auto const h = hash_at(str);
+                prev_[str & w_mask_] = head_[h];
+                head_[h] = (std::uint16_t)str;
                 str++;
                 insert_--;
                 if(lookahead_ + insert_ < minMatch)
                     break;
             }
         }
-        /*  If the whole input has less than minMatch bytes, ins_h is garbage,
-            but this is not important since only literal bytes will be emitted.
-        */
     }
     while(lookahead_ < kMinLookahead && zs.avail_in != 0);
 
@@ -1677,8 +1807,8 @@ flush_block(z_params& zs, bool last)
    flush_pending(zs);
 }
 
-/*  Read a new buffer from the current input stream, update the adler32
-    and total number of bytes read.  All write() input goes through
+/*  Read a new buffer from the current input stream, update the check
+    value and total number of bytes read.  All write() input goes through
     this function so some applications may wish to modify it to avoid
     allocating a large strm->next_in buffer and copying from it.
     (See also flush_pending()).
@@ -1694,6 +1824,15 @@ read_buf(z_params& zs, Byte *buf, unsigned size)
     zs.avail_in  -= len;
 
     std::memcpy(buf, zs.next_in, len);
+    if(wrap_ == Wrap::zlib)
+    {
+        check_ = adler32(check_, buf, len);
+    }
+    else if(wrap_ == Wrap::gzip)
+    {
+        check_ = crc32(check_, buf, len);
+        in_size_ += static_cast<std::uint32_t>(len);
+    }
     zs.next_in = static_cast<
         std::uint8_t const*>(zs.next_in) + len;
     zs.total_in += len;
@@ -1729,7 +1868,6 @@ longest_match(IPos cur_match)
     std::uint16_t *prev = prev_;
     uInt wmask = w_mask_;
 
-    Byte *strend = window_ + strstart_ + maxMatch;
     Byte scan_end1  = scan[best_len-1];
     Byte scan_end   = scan[best_len];
 
@@ -1764,35 +1902,20 @@ longest_match(IPos cur_match)
          */
         if(     match[best_len]   != scan_end  ||
                 match[best_len-1] != scan_end1 ||
-                *match            != *scan     ||
-                *++match          != scan[1])
+                match[0]          != scan[0]   ||
+                match[1]          != scan[1])
             continue;
 
         /* The check at best_len-1 can be removed because it will be made
          * again later. (This heuristic is not always a win.)
-         * It is not necessary to compare scan[2] and match[2] since they
-         * are always equal when the other bytes match, given that
-         * the hash keys are equal and that HASH_BITS >= 8.
+         * The hash does not determine scan[2], so the comparison of the
+         * remaining maxMatch-2 bytes starts there, eight bytes at a time.
+         * It reads at most up to strstart+258, as the byte loop did.
          */
-        scan += 2, match++;
-        BOOST_ASSERT(*scan == *match);
+        len = 2 + static_cast<int>(
+            match_length(scan + 2, match + 2, maxMatch - 2));
 
-        /* We check for insufficient lookahead only every 8th comparison;
-         * the 256th check will be made at strstart+258.
-         */
-        do
-        {
-        }
-        while(  *++scan == *++match && *++scan == *++match &&
-                *++scan == *++match && *++scan == *++match &&
-                *++scan == *++match && *++scan == *++match &&
-                *++scan == *++match && *++scan == *++match &&
-                scan < strend);
-
-        BOOST_ASSERT(scan <= window_+(unsigned)(window_size_-1));
-
-        len = maxMatch - (int)(strend - scan);
-        scan = strend - maxMatch;
+        BOOST_ASSERT(scan + len <= window_+(unsigned)(window_size_-1));
 
         if(len > best_len) {
             match_start_ = cur_match;
@@ -1967,11 +2090,6 @@ f_fast(z_params& zs, Flush flush) ->
             {
                 strstart_ += match_length_;
                 match_length_ = 0;
-                ins_h_ = window_[strstart_];
-                update_hash(ins_h_, window_[strstart_+1]);
-                /* If lookahead < minMatch, ins_h is garbage, but it does not
-                 * matter since it will be recomputed at next deflate call.
-                 */
             }
         }
         else
@@ -40,6 +40,7 @@
 #include <boost/beast/zlib/error.hpp>
 #include <boost/beast/zlib/zlib.hpp>
 #include <boost/beast/zlib/detail/bitstream.hpp>
+#include <boost/beast/zlib/detail/checksum.hpp>
 #include <boost/beast/zlib/detail/ranges.hpp>
 #include <boost/beast/zlib/detail/window.hpp>
 #if 0
@@ -71,16 +72,26 @@ protected:
 
     BOOST_BEAST_DECL
     void
-    doReset(int windowBits);
+    doReset(int windowBits, Wrap wrap);
 
     BOOST_BEAST_DECL
     void
     doWrite(z_params& zs, Flush flush, error_code& ec);
 
+    BOOST_BEAST_DECL
+    void
+    doDictionary(std::uint8_t const* dict, std::size_t n, error_code& ec);
+
     void
     doReset()
     {
-        doReset(w_.bits());
+        doReset(w_.bits(), wrap_);
+    }
+
+    std::size_t
+    doAllocatedSize() const
+    {
+        return w_.allocated_size();
     }
 
 private:
@@ -95,6 +106,8 @@ private:
         NAME,       // i: waiting for end of file name (gzip)
         COMMENT,    // i: waiting for end of comment (gzip)
         HCRC,       // i: waiting for header crc (gzip)
+        DICTID,     // i: waiting for dictionary check value
+        DICT,       // waiting for the dictionary to be set
         TYPE,       // i: waiting for type bits, including last-flag bit
         TYPEDO,     // i: same, but skip check to exit inflate on new block
         STORED,     // i: waiting for stored size (length and complement)
@@ -210,6 +223,11 @@ private:
     int last_ = 0;                  // true if processing last block
     unsigned dmax_ = 32768U;        // zlib header max distance (INFLATE_STRICT)
 
+    Wrap wrap_ = Wrap::none;        // container format
+    unsigned flags_ = 0;            // gzip header flags
+    std::uint32_t check_ = 0;       // Adler-32 or CRC-32 of the output so far
+    std::uint32_t out_size_ = 0;    // output size modulo 2^32, for gzip
+
     // sliding window
     window w_;
 
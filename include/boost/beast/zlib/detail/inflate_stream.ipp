@@ -38,8 +38,11 @@
 #define BOOST_BEAST_ZLIB_DETAIL_INFLATE_STREAM_IPP
 
 #include <boost/beast/zlib/detail/inflate_stream.hpp>
+#include <boost/endian/conversion.hpp>
 #include <boost/throw_exception.hpp>
+#include <algorithm>
 #include <array>
+#include <cstring>
 
 namespace boost {
 namespace beast {
@@ -50,11 +53,13 @@ void
 inflate_stream::
 doClear()
 {
+    doReset(w_.bits(), wrap_);
+    w_.clear();
 }
 
 void
 inflate_stream::
-doReset(int windowBits)
+doReset(int windowBits, Wrap wrap)
 {
     if(windowBits < 8 || windowBits > 15)
         BOOST_THROW_EXCEPTION(std::domain_error{
@@ -65,12 +70,41 @@ doReset(int windowBits)
     mode_ = HEAD;
     last_ = 0;
     dmax_ = 32768U;
+    wrap_ = wrap;
+    flags_ = 0;
+    check_ = 0;
+    out_size_ = 0;
     lencode_ = codes_;
     distcode_ = codes_;
     next_ = codes_;
     back_ = -1;
 }
 
+void
+inflate_stream::
+doDictionary(std::uint8_t const* dict, std::size_t n, error_code& ec)
+{
+    // A zlib stream asks for its dictionary after the header,
+    // while raw deflate has no way to ask for it
+    if(dict == nullptr ||
+        (wrap_ != Wrap::none && mode_ != DICT))
+    {
+        ec = error::stream_error;
+        return;
+    }
+    if(wrap_ == Wrap::zlib)
+    {
+        if(adler32(1, dict, n) != check_)
+        {
+            ec = error::incorrect_data_check;
+            return;
+        }
+        check_ = 1;
+        mode_ = TYPEDO;
+    }
+    w_.write(dict, n);
+}
+
 void
 inflate_stream::
 doWrite(z_params& zs, Flush flush, error_code& ec)
@@ -85,6 +119,27 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
     r.out.last = r.out.first + zs.avail_out;
     r.out.next = r.out.first;
 
+    // Output before this is included in check_
+    auto checked = r.out.first;
+    auto const update_check =
+        [&]
+        {
+            auto const n = static_cast<
+                std::size_t>(r.out.next - checked);
+            if(n == 0)
+                return;
+            if(wrap_ == Wrap::zlib)
+            {
+                check_ = adler32(check_, checked, n);
+            }
+            else if(wrap_ == Wrap::gzip)
+            {
+                check_ = crc32(check_, checked, n);
+                out_size_ += static_cast<std::uint32_t>(n);
+            }
+            checked = r.out.next;
+        };
+
     auto const done =
         [&]
         {
@@ -96,6 +151,8 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
              */
 
 
+            update_check();
+
             // VFALCO TODO Don't allocate update the window unless necessary
             if(/*wsize_ ||*/ (r.out.used() && mode_ < BAD &&
                     (mode_ < CHECK || flush != Flush::finish)))
@@ -121,6 +178,30 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
             ec = e;
             mode_ = BAD;
         };
+    // Add gzip header bytes to the header CRC
+    auto const header_crc =
+        [&](std::uint32_t v, int n)
+        {
+            std::uint8_t b[4];
+            for(int i = 0; i < n; ++i)
+                b[i] = static_cast<std::uint8_t>(v >> (8 * i));
+            check_ = crc32(check_, b, n);
+        };
+    // Skip a zero-terminated gzip header field,
+    // returning false if more input is needed
+    auto const skip_string =
+        [&]
+        {
+            if(! r.in.avail())
+                return false;
+            auto const p = static_cast<std::uint8_t const*>(
+                std::memchr(r.in.next, 0, r.in.avail()));
+            auto const end = p ? p + 1 : r.in.last;
+            check_ = crc32(check_, r.in.next,
+                static_cast<std::size_t>(end - r.in.next));
+            r.in.next = end;
+            return p != nullptr;
+        };
 
     if(mode_ == TYPE)
         mode_ = TYPEDO;
@@ -130,6 +211,149 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
         switch(mode_)
         {
         case HEAD:
+        {
+            if(wrap_ == Wrap::none)
+            {
+                mode_ = TYPEDO;
+                break;
+            }
+            std::uint16_t v;
+            if(! bi_.fill(16, r.in.next, r.in.last))
+                return done();
+            bi_.read(v, 16);
+            if(wrap_ == Wrap::gzip)
+            {
+                if(v != 0x8b1f)
+                    return err(error::incorrect_header_check);
+                check_ = 0;
+                header_crc(v, 2);
+                mode_ = FLAGS;
+                break;
+            }
+            // zlib: CMF then FLG, see RFC 1950 section 2.2
+            unsigned const cmf = v & 0xff;
+            unsigned const flg = v >> 8;
+            if(((cmf << 8) + flg) % 31 != 0)
+                return err(error::incorrect_header_check);
+            if((cmf & 0x0f) != 8)
+                return err(error::unknown_compression_method);
+            int const bits = static_cast<int>(cmf >> 4) + 8;
+            if(bits > w_.bits())
+                return err(error::invalid_window_size);
+            dmax_ = 1U << bits;
+            if(flg & 0x20)
+            {
+                mode_ = DICTID;
+                break;
+            }
+            check_ = 1;
+            mode_ = TYPEDO;
+            break;
+        }
+
+        case DICTID:
+        {
+            std::uint32_t v;
+            if(! bi_.fill(32, r.in.next, r.in.last))
+                return done();
+            bi_.peek(v, 32);
+            bi_.flush();
+            check_ = endian::endian_reverse(v);
+            mode_ = DICT;
+            BOOST_FALLTHROUGH;
+        }
+
+        case DICT:
+            // Wait for doDictionary
+            ec = error::need_dict;
+            return done();
+
+        case FLAGS:
+        {
+            std::uint16_t v;
+            if(! bi_.fill(16, r.in.next, r.in.last))
+                return done();
+            bi_.read(v, 16);
+            if((v & 0xff) != 8)
+                return err(error::unknown_compression_method);
+            flags_ = v >> 8;
+            if(flags_ & 0xe0)
+                return err(error::unknown_header_flags);
+            header_crc(v, 2);
+            mode_ = TIME;
+            BOOST_FALLTHROUGH;
+        }
+
+        case TIME:
+        {
+            std::uint32_t v;
+            if(! bi_.fill(32, r.in.next, r.in.last))
+                return done();
+            bi_.peek(v, 32);
+            bi_.flush();
+            header_crc(v, 4);
+            mode_ = OS;
+            BOOST_FALLTHROUGH;
+        }
+
+        case OS:
+        {
+            std::uint16_t v;
+            if(! bi_.fill(16, r.in.next, r.in.last))
+                return done();
+            bi_.read(v, 16);
+            header_crc(v, 2);
+            mode_ = EXLEN;
+            BOOST_FALLTHROUGH;
+        }
+
+        case EXLEN:
+            if(flags_ & 0x04)
+            {
+                if(! bi_.fill(16, r.in.next, r.in.last))
+                    return done();
+                bi_.read(length_, 16);
+                header_crc(length_, 2);
+            }
+            mode_ = EXTRA;
+            BOOST_FALLTHROUGH;
+
+        case EXTRA:
+            if(flags_ & 0x04)
+            {
+                auto const n = clamp(length_, r.in.avail());
+                check_ = crc32(check_, r.in.next, n);
+                r.in.next += n;
+                length_ -= static_cast<unsigned>(n);
+                if(length_ != 0)
+                    return done();
+            }
+            mode_ = NAME;
+            BOOST_FALLTHROUGH;
+
+        case NAME:
+            if((flags_ & 0x08) && ! skip_string())
+                return done();
+            mode_ = COMMENT;
+            BOOST_FALLTHROUGH;
+
+        case COMMENT:
+            if((flags_ & 0x10) && ! skip_string())
+                return done();
+            mode_ = HCRC;
+            BOOST_FALLTHROUGH;
+
+        case HCRC:
+            if(flags_ & 0x02)
+            {
+                std::uint16_t v;
+                if(! bi_.fill(16, r.in.next, r.in.last))
+                    return done();
+                bi_.read(v, 16);
+                if(v != (check_ & 0xffff))
+                    return err(error::incorrect_header_crc);
+            }
+            check_ = 0;
             mode_ = TYPEDO;
             break;
 
@@ -357,7 +581,7 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
 
         case LEN:
         {
-            if(r.in.avail() >= 6 && r.out.avail() >= 258)
+            if(r.in.avail() >= 8 && r.out.avail() >= 258)
             {
                 inflate_fast(r, ec);
                 if(ec)
@@ -512,8 +736,40 @@ doWrite(z_params& zs, Flush flush, error_code& ec)
         }
 
         case CHECK:
+            if(wrap_ != Wrap::none)
+            {
+                std::uint32_t v;
+                if(! bi_.fill(32, r.in.next, r.in.last))
+                    return done();
+                bi_.peek(v, 32);
+                bi_.flush();
+                update_check();
+                // Adler-32 is stored most significant byte first
+                if(wrap_ == Wrap::zlib)
+                    v = endian::endian_reverse(v);
+                if(v != check_)
+                    return err(error::incorrect_data_check);
+                if(wrap_ == Wrap::gzip)
+                {
+                    mode_ = LENGTH;
+                    break;
+                }
+            }
+            mode_ = DONE;
+            break;
+
+        case LENGTH:
+        {
+            std::uint32_t v;
+            if(! bi_.fill(32, r.in.next, r.in.last))
+                return done();
+            bi_.peek(v, 32);
+            bi_.flush();
+            if(v != out_size_)
+                return err(error::incorrect_length_check);
             mode_ = DONE;
             BOOST_FALLTHROUGH;
+        }
 
         case DONE:
             ec = error::end_of_stream;
@@ -938,7 +1194,7 @@ fixedTables()
    Entry assumptions:
 
         state->mode_ == LEN
-        zs.avail_in >= 6
+        zs.avail_in >= 8
         zs.avail_out >= 258
         start >= zs.avail_out
         state->bits_ < 8
@@ -951,35 +1207,38 @@ fixedTables()
 
    Notes:
 
+    - The bits are held in a 64-bit accumulator, refilled once per loop
+      with an unaligned eight byte load. The refill advances the input by
+      the number of whole bytes which fit, leaving between 56 and 63 valid
+      bits, so that no branch depends on how many bits were left. The bits
+      above the valid ones hold the next input byte again, which the next
+      refill ORs in at the same position. Therefore if zs.avail_in >= 8,
+      then there is enough input to refill without checking.
+
     - The maximum input bits used by a length/distance pair is 15 bits for the
       length code, 5 bits for the length extra, 15 bits for the distance code,
-      and 13 bits for the distance extra.  This totals 48 bits, or six bytes.
-      Therefore if zs.avail_in >= 6, then there is enough input to avoid
-      checking for available input while decoding.
+      and 13 bits for the distance extra.  This totals 48 bits, which is less
+      than the 56 bits available after a refill. When a literal is decoded,
+      the next code is looked up without refilling, and written out as well
+      when it is also a literal.
 
     - The maximum bytes that a single length/distance pair can output is 258
       bytes, which is the maximum length that can be coded.  inflate_fast()
       requires zs.avail_out >= 258 for each loop to avoid checking for
-      output space.
-
-  inflate_fast() speedups that turned out slower (on a PowerPC G3 750CXe):
-   - Using bit fields for code structure
-   - Different op definition to avoid & for extra bits (do & for table bits)
-   - Three separate decoding do-loops for direct, window, and wnext == 0
-   - Special case for distance > 1 copies to do overlapped load and store copy
-   - Explicit branch predictions (based on measured branch probabilities)
-   - Deferring match copy and interspersed it with decoding subsequent codes
-   - Swapping literal/length else
-   - Swapping window/direct else
-   - Larger unrolled copy loops (three is about right)
-   - Moving len -= 3 statement into middle of loop
+      output space. Matches at a distance of at least eight are copied eight
+      bytes at a time, and may write up to seven bytes past their end, so
+      this is only done when that much more output space is available.
  */
 void
 inflate_stream::
 inflate_fast(ranges& r, error_code& ec)
 {
-    unsigned char const* last;  // have enough input while in < last
-    unsigned char *end;         // while out < end, enough space available
+    std::uint8_t const* in;     // next input byte
+    std::uint8_t const* last;   // have enough input while in < last
+    std::uint8_t* out;          // next output byte
+    std::uint8_t* end;          // while out < end, enough space available
+    std::uint64_t hold;         // bit buffer
+    unsigned bits;              // bits in bit buffer
     std::size_t op;             // code bits, operation, extra bits, or window position, window bytes to copy
     unsigned len;               // match length, unused bytes
     unsigned dist;              // match distance
@@ -987,24 +1246,44 @@ inflate_fast(ranges& r, error_code& ec)
         (1U << lenbits_) - 1;   // mask for first level of length codes
     unsigned const dmask =
         (1U << distbits_) - 1;  // mask for first level of distance codes
+    code const* cp;
 
-    last = r.in.next + (r.in.avail() - 5);
-    end = r.out.next + (r.out.avail() - 257);
+    BOOST_ASSERT(r.in.avail() >= 8);
+    BOOST_ASSERT(r.out.avail() >= 258);
+    in = r.in.next;
+    last = in + (r.in.avail() - 7);
+    out = r.out.next;
+    end = out + (r.out.avail() - 257);
+    hold = bi_.peek_fast();
+    bits = bi_.size();
 
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do
     {
-        if(bi_.size() < 15)
-            bi_.fill_16(r.in.next);
-        auto cp = &lencode_[bi_.peek_fast() & lmask];
+        std::uint64_t v;
+        std::memcpy(&v, in, sizeof(v));
+        hold |= endian::little_to_native(v) << bits;
+        in += (63 - bits) >> 3;
+        bits |= 56;
+
+        cp = &lencode_[hold & lmask];
     dolen:
-        bi_.drop(cp->bits);
+        hold >>= cp->bits;
+        bits -= cp->bits;
         op = (unsigned)(cp->op);
         if(op == 0)
         {
             // literal
-            *r.out.next++ = (unsigned char)(cp->val);
+            *out++ = (unsigned char)(cp->val);
+            cp = &lencode_[hold & lmask];
+            if(cp->op == 0)
+            {
+                // another literal
+                hold >>= cp->bits;
+                bits -= cp->bits;
+                *out++ = (unsigned char)(cp->val);
+            }
         }
         else if(op & 16)
         {
@@ -1013,29 +1292,21 @@ inflate_fast(ranges& r, error_code& ec)
             op &= 15; // number of extra bits
             if(op)
             {
-                if(bi_.size() < op)
-                    bi_.fill_8(r.in.next);
-                len += (unsigned)bi_.peek_fast() & ((1U << op) - 1);
-                bi_.drop(op);
+                len += (unsigned)hold & ((1U << op) - 1);
+                hold >>= op;
+                bits -= static_cast<unsigned>(op);
             }
-            if(bi_.size() < 15)
-                bi_.fill_16(r.in.next);
-            cp = &distcode_[bi_.peek_fast() & dmask];
+            cp = &distcode_[hold & dmask];
         dodist:
-            bi_.drop(cp->bits);
+            hold >>= cp->bits;
+            bits -= cp->bits;
             op = (unsigned)(cp->op);
             if(op & 16)
             {
                 // distance base
                 dist = (unsigned)(cp->val);
                 op &= 15; // number of extra bits
-                if(bi_.size() < op)
-                {
-                    bi_.fill_8(r.in.next);
-                    if(bi_.size() < op)
-                        bi_.fill_8(r.in.next);
-                }
-                dist += (unsigned)bi_.peek_fast() & ((1U << op) - 1);
+                dist += (unsigned)hold & ((1U << op) - 1);
 #ifdef INFLATE_STRICT
                 if(dist > dmax_)
                 {
@@ -1044,9 +1315,10 @@ inflate_fast(ranges& r, error_code& ec)
                     break;
                 }
 #endif
-                bi_.drop(op);
+                hold >>= op;
+                bits -= static_cast<unsigned>(op);
 
-                op = r.out.used();
+                op = static_cast<std::size_t>(out - r.out.first);
                 if(dist > op)
                 {
                     // copy from window
@@ -1058,24 +1330,46 @@ inflate_fast(ranges& r, error_code& ec)
                         break;
                     }
                     auto const n = clamp(len, op);
-                    w_.read(r.out.next, op, n);
-                    r.out.next += n;
+                    w_.read(out, op, n);
+                    out += n;
                     len -= n;
                 }
                 if(len > 0)
                 {
                     // copy from output
-                    auto in = r.out.next - dist;
-                    auto n = clamp(len, r.out.avail());
-                    len -= n;
-                    while(n--)
-                        *r.out.next++ = *in++;
+                    auto from = out - dist;
+                    if( dist >= 8 &&
+                        static_cast<std::size_t>(
+                            r.out.last - out) >= len + 7)
+                    {
+                        // whole words, overlapping the end
+                        auto const stop = out + len;
+                        do
+                        {
+                            std::memcpy(out, from, 8);
+                            out += 8;
+                            from += 8;
+                        }
+                        while(out < stop);
+                        out = stop;
+                    }
+                    else if(dist == 1)
+                    {
+                        // run of one byte
+                        std::memset(out, *from, len);
+                        out += len;
+                    }
+                    else
+                    {
+                        while(len--)
+                            *out++ = *from++;
+                    }
                 }
             }
             else if((op & 64) == 0)
             {
                 // 2nd level distance code
-                cp = &distcode_[cp->val + (bi_.peek_fast() & ((1U << op) - 1))];
+                cp = &distcode_[cp->val + (hold & ((1U << op) - 1))];
                 goto dodist;
             }
             else
@@ -1088,7 +1382,7 @@ inflate_fast(ranges& r, error_code& ec)
         else if((op & 64) == 0)
         {
             // 2nd level length code
-            cp = &lencode_[cp->val + (bi_.peek_fast() & ((1U << op) - 1))];
+            cp = &lencode_[cp->val + (hold & ((1U << op) - 1))];
             goto dolen;
         }
         else if(op & 32)
@@ -1104,10 +1398,18 @@ inflate_fast(ranges& r, error_code& ec)
             break;
         }
     }
-    while(r.in.next < last && r.out.next < end);
+    while(in < last && out < end);
 
     // return unused bytes (on entry, bits < 8, so in won't go too far back)
-    bi_.rewind(r.in.next);
+    len = (std::min)(bits >> 3,
+        static_cast<unsigned>(in - r.in.next));
+    in -= len;
+    bits -= len << 3;
+    BOOST_ASSERT(bits <= 32);
+    hold &= (std::uint64_t{1} << bits) - 1;
+    bi_.assign(static_cast<std::uint32_t>(hold), bits);
+    r.in.next = in;
+    r.out.next = out;
 }
 
 } // detail
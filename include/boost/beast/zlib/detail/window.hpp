@@ -75,6 +75,20 @@ public:
         return size_;
     }
 
+    std::size_t
+    allocated_size() const
+    {
+        return p_ ? capacity_ : 0;
+    }
+
+    void
+    clear()
+    {
+        p_.reset();
+        i_ = 0;
+        size_ = 0;
+    }
+
     void
     reset(int bits)
     {
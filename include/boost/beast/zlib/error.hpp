@@ -136,10 +136,33 @@ enum class error
     /// Incomplete length set
     incomplete_length_set,
 
+    /// general error
+    general,
 
+    //
+    // Errors generated by the zlib and gzip formats
+    //
 
-    /// general error
-    general
+    /// Incorrect header check
+    incorrect_header_check,
+
+    /// Unknown compression method
+    unknown_compression_method,
+
+    /// Invalid window size
+    invalid_window_size,
+
+    /// Unknown header flags set
+    unknown_header_flags,
+
+    /// Incorrect header crc
+    incorrect_header_crc,
+
+    /// Incorrect data check
+    incorrect_data_check,
+
+    /// Incorrect length check
+    incorrect_length_check
 };
 
 } // zlib
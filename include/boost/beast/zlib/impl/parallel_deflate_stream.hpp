@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_ZLIB_IMPL_PARALLEL_DEFLATE_STREAM_HPP
+#define BOOST_BEAST_ZLIB_IMPL_PARALLEL_DEFLATE_STREAM_HPP
+
+#include <boost/beast/core/async_base.hpp>
+#include <boost/beast/core/detail/is_invocable.hpp>
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace boost {
+namespace beast {
+namespace zlib {
+
+struct parallel_deflate_stream::job
+{
+    std::vector<std::uint8_t> in;   // dictionary, then the block
+    std::size_t dict = 0;           // size of the dictionary
+    std::vector<std::uint8_t> out;  // the compressed block
+    std::size_t pos = 0;            // bytes of out copied
+    int level;
+    Strategy strategy;
+    bool last = false;
+    error_code ec;
+    bool started = false;           // guarded by state::m
+    bool done = false;              // guarded by state::m
+};
+
+// State shared with the jobs on the executor
+struct parallel_deflate_stream::state
+{
+    executor_type ex;
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<std::unique_ptr<deflate_stream>> idle;
+    job const* waiting = nullptr;   // job the suspended write waits for
+    executor_type op_ex;            // executor of the suspended write
+    saved_handler op;               // the suspended write
+
+    explicit
+    state(executor_type ex_)
+        : ex(std::move(ex_))
+    {
+    }
+};
+
+template<class Handler>
+class parallel_deflate_stream::write_op
+    : public beast::async_base<Handler, executor_type>
+{
+    parallel_deflate_stream& s_;
+    z_params& zs_;
+    Flush flush_;
+    std::size_t total_in_;
+    std::size_t total_out_;
+
+public:
+    template<class Handler_>
+    write_op(
+        Handler_&& h,
+        parallel_deflate_stream& s,
+        z_params& zs,
+        Flush flush)
+        : async_base<Handler, executor_type>(
+            std::forward<Handler_>(h), s.get_executor())
+        , s_(s)
+        , zs_(zs)
+        , flush_(flush)
+        , total_in_(zs.total_in)
+        , total_out_(zs.total_out)
+    {
+        (*this)(false);
+    }
+
+    void
+    operator()(bool cont = true)
+    {
+        error_code ec;
+        while(s_.step(zs_, flush_, ec))
+        {
+            // Suspend until the oldest block is compressed
+            auto& st = *s_.st_;
+            std::lock_guard<std::mutex> lock(st.m);
+            auto const& j = *s_.jobs_.front();
+            if(j.done)
+                continue;
+            st.waiting = &j;
+            st.op_ex = this->get_executor();
+            st.op.emplace(std::move(*this));
+            return;
+        }
+        if(! ec &&
+            zs_.total_in == total_in_ &&
+            zs_.total_out == total_out_)
+            ec = error::need_buffers;
+        this->complete(cont, ec);
+    }
+};
+
+struct parallel_deflate_stream::run_write_op
+{
+    template<class WriteHandler>
+    void
+    operator()(
+        WriteHandler&& h,
+        parallel_deflate_stream* s,
+        z_params* zs,
+        Flush flush)
+    {
+        // If you get an error on the following line it means
+        // that your handler does not meet the documented type
+        // requirements for the handler.
+
+        static_assert(
+            beast::detail::is_invocable<WriteHandler,
+            void(error_code)>::value,
+            "WriteHandler type requirements not met");
+
+        write_op<
+            typename std::decay<WriteHandler>::type>(
+                std::forward<WriteHandler>(h),
+                *s,
+                *zs,
+                flush);
+    }
+};
+
+template<class WriteHandler>
+BOOST_BEAST_ASYNC_RESULT1(WriteHandler)
+parallel_deflate_stream::
+async_write(
+    z_params& zs,
+    Flush flush,
+    WriteHandler&& handler)
+{
+    return net::async_initiate<
+        WriteHandler,
+        void(error_code)>(
+            run_write_op{},
+            handler,
+            this,
+            &zs,
+            flush);
+}
+
+} // zlib
+} // beast
+} // boost
+
+#endif
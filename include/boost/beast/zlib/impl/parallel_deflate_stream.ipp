@@ -0,0 +1,420 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_ZLIB_IMPL_PARALLEL_DEFLATE_STREAM_IPP
+#define BOOST_BEAST_ZLIB_IMPL_PARALLEL_DEFLATE_STREAM_IPP
+
+#include <boost/beast/zlib/parallel_deflate_stream.hpp>
+#include <boost/beast/zlib/detail/checksum.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/make_unique.hpp>
+#include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace boost {
+namespace beast {
+namespace zlib {
+
+parallel_deflate_stream::
+parallel_deflate_stream(
+    executor_type ex,
+    std::size_t max_jobs)
+    : st_(std::make_shared<state>(std::move(ex)))
+    , max_jobs_(max_jobs)
+{
+    if(max_jobs_ == 0)
+        max_jobs_ = (std::max)(1u,
+            std::thread::hardware_concurrency());
+    reset();
+}
+
+parallel_deflate_stream::
+~parallel_deflate_stream() = default;
+
+auto
+parallel_deflate_stream::
+get_executor() const noexcept ->
+    executor_type
+{
+    return st_->ex;
+}
+
+void
+parallel_deflate_stream::
+reset(
+    int level,
+    Strategy strategy,
+    Wrap wrap)
+{
+    if(level == default_size)
+        level = 6;
+    if(level < 0 || level > 9)
+        BOOST_THROW_EXCEPTION(std::invalid_argument{
+            "invalid level"});
+    level_ = level;
+    strategy_ = strategy;
+    wrap_ = wrap;
+    cur_block_size_ = block_size_;
+
+    // Blocks still being compressed finish on their own
+    jobs_.clear();
+    cur_.reset();
+    prev_.reset();
+    pending_.clear();
+    pending_pos_ = 0;
+    check_ = wrap_ == Wrap::zlib ? 1 : 0;
+    in_size_ = 0;
+    started_ = false;
+    finishing_ = false;
+    finished_ = false;
+}
+
+void
+parallel_deflate_stream::
+write(z_params& zs, Flush flush, error_code& ec)
+{
+    auto const total_in = zs.total_in;
+    auto const total_out = zs.total_out;
+    ec = {};
+    while(step(zs, flush, ec))
+        wait_head();
+    if(! ec &&
+        zs.total_in == total_in &&
+        zs.total_out == total_out)
+        ec = error::need_buffers;
+}
+
+bool
+parallel_deflate_stream::
+head_done() const
+{
+    std::lock_guard<std::mutex> lock(st_->m);
+    return jobs_.front()->done;
+}
+
+void
+parallel_deflate_stream::
+wait_head() const
+{
+    auto& j = *jobs_.front();
+    // Rather than wait for a job nobody has started, which
+    // never ends if this thread is the one which would run
+    // it, compress the block here.
+    compress(st_, j);
+    std::unique_lock<std::mutex> lock(st_->m);
+    st_->cv.wait(lock,
+        [&j]
+        {
+            return j.done;
+        });
+}
+
+// Compress one block on the executor, unless
+// it was already started by another caller
+void
+parallel_deflate_stream::
+compress(std::shared_ptr<state> const& sp, job& j)
+{
+    auto& st = *sp;
+    std::unique_ptr<deflate_stream> c;
+    {
+        std::lock_guard<std::mutex> lock(st.m);
+        if(j.started)
+            return;
+        j.started = true;
+        if(! st.idle.empty())
+        {
+            c = std::move(st.idle.back());
+            st.idle.pop_back();
+        }
+    }
+
+    error_code ec;
+    try
+    {
+        if(! c)
+            c = boost::make_unique<deflate_stream>();
+        c->reset(j.level, 15, 8, j.strategy);
+        if(j.dict > 0)
+            c->dictionary(j.in.data(), j.dict, ec);
+        auto const n = j.in.size() - j.dict;
+        z_params zs;
+        zs.next_in = j.in.data() + j.dict;
+        zs.avail_in = n;
+        // Room for the empty stored block after a sync flush
+        j.out.resize(c->upper_bound(n) + 8);
+        auto const flush = j.last ? Flush::finish : Flush::sync;
+        while(! ec)
+        {
+            zs.next_out = j.out.data() + zs.total_out;
+            zs.avail_out = j.out.size() - zs.total_out;
+            c->write(zs, flush, ec);
+            if(ec == error::end_of_stream)
+            {
+                ec = {};
+                break;
+            }
+            if(ec == error::need_buffers)
+                ec = {};
+            if(! j.last && zs.avail_out > 0)
+                break;
+            j.out.resize(j.out.size() * 2);
+        }
+        j.out.resize(zs.total_out);
+    }
+    catch(std::bad_alloc const&)
+    {
+        // The waiters must still be woken
+        ec = make_error_code(errc::not_enough_memory);
+        c.reset();
+    }
+
+    executor_type op_ex;
+    {
+        std::lock_guard<std::mutex> lock(st.m);
+        if(c)
+            st.idle.emplace_back(std::move(c));
+        j.ec = ec;
+        j.done = true;
+        if(st.waiting == &j)
+        {
+            st.waiting = nullptr;
+            op_ex = std::move(st.op_ex);
+        }
+    }
+    st.cv.notify_all();
+    if(op_ex)
+        net::post(op_ex,
+            [sp]
+            {
+                sp->op.invoke();
+            });
+}
+
+// Submit the current block, which may be empty
+void
+parallel_deflate_stream::
+submit(bool last)
+{
+    if(! cur_)
+        cur_ = std::make_shared<job>();
+    auto j = std::move(cur_);
+    j->level = level_;
+    j->strategy = strategy_;
+    j->last = last;
+    jobs_.push_back(j);
+    prev_ = j;
+    auto sp = st_;
+    net::post(st_->ex,
+        [sp, j]
+        {
+            compress(sp, *j);
+        });
+}
+
+/*  Make as much progress as possible without waiting.
+    Returns true if the caller should wait for the oldest
+    job to finish, and then call again.
+*/
+bool
+parallel_deflate_stream::
+step(z_params& zs, Flush flush, error_code& ec)
+{
+    if(zs.next_out == nullptr)
+    {
+        ec = error::stream_error;
+        return false;
+    }
+
+    auto const copy_out =
+        [&zs](void const* p, std::size_t n)
+        {
+            n = (std::min)(n, zs.avail_out);
+            if(n > 0)
+                std::memcpy(zs.next_out, p, n);
+            zs.next_out = static_cast<std::uint8_t*>(zs.next_out) + n;
+            zs.avail_out -= n;
+            zs.total_out += n;
+            return n;
+        };
+
+    if(! started_)
+    {
+        started_ = true;
+        std::uint8_t level_flags;
+        if(strategy_ >= Strategy::huffman || level_ < 2)
+            level_flags = 0;
+        else if(level_ < 6)
+            level_flags = 1;
+        else if(level_ == 6)
+            level_flags = 2;
+        else
+            level_flags = 3;
+        if(wrap_ == Wrap::zlib)
+        {
+            // A 32KB window, see RFC 1950 section 2.2
+            unsigned header = (0x78u << 8) |
+                (unsigned{level_flags} << 6);
+            header += 31 - (header % 31);
+            pending_.push_back(static_cast<char>(header >> 8));
+            pending_.push_back(static_cast<char>(header & 0xff));
+        }
+        else if(wrap_ == Wrap::gzip)
+        {
+            // See RFC 1952 section 2.3
+            char const header[] = {
+                '\x1f', '\x8b', 8, 0, 0, 0, 0, 0,
+                static_cast<char>(level_ == 9 ? 2 :
+                    level_flags == 0 ? 4 : 0),
+                '\xff' };
+            pending_.assign(header, sizeof(header));
+        }
+    }
+
+    for(;;)
+    {
+        // Header or trailer
+        pending_pos_ += copy_out(
+            pending_.data() + pending_pos_,
+            pending_.size() - pending_pos_);
+        if(pending_pos_ < pending_.size())
+            return false;
+
+        // Compressed blocks, in order
+        if(! jobs_.empty() && head_done())
+        {
+            auto& j = *jobs_.front();
+            if(j.ec)
+            {
+                ec = j.ec;
+                return false;
+            }
+            j.pos += copy_out(
+                j.out.data() + j.pos, j.out.size() - j.pos);
+            if(j.pos < j.out.size())
+                return false;
+            if(j.last)
+            {
+                finished_ = true;
+                pending_.clear();
+                pending_pos_ = 0;
+                auto const put =
+                    [this](std::uint32_t v, bool big)
+                    {
+                        for(int i = 0; i < 4; ++i)
+                            pending_.push_back(static_cast<char>(
+                                v >> (big ? 24 - 8 * i : 8 * i)));
+                    };
+                if(wrap_ == Wrap::zlib)
+                {
+                    put(check_, true);
+                }
+                else if(wrap_ == Wrap::gzip)
+                {
+                    put(check_, false);
+                    put(in_size_, false);
+                }
+            }
+            jobs_.pop_front();
+            continue;
+        }
+
+        if(finished_)
+        {
+            if(zs.avail_in > 0)
+                ec = error::stream_error;
+            else if(flush == Flush::finish)
+                ec = error::end_of_stream;
+            return false;
+        }
+
+        // Input
+        if(zs.avail_in > 0)
+        {
+            if(finishing_)
+            {
+                ec = error::stream_error;
+                return false;
+            }
+            if(! cur_)
+            {
+                // Start with the end of the input before
+                // it, so matches may reach back into it
+                cur_ = std::make_shared<job>();
+                if(prev_)
+                {
+                    auto const& p = prev_->in;
+                    auto const n = (std::min)(
+                        p.size(), std::size_t{32768});
+                    cur_->in.reserve(n + cur_block_size_);
+                    cur_->in.assign(p.end() - n, p.end());
+                    cur_->dict = n;
+                }
+                else
+                {
+                    cur_->in.reserve(cur_block_size_);
+                }
+            }
+            auto& in = cur_->in;
+            auto const used = in.size() - cur_->dict;
+            if(used >= cur_block_size_)
+            {
+                if(jobs_.size() >= max_jobs_)
+                    return zs.avail_out > 0;
+                submit(false);
+                continue;
+            }
+            auto const n = (std::min)(
+                zs.avail_in, cur_block_size_ - used);
+            auto const p = static_cast<
+                std::uint8_t const*>(zs.next_in);
+            in.insert(in.end(), p, p + n);
+            if(wrap_ == Wrap::zlib)
+            {
+                check_ = detail::adler32(check_, p, n);
+            }
+            else if(wrap_ == Wrap::gzip)
+            {
+                check_ = detail::crc32(check_, p, n);
+                in_size_ += static_cast<std::uint32_t>(n);
+            }
+            zs.next_in = p + n;
+            zs.avail_in -= n;
+            zs.total_in += n;
+            if(used + n == cur_block_size_ &&
+                    jobs_.size() < max_jobs_)
+                submit(false);
+            continue;
+        }
+
+        if(flush == Flush::none)
+            return false;
+
+        // Flush the rest of the input
+        if(cur_ || (flush == Flush::finish && ! finishing_))
+        {
+            if(jobs_.size() >= max_jobs_)
+                return zs.avail_out > 0;
+            finishing_ = flush == Flush::finish;
+            submit(finishing_);
+            continue;
+        }
+        return ! jobs_.empty() && zs.avail_out > 0;
+    }
+}
+
+} // zlib
+} // beast
+} // boost
+
+#endif
@@ -73,8 +73,8 @@ public:
     /** Reset the stream.
 
         This puts the stream in a newly constructed state with
-        the previously specified window size, but without de-allocating
-        any dynamically created structures.
+        the previously specified window size and container format,
+        but without de-allocating any dynamically created structures.
     */
     void
     reset()
@@ -85,18 +85,28 @@ public:
     /** Reset the stream.
 
         This puts the stream in a newly constructed state with the
-        specified window size, but without de-allocating any dynamically
-        created structures.
+        specified window size and container format, but without
+        de-allocating any dynamically created structures.
+
+        @param windowBits The base two logarithm of the window size.
+
+        @param wrap The container format of the input. For the zlib
+        and gzip formats, the header is checked before the compressed
+        data, and the check value in the trailer is compared with the
+        output before `write` reports `error::end_of_stream`. A zlib
+        header which requires a larger window than `windowBits` is an
+        error.
     */
     void
-    reset(int windowBits)
+    reset(int windowBits, Wrap wrap = Wrap::none)
     {
-        doReset(windowBits);
+        doReset(windowBits, wrap);
     }
 
     /** Put the stream in a newly constructed state.
 
-        All dynamically allocated memory is de-allocated.
+        The stream is reset with the previously specified window
+        size, and all dynamically allocated memory is de-allocated.
     */
     void
     clear()
@@ -104,6 +114,49 @@ public:
         doClear();
     }
 
+    /** Set the preset dictionary.
+
+        This function primes the decompressor with the dictionary
+        used by the compressor, see @ref deflate_stream::dictionary.
+
+        For the zlib format, `write` returns `error::need_dict`
+        after a header which names a dictionary, and this must then
+        be called before `write` is called again. The dictionary is
+        checked against the Adler-32 in the header. For raw deflate,
+        which does not name its dictionary, this may be called at
+        any time, usually right after a reset. The gzip format does
+        not support a dictionary.
+
+        @param dict A pointer to the dictionary.
+
+        @param size The size of the dictionary in bytes.
+
+        @param ec Set to `error::incorrect_data_check` if the
+        dictionary is not the one named in the zlib header, or
+        `error::stream_error` if a dictionary cannot be set at
+        this point of the stream.
+    */
+    void
+    dictionary(
+        void const* dict,
+        std::size_t size,
+        error_code& ec)
+    {
+        doDictionary(static_cast<
+            std::uint8_t const*>(dict), size, ec);
+    }
+
+    /** Returns the number of bytes of dynamically allocated memory.
+
+        This is the size of the window, which is zero until the
+        first output is produced after construction or `clear`.
+    */
+    std::size_t
+    allocated_size() const
+    {
+        return doAllocatedSize();
+    }
+
     /** Decompress input and produce output.
 
         This function decompresses as much data as possible, and stops when
@@ -184,19 +237,17 @@ public:
         `Flush::trees` is used, and when `write` avoids the allocation of memory for a
         sliding window when `Flush::finish` is used.
 
-        If a preset dictionary is needed after this call,
-        `write` sets `zs.adler` to the Adler-32 checksum of the dictionary chosen by
-        the compressor and returns `error::need_dictionary`; otherwise it sets
-        `zs.adler` to the Adler-32 checksum of all output produced so far (that is,
-        `zs.total_out bytes`) and returns no error, `error::end_of_stream`, or an
-        error code as described below. At the end of the stream, `write` checks that
-        its computed adler32 checksum is equal to that saved by the compressor and
-        returns `error::end_of_stream` only if the checksum is correct.
+        If a preset dictionary is needed after this call, `write` returns
+        `error::need_dict`, and the dictionary must be provided with
+        @ref dictionary before `write` is called again. At the end of a zlib
+        or gzip stream, `write` checks that the check value of the output is
+        equal to that saved by the compressor and returns `error::end_of_stream`
+        only if the check value is correct.
 
         This function returns no error if some progress has been made (more input
         processed or more output produced), `error::end_of_stream` if the end of the
         compressed data has been reached and all uncompressed output has been produced,
-        `error::need_dictionary` if a preset dictionary is needed at this point,
+        `error::need_dict` if a preset dictionary is needed at this point,
         `error::invalid_data` if the input data was corrupted (input stream not
         conforming to the zlib format or incorrect check value), `error::stream_error`
         if the stream structure was inconsistent (for example if `zs.next_in` or
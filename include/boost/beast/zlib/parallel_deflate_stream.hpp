@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#ifndef BOOST_BEAST_ZLIB_PARALLEL_DEFLATE_STREAM_HPP
+#define BOOST_BEAST_ZLIB_PARALLEL_DEFLATE_STREAM_HPP
+
+#include <boost/beast/core/detail/config.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/core/saved_handler.hpp>
+#include <boost/beast/zlib/zlib.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/executor.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace zlib {
+
+/** Deflate compressor which compresses blocks in parallel.
+
+    The input is split into blocks of equal size, which are
+    compressed concurrently by submitting each one to an
+    executor, usually that of a `net::thread_pool`. Each block
+    except the first is compressed with the last 32KB of the
+    input before it as a preset dictionary, so matches may
+    reach back across block boundaries, and each block except
+    the last ends with an empty stored block so that it ends
+    on a byte boundary. The compressed blocks are joined in
+    order into one DEFLATE stream, optionally in the zlib or
+    gzip format, which any inflater can decompress. This is
+    the method used by pigz.
+
+    The output is a few bytes per block larger than that of a
+    @ref deflate_stream with the same settings, and the input
+    is only compressed when a block is full or the stream is
+    flushed. At most @ref max_jobs blocks, each holding up to
+    twice @ref block_size bytes, are in memory at once.
+
+    The stream is used like a @ref deflate_stream: each call
+    to @ref write or @ref async_write consumes input and
+    produces output through a @ref z_params. A synchronous
+    write blocks the calling thread while it waits for a
+    block to be compressed, and an asynchronous write
+    suspends until then instead. If no thread has started
+    on the block a synchronous write waits for, the calling
+    thread compresses it, so a write made from a thread of
+    the executor can not deadlock. An asynchronous write
+    needs some thread to run the executor.
+
+    @par Thread Safety
+    @e Distinct @e objects: Safe.@n
+    @e Shared @e objects: Unsafe.
+*/
+class parallel_deflate_stream
+{
+    struct job;
+    struct state;
+
+    template<class Handler>
+    class write_op;
+
+    struct run_write_op;
+
+    std::shared_ptr<state> st_;
+    std::deque<std::shared_ptr<job>> jobs_; // submitted, in order
+    std::shared_ptr<job> cur_;              // block being filled
+    std::shared_ptr<job> prev_;             // block last submitted
+    std::string pending_;           // header or trailer bytes
+    std::size_t pending_pos_ = 0;   // bytes of pending_ copied out
+    std::size_t block_size_ = 131072;
+    std::size_t cur_block_size_;    // block_size_ as of reset
+    std::size_t max_jobs_;
+    int level_ = 6;
+    Strategy strategy_ = Strategy::normal;
+    Wrap wrap_ = Wrap::none;
+    std::uint32_t check_ = 0;       // check value of the input
+    std::uint32_t in_size_ = 0;     // input size modulo 2^32
+    bool started_ = false;          // header is pending or written
+    bool finishing_ = false;        // last block submitted
+    bool finished_ = false;         // trailer is pending or written
+
+    BOOST_BEAST_DECL
+    static
+    void
+    compress(std::shared_ptr<state> const& sp, job& j);
+
+    BOOST_BEAST_DECL
+    void
+    submit(bool last);
+
+    BOOST_BEAST_DECL
+    bool
+    step(z_params& zs, Flush flush, error_code& ec);
+
+    BOOST_BEAST_DECL
+    bool
+    head_done() const;
+
+    BOOST_BEAST_DECL
+    void
+    wait_head() const;
+
+public:
+    /// The type of the executor used to compress blocks
+    using executor_type = net::executor;
+
+    /** Constructor
+
+        @param ex The executor used to compress blocks.
+
+        @param max_jobs The largest number of blocks submitted
+        at once. The default is the number of hardware threads.
+    */
+    BOOST_BEAST_DECL
+    explicit
+    parallel_deflate_stream(
+        executor_type ex,
+        std::size_t max_jobs = 0);
+
+    /** Destructor
+
+        Blocks being compressed when the stream is destroyed
+        are discarded when they finish.
+    */
+    BOOST_BEAST_DECL
+    ~parallel_deflate_stream();
+
+    parallel_deflate_stream(
+        parallel_deflate_stream const&) = delete;
+    parallel_deflate_stream& operator=(
+        parallel_deflate_stream const&) = delete;
+
+    /// Returns the executor used to compress blocks
+    BOOST_BEAST_DECL
+    executor_type
+    get_executor() const noexcept;
+
+    /** Reset the stream and compression settings.
+
+        Any unprocessed input, pending output and blocks not
+        yet compressed are discarded. The window size is always
+        32KB and the memory level is the default.
+
+        @param level The compression level, from 0 to 9, or
+        -1 for the default.
+
+        @param strategy The compression strategy.
+
+        @param wrap The container format of the output.
+    */
+    BOOST_BEAST_DECL
+    void
+    reset(
+        int level = 6,
+        Strategy strategy = Strategy::normal,
+        Wrap wrap = Wrap::none);
+
+    /// Returns the size of each block of input
+    std::size_t
+    block_size() const noexcept
+    {
+        return block_size_;
+    }
+
+    /** Set the size of each block of input.
+
+        Smaller blocks allow more parallelism on small inputs,
+        at the cost of a few bytes of output per block. The new
+        size takes effect at the next call to @ref reset. The
+        default is 128KB.
+    */
+    void
+    block_size(std::size_t n)
+    {
+        BOOST_ASSERT(n > 0);
+        block_size_ = n;
+    }
+
+    /// Returns the largest number of blocks submitted at once
+    std::size_t
+    max_jobs() const noexcept
+    {
+        return max_jobs_;
+    }
+
+    /** Compress input and write output.
+
+        This function consumes input from `zs.next_in` into
+        the current block, submits each full block to the
+        executor, and writes the output of the compressed
+        blocks to `zs.next_out` in order, with the header and
+        trailer of the container format. The calling thread
+        blocks while it waits for the oldest block submitted
+        when that is the only way to make progress.
+
+        @li With `Flush::none`, the call returns when all the
+        input is consumed or the output is full. The output of
+        blocks still being compressed is written by later calls.
+
+        @li With `Flush::finish`, the remaining input is
+        submitted as the last block, and the call returns
+        `error::end_of_stream` once all the output is written.
+        No more input may be provided until the stream is reset.
+
+        @li Any other flush value submits the remaining input
+        as a block and returns when all of the output so far is
+        written, which ends on a byte boundary.
+
+        @return `error::need_buffers` if no progress was
+        possible, or `error::stream_error` if input is provided
+        after the stream is finished.
+    */
+    BOOST_BEAST_DECL
+    void
+    write(z_params& zs, Flush flush, error_code& ec);
+
+    /** Compress input and write output asynchronously.
+
+        This behaves like @ref write, except that instead of
+        blocking, the operation suspends until the block it
+        waits for is compressed. The caller must not start
+        another operation on the stream until it completes.
+
+        @param zs The input and output areas, which must
+        remain valid until the handler is called.
+
+        @param flush The flush mode, as for @ref write.
+
+        @param handler The completion handler to invoke when
+        the operation completes. The equivalent function
+        signature of the handler must be:
+        @code
+        void handler(
+            error_code const& ec    // Result of operation
+        );
+        @endcode
+        Regardless of whether the asynchronous operation
+        completes immediately or not, the handler will not be
+        invoked from within this function. Invocation of the
+        handler will be performed in a manner equivalent to
+        using `net::post`.
+    */
+    template<
+        BOOST_BEAST_ASYNC_TPARAM1 WriteHandler =
+            net::default_completion_token_t<executor_type>>
+    BOOST_BEAST_ASYNC_RESULT1(WriteHandler)
+    async_write(
+        z_params& zs,
+        Flush flush,
+        WriteHandler&& handler =
+            net::default_completion_token_t<executor_type>{});
+};
+
+} // zlib
+} // beast
+} // boost
+
+#include <boost/beast/zlib/impl/parallel_deflate_stream.hpp>
+#ifdef BOOST_BEAST_HEADER_ONLY
+#include <boost/beast/zlib/impl/parallel_deflate_stream.ipp>
+#endif
+
+#endif
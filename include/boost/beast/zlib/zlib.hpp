@@ -175,6 +175,34 @@ enum class Strategy
     fixed
 };
 
+/** Stream container format.
+
+    This selects the framing written around the compressed
+    data by a deflate stream, and expected around it by an
+    inflate stream.
+*/
+enum class Wrap
+{
+    /// Raw deflate data (RFC 1951), without a header or trailer.
+    none,
+
+    /** The zlib format (RFC 1950).
+
+        The data has a two byte header and is followed by
+        the Adler-32 check value of the uncompressed data.
+        This is the HTTP "deflate" content coding.
+    */
+    zlib,
+
+    /** The gzip format (RFC 1952).
+
+        The data has a header of at least ten bytes and is
+        followed by the CRC-32 check value and the size of the
+        uncompressed data. This is the HTTP "gzip" content coding.
+    */
+    gzip
+};
+
 } // zlib
 } // beast
 } // boost
@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/file_uring.hpp>
+
+#if BOOST_BEAST_USE_IO_URING && BOOST_BEAST_USE_POSIX_FILE
+
+#include "../core/file_test.hpp"
+
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/http/file_body.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/filesystem.hpp>
+#include <string>
+
+namespace boost {
+namespace beast {
+
+BOOST_STATIC_ASSERT(is_file<file_uring>::value);
+
+class file_uring_test
+    : public unit_test::suite
+{
+public:
+    void
+    testBody()
+    {
+        auto const temp = boost::filesystem::unique_path();
+        std::string const text(100000, 'z');
+        {
+            error_code ec;
+            file_uring f;
+            f.open(temp.string<std::string>().c_str(),
+                file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(f.write(text.data(), text.size(), ec) ==
+                text.size());
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+        {
+            net::io_context ioc;
+            test::stream ts(ioc);
+            test::stream tr(ioc);
+            ts.connect(tr);
+
+            http::response<http::basic_file_body<file_uring>> res;
+            error_code ec;
+            res.body().open(temp.string<std::string>().c_str(),
+                file_mode::scan, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            res.prepare_payload();
+            http::write(ts, res, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            auto const s = std::string(tr.str());
+            BEAST_EXPECT(s.size() > text.size());
+            BEAST_EXPECT(s.substr(s.size() - text.size()) == text);
+        }
+        boost::filesystem::remove(temp);
+    }
+
+    void
+    run() override
+    {
+        test_file<file_uring>();
+        testBody();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,file_uring);
+
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,385 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/_experimental/core/uring_stream.hpp>
+
+#if BOOST_BEAST_USE_IO_URING
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/flat_static_buffer.hpp>
+#include <boost/beast/core/multi_buffer.hpp>
+#include <boost/beast/core/ostream.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
+#include <string>
+
+namespace boost {
+namespace beast {
+
+class uring_stream_test
+    : public unit_test::suite
+{
+public:
+    using tcp = net::ip::tcp;
+
+    // Connect two streams over the loopback interface
+    static
+    void
+    connect(
+        net::io_context& ioc,
+        uring_stream& client,
+        uring_stream& server)
+    {
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        client.socket().connect(a.local_endpoint());
+        a.accept(server.socket());
+    }
+
+    void
+    testEcho()
+    {
+        net::io_context ioc;
+        uring_stream s1(ioc);
+        uring_stream s2(ioc);
+        connect(ioc, s1, s2);
+        if(! BEAST_EXPECT(s1.is_uring()))
+            return;
+
+        std::string const text(100000, '*');
+        std::size_t n1 = 0;
+        std::size_t n2 = 0;
+        multi_buffer b;
+        net::async_write(s1, net::buffer(text),
+            [&](error_code ec, std::size_t n)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                n1 = n;
+            });
+        net::async_read(s2, b.prepare(text.size()),
+            [&](error_code ec, std::size_t n)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                n2 = n;
+                b.commit(n);
+            });
+        ioc.run();
+        BEAST_EXPECT(n1 == text.size());
+        BEAST_EXPECT(n2 == text.size());
+        BEAST_EXPECT(buffers_to_string(b.data()) == text);
+    }
+
+    void
+    testRegisteredBuffer()
+    {
+        net::io_context ioc;
+        uring_stream s1(ioc);
+        uring_stream s2(ioc);
+        connect(ioc, s1, s2);
+
+        flat_static_buffer<4096> b;
+        error_code ec;
+        auto const mb = b.prepare(b.max_size());
+        s2.register_buffer(mb, ec);
+        if(! BEAST_EXPECTS(! ec, ec.message()))
+            return;
+
+        std::string const text = "Hello, world!";
+        std::size_t n = 0;
+        net::write(s1.socket(), net::buffer(text));
+        s2.async_read_some(mb,
+            [&](error_code ec, std::size_t bytes_transferred)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                n = bytes_transferred;
+            });
+        ioc.run();
+        b.commit(n);
+        BEAST_EXPECT(buffers_to_string(b.data()) == text);
+
+        // a buffer that is not registered
+        s2.unregister_buffers();
+        char buf[16];
+        n = 0;
+        net::write(s1.socket(), net::buffer(text));
+        s2.async_read_some(net::buffer(buf),
+            [&](error_code ec, std::size_t bytes_transferred)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                n = bytes_transferred;
+            });
+        ioc.restart();
+        ioc.run();
+        BEAST_EXPECT(std::string(buf, n) == text);
+    }
+
+    void
+    testEof()
+    {
+        net::io_context ioc;
+        uring_stream s1(ioc);
+        uring_stream s2(ioc);
+        connect(ioc, s1, s2);
+
+        char buf[16];
+        error_code result;
+        s2.async_read_some(net::buffer(buf),
+            [&](error_code ec, std::size_t)
+            {
+                result = ec;
+            });
+        s1.close();
+        ioc.run();
+        BEAST_EXPECTS(result == net::error::eof, result.message());
+    }
+
+    void
+    testCancel()
+    {
+        {
+            net::io_context ioc;
+            uring_stream s1(ioc);
+            uring_stream s2(ioc);
+            connect(ioc, s1, s2);
+
+            char buf[16];
+            error_code result;
+            s2.async_read_some(net::buffer(buf),
+                [&](error_code ec, std::size_t)
+                {
+                    result = ec;
+                });
+            ioc.poll();
+            s2.cancel();
+            ioc.run();
+            BEAST_EXPECTS(result ==
+                net::error::operation_aborted, result.message());
+        }
+        {
+            net::io_context ioc;
+            uring_stream s1(ioc);
+            uring_stream s2(ioc);
+            connect(ioc, s1, s2);
+
+            char buf[16];
+            error_code result;
+            s2.async_read_some(net::buffer(buf),
+                [&](error_code ec, std::size_t)
+                {
+                    result = ec;
+                });
+            s2.close();
+            ioc.run();
+            BEAST_EXPECTS(result ==
+                net::error::operation_aborted, result.message());
+
+            // closed
+            s2.async_read_some(net::buffer(buf),
+                [&](error_code ec, std::size_t)
+                {
+                    result = ec;
+                });
+            ioc.restart();
+            ioc.run();
+            BEAST_EXPECTS(result ==
+                net::error::bad_descriptor, result.message());
+        }
+        {
+            // abandon
+            net::io_context ioc;
+            uring_stream s1(ioc);
+            uring_stream s2(ioc);
+            connect(ioc, s1, s2);
+
+            char buf[16];
+            s2.async_read_some(net::buffer(buf),
+                [&](error_code, std::size_t)
+                {
+                    BEAST_FAIL();
+                });
+            ioc.poll();
+        }
+    }
+
+    void
+    testNonBlocking()
+    {
+        net::io_context ioc;
+        uring_stream s1(ioc);
+        uring_stream s2(ioc);
+        connect(ioc, s1, s2);
+        s2.socket().non_blocking(true);
+
+        flat_static_buffer<64> b;
+        error_code ec;
+        s2.register_buffer(b.prepare(b.max_size()), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+
+        std::size_t n = 0;
+        s2.async_read_some(b.prepare(b.max_size()),
+            [&](error_code ec, std::size_t bytes_transferred)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                n = bytes_transferred;
+            });
+        ioc.poll();
+        net::write(s1.socket(), net::buffer("x", 1));
+        ioc.run();
+        BEAST_EXPECT(n == 1);
+    }
+
+    void
+    testStrand()
+    {
+        using stream_type = basic_uring_stream<tcp,
+            net::strand<net::io_context::executor_type>>;
+        net::io_context ioc;
+        stream_type s1(net::make_strand(ioc));
+        stream_type s2(net::make_strand(ioc));
+        BEAST_EXPECT(s1.is_uring());
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        s1.socket().connect(a.local_endpoint());
+        a.accept(s2.socket());
+
+        std::size_t n = 0;
+        char buf[4];
+        s1.async_write_some(net::buffer("ping", 4),
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        net::async_read(s2, net::buffer(buf),
+            [&](error_code ec, std::size_t bytes_transferred)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(s2.get_executor().running_in_this_thread());
+                n = bytes_transferred;
+            });
+        ioc.run();
+        BEAST_EXPECT(n == 4);
+    }
+
+    void
+    testHttp()
+    {
+        net::io_context ioc;
+        uring_stream s1(ioc);
+        uring_stream s2(ioc);
+        connect(ioc, s1, s2);
+
+        http::request<http::string_body> req{http::verb::post, "/", 11};
+        req.body() = std::string(50000, 'x');
+        req.prepare_payload();
+        http::async_write(s1, req,
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        flat_buffer b;
+        http::request<http::string_body> res;
+        http::async_read(s2, b, res,
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ioc.run();
+        BEAST_EXPECT(res.method() == http::verb::post);
+        BEAST_EXPECT(res.body() == req.body());
+    }
+
+    void
+    testWebsocket()
+    {
+        net::io_context ioc;
+        websocket::stream<uring_stream> ws1(ioc);
+        websocket::stream<uring_stream> ws2(ioc);
+        connect(ioc, ws1.next_layer(), ws2.next_layer());
+
+        std::string const text(10000, 'y');
+        flat_buffer b1;
+        flat_buffer b2;
+        bool closed = false;
+        ws2.async_accept(
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                ws2.async_read(b2,
+                    [&](error_code ec, std::size_t)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        ws2.async_write(b2.data(),
+                            [&](error_code ec, std::size_t)
+                            {
+                                BEAST_EXPECTS(! ec, ec.message());
+                                ws2.async_read(b2,
+                                    [&](error_code ec, std::size_t)
+                                    {
+                                        BEAST_EXPECTS(ec ==
+                                            websocket::error::closed,
+                                            ec.message());
+                                    });
+                            });
+                    });
+            });
+        ws1.async_handshake("localhost", "/",
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                ws1.async_write(net::buffer(text),
+                    [&](error_code ec, std::size_t)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        ws1.async_read(b1,
+                            [&](error_code ec, std::size_t)
+                            {
+                                BEAST_EXPECTS(! ec, ec.message());
+                                ws1.async_close({},
+                                    [&](error_code ec)
+                                    {
+                                        BEAST_EXPECTS(! ec, ec.message());
+                                        closed = true;
+                                    });
+                            });
+                    });
+            });
+        ioc.run();
+        BEAST_EXPECT(buffers_to_string(b1.data()) == text);
+        BEAST_EXPECT(closed);
+    }
+
+    void
+    run() override
+    {
+        testEcho();
+        testRegisteredBuffer();
+        testEof();
+        testCancel();
+        testNonBlocking();
+        testStrand();
+        testHttp();
+        testWebsocket();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,core,uring_stream);
+
+} // beast
+} // boost
+
+#endif
@@ -0,0 +1,276 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/async_file_body.hpp>
+
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/http/type_traits.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/filesystem.hpp>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+BOOST_STATIC_ASSERT(is_body<async_file_body>::value);
+BOOST_STATIC_ASSERT(is_body_writer<async_file_body>::value);
+BOOST_STATIC_ASSERT(! is_body_reader<async_file_body>::value);
+
+class async_file_body_test : public beast::unit_test::suite
+{
+public:
+    // A file which records the threads which read from it
+    class recording_file : public file
+    {
+        std::mutex* m_ = nullptr;
+        std::vector<std::thread::id>* ids_ = nullptr;
+
+    public:
+        void
+        record(std::mutex& m, std::vector<std::thread::id>& ids)
+        {
+            m_ = &m;
+            ids_ = &ids;
+        }
+
+        std::size_t
+        read(void* buffer, std::size_t n, error_code& ec)
+        {
+            if(ids_)
+            {
+                std::lock_guard<std::mutex> lock(*m_);
+                ids_->push_back(std::this_thread::get_id());
+            }
+            return file::read(buffer, n, ec);
+        }
+    };
+
+    using body_type = basic_async_file_body<recording_file>;
+
+    static
+    std::string
+    make_content(std::size_t n)
+    {
+        std::string s;
+        s.reserve(n);
+        for(std::size_t i = 0; i < n; ++i)
+            s.push_back(static_cast<char>('a' + i % 26));
+        return s;
+    }
+
+    struct temp_file
+    {
+        std::string path =
+            boost::filesystem::unique_path().string();
+
+        explicit
+        temp_file(string_view s)
+        {
+            error_code ec;
+            file f;
+            f.open(path.c_str(), file_mode::write, ec);
+            if(! s.empty())
+                f.write(s.data(), s.size(), ec);
+        }
+
+        ~temp_file()
+        {
+            error_code ec;
+            boost::filesystem::remove(path, ec);
+        }
+    };
+
+    static
+    std::string
+    expected(string_view s)
+    {
+        return
+            "HTTP/1.1 200 OK\r\n"
+            "Server: test\r\n"
+            "Content-Length: " + std::to_string(s.size()) + "\r\n"
+            "\r\n" + std::string(s);
+    }
+
+    void
+    open(response<body_type>& res, temp_file const& tf)
+    {
+        error_code ec;
+        res.set(field::server, "test");
+        res.body().buffer_size(1000);
+        res.body().open(tf.path.c_str(), file_mode::scan, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        res.prepare_payload();
+    }
+
+    void
+    testAsyncWrite()
+    {
+        for(std::size_t size : {
+            std::size_t{0}, std::size_t{1}, std::size_t{999},
+            std::size_t{1000}, std::size_t{1001}, std::size_t{25000}})
+        {
+            auto const s = make_content(size);
+            temp_file tf(s);
+            std::mutex m;
+            std::vector<std::thread::id> ids;
+
+            net::io_context ioc;
+            net::thread_pool pool(1);
+            test::stream ts{ioc}, tr{ioc};
+            ts.connect(tr);
+            response<body_type> res{status::ok, 11};
+            open(res, tf);
+            res.body().file().record(m, ids);
+            res.body().set_executor(pool.get_executor());
+
+            bool invoked = false;
+            async_write(ts, res,
+                [&](error_code ec, std::size_t n)
+                {
+                    invoked = true;
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(n == expected(s).size());
+                });
+            ioc.run();
+            BEAST_EXPECT(invoked);
+            BEAST_EXPECT(tr.str() == expected(s));
+
+            // Every read happened on the file executor
+            BEAST_EXPECT(ids.size() == (size + 999) / 1000);
+            for(auto const& id : ids)
+                BEAST_EXPECT(id != std::this_thread::get_id());
+            pool.join();
+        }
+    }
+
+    void
+    testWriteSome()
+    {
+        // Small writes take several calls per block
+        auto const s = make_content(10000);
+        temp_file tf(s);
+        net::io_context ioc;
+        net::thread_pool pool(2);
+        test::stream ts{ioc}, tr{ioc};
+        ts.connect(tr);
+        response<body_type> res{status::ok, 11};
+        open(res, tf);
+        res.body().set_executor(pool.get_executor());
+        serializer<false, body_type> sr{res};
+        sr.limit(333);
+        std::size_t calls = 0;
+        std::function<void(error_code, std::size_t)> next =
+            [&](error_code ec, std::size_t n)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n <= 333);
+                if(sr.is_done())
+                    return;
+                ++calls;
+                async_write_some(ts, sr, next);
+            };
+        async_write_some(ts, sr, next);
+        ioc.run();
+        BEAST_EXPECT(sr.is_done());
+        BEAST_EXPECT(calls > 30);
+        BEAST_EXPECT(tr.str() == expected(s));
+        pool.join();
+    }
+
+    void
+    testInPlace()
+    {
+        auto const s = make_content(2500);
+        temp_file tf(s);
+        std::mutex m;
+        std::vector<std::thread::id> ids;
+
+        // Synchronous write
+        {
+            net::io_context ioc;
+            test::stream ts{ioc}, tr{ioc};
+            ts.connect(tr);
+            response<body_type> res{status::ok, 11};
+            open(res, tf);
+            error_code ec;
+            write(ts, res, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(tr.str() == expected(s));
+        }
+
+        // Asynchronous write without a file executor
+        {
+            net::io_context ioc;
+            test::stream ts{ioc}, tr{ioc};
+            ts.connect(tr);
+            response<body_type> res{status::ok, 11};
+            open(res, tf);
+            res.body().file().record(m, ids);
+            async_write(ts, res,
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            ioc.run();
+            BEAST_EXPECT(tr.str() == expected(s));
+            BEAST_EXPECT(ids.size() == 3);
+            for(auto const& id : ids)
+                BEAST_EXPECT(id == std::this_thread::get_id());
+        }
+    }
+
+    void
+    testError()
+    {
+        // A write fails while the next block is being read
+        auto const s = make_content(5000);
+        temp_file tf(s);
+        net::io_context ioc;
+        net::thread_pool pool(1);
+        test::fail_count fc(2);
+        test::stream ts{ioc, fc}, tr{ioc};
+        ts.connect(tr);
+        response<body_type> res{status::ok, 11};
+        open(res, tf);
+        res.body().set_executor(pool.get_executor());
+        bool invoked = false;
+        async_write(ts, res,
+            [&](error_code ec, std::size_t)
+            {
+                invoked = true;
+                BEAST_EXPECTS(ec == test::error::test_failure,
+                    ec.message());
+            });
+        ioc.run();
+        BEAST_EXPECT(invoked);
+        pool.join();
+    }
+
+    void
+    run() override
+    {
+        testAsyncWrite();
+        testWriteSome();
+        testInPlace();
+        testError();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,async_file_body);
+
+} // http
+} // beast
+} // boost
@@ -17,6 +17,7 @@
 #include <boost/beast/core/buffers_cat.hpp>
 #include <boost/beast/core/buffers_prefix.hpp>
 #include <boost/beast/core/buffers_suffix.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
 #include <boost/beast/core/multi_buffer.hpp>
 #include <boost/beast/core/ostream.hpp>
 #include <boost/beast/http/parser.hpp>
@@ -1376,6 +1377,63 @@ public:
         BEAST_EXPECT(p.is_done());
     }
 
+    // Parse long lines once for each vector width available,
+    // placing the interesting byte at every offset so that the
+    // wide kernels, their tails, and the scalar loops all see it.
+    void
+    testWideScan()
+    {
+        using P = test_parser<true>;
+
+        auto const check = [&]
+        {
+            for(std::size_t n = 0; n < 150; n += 7)
+            {
+                std::string const pad(n, 'x');
+                parsegrind<P>(
+                    "GET /" + pad + " HTTP/1.1\r\n"
+                    "X" + pad + ": " + pad + "\x80\t\xff" + pad + "\r\n"
+                    "\r\n",
+                    [&](P const& p)
+                    {
+                        BEAST_EXPECT(p.path == "/" + pad);
+                        BEAST_EXPECT(p.fields.at("X" + pad) ==
+                            pad + "\x80\t\xff" + pad);
+                    });
+                failgrind<P>(
+                    "GET /" + pad + "\x7f HTTP/1.1\r\n"
+                    "\r\n", error::bad_target);
+                failgrind<P>(
+                    "GET / HTTP/1.1\r\n"
+                    "X" + pad + "{: 1\r\n"
+                    "\r\n", error::bad_field);
+                failgrind<P>(
+                    "GET / HTTP/1.1\r\n"
+                    "X: " + pad + "\x01" + pad + "\r\n"
+                    "\r\n", error::bad_value);
+                failgrind<P>(
+                    "GET / HTTP/1.1\r\n"
+                    "X: " + pad + "\x7f\r\n"
+                    "\r\n", error::bad_value);
+            }
+        };
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+        auto& ci = beast::detail::get_mutable_cpu_info();
+        auto const saved = ci;
+        check();
+        ci.avx512bw = false;
+        check();
+        ci.avx2 = false;
+        check();
+        ci.sse42 = false;
+        check();
+        ci = saved;
+#else
+        check();
+#endif
+    }
+
     //--------------------------------------------------------------------------
 
     void
@@ -1402,6 +1460,7 @@ public:
         testRegression1();
         testIssue1211();
         testIssue1267();
+        testWideScan();
     }
 };
 
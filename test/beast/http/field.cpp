@@ -394,6 +394,10 @@ public:
             };
         unknown("");
         unknown("x");
+        unknown("<unknown-field>");
+        unknown("Accept-");
+        unknown("Content-Lengths");
+        unknown("X-Request-Id");
     }
 
     void run() override
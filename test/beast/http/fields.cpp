@@ -16,6 +16,7 @@
 #include <boost/beast/test/test_allocator.hpp>
 #include <boost/beast/_experimental/unit_test/suite.hpp>
 #include <string>
+#include <vector>
 
 namespace boost {
 namespace beast {
@@ -405,11 +406,155 @@ public:
         BEAST_EXPECT(std::next(f.begin(), 1)->name_string() == "c");
     }
 
+    void
+    testKnownFields()
+    {
+        // Known names are found through the enum index
+        {
+            f_t f;
+            f.insert(field::accept, "a1");
+            f.insert("X-Custom", "c1");
+            f.insert("ACCEPT", "a2");
+            f.insert(field::unknown, "Host", "h");
+            f.insert("x-custom", "c2");
+            f.insert(field::accept, "a3");
+            BEAST_EXPECT(size(f) == 6);
+            BEAST_EXPECT(f.count(field::accept) == 3);
+            BEAST_EXPECT(f.count("accept") == 3);
+            BEAST_EXPECT(f.count("X-CUSTOM") == 2);
+            BEAST_EXPECT(f.count(field::host) == 1);
+            BEAST_EXPECT(f.find("host")->name() == field::host);
+            BEAST_EXPECT(f[field::host] == "h");
+            BEAST_EXPECT(f.count(field::age) == 0);
+            BEAST_EXPECT(f.find(field::age) == f.end());
+
+            // Known fields keep their insertion order
+            {
+                std::vector<std::string> v;
+                for(auto const& e : f)
+                    v.emplace_back(e.value());
+                BEAST_EXPECT((v == std::vector<std::string>{
+                    "a1", "c1", "c2", "a2", "h", "a3"}));
+            }
+
+            // The range skips the fields in between
+            auto r = f.equal_range(field::accept);
+            BEAST_EXPECT(std::distance(r.first, r.second) == 3);
+            BEAST_EXPECT(r.first->value() == "a1");
+            BEAST_EXPECT(std::next(r.first)->value() == "a2");
+            BEAST_EXPECT(std::next(r.first, 2)->value() == "a3");
+            BEAST_EXPECT(std::next(r.first, 3) == r.second);
+            BEAST_EXPECT(std::prev(r.second)->value() == "a3");
+            BEAST_EXPECT(std::prev(r.second, 2)->value() == "a2");
+            r = f.equal_range("Accept");
+            BEAST_EXPECT(std::distance(r.first, r.second) == 3);
+
+            // Erasing the first of several updates the index
+            f.erase(f.find(field::accept));
+            BEAST_EXPECT(f[field::accept] == "a2");
+            BEAST_EXPECT(f.count(field::accept) == 2);
+            f.erase(std::next(f.equal_range(field::accept).first));
+            BEAST_EXPECT(f.count(field::accept) == 1);
+            BEAST_EXPECT(f[field::accept] == "a2");
+            f.erase(f.find(field::accept));
+            BEAST_EXPECT(f.count(field::accept) == 0);
+            BEAST_EXPECT(f.find("Accept") == f.end());
+
+            // Erasing one unknown field keeps the others
+            f.erase(f.find("x-custom"));
+            BEAST_EXPECT(f["X-Custom"] == "c2");
+            BEAST_EXPECT(f.count("X-Custom") == 1);
+
+            f.set(field::host, "h2");
+            BEAST_EXPECT(f.count(field::host) == 1);
+            BEAST_EXPECT(f[field::host] == "h2");
+            BEAST_EXPECT(f.erase("HOST") == 1);
+            BEAST_EXPECT(f.find(field::host) == f.end());
+            BEAST_EXPECT(size(f) == 1);
+
+            f.insert(field::server, "s");
+            f.clear();
+            BEAST_EXPECT(f.count(field::server) == 0);
+            f.insert(field::server, "t");
+            BEAST_EXPECT(f[field::server] == "t");
+        }
+
+        // Erasing through a range
+        {
+            f_t f;
+            f.insert(field::accept, "a1");
+            f.insert(field::host, "h");
+            f.insert(field::accept, "a2");
+            f.insert(field::age, "1");
+            f.insert(field::accept, "a3");
+            auto r = f.equal_range(field::accept);
+            while(r.first != r.second)
+                r.first = f.erase(r.first);
+            BEAST_EXPECT(size(f) == 2);
+            BEAST_EXPECT(f.begin()->value() == "h");
+            BEAST_EXPECT(std::next(f.begin())->value() == "1");
+        }
+
+        // The index grows and shrinks with the names
+        {
+            f_t f;
+            int const n = static_cast<int>(field::xref);
+            for(int i = 1; i <= n; ++i)
+                f.insert(static_cast<field>(i), std::to_string(i));
+            for(int i = 1; i <= n; i += 2)
+                f.insert(static_cast<field>(i), "-");
+            for(int i = 1; i <= n; ++i)
+            {
+                auto const name = static_cast<field>(i);
+                BEAST_EXPECT(f[name] == std::to_string(i));
+                BEAST_EXPECT(f.count(name) ==
+                    static_cast<std::size_t>(i % 2 ? 2 : 1));
+            }
+            for(int i = 1; i <= n; i += 3)
+                BEAST_EXPECT(f.erase(static_cast<field>(i)) ==
+                    static_cast<std::size_t>(i % 2 ? 2 : 1));
+            for(int i = 1; i <= n; ++i)
+            {
+                auto const name = static_cast<field>(i);
+                if((i - 1) % 3 == 0)
+                    BEAST_EXPECT(f.find(name) == f.end());
+                else
+                    BEAST_EXPECT(f[name] == std::to_string(i));
+            }
+            f_t f2(f);
+            for(int i = 2; i <= n; i += 3)
+                BEAST_EXPECT(f2[static_cast<field>(i)] ==
+                    std::to_string(i));
+        }
+
+        // The index follows the fields on copy, move, and swap
+        {
+            f_t f1;
+            f1.insert(field::host, "h");
+            f1.insert(field::age, "1");
+            f_t f2(f1);
+            BEAST_EXPECT(f2[field::host] == "h");
+            f_t f3(std::move(f2));
+            BEAST_EXPECT(f3[field::age] == "1");
+            BEAST_EXPECT(f2.find(field::age) == f2.end());
+            f2.insert(field::server, "s");
+            swap(f2, f3);
+            BEAST_EXPECT(f2[field::host] == "h");
+            BEAST_EXPECT(f3[field::server] == "s");
+            BEAST_EXPECT(f3.find(field::host) == f3.end());
+            f3 = f2;
+            BEAST_EXPECT(f3.find(field::server) == f3.end());
+            BEAST_EXPECT(f3[field::age] == "1");
+            f1 = std::move(f3);
+            BEAST_EXPECT(f1[field::host] == "h");
+        }
+    }
+
     void
     testContainer()
     {
         {
-            // group fields
+            // known fields, in insertion order
             fields f;
             f.insert(field::age,   1);
             f.insert(field::body,  2);
@@ -417,16 +562,16 @@ public:
             f.insert(field::body,  4);
             BEAST_EXPECT(std::next(f.begin(), 0)->name() == field::age);
             BEAST_EXPECT(std::next(f.begin(), 1)->name() == field::body);
-            BEAST_EXPECT(std::next(f.begin(), 2)->name() == field::body);
-            BEAST_EXPECT(std::next(f.begin(), 3)->name() == field::close);
+            BEAST_EXPECT(std::next(f.begin(), 2)->name() == field::close);
+            BEAST_EXPECT(std::next(f.begin(), 3)->name() == field::body);
             BEAST_EXPECT(std::next(f.begin(), 0)->name_string() == "Age");
             BEAST_EXPECT(std::next(f.begin(), 1)->name_string() == "Body");
-            BEAST_EXPECT(std::next(f.begin(), 2)->name_string() == "Body");
-            BEAST_EXPECT(std::next(f.begin(), 3)->name_string() == "Close");
+            BEAST_EXPECT(std::next(f.begin(), 2)->name_string() == "Close");
+            BEAST_EXPECT(std::next(f.begin(), 3)->name_string() == "Body");
             BEAST_EXPECT(std::next(f.begin(), 0)->value() == "1");
             BEAST_EXPECT(std::next(f.begin(), 1)->value() == "2");
-            BEAST_EXPECT(std::next(f.begin(), 2)->value() == "4");
-            BEAST_EXPECT(std::next(f.begin(), 3)->value() == "3");
+            BEAST_EXPECT(std::next(f.begin(), 2)->value() == "3");
+            BEAST_EXPECT(std::next(f.begin(), 3)->value() == "4");
             BEAST_EXPECT(f.erase(field::body) == 2);
             BEAST_EXPECT(std::next(f.begin(), 0)->name_string() == "Age");
             BEAST_EXPECT(std::next(f.begin(), 1)->name_string() == "Close");
@@ -996,6 +1141,7 @@ public:
         testRFC2616();
         testErase();
         testIteratorErase();
+        testKnownFields();
         testContainer();
         testPreparePayload();
 
@@ -14,10 +14,20 @@
 #include <boost/beast/core/buffers_prefix.hpp>
 #include <boost/beast/core/file_stdio.hpp>
 #include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
 #include <boost/beast/http/parser.hpp>
+#include <boost/beast/http/read.hpp>
 #include <boost/beast/http/serializer.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
 #include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/asio/ip/tcp.hpp>
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
 
 namespace boost {
 namespace beast {
@@ -98,6 +108,227 @@ public:
         boost::filesystem::remove(temp, ec);
         BEAST_EXPECTS(! ec, ec.message());
     }
+#if BOOST_BEAST_USE_POSIX_SENDFILE
+    // A connected pair of loopback sockets
+    struct socket_pair
+    {
+        net::io_context ioc;
+        net::ip::tcp::socket s1{ioc};
+        net::ip::tcp::socket s2{ioc};
+
+        socket_pair()
+        {
+            net::ip::tcp::acceptor a(ioc,
+                {net::ip::make_address_v4("127.0.0.1"), 0});
+            s1.connect(a.local_endpoint());
+            a.accept(s2);
+        }
+    };
+
+    template<class Function>
+    void
+    doSendfile(
+        std::string const& path,
+        std::string const& body,
+        bool chunked,
+        Function&& f)
+    {
+        socket_pair p;
+        error_code ec;
+        response<file_body> res{status::ok, 11};
+        res.set(field::server, "test");
+        res.body().open(path.c_str(), file_mode::scan, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        if(chunked)
+            res.chunked(true);
+        else
+            res.prepare_payload();
+        serializer<false, file_body> sr{res};
+        std::thread t(
+            [&]
+            {
+                f(p.s1, sr);
+                p.s1.shutdown(net::socket_base::shutdown_send);
+            });
+        flat_buffer b;
+        response<string_body> m;
+        read(p.s2, b, m, ec);
+        t.join();
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(m[field::server] == "test");
+        BEAST_EXPECT(m.chunked() == chunked);
+        BEAST_EXPECT(m.body() == body);
+        BEAST_EXPECT(sr.is_done());
+    }
+
+    void
+    testSendfile()
+    {
+        error_code ec;
+        auto const temp = boost::filesystem::unique_path();
+        auto const path = temp.string<std::string>();
+        std::string body;
+        for(std::size_t i = 0; i < 300000; ++i)
+            body.push_back(static_cast<char>('a' + i % 26));
+        {
+            file_posix f;
+            f.open(path.c_str(), file_mode::write, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            f.write(body.data(), body.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+
+        using socket_type = net::ip::tcp::socket;
+        using sr_type = serializer<false, file_body>;
+
+        // write
+        doSendfile(path, body, false,
+            [](socket_type& s, sr_type& sr)
+            {
+                error_code ec;
+                write(s, sr, ec);
+            });
+
+        // write_some honors the limit
+        doSendfile(path, body, false,
+            [&](socket_type& s, sr_type& sr)
+            {
+                error_code ec;
+                sr.limit(10000);
+                std::size_t largest = 0;
+                while(! ec && ! sr.is_done())
+                {
+                    auto const n = write_some(s, sr, ec);
+                    BEAST_EXPECT(n <= 10000);
+                    largest = (std::max)(largest, n);
+                }
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(! sr.split());
+                // The body writer reads 4096 bytes at a time,
+                // so anything larger came from sendfile.
+                BEAST_EXPECT(largest > 4096);
+            });
+
+        // chunked bodies use the serializer
+        doSendfile(path, body, true,
+            [](socket_type& s, sr_type& sr)
+            {
+                error_code ec;
+                write(s, sr, ec);
+            });
+
+        // basic_stream
+        doSendfile(path, body, false,
+            [](socket_type& s, sr_type& sr)
+            {
+                error_code ec;
+                tcp_stream ts(std::move(s));
+                write(ts, sr, ec);
+                s = std::move(ts.socket());
+            });
+
+        // async_write
+        doSendfile(path, body, false,
+            [&](socket_type& s, sr_type& sr)
+            {
+                net::io_context ioc;
+                socket_type s1(ioc);
+                s1.assign(net::ip::tcp::v4(), s.release());
+                bool invoked = false;
+                async_write(s1, sr,
+                    [&](error_code ec, std::size_t n)
+                    {
+                        invoked = true;
+                        BEAST_EXPECTS(! ec, ec.message());
+                        BEAST_EXPECT(n > body.size());
+                    });
+                ioc.run();
+                BEAST_EXPECT(invoked);
+                s.assign(net::ip::tcp::v4(), s1.release());
+            });
+
+        // async_write_some honors the limit
+        doSendfile(path, body, false,
+            [&](socket_type& s, sr_type& sr)
+            {
+                net::io_context ioc;
+                socket_type s1(ioc);
+                s1.assign(net::ip::tcp::v4(), s.release());
+                sr.limit(65536);
+                std::size_t calls = 0;
+                std::size_t largest = 0;
+                std::function<void(error_code, std::size_t)> next =
+                    [&](error_code ec, std::size_t n)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        BEAST_EXPECT(n <= 65536);
+                        largest = (std::max)(largest, n);
+                        if(ec || sr.is_done())
+                            return;
+                        ++calls;
+                        async_write_some(s1, sr, next);
+                    };
+                next({}, 0);
+                ioc.run();
+                BEAST_EXPECT(calls > 5);
+                BEAST_EXPECT(! sr.split());
+                BEAST_EXPECT(largest > 4096);
+                s.assign(net::ip::tcp::v4(), s1.release());
+            });
+
+        // async_write_some on a tcp_stream
+        doSendfile(path, body, false,
+            [&](socket_type& s, sr_type& sr)
+            {
+                net::io_context ioc;
+                tcp_stream ts(ioc);
+                ts.socket().assign(net::ip::tcp::v4(), s.release());
+                ts.expires_after(std::chrono::seconds(30));
+                std::size_t largest = 0;
+                std::function<void(error_code, std::size_t)> next =
+                    [&](error_code ec, std::size_t n)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        largest = (std::max)(largest, n);
+                        if(ec || sr.is_done())
+                            return;
+                        async_write_some(ts, sr, next);
+                    };
+                next({}, 0);
+                ioc.run();
+                BEAST_EXPECT(! sr.split());
+                BEAST_EXPECT(largest > 4096);
+                s.assign(net::ip::tcp::v4(),
+                    ts.release_socket().release());
+            });
+
+        // a peer that stops reading times out the tcp_stream
+        {
+            socket_pair p;
+            p.s1.set_option(net::socket_base::send_buffer_size(4096));
+            p.s2.set_option(net::socket_base::receive_buffer_size(4096));
+            response<file_body> res{status::ok, 11};
+            res.body().open(path.c_str(), file_mode::scan, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            res.prepare_payload();
+            tcp_stream ts(std::move(p.s1));
+            ts.expires_after(std::chrono::milliseconds(100));
+            bool invoked = false;
+            async_write(ts, res,
+                [&](error_code ec, std::size_t)
+                {
+                    invoked = true;
+                    BEAST_EXPECTS(ec == beast::error::timeout,
+                        ec.message());
+                });
+            p.ioc.run();
+            BEAST_EXPECT(invoked);
+        }
+
+        boost::filesystem::remove(temp, ec);
+    }
+#endif
+
     void
     run() override
     {
@@ -108,6 +339,9 @@ public:
     #if BOOST_BEAST_USE_POSIX_FILE
         doTestFileBody<file_posix>();
     #endif
+    #if BOOST_BEAST_USE_POSIX_SENDFILE
+        testSendfile();
+    #endif
     }
 };
 
@@ -0,0 +1,301 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/flat_fields.hpp>
+
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/type_traits.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/test/test_allocator.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+BOOST_STATIC_ASSERT(is_fields<flat_fields>::value);
+
+class flat_fields_test : public beast::unit_test::suite
+{
+public:
+    template<class Fields>
+    static
+    std::vector<std::string>
+    names(Fields const& f)
+    {
+        std::vector<std::string> v;
+        for(auto const& e : f)
+            v.emplace_back(std::string(e.name_string()) +
+                "=" + std::string(e.value()));
+        return v;
+    }
+
+    template<bool isRequest, class Fields>
+    static
+    std::string
+    str(header<isRequest, Fields> const& h)
+    {
+        std::ostringstream ss;
+        ss << h;
+        return ss.str();
+    }
+
+    void
+    testInsert()
+    {
+        flat_fields f;
+        BEAST_EXPECT(f.begin() == f.end());
+        f.insert(field::host, "example.com");
+        f.insert("X-Custom", "one");
+        f.insert(field::accept, "*/*");
+        f.insert("x-custom", "two");
+        f.insert(field::host, "example.org");
+        f.insert(field::user_agent, "  test\t");
+        BEAST_EXPECT((names(f) == std::vector<std::string>{
+            "Host=example.com",
+            "Host=example.org",
+            "X-Custom=one",
+            "x-custom=two",
+            "Accept=*/*",
+            "User-Agent=test"}));
+
+        BEAST_EXPECT(f.count(field::host) == 2);
+        BEAST_EXPECT(f.count("HOST") == 2);
+        BEAST_EXPECT(f.count("X-CUSTOM") == 2);
+        BEAST_EXPECT(f.count(field::age) == 0);
+        BEAST_EXPECT(f[field::host] == "example.com");
+        BEAST_EXPECT(f["x-Custom"] == "one");
+        BEAST_EXPECT(f["X-Missing"].empty());
+        BEAST_EXPECT(f.at(field::accept) == "*/*");
+        BEAST_EXPECT(f.at("user-agent") == "test");
+        BEAST_THROWS(f.at(field::age), std::out_of_range);
+        BEAST_THROWS(f.at("X-Missing"), std::out_of_range);
+
+        auto const r = f.equal_range("x-custom");
+        BEAST_EXPECT(std::distance(r.first, r.second) == 2);
+        BEAST_EXPECT(r.first->value() == "one");
+        BEAST_EXPECT(r.first->name() == field::unknown);
+        BEAST_EXPECT(std::next(r.first)->value() == "two");
+        BEAST_EXPECT(f.equal_range(field::age).first == f.end());
+        BEAST_EXPECT(f.find(field::accept)->name() == field::accept);
+        BEAST_EXPECT(f.find("X-Missing") == f.end());
+
+        // Insert a value taken from the container itself
+        f.insert("X-Copy", f[field::accept]);
+        BEAST_EXPECT(f["X-Copy"] == "*/*");
+    }
+
+    void
+    testSetErase()
+    {
+        flat_fields f;
+        f.insert(field::host, "a");
+        f.insert(field::accept, "b");
+        f.insert(field::host, "c");
+        f.insert("X-Custom", "d");
+        f.set(field::host, "e");
+        BEAST_EXPECT((names(f) == std::vector<std::string>{
+            "Accept=b", "X-Custom=d", "Host=e"}));
+        f.set("x-custom", "f");
+        BEAST_EXPECT((names(f) == std::vector<std::string>{
+            "Accept=b", "Host=e", "x-custom=f"}));
+        f.set(field::host, f[field::accept]);
+        BEAST_EXPECT(f[field::host] == "b");
+
+        BEAST_EXPECT(f.erase(field::age) == 0);
+        BEAST_EXPECT(f.erase("X-CUSTOM") == 1);
+        auto it = f.erase(f.begin());
+        BEAST_EXPECT(it == f.begin());
+        BEAST_EXPECT((names(f) == std::vector<std::string>{
+            "Host=b"}));
+        it = f.erase(f.begin());
+        BEAST_EXPECT(it == f.end());
+
+        f.insert(field::host, "a");
+        f.insert(field::host, "b");
+        BEAST_EXPECT(f.erase(field::host) == 2);
+        BEAST_EXPECT(f.begin() == f.end());
+
+        f.insert(field::server, "x");
+        f.clear();
+        BEAST_EXPECT(f.begin() == f.end());
+        BEAST_EXPECT(f.count(field::server) == 0);
+    }
+
+    void
+    testLarge()
+    {
+        // Exceed the inline storage and the hash threshold
+        flat_fields f;
+        auto const n = 4 * flat_fields::hash_threshold;
+        for(std::size_t i = 0; i < n; ++i)
+            f.insert("X-Field-" + std::to_string(i),
+                std::string(40, 'a' + i % 26));
+        f.insert(field::host, "h");
+        f.insert(field::accept, "a1");
+        f.insert("X-Field-5", "dup");
+        f.insert(field::accept, "a2");
+        BEAST_EXPECT(static_cast<std::size_t>(
+            std::distance(f.begin(), f.end())) == n + 4);
+        for(std::size_t i = 0; i < n; ++i)
+            BEAST_EXPECT(f["x-field-" + std::to_string(i)] ==
+                std::string(40, 'a' + i % 26));
+        BEAST_EXPECT(f.count("X-FIELD-5") == 2);
+        BEAST_EXPECT(std::next(f.find("X-Field-5"))->value() == "dup");
+        BEAST_EXPECT(f.count(field::accept) == 2);
+        BEAST_EXPECT(f[field::host] == "h");
+
+        // Erase back below the threshold
+        for(std::size_t i = 0; i < n; ++i)
+            f.erase("X-Field-" + std::to_string(i));
+        BEAST_EXPECT((names(f) == std::vector<std::string>{
+            "Host=h", "Accept=a1", "Accept=a2"}));
+        BEAST_EXPECT(f.count(field::accept) == 2);
+
+        f.reserve(100, 10000);
+        BEAST_EXPECT(f[field::host] == "h");
+    }
+
+    void
+    testSpecial()
+    {
+        flat_fields f;
+        BEAST_THROWS(f.insert("X",
+            std::string(70000, 'x')), std::length_error);
+        BEAST_THROWS(f.insert(std::string(70000, 'x'),
+            "y"), std::length_error);
+    }
+
+    void
+    testCopyMove()
+    {
+        auto const check =
+            [&](flat_fields const& f, std::size_t n)
+            {
+                BEAST_EXPECT(static_cast<std::size_t>(
+                    std::distance(f.begin(), f.end())) == n);
+                BEAST_EXPECT(f[field::host] == "example.com");
+                BEAST_EXPECT(f["X-0"] == "0");
+            };
+        for(std::size_t n : {std::size_t{2}, std::size_t{100}})
+        {
+            flat_fields f1;
+            f1.insert(field::host, "example.com");
+            for(std::size_t i = 0; i + 1 < n; ++i)
+                f1.insert("X-" + std::to_string(i), std::to_string(i));
+            flat_fields f2(f1);
+            check(f1, n);
+            check(f2, n);
+            flat_fields f3(std::move(f2));
+            check(f3, n);
+            BEAST_EXPECT(f2.begin() == f2.end());
+            flat_fields f4;
+            f4 = f3;
+            check(f4, n);
+            flat_fields f5;
+            f5.insert(field::age, "1");
+            f5 = std::move(f4);
+            check(f5, n);
+            BEAST_EXPECT(f4.begin() == f4.end());
+            flat_fields f6;
+            f6.insert(field::age, "1");
+            swap(f5, f6);
+            check(f6, n);
+            BEAST_EXPECT(f5[field::age] == "1");
+            f6.swap(f5);
+            check(f5, n);
+            BEAST_EXPECT(f6[field::age] == "1");
+
+            using alloc_type = test::test_allocator<char,
+                false, true, true, true, true>;
+            basic_flat_fields<alloc_type> f7(f5);
+            BEAST_EXPECT(f7[field::host] == "example.com");
+            basic_flat_fields<alloc_type> f8;
+            f8 = std::move(f7);
+            BEAST_EXPECT(f8["X-0"] == "0");
+        }
+    }
+
+    void
+    testMessage()
+    {
+        {
+            request<empty_body, flat_fields> req;
+            req.method(verb::get);
+            req.target("/index.html");
+            req.set(field::host, "example.com");
+            req.set(field::user_agent, "test");
+            req.keep_alive(false);
+            req.prepare_payload();
+            BEAST_EXPECT(req.target() == "/index.html");
+            BEAST_EXPECT(req[field::host] == "example.com");
+            req.method_string("CUSTOM");
+            BEAST_EXPECT(req.method_string() == "CUSTOM");
+            BEAST_EXPECT(req.target() == "/index.html");
+            req.target("/");
+            BEAST_EXPECT(req.target() == "/");
+            BEAST_EXPECT(req[field::user_agent] == "test");
+
+            request<empty_body, fields> ref;
+            ref.method_string("CUSTOM");
+            ref.target("/");
+            ref.set(field::host, "example.com");
+            ref.set(field::user_agent, "test");
+            ref.keep_alive(false);
+            ref.prepare_payload();
+            BEAST_EXPECT(str(req.base()) == str(ref.base()));
+        }
+        {
+            response<empty_body, flat_fields> res;
+            res.result(status::not_found);
+            res.set(field::server, "test");
+            res.chunked(true);
+            BEAST_EXPECT(res.chunked());
+            BEAST_EXPECT(str(res.base()) ==
+                "HTTP/1.1 404 Not Found\r\n"
+                "Server: test\r\n"
+                "Transfer-Encoding: chunked\r\n"
+                "\r\n");
+            res.reason("Gone Fishing");
+            res.chunked(false);
+            res.content_length(5);
+            BEAST_EXPECT(res.has_content_length());
+            BEAST_EXPECT(str(res.base()) ==
+                "HTTP/1.1 404 Gone Fishing\r\n"
+                "Server: test\r\n"
+                "Content-Length: 5\r\n"
+                "\r\n");
+            res.reason({});
+            BEAST_EXPECT(res.reason() == "Not Found");
+        }
+    }
+
+    void
+    run() override
+    {
+        testInsert();
+        testSetErase();
+        testLarge();
+        testSpecial();
+        testCopyMove();
+        testMessage();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,flat_fields);
+
+} // http
+} // beast
+} // boost
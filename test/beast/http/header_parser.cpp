@@ -0,0 +1,292 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/header_parser.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/core/buffers_cat.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/ostream.hpp>
+#include <boost/beast/http/read.hpp>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class header_parser_test
+    : public beast::unit_test::suite
+{
+public:
+    static
+    net::const_buffer
+    buf(string_view s)
+    {
+        return {s.data(), s.size()};
+    }
+
+    // Returns `true` if `s` points into `in`
+    static
+    bool
+    within(string_view s, string_view in)
+    {
+        return
+            s.data() >= in.data() &&
+            s.data() + s.size() <= in.data() + in.size();
+    }
+
+    void
+    testRequest()
+    {
+        string_view const s =
+            "GET /index.html HTTP/1.1\r\n"
+            "Host: www.example.com\r\n"
+            "User-Agent: test\r\n"
+            "Accept: */*\r\n"
+            "X-Custom: one\r\n"
+            "accept: text/html\r\n"
+            "x-custom:  two \r\n"
+            "\r\n";
+        error_code ec;
+        request_header_parser p;
+        auto const used = p.put(buf(s), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(used == s.size());
+        BEAST_EXPECT(p.is_header_done());
+        BEAST_EXPECT(p.is_done());
+
+        auto const& h = p.get();
+        BEAST_EXPECT(h.method() == verb::get);
+        BEAST_EXPECT(h.method_string() == "GET");
+        BEAST_EXPECT(h.target() == "/index.html");
+        BEAST_EXPECT(h.version() == 11);
+        BEAST_EXPECT(h.size() == 6);
+
+        BEAST_EXPECT(h[field::host] == "www.example.com");
+        BEAST_EXPECT(h["HOST"] == "www.example.com");
+        BEAST_EXPECT(h[field::accept] == "*/*");
+        BEAST_EXPECT(h.count(field::accept) == 2);
+        BEAST_EXPECT(h.count("Accept") == 2);
+        BEAST_EXPECT(h.count(field::connection) == 0);
+        BEAST_EXPECT(h["X-Custom"] == "one");
+        BEAST_EXPECT(h.count("x-CUSTOM") == 2);
+        BEAST_EXPECT(h["X-Missing"].empty());
+        BEAST_EXPECT(h.find("X-Missing") == h.end());
+        BEAST_EXPECT(h.find(field::age) == h.end());
+        BEAST_EXPECT(h.at(field::user_agent) == "test");
+        BEAST_EXPECT(h.at("user-agent") == "test");
+        BEAST_THROWS(h.at(field::age), std::out_of_range);
+        BEAST_THROWS(h.at("X-Missing"), std::out_of_range);
+
+        auto it = h.find("X-Custom");
+        BEAST_EXPECT(it->name() == field::unknown);
+        BEAST_EXPECT(it->name_string() == "X-Custom");
+
+        std::vector<std::string> v;
+        for(auto const& f : h)
+            v.emplace_back(std::string(
+                f.name_string()) + "=" + std::string(f.value()));
+        BEAST_EXPECT((v == std::vector<std::string>{
+            "Host=www.example.com",
+            "User-Agent=test",
+            "Accept=*/*",
+            "X-Custom=one",
+            "accept=text/html",
+            "x-custom=two"}));
+
+        // Every string points into the input
+        BEAST_EXPECT(within(h.method_string(), s));
+        BEAST_EXPECT(within(h.target(), s));
+        for(auto const& f : h)
+        {
+            BEAST_EXPECT(within(f.name_string(), s));
+            BEAST_EXPECT(within(f.value(), s));
+        }
+    }
+
+    void
+    testResponse()
+    {
+        string_view const s =
+            "HTTP/1.0 404 Not Found\r\n"
+            "Server: test\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n";
+        error_code ec;
+        response_header_parser p;
+        p.put(buf(s), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(p.is_done());
+        auto const& h = p.get();
+        BEAST_EXPECT(h.result() == status::not_found);
+        BEAST_EXPECT(h.result_int() == 404);
+        BEAST_EXPECT(h.reason() == "Not Found");
+        BEAST_EXPECT(h.version() == 10);
+        BEAST_EXPECT(h[field::server] == "test");
+        BEAST_EXPECT(h[field::content_length] == "0");
+        BEAST_EXPECT(within(h.reason(), s));
+    }
+
+    void
+    testWholeHeader()
+    {
+        // Nothing is consumed until the whole header is present
+        std::string const s =
+            "GET / HTTP/1.1\r\n"
+            "Host: a\r\n"
+            "User-Agent: test\r\n"
+            "\r\n";
+        for(std::size_t n = 0; n < s.size(); ++n)
+        {
+            error_code ec;
+            request_header_parser p;
+            auto const used = p.put(buf({s.data(), n}), ec);
+            BEAST_EXPECTS(ec == error::need_more, ec.message());
+            BEAST_EXPECT(used == 0);
+            BEAST_EXPECT(! p.is_header_done());
+
+            // Present the rest in a different buffer
+            std::string const s2 = s;
+            ec = {};
+            BEAST_EXPECT(p.put(buf(s2), ec) == s2.size());
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(p.get()[field::host] == "a");
+            BEAST_EXPECT(within(p.get()[field::host], s2));
+        }
+    }
+
+    void
+    testCopied()
+    {
+        // Input split across buffers is copied
+        {
+            std::string const s1 =
+                "GET / HTTP/1.1\r\n"
+                "Host: loc";
+            std::string const s2 =
+                "alhost\r\n"
+                "User-Agent: test\r\n"
+                "\r\n";
+            error_code ec;
+            request_header_parser p;
+            p.put(buffers_cat(buf(s1), buf(s2)), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            auto const& h = p.get();
+            BEAST_EXPECT(h.method() == verb::get);
+            BEAST_EXPECT(h.target() == "/");
+            BEAST_EXPECT(h[field::host] == "localhost");
+            BEAST_EXPECT(h[field::user_agent] == "test");
+        }
+
+        // Values with obs-fold are copied
+        {
+            string_view const s =
+                "GET / HTTP/1.1\r\n"
+                "X-Folded: a\r\n"
+                " b\r\n"
+                "Host: x\r\n"
+                "\r\n";
+            error_code ec;
+            request_header_parser p;
+            p.put(buf(s), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            auto const& h = p.get();
+            BEAST_EXPECT(h["X-Folded"] == "a b");
+            BEAST_EXPECT(! within(h["X-Folded"], s));
+            BEAST_EXPECT(h[field::host] == "x");
+            BEAST_EXPECT(within(h[field::host], s));
+        }
+    }
+
+    void
+    testManyFields()
+    {
+        // More fields than fit inline
+        std::string s = "GET / HTTP/1.1\r\n";
+        auto const n = 3 * request_header_parser::inline_fields;
+        for(std::size_t i = 0; i < n; ++i)
+            s += "X-" + std::to_string(i) + ": " +
+                std::to_string(i) + "\r\n";
+        s += "\r\n";
+        error_code ec;
+        request_header_parser p;
+        p.header_limit(static_cast<std::uint32_t>(s.size()));
+        p.put(buf(s), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        auto const& h = p.get();
+        BEAST_EXPECT(h.size() == n);
+        std::size_t i = 0;
+        for(auto const& f : h)
+        {
+            BEAST_EXPECT(f.value() == std::to_string(i));
+            ++i;
+        }
+        BEAST_EXPECT(h["x-70"] == "70");
+    }
+
+    void
+    testBody()
+    {
+        net::io_context ioc;
+        test::stream ts{ioc};
+        ostream(ts.buffer()) <<
+            "HTTP/1.1 200 OK\r\n"
+            "Server: test\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "5\r\n"
+            "hello\r\n"
+            "6\r\n"
+            ", body\r\n"
+            "0\r\n"
+            "\r\n";
+        error_code ec;
+        flat_buffer fb;
+        response_header_parser p;
+        read_header(ts, fb, p, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(p.get()[field::server] == "test");
+        BEAST_EXPECT(p.chunked());
+
+        std::string body;
+        char tmp[4];
+        while(! p.is_done())
+        {
+            p.body().data = tmp;
+            p.body().size = sizeof(tmp);
+            read(ts, fb, p, ec);
+            if(ec == error::need_buffer)
+                ec = {};
+            if(! BEAST_EXPECTS(! ec, ec.message()))
+                break;
+            body.append(tmp, sizeof(tmp) - p.body().size);
+        }
+        BEAST_EXPECT(body == "hello, body");
+    }
+
+    void
+    run() override
+    {
+        testRequest();
+        testResponse();
+        testWholeHeader();
+        testCopied();
+        testManyFields();
+        testBody();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,header_parser);
+
+} // http
+} // beast
+} // boost
@@ -0,0 +1,209 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/http/mapped_file_body.hpp>
+
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/http/serializer.hpp>
+#include <boost/beast/http/type_traits.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/filesystem.hpp>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+BOOST_STATIC_ASSERT(is_body<mapped_file_body>::value);
+BOOST_STATIC_ASSERT(is_body_writer<mapped_file_body>::value);
+BOOST_STATIC_ASSERT(! is_body_reader<mapped_file_body>::value);
+
+class mapped_file_body_test : public beast::unit_test::suite
+{
+public:
+    static
+    std::string
+    make_content(std::size_t n)
+    {
+        std::string s;
+        s.reserve(n);
+        for(std::size_t i = 0; i < n; ++i)
+            s.push_back(static_cast<char>('a' + i % 26));
+        return s;
+    }
+
+    void
+    create(std::string const& path, string_view s)
+    {
+        error_code ec;
+        file f;
+        f.open(path.c_str(), file_mode::write, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        if(! s.empty())
+            f.write(s.data(), s.size(), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    void
+    testOpen()
+    {
+        error_code ec;
+        auto const path = boost::filesystem::unique_path().string();
+        auto const s = make_content(10000);
+        create(path, s);
+
+        mapped_file_body::value_type body;
+        BEAST_EXPECT(! body.is_open());
+        body.open(path.c_str(), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(body.is_open());
+        BEAST_EXPECT(body.size() == s.size());
+        BEAST_EXPECT(string_view(body.data(), body.size()) == s);
+
+        // Copies share the mapping and outlive the original
+        auto copy = body;
+        BEAST_EXPECT(copy.data() == body.data());
+        body.close();
+        BEAST_EXPECT(! body.is_open());
+        BEAST_EXPECT(body.size() == 0);
+        BEAST_EXPECT(string_view(copy.data(), copy.size()) == s);
+
+        // The mapping remains usable after the file is removed
+        boost::filesystem::remove(path, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(string_view(copy.data(), copy.size()) == s);
+
+        body.open(path.c_str(), ec);
+        BEAST_EXPECT(ec);
+        BEAST_EXPECT(! body.is_open());
+    }
+
+    void
+    testEmpty()
+    {
+        error_code ec;
+        auto const path = boost::filesystem::unique_path().string();
+        create(path, {});
+        response<mapped_file_body> res{status::ok, 11};
+        res.body().open(path.c_str(), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(res.body().is_open());
+        BEAST_EXPECT(res.body().size() == 0);
+        res.prepare_payload();
+
+        net::io_context ioc;
+        test::stream ts{ioc}, tr{ioc};
+        ts.connect(tr);
+        write(ts, res, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(tr.str() ==
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n");
+        boost::filesystem::remove(path, ec);
+    }
+
+    void
+    testSerialize()
+    {
+        error_code ec;
+        auto const path = boost::filesystem::unique_path().string();
+        auto const s = make_content(100000);
+        create(path, s);
+
+        response<mapped_file_body> res{status::ok, 11};
+        res.set(field::server, "test");
+        res.body().open(path.c_str(), ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        res.prepare_payload();
+        BEAST_EXPECT(res[field::content_length] ==
+            std::to_string(s.size()));
+
+        std::string const expected =
+            "HTTP/1.1 200 OK\r\n"
+            "Server: test\r\n"
+            "Content-Length: 100000\r\n"
+            "\r\n" + s;
+
+        // Several serializers share one message concurrently,
+        // each writing pieces bounded by its limit.
+        response<mapped_file_body> const& cres = res;
+        net::io_context ioc;
+        test::stream ts1{ioc}, tr1{ioc};
+        test::stream ts2{ioc}, tr2{ioc};
+        ts1.connect(tr1);
+        ts2.connect(tr2);
+        serializer<false, mapped_file_body> sr1{cres};
+        serializer<false, mapped_file_body> sr2{cres};
+        sr1.limit(1000);
+        sr2.limit(3001);
+        while(! sr1.is_done() || ! sr2.is_done())
+        {
+            if(! sr1.is_done())
+            {
+                auto const n = write_some(ts1, sr1, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n <= 1000);
+            }
+            if(! sr2.is_done())
+            {
+                auto const n = write_some(ts2, sr2, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n <= 3001);
+            }
+        }
+        BEAST_EXPECT(tr1.str() == expected);
+        BEAST_EXPECT(tr2.str() == expected);
+
+        // A copy of the body serializes the same content
+        response<mapped_file_body> res2{status::ok, 11};
+        res2.set(field::server, "test");
+        res2.body() = res.body();
+        res2.prepare_payload();
+        res.body().close();
+        test::stream ts3{ioc}, tr3{ioc};
+        ts3.connect(tr3);
+        write(ts3, res2, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        BEAST_EXPECT(tr3.str() == expected);
+
+        boost::filesystem::remove(path, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+    }
+
+    void
+    testNotOpen()
+    {
+        error_code ec;
+        response<mapped_file_body> res{status::ok, 11};
+        net::io_context ioc;
+        test::stream ts{ioc}, tr{ioc};
+        ts.connect(tr);
+        write(ts, res, ec);
+        BEAST_EXPECT(ec == errc::bad_file_descriptor);
+    }
+
+    void
+    run() override
+    {
+        testOpen();
+        testEmpty();
+        testSerialize();
+        testNotOpen();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,http,mapped_file_body);
+
+} // http
+} // beast
+} // boost
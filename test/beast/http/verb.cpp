@@ -106,6 +106,12 @@ public:
         bad("UNLOC_");
         bad("UNSUBSCRIB_");
 
+        bad("");
+        bad("get");
+        bad("Post");
+        bad("<unknown>");
+        bad("UNSUBSCRIBER");
+
         try
         {
             to_string(static_cast<verb>(-1));
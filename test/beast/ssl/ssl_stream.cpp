@@ -9,3 +9,494 @@
 
 // Test that header file is self-contained.
 #include <boost/beast/ssl/ssl_stream.hpp>
+
+#include "example/common/server_certificate.hpp"
+
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http/file_body.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/core/ignore_unused.hpp>
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace boost {
+namespace beast {
+
+class ssl_stream_test
+    : public unit_test::suite
+{
+public:
+    using tcp = net::ip::tcp;
+
+    struct config
+    {
+        char const* name;
+        int version;
+        char const* cipher;
+    };
+
+    static
+    void
+    configure(
+        net::ssl::context& ctx,
+        int version,
+        char const* cipher)
+    {
+        SSL_CTX_set_min_proto_version(ctx.native_handle(), version);
+        SSL_CTX_set_max_proto_version(ctx.native_handle(), version);
+        if(! cipher)
+            return;
+        if(version == TLS1_3_VERSION)
+            SSL_CTX_set_ciphersuites(ctx.native_handle(), cipher);
+        else
+            SSL_CTX_set_cipher_list(ctx.native_handle(), cipher);
+    }
+
+    static
+    net::ssl::context
+    make_server_context(int version, char const* cipher = nullptr)
+    {
+        net::ssl::context ctx(net::ssl::context::tls_server);
+        load_server_certificate(ctx);
+        configure(ctx, version, cipher);
+        enable_ktls(ctx);
+        return ctx;
+    }
+
+    static
+    net::ssl::context
+    make_client_context(int version, char const* cipher = nullptr)
+    {
+        net::ssl::context ctx(net::ssl::context::tls_client);
+        ctx.set_verify_mode(net::ssl::verify_none);
+        configure(ctx, version, cipher);
+        enable_ktls(ctx);
+        return ctx;
+    }
+
+#if BOOST_BEAST_USE_KTLS
+    // Decrypt one record using the parameters
+    // computed for the kernel, like the kernel would.
+    bool
+    decrypt(
+        detail::ktls_crypto_info const& ci,
+        string_view record,
+        std::string& out)
+    {
+        auto const p = reinterpret_cast<
+            unsigned char const*>(record.data());
+        if(record.size() < 5 + 16)
+            return false;
+        EVP_CIPHER const* cipher;
+        unsigned char const* key;
+        unsigned char const* seq;
+        unsigned char nonce[12];
+        switch(ci.info.cipher_type)
+        {
+        case TLS_CIPHER_AES_GCM_128:
+            cipher = EVP_aes_128_gcm();
+            key = ci.aes_gcm_128.key;
+            seq = ci.aes_gcm_128.rec_seq;
+            std::memcpy(nonce, ci.aes_gcm_128.salt, 4);
+            std::memcpy(nonce + 4, ci.aes_gcm_128.iv, 8);
+            break;
+        case TLS_CIPHER_AES_GCM_256:
+            cipher = EVP_aes_256_gcm();
+            key = ci.aes_gcm_256.key;
+            seq = ci.aes_gcm_256.rec_seq;
+            std::memcpy(nonce, ci.aes_gcm_256.salt, 4);
+            std::memcpy(nonce + 4, ci.aes_gcm_256.iv, 8);
+            break;
+        case TLS_CIPHER_CHACHA20_POLY1305:
+            cipher = EVP_chacha20_poly1305();
+            key = ci.chacha20_poly1305.key;
+            seq = ci.chacha20_poly1305.rec_seq;
+            std::memcpy(nonce, ci.chacha20_poly1305.iv, 12);
+            break;
+        default:
+            return false;
+        }
+        bool const tls13 = ci.info.version == TLS_1_3_VERSION;
+        bool const explicit_nonce = ! tls13 &&
+            ci.info.cipher_type != TLS_CIPHER_CHACHA20_POLY1305;
+        auto body = p + 5;
+        std::size_t size = record.size() - 5 - 16;
+        if(explicit_nonce)
+        {
+            // OpenSSL chooses its own explicit nonce
+            if(size < 8)
+                return false;
+            std::memcpy(nonce + 4, body, 8);
+            body += 8;
+            size -= 8;
+        }
+        else
+        {
+            for(int i = 0; i < 8; ++i)
+                nonce[4 + i] ^= seq[i];
+        }
+        unsigned char aad[13];
+        std::size_t aad_size;
+        if(tls13)
+        {
+            std::memcpy(aad, p, 5);
+            aad_size = 5;
+        }
+        else
+        {
+            std::memcpy(aad, seq, 8);
+            std::memcpy(aad + 8, p, 3);
+            aad[11] = static_cast<unsigned char>(size >> 8);
+            aad[12] = static_cast<unsigned char>(size & 0xff);
+            aad_size = 13;
+        }
+        out.resize(size);
+        auto const ctx = EVP_CIPHER_CTX_new();
+        int len = 0;
+        bool const ok =
+            EVP_DecryptInit_ex(ctx, cipher, nullptr, nullptr, nullptr) &&
+            EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, 12, nullptr) &&
+            EVP_DecryptInit_ex(ctx, nullptr, nullptr, key, nonce) &&
+            EVP_DecryptUpdate(ctx, nullptr, &len,
+                aad, static_cast<int>(aad_size)) &&
+            EVP_DecryptUpdate(ctx,
+                reinterpret_cast<unsigned char*>(&out[0]), &len,
+                body, static_cast<int>(size)) &&
+            EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, 16,
+                const_cast<unsigned char*>(body + size)) &&
+            EVP_DecryptFinal_ex(ctx,
+                reinterpret_cast<unsigned char*>(&out[0]) + len, &len);
+        EVP_CIPHER_CTX_free(ctx);
+        if(ok && tls13)
+        {
+            // Remove the inner content type
+            if(out.empty() || out.back() != 23)
+                return false;
+            out.pop_back();
+        }
+        return ok;
+    }
+
+    // Check that the parameters which would be given to the
+    // kernel decrypt the records OpenSSL produces.
+    void
+    testKeys(config const& cfg)
+    {
+        testcase << "keys " << cfg.name;
+        auto sctx = make_server_context(cfg.version, cfg.cipher);
+        auto cctx = make_client_context(cfg.version, cfg.cipher);
+        net::io_context ioc;
+        net::ssl::stream<test::stream> c(ioc, cctx);
+        net::ssl::stream<test::stream> s(ioc, sctx);
+        c.next_layer().connect(s.next_layer());
+        c.async_handshake(net::ssl::stream_base::client,
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        s.async_handshake(net::ssl::stream_base::server,
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ioc.run();
+        BEAST_EXPECT(SSL_version(c.native_handle()) == cfg.version);
+
+        detail::ktls_crypto_info c_tx;
+        detail::ktls_crypto_info c_rx;
+        detail::ktls_crypto_info s_tx;
+        detail::ktls_crypto_info s_rx;
+        if(! BEAST_EXPECT(
+            detail::ktls_make_crypto_info(c.native_handle(), true, c_tx) &&
+            detail::ktls_make_crypto_info(c.native_handle(), false, c_rx) &&
+            detail::ktls_make_crypto_info(s.native_handle(), true, s_tx) &&
+            detail::ktls_make_crypto_info(s.native_handle(), false, s_rx)))
+            return;
+        BEAST_EXPECT(c_tx.size == s_rx.size);
+        BEAST_EXPECT(std::memcmp(&c_tx, &s_rx, c_tx.size) == 0);
+        BEAST_EXPECT(c_rx.size == s_tx.size);
+        BEAST_EXPECT(std::memcmp(&c_rx, &s_tx, c_rx.size) == 0);
+        BEAST_EXPECT(std::memcmp(&c_tx, &c_rx, c_tx.size) != 0);
+
+        std::string out;
+        net::write(c, net::buffer("hello", 5));
+        BEAST_EXPECT(decrypt(c_tx, s.next_layer().str(), out));
+        BEAST_EXPECT(out == "hello");
+        net::write(s, net::buffer("world", 5));
+        BEAST_EXPECT(decrypt(s_tx, c.next_layer().str(), out));
+        BEAST_EXPECT(out == "world");
+    }
+#endif
+
+    // Without a socket the stream keeps using OpenSSL
+    void
+    testFallback()
+    {
+        testcase("fallback");
+        auto sctx = make_server_context(TLS1_3_VERSION);
+        auto cctx = make_client_context(TLS1_3_VERSION);
+        net::io_context ioc;
+        ssl_stream<test::stream> c(ioc, cctx);
+        ssl_stream<test::stream> s(ioc, sctx);
+        c.next_layer().connect(s.next_layer());
+        c.async_handshake(net::ssl::stream_base::client,
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        s.async_handshake(net::ssl::stream_base::server,
+            [&](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ioc.run();
+        BEAST_EXPECT(! c.ktls_send());
+        BEAST_EXPECT(! c.ktls_receive());
+        BEAST_EXPECT(! s.ktls_send());
+
+        char buf[5];
+        net::write(c, net::buffer("hello", 5));
+        net::read(s, net::buffer(buf));
+        BEAST_EXPECT(string_view(buf, 5) == "hello");
+    }
+
+    // Connect two streams over the loopback interface
+    static
+    void
+    connect(
+        net::io_context& ioc,
+        ssl_stream<tcp_stream>& client,
+        ssl_stream<tcp_stream>& server)
+    {
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        get_lowest_layer(client).socket().connect(a.local_endpoint());
+        a.accept(get_lowest_layer(server).socket());
+    }
+
+    static
+    std::string
+    make_file(std::string const& text)
+    {
+        auto const path = boost::filesystem::unique_path();
+        error_code ec;
+        file f;
+        f.open(path.string<std::string>().c_str(),
+            file_mode::write, ec);
+        f.write(text.data(), text.size(), ec);
+        return path.string<std::string>();
+    }
+
+    // Set tx and rx to whether the kernel accepts
+    // AES-128-GCM keys for each direction.
+    static
+    void
+    probe_ktls(int version, bool& tx, bool& rx)
+    {
+        tx = false;
+        rx = false;
+#if BOOST_BEAST_USE_KTLS
+        net::io_context ioc;
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        tcp::socket s1(ioc);
+        tcp::socket s2(ioc);
+        s1.connect(a.local_endpoint());
+        a.accept(s2);
+        auto const fd = s1.native_handle();
+        if(::setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) != 0)
+            return;
+        tls12_crypto_info_aes_gcm_128 ci;
+        std::memset(&ci, 0, sizeof(ci));
+        ci.info.version = version == TLS1_3_VERSION ?
+            TLS_1_3_VERSION : TLS_1_2_VERSION;
+        ci.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        tx = ::setsockopt(fd, SOL_TLS, TLS_TX, &ci, sizeof(ci)) == 0;
+        rx = ::setsockopt(fd, SOL_TLS, TLS_RX, &ci, sizeof(ci)) == 0;
+#else
+        boost::ignore_unused(version);
+#endif
+    }
+
+    // HTTP with a file body, using kernel TLS when it is available
+    void
+    testAsync(int version)
+    {
+        bool tx;
+        bool rx;
+        probe_ktls(version, tx, rx);
+        testcase << "async " << (version == TLS1_3_VERSION ? "1.3" : "1.2") <<
+            (tx ? "" : " (no kernel TLS, its checks skipped)");
+        char const* const cipher = version == TLS1_3_VERSION ?
+            "TLS_AES_128_GCM_SHA256" : "ECDHE-RSA-AES128-GCM-SHA256";
+        auto sctx = make_server_context(version, cipher);
+        auto cctx = make_client_context(version, cipher);
+        net::io_context ioc;
+        ssl_stream<tcp_stream> c(ioc, cctx);
+        ssl_stream<tcp_stream> s(ioc, sctx);
+        connect(ioc, c, s);
+
+        std::string const text(300000, '*');
+        auto const path = make_file(text);
+        http::request<http::string_body> req{http::verb::get, "/", 11};
+        http::response<http::file_body> res{http::status::ok, 11};
+        http::request<http::string_body> req2;
+        http::response<http::string_body> res2;
+        flat_buffer b1;
+        flat_buffer b2;
+        error_code ec;
+        res.body().open(path.c_str(), file_mode::scan, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        res.prepare_payload();
+
+        bool c_done = false;
+        bool s_done = false;
+        c.async_handshake(net::ssl::stream_base::client,
+        [&](error_code ec)
+        {
+            if(! BEAST_EXPECTS(! ec, ec.message()))
+                return;
+            http::async_write(c, req,
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                http::async_read(c, b1, res2,
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    c.async_shutdown(
+                    [&](error_code ec)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        c_done = true;
+                    });
+                });
+            });
+        });
+        s.async_handshake(net::ssl::stream_base::server,
+        [&](error_code ec)
+        {
+            if(! BEAST_EXPECTS(! ec, ec.message()))
+                return;
+            http::async_read(s, b2, req2,
+            [&](error_code ec, std::size_t)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+                http::async_write(s, res,
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    s.async_shutdown(
+                    [&](error_code ec)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                        s_done = true;
+                    });
+                });
+            });
+        });
+        ioc.run();
+        BEAST_EXPECT(c.ktls_send() == tx);
+        BEAST_EXPECT(s.ktls_send() == tx);
+        // Nothing follows the client's last handshake
+        // record, so its receive side always moves.
+        if(rx)
+            BEAST_EXPECT(c.ktls_receive());
+        BEAST_EXPECT(res2.body() == text);
+        BEAST_EXPECT(c_done);
+        BEAST_EXPECT(s_done);
+        boost::filesystem::remove(path);
+    }
+
+    void
+    testSync(int version)
+    {
+        testcase << "sync " << (version == TLS1_3_VERSION ? "1.3" : "1.2");
+        auto sctx = make_server_context(version);
+        auto cctx = make_client_context(version);
+        net::io_context ioc;
+        ssl_stream<tcp_stream> c(ioc, cctx);
+        ssl_stream<tcp_stream> s(ioc, sctx);
+        connect(ioc, c, s);
+
+        std::string const text(300000, '#');
+        auto const path = make_file(text);
+        http::response<http::string_body> res2;
+        std::thread t(
+            [&]
+            {
+                error_code ec;
+                s.handshake(net::ssl::stream_base::server, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                flat_buffer b;
+                http::request<http::string_body> req;
+                http::read(s, b, req, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                http::response<http::file_body> res{http::status::ok, 11};
+                res.body().open(path.c_str(), file_mode::scan, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                res.prepare_payload();
+                http::write(s, res, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                s.shutdown(ec);
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        error_code ec;
+        c.handshake(net::ssl::stream_base::client, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        http::request<http::string_body> req{http::verb::get, "/", 11};
+        http::write(c, req, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        flat_buffer b;
+        http::read(c, b, res2, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        c.shutdown(ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        t.join();
+        BEAST_EXPECT(res2.body() == text);
+        boost::filesystem::remove(path);
+    }
+
+    void
+    run() override
+    {
+#if BOOST_BEAST_USE_KTLS
+        config const configs[] = {
+            { "TLS 1.2 AES-128-GCM", TLS1_2_VERSION,
+                "ECDHE-RSA-AES128-GCM-SHA256" },
+            { "TLS 1.2 AES-256-GCM", TLS1_2_VERSION,
+                "ECDHE-RSA-AES256-GCM-SHA384" },
+            { "TLS 1.2 CHACHA20-POLY1305", TLS1_2_VERSION,
+                "ECDHE-RSA-CHACHA20-POLY1305" },
+            { "TLS 1.3 AES-128-GCM", TLS1_3_VERSION,
+                "TLS_AES_128_GCM_SHA256" },
+            { "TLS 1.3 AES-256-GCM", TLS1_3_VERSION,
+                "TLS_AES_256_GCM_SHA384" },
+            { "TLS 1.3 CHACHA20-POLY1305", TLS1_3_VERSION,
+                "TLS_CHACHA20_POLY1305_SHA256" },
+        };
+        for(auto const& cfg : configs)
+            testKeys(cfg);
+#endif
+        testFallback();
+        testAsync(TLS1_2_VERSION);
+        testAsync(TLS1_3_VERSION);
+        testSync(TLS1_2_VERSION);
+        testSync(TLS1_3_VERSION);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,ssl,ssl_stream);
+
+} // beast
+} // boost
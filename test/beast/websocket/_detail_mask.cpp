@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/websocket/detail/mask.hpp>
+
+#include <boost/beast/core/buffers_cat.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <cstring>
+#include <string>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+namespace detail {
+
+class mask_test
+    : public beast::unit_test::suite
+{
+public:
+    static std::uint32_t constexpr key = 0xd1a3b5c7;
+
+    // Mask one byte at a time
+    static
+    std::string
+    reference(std::string s, std::size_t offset)
+    {
+        prepared_key k;
+        prepare_key(k, key);
+        for(auto& c : s)
+            c = static_cast<char>(
+                static_cast<unsigned char>(c) ^ k[offset++ & 3]);
+        return s;
+    }
+
+    static
+    std::string
+    make_payload(std::size_t n)
+    {
+        std::string s;
+        s.reserve(n);
+        for(std::size_t i = 0; i < n; ++i)
+            s.push_back(static_cast<char>(i * 7 + 3));
+        return s;
+    }
+
+    // Every size and alignment up to a few
+    // vectors, split across up to three buffers.
+    void
+    testMask()
+    {
+        std::string const in = make_payload(300);
+        char storage[320];
+        for(std::size_t align = 0; align < 16; ++align)
+        {
+            for(std::size_t n = 0; n <= 200; ++n)
+            {
+                auto const p = storage + align;
+                std::memcpy(p, in.data(), n);
+                prepared_key k;
+                prepare_key(k, key);
+                mask_inplace(net::mutable_buffer(p, n), k);
+                BEAST_EXPECT(std::string(p, n) ==
+                    reference(in.substr(0, n), 0));
+                prepared_key k2;
+                prepare_key(k2, key);
+                mask_inplace(net::mutable_buffer(p, 0), k2);
+                for(std::size_t i = 0; i < 4; ++i)
+                    BEAST_EXPECT(k[i] == k2[(i + n) & 3]);
+            }
+        }
+        for(std::size_t i = 0; i < 70; i += 3)
+        {
+            for(std::size_t j = 0; j < 130; j += 5)
+            {
+                std::size_t const n = 200;
+                std::memcpy(storage, in.data(), n);
+                prepared_key k;
+                prepare_key(k, key);
+                mask_inplace(buffers_cat(
+                    net::mutable_buffer(storage, i),
+                    net::mutable_buffer(storage + i, j),
+                    net::mutable_buffer(storage + i + j, n - i - j)),
+                    k);
+                BEAST_EXPECT(std::string(storage, n) ==
+                    reference(in.substr(0, n), 0));
+            }
+        }
+    }
+
+    void
+    run() override
+    {
+#if ! BOOST_BEAST_NO_INTRINSICS
+        auto& ci = beast::detail::get_mutable_cpu_info();
+        auto const saved = ci;
+        testMask();
+        ci.avx2 = false;
+        testMask();
+        ci.sse2 = false;
+        testMask();
+        ci = saved;
+#else
+        testMask();
+#endif
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,websocket,mask);
+
+} // detail
+} // websocket
+} // beast
+} // boost
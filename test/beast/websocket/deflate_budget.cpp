@@ -0,0 +1,220 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/websocket/deflate_budget.hpp>
+
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <memory>
+#include <vector>
+
+#include "test.hpp"
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+class deflate_budget_test : public websocket_test_suite
+{
+public:
+    using ws_type = stream<test::stream>;
+
+    // Connect a client and a server stream, with
+    // permessage-deflate options for each, and
+    // return the server's response.
+    response_type
+    connect(
+        net::io_context& ioc,
+        ws_type& client,
+        ws_type& server,
+        permessage_deflate const& client_pmd,
+        permessage_deflate const& server_pmd)
+    {
+        response_type res;
+        client.next_layer().connect(server.next_layer());
+        client.set_option(client_pmd);
+        server.set_option(server_pmd);
+        server.async_accept(
+            [](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        client.async_handshake(res, "localhost", "/",
+            [](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ioc.run();
+        ioc.restart();
+        return res;
+    }
+
+    static
+    permessage_deflate
+    make_pmd(std::shared_ptr<deflate_budget> budget)
+    {
+        permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.server_enable = true;
+        pmd.budget = std::move(budget);
+        return pmd;
+    }
+
+    // Send a message each way and check it arrives compressed
+    void
+    echo(ws_type& client, ws_type& server)
+    {
+        std::string const s(4000, '*');
+        flat_buffer b;
+        auto const n0 = server.next_layer().nwrite_bytes();
+        server.write(net::buffer(s));
+        BEAST_EXPECT(
+            server.next_layer().nwrite_bytes() - n0 < s.size());
+        client.read(b);
+        BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        b.clear();
+        client.write(net::buffer(s));
+        server.read(b);
+        BEAST_EXPECT(buffers_to_string(b.data()) == s);
+    }
+
+    void
+    testSizes()
+    {
+        // Defaults of permessage_deflate
+        BEAST_EXPECT(
+            deflate_budget::deflate_size(15, 4) == 139264);
+        BEAST_EXPECT(
+            deflate_budget::inflate_size(15) == 32768);
+
+        // Smallest possible
+        BEAST_EXPECT(
+            deflate_budget::deflate_size(9, 1) +
+            deflate_budget::inflate_size(9) == 3584);
+
+        deflate_budget b(1000000);
+        BEAST_EXPECT(b.limit() == 1000000);
+        BEAST_EXPECT(b.usage() == 0);
+        BEAST_EXPECT(b.connections() == 0);
+    }
+
+    void
+    testServer()
+    {
+        auto const budget =
+            std::make_shared<deflate_budget>(65536);
+        {
+            net::io_context ioc;
+            ws_type client(ioc);
+            ws_type server(ioc);
+            auto const res = connect(ioc, client, server,
+                make_pmd(nullptr), make_pmd(budget));
+            auto const ext = std::string(
+                res[http::field::sec_websocket_extensions]);
+            BEAST_EXPECTS(ext.find(
+                "server_max_window_bits=") !=
+                    std::string::npos, ext);
+            BEAST_EXPECT(budget->connections() == 1);
+            BEAST_EXPECT(budget->usage() > 0);
+            BEAST_EXPECT(budget->usage() <= budget->limit());
+            echo(client, server);
+        }
+        BEAST_EXPECT(budget->connections() == 0);
+        BEAST_EXPECT(budget->usage() == 0);
+    }
+
+    void
+    testClient()
+    {
+        auto const budget =
+            std::make_shared<deflate_budget>(65536);
+        {
+            net::io_context ioc;
+            ws_type client(ioc);
+            ws_type server(ioc);
+            auto const res = connect(ioc, client, server,
+                make_pmd(budget), make_pmd(nullptr));
+            auto const ext = std::string(
+                res[http::field::sec_websocket_extensions]);
+            BEAST_EXPECTS(ext.find(
+                "client_max_window_bits=") !=
+                    std::string::npos, ext);
+            BEAST_EXPECT(budget->connections() == 1);
+            BEAST_EXPECT(budget->usage() <= budget->limit());
+            echo(client, server);
+        }
+        BEAST_EXPECT(budget->connections() == 0);
+        BEAST_EXPECT(budget->usage() == 0);
+    }
+
+    void
+    testShared()
+    {
+        // Room for every connection expected
+        auto const budget =
+            std::make_shared<deflate_budget>(1024 * 1024, 64);
+        {
+            net::io_context ioc;
+            std::vector<std::unique_ptr<ws_type>> v;
+            for(int i = 0; i < 32; ++i)
+            {
+                v.emplace_back(new ws_type(ioc));
+                v.emplace_back(new ws_type(ioc));
+                auto& client = *v[v.size() - 2];
+                auto& server = *v[v.size() - 1];
+                connect(ioc, client, server,
+                    make_pmd(budget), make_pmd(budget));
+                BEAST_EXPECT(budget->usage() <= budget->limit());
+                echo(client, server);
+            }
+            BEAST_EXPECT(budget->connections() == 64);
+
+            // Destroying a stream returns its share
+            auto const used = budget->usage();
+            v[0].reset();
+            BEAST_EXPECT(budget->connections() == 63);
+            BEAST_EXPECT(budget->usage() < used);
+        }
+        BEAST_EXPECT(budget->connections() == 0);
+        BEAST_EXPECT(budget->usage() == 0);
+
+        // No room left, streams still compress
+        auto const small =
+            std::make_shared<deflate_budget>(1000);
+        {
+            net::io_context ioc;
+            ws_type client(ioc);
+            ws_type server(ioc);
+            connect(ioc, client, server,
+                make_pmd(small), make_pmd(small));
+            BEAST_EXPECT(small->connections() == 2);
+            BEAST_EXPECT(small->usage() == 2 * 3584);
+            echo(client, server);
+        }
+        BEAST_EXPECT(small->usage() == 0);
+    }
+
+    void
+    run() override
+    {
+        testSizes();
+        testServer();
+        testClient();
+        testShared();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,websocket,deflate_budget);
+
+} // websocket
+} // beast
+} // boost
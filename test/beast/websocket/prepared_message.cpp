@@ -0,0 +1,345 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/websocket/prepared_message.hpp>
+
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include "test.hpp"
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+class prepared_message_test : public websocket_test_suite
+{
+public:
+    using ws_type = stream<test::stream>;
+
+    // Connect a client and a server stream,
+    // with permessage-deflate options for each.
+    void
+    connect(
+        net::io_context& ioc,
+        ws_type& client,
+        ws_type& server,
+        permessage_deflate const& client_pmd,
+        permessage_deflate const& server_pmd)
+    {
+        client.next_layer().connect(server.next_layer());
+        client.set_option(client_pmd);
+        server.set_option(server_pmd);
+        server.async_accept(
+            [](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        client.async_handshake("localhost", "/",
+            [](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ioc.run();
+        ioc.restart();
+    }
+
+    static
+    std::string
+    make_text(std::size_t n)
+    {
+        std::string s;
+        s.reserve(n);
+        while(s.size() < n)
+            s.append("{\"user\":\"alice\",\"text\":\"hello, world\"}");
+        s.resize(n);
+        return s;
+    }
+
+    static
+    permessage_deflate
+    make_pmd(bool no_context_takeover)
+    {
+        permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.server_enable = true;
+        pmd.server_no_context_takeover = no_context_takeover;
+        return pmd;
+    }
+
+    void
+    testMessage()
+    {
+        std::string const s = make_text(1000);
+        {
+            prepared_message m(false, net::buffer(s));
+            BEAST_EXPECT(! m.binary());
+            BEAST_EXPECT(m.size() == s.size());
+            BEAST_EXPECT(! m.deflated());
+        }
+        {
+            prepared_message m(true, net::buffer(s), make_pmd(true));
+            BEAST_EXPECT(m.binary());
+            BEAST_EXPECT(m.size() == s.size());
+            BEAST_EXPECT(m.deflated());
+
+            // copies share the frames
+            prepared_message m2(m);
+            BEAST_EXPECT(m2.deflated());
+            BEAST_EXPECT(m2.size() == s.size());
+        }
+        {
+            // nothing to gain from compression
+            prepared_message m(false,
+                net::const_buffer{}, make_pmd(true));
+            BEAST_EXPECT(m.size() == 0);
+            BEAST_EXPECT(! m.deflated());
+        }
+    }
+
+    // Send a prepared message and check the
+    // first byte of the frame on the wire.
+    void
+    doTestFrame(
+        std::size_t size,
+        bool binary,
+        permessage_deflate const& client_pmd,
+        permessage_deflate const& server_pmd,
+        unsigned char first)
+    {
+        std::string const s = make_text(size);
+        prepared_message m(binary, net::buffer(s), make_pmd(true));
+
+        net::io_context ioc;
+        ws_type client{ioc};
+        ws_type server{ioc};
+        connect(ioc, client, server, client_pmd, server_pmd);
+        server.write_prepared(m);
+        server.next_layer().close();
+
+        // Read the raw frame
+        std::string wire;
+        error_code ec;
+        char buf[4096];
+        for(;;)
+        {
+            auto const n = client.next_layer().read_some(
+                net::buffer(buf), ec);
+            if(ec)
+                break;
+            wire.append(buf, n);
+        }
+        BEAST_EXPECT(ec == net::error::eof);
+        if(! BEAST_EXPECT(! wire.empty()))
+            return;
+        BEAST_EXPECT(static_cast<
+            unsigned char>(wire[0]) == first);
+        if(first & 0x40)
+            BEAST_EXPECT(wire.size() < s.size());
+        else
+            BEAST_EXPECT(wire.size() > s.size());
+    }
+
+    void
+    testFrame()
+    {
+        permessage_deflate none;
+        auto const nct = make_pmd(true);
+        auto const ct = make_pmd(false);
+
+        // no permessage-deflate
+        doTestFrame(1000, false, none, none, 0x81);
+        doTestFrame(1000, true, none, none, 0x82);
+
+        // compressed once, and legal to send
+        doTestFrame(100, false, nct, nct, 0xc1);
+        doTestFrame(1000, false, nct, nct, 0xc1);
+        doTestFrame(100000, true, nct, nct, 0xc2);
+
+        // server keeps its window between messages
+        doTestFrame(1000, false, ct, ct, 0x81);
+
+        // negotiated window is smaller than the one used
+        {
+            auto small = nct;
+            small.server_max_window_bits = 9;
+            doTestFrame(1000, false, nct, small, 0x81);
+        }
+    }
+
+    // Interleave prepared and regular messages and make
+    // sure the client reads every payload back.
+    template<class Api>
+    void
+    doTestRoundTrip(
+        Api const& w,
+        permessage_deflate const& pmd)
+    {
+        net::io_context ioc;
+        ws_type client{ioc};
+        ws_type server{ioc};
+        connect(ioc, client, server, pmd, pmd);
+
+        std::string const small = make_text(10);
+        std::string const medium = make_text(1000);
+        std::string const large = make_text(70000);
+        prepared_message const m0(false, net::buffer(small), pmd);
+        prepared_message const m1(false, net::buffer(medium), pmd);
+        prepared_message const m2(true, net::buffer(large), pmd);
+
+        BEAST_EXPECT(w.write_prepared(server, m1) == medium.size());
+        w.write(server, net::buffer(medium));
+        BEAST_EXPECT(w.write_prepared(server, m0) == small.size());
+        BEAST_EXPECT(w.write_prepared(server, m2) == large.size());
+        w.write(server, net::buffer(medium));
+        BEAST_EXPECT(w.write_prepared(server, m1) == medium.size());
+
+        auto const check =
+            [&](std::string const& s, bool binary)
+            {
+                flat_buffer b;
+                w.read(client, b);
+                BEAST_EXPECT(client.got_binary() == binary);
+                BEAST_EXPECT(buffers_to_string(b.data()) == s);
+            };
+        check(medium, false);
+        check(medium, false);
+        check(small, false);
+        check(large, true);
+        check(medium, false);
+        check(medium, false);
+    }
+
+    void
+    testRoundTrip()
+    {
+        for(auto nct : {true, false})
+        {
+            doTestRoundTrip(test_sync_api{}, make_pmd(nct));
+            doTestRoundTrip(test_async_api{}, make_pmd(nct));
+        }
+        doTestRoundTrip(test_sync_api{}, permessage_deflate{});
+        doTestRoundTrip(test_async_api{}, permessage_deflate{});
+    }
+
+    void
+    testAsync()
+    {
+        std::string const s = make_text(1000);
+        auto const pmd = make_pmd(true);
+        prepared_message m(false, net::buffer(s), pmd);
+
+        net::io_context ioc;
+        ws_type client{ioc};
+        ws_type server{ioc};
+        connect(ioc, client, server, pmd, pmd);
+
+        bool invoked = false;
+        server.async_write_prepared(m,
+            [&](error_code ec, std::size_t n)
+            {
+                invoked = true;
+                BEAST_EXPECTS(! ec, ec.message());
+                BEAST_EXPECT(n == s.size());
+            });
+        ioc.run();
+        BEAST_EXPECT(invoked);
+
+        flat_buffer b;
+        client.read(b);
+        BEAST_EXPECT(buffers_to_string(b.data()) == s);
+    }
+
+    void
+    testErrors()
+    {
+        std::string const s = make_text(100);
+        prepared_message m(false, net::buffer(s));
+
+        // client streams must mask their frames
+        {
+            net::io_context ioc;
+            ws_type client{ioc};
+            ws_type server{ioc};
+            connect(ioc, client, server, {}, {});
+            error_code ec;
+            BEAST_EXPECT(client.write_prepared(m, ec) == 0);
+            BEAST_EXPECTS(ec == net::error::operation_not_supported,
+                ec.message());
+            bool invoked = false;
+            client.async_write_prepared(m,
+                [&](error_code ec, std::size_t n)
+                {
+                    invoked = true;
+                    BEAST_EXPECTS(ec ==
+                        net::error::operation_not_supported,
+                        ec.message());
+                    BEAST_EXPECT(n == 0);
+                });
+            BEAST_EXPECT(! invoked);
+            ioc.run();
+            BEAST_EXPECT(invoked);
+
+            // nothing was sent
+            client.write(net::buffer(s));
+            flat_buffer b;
+            server.read(b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        }
+
+        // a message started with write_some is unfinished
+        {
+            net::io_context ioc;
+            ws_type client{ioc};
+            ws_type server{ioc};
+            connect(ioc, client, server, {}, {});
+            server.write_some(false, net::buffer(s));
+            error_code ec;
+            BEAST_EXPECT(server.write_prepared(m, ec) == 0);
+            BEAST_EXPECTS(ec == net::error::in_progress,
+                ec.message());
+            bool invoked = false;
+            server.async_write_prepared(m,
+                [&](error_code ec, std::size_t n)
+                {
+                    invoked = true;
+                    BEAST_EXPECTS(ec == net::error::in_progress,
+                        ec.message());
+                    BEAST_EXPECT(n == 0);
+                });
+            ioc.run();
+            BEAST_EXPECT(invoked);
+
+            // the unfinished message is intact
+            server.write_some(true, net::buffer(s));
+            flat_buffer b;
+            client.read(b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s + s);
+        }
+    }
+
+    void
+    run() override
+    {
+        testMessage();
+        testFrame();
+        testRoundTrip();
+        testAsync();
+        testErrors();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,websocket,prepared_message);
+
+} // websocket
+} // beast
+} // boost
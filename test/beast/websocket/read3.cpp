@@ -597,6 +597,157 @@ public:
         }
     }
 
+    // Records whether reads were made
+    // directly into a given region
+    class recording_stream
+    {
+        test::stream s_;
+
+    public:
+        using executor_type =
+            test::stream::executor_type;
+
+        net::const_buffer target;
+        std::size_t direct = 0;
+
+        explicit
+        recording_stream(net::io_context& ioc)
+            : s_(ioc)
+        {
+        }
+
+        test::stream&
+        next() noexcept
+        {
+            return s_;
+        }
+
+        executor_type
+        get_executor() noexcept
+        {
+            return s_.get_executor();
+        }
+
+        template<class MutableBufferSequence>
+        std::size_t
+        read_some(MutableBufferSequence const& buffers)
+        {
+            error_code ec;
+            auto const n = read_some(buffers, ec);
+            if(ec)
+                BOOST_THROW_EXCEPTION(system_error{ec});
+            return n;
+        }
+
+        template<class MutableBufferSequence>
+        std::size_t
+        read_some(MutableBufferSequence const& buffers,
+            error_code& ec)
+        {
+            auto const n = s_.read_some(buffers, ec);
+            auto const first = static_cast<
+                char const*>(target.data());
+            for(net::mutable_buffer b :
+                    beast::buffers_range_ref(buffers))
+            {
+                auto const p = static_cast<char const*>(b.data());
+                if(p >= first && p < first + target.size())
+                {
+                    direct += n;
+                    break;
+                }
+            }
+            return n;
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        write_some(ConstBufferSequence const& buffers)
+        {
+            return s_.write_some(buffers);
+        }
+
+        template<class ConstBufferSequence>
+        std::size_t
+        write_some(ConstBufferSequence const& buffers,
+            error_code& ec)
+        {
+            return s_.write_some(buffers, ec);
+        }
+
+        friend
+        void
+        teardown(role_type role,
+            recording_stream& s, error_code& ec)
+        {
+            teardown(role, s.s_, ec);
+        }
+    };
+
+    /*  Once the frame header is parsed and the read
+        buffer is drained, the payload of a large frame
+        is read straight into the caller's buffer and
+        unmasked there.
+    */
+    void
+    testDirectRead()
+    {
+        net::io_context ioc;
+        test::stream peer{ioc};
+        stream<recording_stream> ws{ioc};
+        ws.next_layer().next().connect(peer);
+        ws.next_layer().next().append(
+            "GET / HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: upgrade\r\n"
+            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+            "Sec-WebSocket-Version: 13\r\n"
+            "\r\n");
+        ws.accept();
+
+        // A masked frame, as sent by a client
+        std::string const s = random_string();
+        std::string payload;
+        while(payload.size() < 256 * 1024)
+            payload += s;
+        detail::frame_header fh;
+        fh.op = detail::opcode::binary;
+        fh.fin = true;
+        fh.rsv1 = false;
+        fh.rsv2 = false;
+        fh.rsv3 = false;
+        fh.len = payload.size();
+        fh.mask = true;
+        fh.key = 0x12345678;
+        detail::fh_buffer fb;
+        detail::write<flat_static_buffer_base>(fb, fh);
+        std::string frame = buffers_to_string(fb.data());
+        {
+            std::string masked = payload;
+            detail::prepared_key key;
+            detail::prepare_key(key, fh.key);
+            detail::mask_inplace(net::buffer(&masked[0],
+                masked.size()), key);
+            frame += masked;
+        }
+        ws.next_layer().next().append(frame);
+        ws.next_layer().next().read_size(16 * 1024);
+
+        std::string result(payload.size(), 0);
+        ws.next_layer().target = net::buffer(result);
+        std::size_t n = 0;
+        while(n < result.size())
+            n += ws.read_some(net::buffer(
+                &result[n], result.size() - n));
+        BEAST_EXPECT(ws.is_message_done());
+        BEAST_EXPECT(result == payload);
+        // only the bytes read along with the
+        // header went through the read buffer
+        BEAST_EXPECT(ws.next_layer().direct >=
+            payload.size() - stream<test::stream>::tcp_frame_size);
+    }
+
     void
     testMoveOnly()
     {
@@ -643,6 +794,7 @@ public:
         testIssue954();
         testIssueBF1();
         testIssueBF2();
+        testDirectRead();
         testMoveOnly();
         testAsioHandlerInvoke();
     }
@@ -12,6 +12,9 @@
 
 #include <boost/beast/core/tcp_stream.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/smart_ptr/make_unique.hpp>
+#include <memory>
+#include <vector>
 
 #include "test.hpp"
 
@@ -152,6 +155,182 @@ public:
         }
     }
 
+    // Returns the server's memory usage after a message is
+    // exchanged each way and the server is waiting for more.
+    std::size_t
+    doTestHibernate(
+        bool hibernate,
+        bool no_context_takeover,
+        std::size_t& base)
+    {
+        net::io_context ioc;
+        permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.server_enable = true;
+        pmd.client_no_context_takeover = no_context_takeover;
+        pmd.server_no_context_takeover = no_context_takeover;
+        stream<test::stream> ws0{ioc};
+        stream<test::stream> ws1{ioc};
+        ws0.next_layer().connect(ws1.next_layer());
+        ws0.set_option(pmd);
+        ws1.set_option(pmd);
+        ws0.hibernate(hibernate);
+        ws1.hibernate(hibernate);
+        BEAST_EXPECT(ws1.hibernate() == hibernate);
+        ws1.async_accept(
+            [](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ws0.async_handshake("test", "/",
+            [](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ioc.run();
+        ioc.restart();
+        base = ws1.memory_usage();
+
+        std::string const s(10000, '*');
+        ws0.write(net::buffer(s));
+        flat_buffer b;
+        ws1.read(b);
+        BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        ws1.write(b.data());
+        b.clear();
+        ws0.read(b);
+        BEAST_EXPECT(buffers_to_string(b.data()) == s);
+
+        // Wait for the next message
+        ws1.async_read(b,
+            [](error_code, std::size_t)
+            {
+            });
+        ioc.poll();
+        return ws1.memory_usage();
+    }
+
+    void
+    testHibernate()
+    {
+        std::size_t base;
+        auto const idle = doTestHibernate(false, true, base);
+        BEAST_EXPECT(idle > base);
+        log << "idle connection: " << idle << " bytes, ";
+        auto const hibernating = doTestHibernate(true, true, base);
+        BEAST_EXPECT(hibernating == base);
+        log << "hibernating: " << hibernating << " bytes" << std::endl;
+
+        // Compression state must be kept
+        // when context takeover is in use.
+        BEAST_EXPECT(
+            doTestHibernate(true, false, base) > base);
+    }
+
+    // Streams which reset compression after every message
+    // share contexts instead of holding one each.
+    void
+    testPmdPool()
+    {
+        std::size_t constexpr N = 8;
+        net::io_context ioc;
+        auto& pool = net::use_service<detail::pmd_pool>(ioc);
+        std::vector<std::unique_ptr<stream<test::stream>>> v;
+        for(std::size_t i = 0; i < N; ++i)
+        {
+            permessage_deflate pmd;
+            pmd.client_enable = true;
+            pmd.server_enable = true;
+            pmd.client_no_context_takeover = true;
+            pmd.server_no_context_takeover = true;
+            // different windows draw from the same pool
+            pmd.client_max_window_bits = 9 + i % 7;
+            auto ws0 = boost::make_unique<stream<test::stream>>(ioc);
+            auto ws1 = boost::make_unique<stream<test::stream>>(ioc);
+            ws0->next_layer().connect(ws1->next_layer());
+            ws0->set_option(pmd);
+            ws1->set_option(pmd);
+            ws0->hibernate(true);
+            ws1->hibernate(true);
+            ws1->async_accept(
+                [](error_code ec)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            ws0->async_handshake("test", "/",
+                [](error_code ec)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            v.emplace_back(std::move(ws0));
+            v.emplace_back(std::move(ws1));
+        }
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(pool.idle_deflate() == 0);
+        BEAST_EXPECT(pool.idle_inflate() == 0);
+
+        std::size_t const base = v[1]->memory_usage();
+        for(int round = 0; round < 3; ++round)
+        {
+            for(std::size_t i = 0; i < v.size(); i += 2)
+            {
+                std::string const s(
+                    1000 + 100 * i, static_cast<char>('a' + i));
+                flat_buffer b;
+                v[i]->write(net::buffer(s));
+                v[i + 1]->read(b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == s);
+                v[i + 1]->write(b.data());
+                b.clear();
+                v[i]->read(b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == s);
+            }
+        }
+        // one message was in flight at a time
+        BEAST_EXPECT(pool.idle_deflate() == 1);
+        BEAST_EXPECT(pool.idle_inflate() == 1);
+        BEAST_EXPECT(v[1]->memory_usage() == base);
+
+        // every stream compressing at once, with messages
+        // which take more than one frame to send, leaves
+        // no more idle contexts than the pool keeps
+        pool.max_idle(4);
+        std::string s;
+        std::uint32_t x = 1;
+        while(s.size() < 20000)
+        {
+            x = x * 1103515245 + 12345;
+            s.push_back(static_cast<char>(x >> 24));
+        }
+        for(auto& ws : v)
+        {
+            ws->binary(true);
+            ws->async_write(net::buffer(s),
+                [](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+        }
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(pool.idle_deflate() == 4);
+        for(auto& ws : v)
+        {
+            flat_buffer b;
+            ws->read(b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == s);
+        }
+        BEAST_EXPECT(pool.idle_inflate() == 1);
+
+        // lowering the limit frees the surplus
+        pool.max_idle(2);
+        BEAST_EXPECT(pool.idle_deflate() == 2);
+        pool.max_idle(0);
+        BEAST_EXPECT(pool.idle_deflate() == 0);
+        BEAST_EXPECT(pool.idle_inflate() == 0);
+    }
+
     void
     testJavadoc()
     {
@@ -195,6 +374,8 @@ public:
             sizeof(websocket::stream<test::stream&>::impl_type) << std::endl;
 
         testOptions();
+        testHibernate();
+        testPmdPool();
         testJavadoc();
     }
 };
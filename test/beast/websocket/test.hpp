@@ -1174,6 +1174,15 @@ struct test_sync_api
         return ws.write_some(fin, buffers);
     }
 
+    template<class NextLayer, bool deflateSupported>
+    std::size_t
+    write_prepared(
+        stream<NextLayer, deflateSupported>& ws,
+        prepared_message const& m) const
+    {
+        return ws.write_prepared(m);
+    }
+
     template<
         class NextLayer, bool deflateSupported,
         class ConstBufferSequence>
@@ -1213,6 +1222,7 @@ class test_async_api
 
         handler(handler&& other)
             : ec_(other.ec_)
+            , n_(other.n_)
             , pass_(boost::exchange(other.pass_, true))
         {
         }
@@ -1563,6 +1573,22 @@ public:
         return n;
     }
 
+    template<class NextLayer, bool deflateSupported>
+    std::size_t
+    write_prepared(
+        stream<NextLayer, deflateSupported>& ws,
+        prepared_message const& m) const
+    {
+        error_code ec;
+        std::size_t n;
+        ws.async_write_prepared(m, handler(ec, n));
+        ws.get_executor().context().run();
+        ws.get_executor().context().restart();
+        if(ec)
+            throw system_error{ec};
+        return n;
+    }
+
     template<
         class NextLayer, bool deflateSupported,
         class ConstBufferSequence>
@@ -11,9 +11,14 @@
 #include <boost/beast/websocket/detail/utf8_checker.hpp>
 
 #include <boost/beast/core/buffers_suffix.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
 #include <boost/beast/core/multi_buffer.hpp>
 #include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <algorithm>
 #include <array>
+#include <random>
+#include <string>
+#include <vector>
 
 namespace boost {
 namespace beast {
@@ -566,6 +571,135 @@ public:
         }
     }
 
+    // Append one code point, encoded with `n` bytes
+    static
+    void
+    append(std::string& s, std::uint32_t cp, int n)
+    {
+        if(n == 1)
+        {
+            s.push_back(static_cast<char>(cp));
+            return;
+        }
+        static unsigned char const lead[] = { 0, 0, 0xc0, 0xe0, 0xf0 };
+        s.push_back(static_cast<char>(lead[n] | (cp >> (6 * (n - 1)))));
+        for(int i = n - 2; i >= 0; --i)
+            s.push_back(static_cast<char>(0x80 | ((cp >> (6 * i)) & 0x3f)));
+    }
+
+    // Text with runs of ASCII and of 2, 3 and 4 byte code points
+    static
+    std::string
+    make_text(std::mt19937& g, std::size_t size)
+    {
+        std::string s;
+        while(s.size() < size)
+        {
+            auto const n = static_cast<int>(g() % 5);
+            auto run = g() % 40;
+            while(run--)
+            {
+                switch(n)
+                {
+                case 2:
+                    append(s, 0x80 + g() % 0x780, 2);
+                    break;
+                case 3:
+                {
+                    auto cp = 0x800 + g() % 0xf800;
+                    if(cp >= 0xd800 && cp < 0xe000)
+                        cp -= 0x800;
+                    append(s, cp, 3);
+                    break;
+                }
+                case 4:
+                    append(s, 0x10000 + g() % 0x100000, 4);
+                    break;
+                default:
+                    s.push_back(static_cast<char>(' ' + g() % 95));
+                }
+            }
+        }
+        return s;
+    }
+
+    static
+    bool
+    check(std::string const& s, std::size_t split)
+    {
+        utf8_checker u;
+        auto const p = reinterpret_cast<std::uint8_t const*>(s.data());
+        split = (std::min)(split, s.size());
+        return
+            u.write(p, split) &&
+            u.write(p + split, s.size() - split) &&
+            u.finish();
+    }
+
+    // Compare each vector width with the scalar loops on valid
+    // text, and on text with one byte replaced, split at every
+    // position around the vector blocks.
+    void
+    testWide()
+    {
+        std::mt19937 g;
+        std::vector<std::string> valid;
+        std::vector<std::string> texts;
+        for(int i = 0; i < 200; ++i)
+        {
+            auto s = make_text(g, 40 + g() % 200);
+            valid.push_back(s);
+            texts.push_back(s);
+            static unsigned char const bad[] = {
+                0x80, 0xbf, 0xc0, 0xc1, 0xc2, 0xe0, 0xed,
+                0xef, 0xf0, 0xf4, 0xf5, 0xf8, 0xff, 'A' };
+            s[g() % s.size()] = static_cast<char>(
+                bad[g() % sizeof(bad)]);
+            texts.push_back(s);
+        }
+
+        // Valid text passes on every path
+        auto const check_valid = [&]
+        {
+            for(auto const& s : valid)
+                for(std::size_t split = 0; split <= 70; split += 7)
+                    BEAST_EXPECT(check(s, split));
+        };
+
+#if ! BOOST_BEAST_NO_INTRINSICS
+        auto const run = [&](std::vector<bool>& v)
+        {
+            v.clear();
+            for(auto const& s : texts)
+                for(std::size_t split = 0; split <= 70; ++split)
+                    v.push_back(check(s, split));
+        };
+
+        auto& ci = beast::detail::get_mutable_cpu_info();
+        auto const saved = ci;
+        ci.avx2 = false;
+        ci.sse42 = false;
+        check_valid();
+        std::vector<bool> expected;
+        run(expected);
+        // Not every replacement makes the text invalid
+        BEAST_EXPECT(std::count(
+            expected.begin(), expected.end(), false) > 0);
+        ci = saved;
+        check_valid();
+        std::vector<bool> actual;
+        run(actual);
+        BEAST_EXPECT(actual == expected);
+        ci.avx2 = false;
+        check_valid();
+        run(actual);
+        BEAST_EXPECT(actual == expected);
+        ci = saved;
+#else
+        check_valid();
+#endif
+    }
+
     void
     run() override
     {
@@ -575,6 +709,7 @@ public:
         testFourByteSequence();
         testWithStreamBuffer();
         testBranches();
+        testWide();
         AutodeskTests();
         // 6.4.2
         AutobahnTest(std::vector<std::vector<std::uint8_t>>{
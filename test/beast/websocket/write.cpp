@@ -12,6 +12,11 @@
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/strand.hpp>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "test.hpp"
 
@@ -716,6 +721,605 @@ public:
         BEAST_EXPECT(n1 < n0 + s.size());
     }
 
+    // Connect a client and a server stream
+    void
+    connect(
+        net::io_context& ioc,
+        stream<test::stream>& ws0,
+        stream<test::stream>& ws1,
+        permessage_deflate const& pmd)
+    {
+        ws0.next_layer().connect(ws1.next_layer());
+        ws0.set_option(pmd);
+        ws1.set_option(pmd);
+        ws1.async_accept(
+            [](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ws0.async_handshake("test", "/",
+            [](error_code ec)
+            {
+                BEAST_EXPECTS(! ec, ec.message());
+            });
+        ioc.run();
+        ioc.restart();
+    }
+
+    // Queue many messages from `from` without waiting,
+    // along with a ping, and read them back in order.
+    void
+    doTestWriteQueued(
+        stream<test::stream>& from,
+        stream<test::stream>& to,
+        net::io_context& ioc)
+    {
+        std::size_t constexpr N = 100;
+        std::vector<std::string> v;
+        for(std::size_t i = 0; i < N; ++i)
+            v.emplace_back(std::to_string(i) +
+                std::string(i % 7 * 10, '*'));
+        std::size_t completed = 0;
+        auto const nwrite = to.next_layer().nwrite();
+        for(std::size_t i = 0; i < N; ++i)
+        {
+            from.binary(i % 2 == 0);
+            // the queue keeps its own copy
+            std::string s = v[i];
+            from.async_write_queued(net::buffer(s),
+                [&, i](error_code ec, std::size_t n)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(n == v[i].size());
+                    BEAST_EXPECT(completed++ == i);
+                });
+            if(i == N / 2)
+                from.async_ping({},
+                    [](error_code ec)
+                    {
+                        BEAST_EXPECTS(! ec, ec.message());
+                    });
+        }
+        BEAST_EXPECT(from.write_queue_size() == N);
+        ioc.run();
+        ioc.restart();
+        BEAST_EXPECT(completed == N);
+        BEAST_EXPECT(from.write_queue_size() == 0);
+        BEAST_EXPECT(from.write_queue_bytes() == 0);
+        // messages were coalesced
+        BEAST_EXPECT(to.next_layer().nwrite() - nwrite < N / 2);
+
+        for(std::size_t i = 0; i < N; ++i)
+        {
+            flat_buffer b;
+            to.read(b);
+            BEAST_EXPECT(to.got_binary() == (i % 2 == 0));
+            BEAST_EXPECT(buffers_to_string(b.data()) == v[i]);
+        }
+    }
+
+    void
+    testWriteQueued()
+    {
+        permessage_deflate pmd;
+        for(int i = 0; i < 4; ++i)
+        {
+            pmd.client_enable = i >= 2;
+            pmd.server_enable = i >= 2;
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, pmd);
+            // client masks, server does not
+            if(i % 2 == 0)
+                doTestWriteQueued(ws0, ws1, ioc);
+            else
+                doTestWriteQueued(ws1, ws0, ioc);
+        }
+
+        // limits
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, {});
+            ws1.write_queue_limit(100, 3);
+            std::string const s(40, '*');
+            std::vector<error_code> results;
+            auto const queue =
+                [&](std::size_t n)
+                {
+                    ws1.async_write_queued(
+                        net::buffer(s.data(), n),
+                        [&](error_code ec, std::size_t)
+                        {
+                            results.push_back(ec);
+                        });
+                };
+            queue(40);
+            queue(40);
+            BEAST_EXPECT(ws1.write_queue_bytes() == 80);
+            queue(40); // over the byte limit
+            queue(20);
+            queue(0);  // over the message limit
+            ioc.run();
+            ioc.restart();
+            BEAST_EXPECT(results.size() == 5);
+            BEAST_EXPECT(std::count(
+                results.begin(), results.end(),
+                error::write_queue_full) == 2);
+
+            // an empty queue takes any message
+            std::string const big(1000, '*');
+            ws1.async_write_queued(net::buffer(big),
+                [&](error_code ec, std::size_t n)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    BEAST_EXPECT(n == big.size());
+                });
+            ioc.run();
+        }
+
+        // every queued message gets the error
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, {});
+            ws1.next_layer().close();
+            std::size_t failed = 0;
+            for(int i = 0; i < 10; ++i)
+                ws1.async_write_queued(net::buffer("hello", 5),
+                    [&](error_code ec, std::size_t n)
+                    {
+                        if(ec)
+                            ++failed;
+                        BEAST_EXPECT(n == 0);
+                    });
+            ioc.run();
+            BEAST_EXPECT(failed == 10);
+            BEAST_EXPECT(ws1.write_queue_size() == 0);
+        }
+
+        // queued after a message in progress
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, {});
+            ws1.async_write_some(false, net::buffer("a", 1),
+                [](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            ioc.run();
+            ioc.restart();
+            ws1.async_write_queued(net::buffer("queued", 6),
+                [](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            ioc.poll();
+            ioc.restart();
+            ws1.async_write_some(true, net::buffer("b", 1),
+                [](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                });
+            ioc.run();
+            flat_buffer b;
+            ws0.read(b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == "ab");
+            b.clear();
+            ws0.read(b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == "queued");
+        }
+
+        // destroyed while queued
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            {
+                stream<test::stream> ws1{ioc};
+                connect(ioc, ws0, ws1, {});
+                for(int i = 0; i < 10; ++i)
+                    ws1.async_write_queued(net::buffer("hello", 5),
+                        [](error_code, std::size_t)
+                        {
+                        });
+            }
+            ioc.run();
+        }
+    }
+
+    // Write a batch of messages from `from`, with the
+    // synchronous or asynchronous API, and read them back.
+    void
+    doTestWriteBatch(
+        stream<test::stream>& from,
+        stream<test::stream>& to,
+        net::io_context& ioc,
+        bool async)
+    {
+        std::size_t constexpr N = 50;
+        std::vector<std::string> v;
+        std::vector<std::vector<net::const_buffer>> bs;
+        std::size_t size = 0;
+        for(std::size_t i = 0; i < N; ++i)
+        {
+            v.emplace_back(std::to_string(i) +
+                std::string(i % 5 * 40, '*'));
+            size += v.back().size();
+        }
+        for(std::size_t i = 0; i < N; ++i)
+        {
+            // split some payloads in two
+            auto const& s = v[i];
+            bs.emplace_back();
+            bs.back().emplace_back(s.data(), s.size() / 2);
+            bs.back().emplace_back(
+                s.data() + s.size() / 2, s.size() - s.size() / 2);
+        }
+        from.binary(true);
+        auto const nwrite = to.next_layer().nwrite();
+        if(async)
+        {
+            std::size_t n = 0;
+            from.async_write_batch(bs,
+                [&](error_code ec, std::size_t n_)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    n = n_;
+                });
+            // the range may be destroyed after the call
+            bs.clear();
+            ioc.run();
+            ioc.restart();
+            BEAST_EXPECT(n == size);
+        }
+        else
+        {
+            BEAST_EXPECT(from.write_batch(bs) == size);
+        }
+        BEAST_EXPECT(to.next_layer().nwrite() - nwrite < N / 2);
+
+        for(std::size_t i = 0; i < N; ++i)
+        {
+            flat_buffer b;
+            to.read(b);
+            BEAST_EXPECT(to.got_binary());
+            BEAST_EXPECT(buffers_to_string(b.data()) == v[i]);
+        }
+    }
+
+    void
+    testWriteBatch()
+    {
+        permessage_deflate pmd;
+        for(int i = 0; i < 8; ++i)
+        {
+            pmd.client_enable = i & 2;
+            pmd.server_enable = i & 2;
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, pmd);
+            // client masks, server does not
+            if(i & 1)
+                doTestWriteBatch(ws1, ws0, ioc, i & 4);
+            else
+                doTestWriteBatch(ws0, ws1, ioc, i & 4);
+        }
+
+        // empty range and empty messages
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, {});
+            std::vector<net::const_buffer> v;
+            BEAST_EXPECT(ws1.write_batch(v) == 0);
+            v.resize(2);
+            BEAST_EXPECT(ws1.write_batch(v) == 0);
+            flat_buffer b;
+            ws0.read(b);
+            BEAST_EXPECT(b.size() == 0);
+            ws0.read(b);
+            BEAST_EXPECT(b.size() == 0);
+        }
+
+        // error
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, {});
+            ws1.next_layer().close();
+            std::vector<net::const_buffer> v(
+                3, net::buffer("hello", 5));
+            error_code ec;
+            BEAST_EXPECT(ws1.write_batch(v, ec) == 0);
+            BEAST_EXPECT(ec);
+        }
+
+        // a message started with write_some is unfinished
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, {});
+            ws1.write_some(false, net::buffer("a", 1));
+            std::vector<net::const_buffer> v(
+                3, net::buffer("hello", 5));
+            error_code ec;
+            BEAST_EXPECT(ws1.write_batch(v, ec) == 0);
+            BEAST_EXPECT(ec == net::error::in_progress);
+            bool invoked = false;
+            ws1.async_write_batch(v,
+                [&](error_code ec, std::size_t n)
+                {
+                    invoked = true;
+                    BEAST_EXPECT(ec == net::error::in_progress);
+                    BEAST_EXPECT(n == 0);
+                });
+            ioc.run();
+            BEAST_EXPECT(invoked);
+            ws1.write_some(true, net::buffer("b", 1));
+            flat_buffer b;
+            ws0.read(b);
+            BEAST_EXPECT(buffers_to_string(b.data()) == "ab");
+        }
+
+        // a batch waiting for the write lock is compressed
+        // in the order its frames go out
+        {
+            pmd.client_enable = true;
+            pmd.server_enable = true;
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, pmd);
+            std::string const s(2000, '*');
+            std::vector<net::const_buffer> v(
+                3, net::buffer("hello", 5));
+            int n = 0;
+            ws1.async_ping({},
+                [&](error_code ec)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    ++n;
+                });
+            ws1.async_write_queued(net::buffer(s),
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    ++n;
+                });
+            ws1.async_write_batch(v,
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    ++n;
+                });
+            ioc.run();
+            BEAST_EXPECT(n == 3);
+            std::size_t hellos = 0;
+            std::size_t stars = 0;
+            for(int i = 0; i < 4; ++i)
+            {
+                flat_buffer b;
+                ws0.read(b);
+                auto const m = buffers_to_string(b.data());
+                if(m == "hello")
+                    ++hellos;
+                else if(BEAST_EXPECT(m == s))
+                    ++stars;
+            }
+            BEAST_EXPECT(hellos == 3);
+            BEAST_EXPECT(stars == 1);
+        }
+    }
+
+    void
+    testAdaptiveDeflate()
+    {
+        auto const check =
+            [&](permessage_deflate const& pmd,
+                std::string const& s, bool compressed)
+            {
+                net::io_context ioc;
+                stream<test::stream> ws0{ioc};
+                stream<test::stream> ws1{ioc};
+                connect(ioc, ws0, ws1, pmd);
+                ws1.binary(true);
+                ws1.write(net::buffer(s));
+                auto const st = ws1.deflate_statistics();
+                BEAST_EXPECT(st.messages_compressed == (compressed ? 1 : 0));
+                BEAST_EXPECT(st.messages_skipped == (compressed ? 0 : 1));
+                BEAST_EXPECT(compressed ?
+                    st.bytes_in == s.size() : st.bytes_in == 0);
+                flat_buffer b;
+                ws0.read(b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == s);
+            };
+
+        permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.server_enable = true;
+
+        std::string const text(2000, 'a');
+        std::string noise(2000, 0);
+        {
+            std::mt19937 rng;
+            for(auto& c : noise)
+                c = static_cast<char>(rng());
+        }
+
+        // defaults compress everything
+        check(pmd, "x", true);
+        check(pmd, noise, true);
+
+        // size threshold
+        pmd.msg_size_threshold = 100;
+        check(pmd, std::string(99, 'a'), false);
+        check(pmd, text, true);
+        pmd.msg_size_threshold = 0;
+
+        // entropy check
+        pmd.skip_incompressible = true;
+        check(pmd, noise, false);
+        check(pmd, text, true);
+        check(pmd, "short", true);
+        pmd.skip_incompressible = false;
+
+        // statistics
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, pmd);
+            ws1.write(net::buffer(text));
+            auto const st = ws1.deflate_statistics();
+            BEAST_EXPECT(st.bytes_in == text.size());
+            BEAST_EXPECT(st.bytes_out > 0);
+            BEAST_EXPECT(st.bytes_out < text.size());
+            BEAST_EXPECT(st.level == pmd.compLevel);
+        }
+
+        // level lowered to meet an unreachable time budget,
+        // with an owned and with a pooled compressor
+        std::string letters(16384, 0);
+        {
+            std::mt19937 rng;
+            std::uniform_int_distribution<int> ch('a', 'z');
+            for(auto& c : letters)
+                c = static_cast<char>(ch(rng));
+        }
+        pmd.max_ns_per_byte = 1;
+        for(int i = 0; i < 2; ++i)
+        {
+            pmd.server_no_context_takeover = i == 1;
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, pmd);
+            flat_buffer b;
+            for(int j = 0; j < 10; ++j)
+            {
+                ws1.write(net::buffer(letters));
+                ws0.read(b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == letters);
+                b.clear();
+            }
+            BEAST_EXPECT(ws1.deflate_statistics().level == 1);
+        }
+        pmd.server_no_context_takeover = false;
+
+        // level 0 is never raised or lowered
+        pmd.compLevel = 0;
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, pmd);
+            flat_buffer b;
+            for(int j = 0; j < 4; ++j)
+            {
+                ws1.write(net::buffer(letters));
+                ws0.read(b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == letters);
+                b.clear();
+                BEAST_EXPECT(ws1.deflate_statistics().level == 0);
+            }
+        }
+        pmd.max_ns_per_byte = 1000000;
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, pmd);
+            flat_buffer b;
+            for(int j = 0; j < 4; ++j)
+            {
+                ws1.write(net::buffer(text));
+                ws0.read(b);
+                BEAST_EXPECT(buffers_to_string(b.data()) == text);
+                b.clear();
+                BEAST_EXPECT(ws1.deflate_statistics().level == 0);
+            }
+        }
+        pmd.compLevel = permessage_deflate{}.compLevel;
+        pmd.max_ns_per_byte = 0;
+
+        // no extension
+        {
+            net::io_context ioc;
+            stream<test::stream> ws0{ioc};
+            stream<test::stream> ws1{ioc};
+            connect(ioc, ws0, ws1, {});
+            ws1.write(net::buffer(text));
+            auto const st = ws1.deflate_statistics();
+            BEAST_EXPECT(st.messages_compressed == 0);
+            BEAST_EXPECT(st.bytes_in == 0);
+        }
+    }
+
+    void
+    testDeflateDictionary()
+    {
+        std::vector<std::string> messages;
+        for(int i = 0; i < 20; ++i)
+            messages.push_back(
+                "{\"id\":" + std::to_string(1000 + i * 37) +
+                ",\"type\":\"price_update\",\"symbol\":\"ABC\","
+                "\"currency\":\"USD\",\"exchange\":\"NASDAQ\","
+                "\"price\":" + std::to_string(100 + i) + "}");
+        auto const dict = std::make_shared<std::string const>(
+            "\"type\":\"trade\",\"type\":\"price_update\","
+            "\"symbol\":\"ABC\",\"currency\":\"USD\","
+            "\"exchange\":\"NASDAQ\",\"price\":{\"id\":");
+
+        // Returns the bytes sent compressed by ws1
+        auto const exchange =
+            [&](permessage_deflate const& pmd)
+            {
+                net::io_context ioc;
+                stream<test::stream> ws0{ioc};
+                stream<test::stream> ws1{ioc};
+                connect(ioc, ws0, ws1, pmd);
+                flat_buffer b;
+                for(auto const& m : messages)
+                {
+                    ws1.write(net::buffer(m));
+                    ws0.read(b);
+                    BEAST_EXPECT(buffers_to_string(b.data()) == m);
+                    b.clear();
+                    ws0.write(net::buffer(m));
+                    ws1.read(b);
+                    BEAST_EXPECT(buffers_to_string(b.data()) == m);
+                    b.clear();
+                }
+                return ws1.deflate_statistics().bytes_out;
+            };
+
+        permessage_deflate pmd;
+        pmd.client_enable = true;
+        pmd.server_enable = true;
+        for(int i = 0; i < 2; ++i)
+        {
+            // with owned and with pooled streams
+            pmd.server_no_context_takeover = i == 1;
+            pmd.client_no_context_takeover = i == 1;
+            pmd.dictionary = nullptr;
+            auto const n0 = exchange(pmd);
+            pmd.dictionary = dict;
+            auto const n1 = exchange(pmd);
+            BEAST_EXPECT(n1 < n0);
+            if(i == 1)
+                BEAST_EXPECT(n1 * 2 < n0);
+        }
+    }
+
     void
     run() override
     {
@@ -726,6 +1330,10 @@ public:
         testMoveOnly();
         testIssue300();
         testIssue1666();
+        testWriteQueued();
+        testWriteBatch();
+        testAdaptiveDeflate();
+        testDeflateDictionary();
     }
 };
 
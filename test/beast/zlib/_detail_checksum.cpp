@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/zlib/detail/checksum.hpp>
+
+#include <boost/beast/core/detail/cpu_info.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <cstring>
+#include <string>
+
+#include "zlib-1.2.11/zlib.h"
+
+namespace boost {
+namespace beast {
+namespace zlib {
+namespace detail {
+
+class checksum_test
+    : public beast::unit_test::suite
+{
+public:
+    static
+    std::string
+    make_data(std::size_t n)
+    {
+        std::string s;
+        s.reserve(n);
+        std::uint32_t x = 1;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            x = x * 1103515245 + 12345;
+            s.push_back(static_cast<char>(x >> 24));
+        }
+        return s;
+    }
+
+    // Compare both check values with zlib's
+    void
+    check(char const* p, std::size_t n)
+    {
+        auto const b = reinterpret_cast<Bytef const*>(p);
+        BEAST_EXPECTS(crc32(0, p, n) ==
+            ::crc32(0, b, static_cast<uInt>(n)),
+            std::to_string(n));
+        BEAST_EXPECTS(adler32(1, p, n) ==
+            ::adler32(1, b, static_cast<uInt>(n)),
+            std::to_string(n));
+    }
+
+    // Every size up to a few vectors, at every alignment
+    void
+    testSmall()
+    {
+        std::string const in = make_data(320);
+        for(std::size_t align = 0; align < 16; ++align)
+            for(std::size_t n = 0; n <= 300; ++n)
+                check(in.data() + align, n);
+    }
+
+    // Sizes around the 5552 byte block after which
+    // Adler-32 must reduce its sums, and larger ones
+    void
+    testLarge()
+    {
+        std::size_t const sizes[] = {
+            5551, 5552, 5553, 5552 * 2, 5552 * 3 + 17,
+            65536, 65536 + 33, 1000003 };
+        std::string const in = make_data(1000003 + 16);
+        for(auto n : sizes)
+            for(std::size_t align : {0, 1, 7, 13})
+                check(in.data() + align, n);
+
+        // The largest sums, from bytes which are all ones
+        std::string const ones(100000, '\xff');
+        for(auto n : sizes)
+            if(n <= ones.size())
+                check(ones.data(), n);
+        check(ones.data(), ones.size());
+    }
+
+    // Values carried over from the bytes before
+    void
+    testIncremental()
+    {
+        std::string const in = make_data(20000);
+        auto const b = reinterpret_cast<Bytef const*>(in.data());
+        auto const crc = ::crc32(0, b, static_cast<uInt>(in.size()));
+        auto const adler = ::adler32(1, b, static_cast<uInt>(in.size()));
+        for(std::size_t i : {0, 1, 63, 64, 65, 5553, 12345, 20000})
+        {
+            auto const n = in.size() - i;
+            BEAST_EXPECT(crc32(crc32(0, in.data(), i),
+                in.data() + i, n) == crc);
+            BEAST_EXPECT(adler32(adler32(1, in.data(), i),
+                in.data() + i, n) == adler);
+        }
+    }
+
+    void
+    testChecksum()
+    {
+        testSmall();
+        testLarge();
+        testIncremental();
+    }
+
+    void
+    run() override
+    {
+#if ! BOOST_BEAST_NO_INTRINSICS
+        auto& ci = beast::detail::get_mutable_cpu_info();
+        auto const saved = ci;
+        testChecksum();
+        ci.ssse3 = false;
+        ci.pclmul = false;
+        testChecksum();
+        ci = saved;
+#else
+        testChecksum();
+#endif
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,zlib,checksum);
+
+} // detail
+} // zlib
+} // beast
+} // boost
@@ -12,6 +12,7 @@
 
 #include <boost/beast/core/string.hpp>
 #include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <numeric>
@@ -604,6 +605,211 @@ public:
         }
     }
 
+    void
+    testClear()
+    {
+        auto const compress_once =
+            [&](deflate_stream& ds)
+            {
+                std::string const in(1000, 'a');
+                std::string out(100, 0);
+                z_params zs;
+                zs.next_in = in.data();
+                zs.avail_in = in.size();
+                zs.next_out = &out[0];
+                zs.avail_out = out.size();
+                error_code ec;
+                ds.write(zs, Flush::sync, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                out.resize(zs.total_out);
+                return out;
+            };
+        deflate_stream ds;
+        ds.reset(6, 15, 8, Strategy::normal);
+        BEAST_EXPECT(ds.allocated_size() == 0);
+        auto const out = compress_once(ds);
+        BEAST_EXPECT(ds.allocated_size() > 0);
+        ds.clear();
+        BEAST_EXPECT(ds.allocated_size() == 0);
+        BEAST_EXPECT(compress_once(ds) == out);
+    }
+
+    // Compress in small pieces into a small output buffer,
+    // then check the result with zlib.
+    void
+    testWrap(Wrap wrap, std::string const& in)
+    {
+        deflate_stream ds;
+        ds.reset(6, 15, 8, Strategy::normal, wrap);
+        std::string out;
+        z_params zs;
+        zs.next_in = in.data();
+        zs.avail_in = 0;
+        for(;;)
+        {
+            auto const used = static_cast<std::size_t>(
+                static_cast<char const*>(zs.next_in) - in.data());
+            zs.avail_in = (std::min)(in.size() - used,
+                zs.avail_in + 1000);
+            out.resize(zs.total_out + 37);
+            zs.next_out = &out[zs.total_out];
+            zs.avail_out = out.size() - zs.total_out;
+            error_code ec;
+            ds.write(zs, used + zs.avail_in == in.size() ?
+                Flush::finish : Flush::none, ec);
+            if(ec == error::end_of_stream)
+                break;
+            if(! BEAST_EXPECTS(! ec || ec == error::need_buffers,
+                    ec.message()))
+                return;
+        }
+        out.resize(zs.total_out);
+        BEAST_EXPECT(zs.total_in == in.size());
+        BEAST_EXPECT(out.size() <= ds.upper_bound(in.size()));
+
+        z_stream zi;
+        memset(&zi, 0, sizeof(zi));
+        BEAST_EXPECT(inflateInit2(&zi,
+            wrap == Wrap::gzip ? 15 + 16 : 15) == Z_OK);
+        std::string result(in.size() + 1, 0);
+        zi.next_in = (Bytef*)&out[0];
+        zi.avail_in = static_cast<uInt>(out.size());
+        zi.next_out = (Bytef*)&result[0];
+        zi.avail_out = static_cast<uInt>(result.size());
+        BEAST_EXPECT(inflate(&zi, Z_FINISH) == Z_STREAM_END);
+        BEAST_EXPECT(zi.avail_in == 0);
+        result.resize(zi.total_out);
+        inflateEnd(&zi);
+        BEAST_EXPECT(result == in);
+    }
+
+    void
+    testWrap()
+    {
+        for(auto wrap : {Wrap::zlib, Wrap::gzip})
+        {
+            testWrap(wrap, {});
+            testWrap(wrap, corpus1(100000));
+            testWrap(wrap, corpus2(100000));
+        }
+
+        // The header is written again after a reset
+        deflate_stream ds;
+        ds.reset(9, 15, 8, Strategy::normal, Wrap::gzip);
+        for(int i = 0; i < 2; ++i)
+        {
+            std::string out(100, 0);
+            z_params zs;
+            zs.next_in = "*";
+            zs.avail_in = 1;
+            zs.next_out = &out[0];
+            zs.avail_out = out.size();
+            error_code ec;
+            ds.write(zs, Flush::finish, ec);
+            BEAST_EXPECTS(ec == error::end_of_stream, ec.message());
+            BEAST_EXPECT(zs.total_out > 18);
+            BEAST_EXPECT(out[0] == '\x1f');
+            BEAST_EXPECT(out[8] == 2);
+            ds.reset();
+        }
+    }
+
+    // Compress with a preset dictionary, then
+    // check the result with zlib.
+    std::size_t
+    doDictionary(
+        Wrap wrap,
+        std::string const& in,
+        std::string const* dict)
+    {
+        deflate_stream ds;
+        ds.reset(6, 15, 8, Strategy::normal, wrap);
+        error_code ec;
+        if(dict)
+        {
+            ds.dictionary(dict->data(), dict->size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+        std::string out(ds.upper_bound(in.size()), 0);
+        z_params zs;
+        zs.next_in = in.data();
+        zs.avail_in = in.size();
+        zs.next_out = &out[0];
+        zs.avail_out = out.size();
+        ds.write(zs, Flush::finish, ec);
+        BEAST_EXPECTS(ec == error::end_of_stream, ec.message());
+        out.resize(zs.total_out);
+
+        z_stream zi;
+        memset(&zi, 0, sizeof(zi));
+        BEAST_EXPECT(inflateInit2(&zi,
+            wrap == Wrap::zlib ? 15 : -15) == Z_OK);
+        if(dict && wrap == Wrap::none)
+            BEAST_EXPECT(inflateSetDictionary(&zi,
+                (Bytef const*)dict->data(),
+                static_cast<uInt>(dict->size())) == Z_OK);
+        std::string result(in.size() + 1, 0);
+        zi.next_in = (Bytef*)&out[0];
+        zi.avail_in = static_cast<uInt>(out.size());
+        zi.next_out = (Bytef*)&result[0];
+        zi.avail_out = static_cast<uInt>(result.size());
+        auto rv = inflate(&zi, Z_FINISH);
+        if(dict && wrap == Wrap::zlib)
+        {
+            // The header names the dictionary by its Adler-32
+            BEAST_EXPECT(rv == Z_NEED_DICT);
+            BEAST_EXPECT(zi.adler == ::adler32(1,
+                (Bytef const*)dict->data(),
+                static_cast<uInt>(dict->size())));
+            BEAST_EXPECT(inflateSetDictionary(&zi,
+                (Bytef const*)dict->data(),
+                static_cast<uInt>(dict->size())) == Z_OK);
+            rv = inflate(&zi, Z_FINISH);
+        }
+        BEAST_EXPECT(rv == Z_STREAM_END);
+        BEAST_EXPECT(zi.avail_in == 0);
+        result.resize(zi.total_out);
+        inflateEnd(&zi);
+        BEAST_EXPECT(result == in);
+        return out.size();
+    }
+
+    void
+    testDictionary()
+    {
+        auto const in = corpus1(50000);
+        auto const dict = in.substr(0, 30000);
+        for(auto wrap : {Wrap::none, Wrap::zlib})
+        {
+            auto const n0 = doDictionary(wrap, in, nullptr);
+            auto const n1 = doDictionary(wrap, in, &dict);
+            BEAST_EXPECT(n1 < n0 / 2);
+        }
+
+        // Larger than the window
+        doDictionary(Wrap::zlib, in, &in);
+
+        // Not supported by gzip, and only before
+        // the zlib header is written
+        error_code ec;
+        deflate_stream ds;
+        ds.reset(6, 15, 8, Strategy::normal, Wrap::gzip);
+        ds.dictionary(dict.data(), dict.size(), ec);
+        BEAST_EXPECT(ec == error::stream_error);
+        ds.reset(6, 15, 8, Strategy::normal, Wrap::zlib);
+        std::string out(100, 0);
+        z_params zs;
+        zs.next_in = "*";
+        zs.avail_in = 1;
+        zs.next_out = &out[0];
+        zs.avail_out = out.size();
+        ec = {};
+        ds.write(zs, Flush::none, ec);
+        BEAST_EXPECTS(! ec, ec.message());
+        ds.dictionary(dict.data(), dict.size(), ec);
+        BEAST_EXPECT(ec == error::stream_error);
+    }
+
     void
     run() override
     {
@@ -625,6 +831,9 @@ public:
         testRLEMatchLengthExceedLookahead(beast_compressor);
         testFlushAfterDistMatch(zlib_compressor);
         testFlushAfterDistMatch(beast_compressor);
+        testClear();
+        testWrap();
+        testDictionary();
     }
 };
 
@@ -57,7 +57,19 @@ public:
         check("boost.beast.zlib", error::over_subscribed_length);
         check("boost.beast.zlib", error::incomplete_length_set);
 
+        check("boost.beast.zlib", error::incorrect_header_check);
+        check("boost.beast.zlib", error::unknown_compression_method);
+        check("boost.beast.zlib", error::invalid_window_size);
+        check("boost.beast.zlib", error::unknown_header_flags);
+        check("boost.beast.zlib", error::incorrect_header_crc);
+        check("boost.beast.zlib", error::incorrect_data_check);
+        check("boost.beast.zlib", error::incorrect_length_check);
+
         check("boost.beast.zlib", error::general);
+
+        // Values already in use must not change
+        BEAST_EXPECT(static_cast<int>(error::incomplete_length_set) == 15);
+        BEAST_EXPECT(static_cast<int>(error::general) == 16);
     }
 };
 
@@ -12,6 +12,7 @@
 
 #include <boost/beast/core/string.hpp>
 #include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <algorithm>
 #include <chrono>
 #include <random>
 
@@ -634,6 +635,340 @@ public:
         BEAST_EXPECT(out == "Hello");
     }
 
+    // Matches at every short distance, including those which
+    // overlap the bytes being copied, decoded with output
+    // buffers of sizes near the fast path's requirement.
+    void
+    testFastMatches()
+    {
+        std::string check;
+        {
+            std::mt19937 g;
+            std::uniform_int_distribution<std::uint32_t> d0{0, 255};
+            std::uniform_int_distribution<std::size_t> d1{3, 258};
+            for(int i = 0; i < 64; ++i)
+                check.push_back(static_cast<char>(d0(g)));
+            for(std::size_t dist = 1; dist <= 300; ++dist)
+            {
+                auto const len = d1(g);
+                for(std::size_t i = 0; i < len; ++i)
+                    check.push_back(check[check.size() - dist]);
+                check.push_back(static_cast<char>(d0(g)));
+            }
+        }
+        auto const in = compress(
+            check, 9, 15, 8, Z_DEFAULT_STRATEGY);
+        for(std::size_t chunk : {
+            std::size_t{258}, std::size_t{261},
+            std::size_t{265}, std::size_t{4096},
+            check.size()})
+        {
+            inflate_stream is;
+            is.reset(15);
+            std::string out(check.size(), 0);
+            z_params zs;
+            zs.next_in = in.data();
+            zs.avail_in = in.size();
+            zs.next_out = &out[0];
+            error_code ec;
+            while(zs.total_out < out.size())
+            {
+                zs.avail_out = (std::min)(
+                    chunk, out.size() - zs.total_out);
+                is.write(zs, Flush::sync, ec);
+                if(ec)
+                    break;
+            }
+            BEAST_EXPECTS(! ec, ec.message());
+            BEAST_EXPECT(out == check);
+        }
+    }
+
+    // Compress with zlib, in the zlib format or with
+    // an optional gzip header.
+    static
+    std::string
+    compressWrapped(
+        string_view const& in,
+        Wrap wrap,
+        gz_header* head = nullptr)
+    {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        if(deflateInit2(&zs, 6, Z_DEFLATED,
+                wrap == Wrap::gzip ? 15 + 16 : 15,
+                8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw std::logic_error{"deflateInit2 failed"};
+        if(head)
+            deflateSetHeader(&zs, head);
+        std::string out;
+        out.resize(deflateBound(&zs,
+            static_cast<uLong>(in.size())) + 100);
+        zs.next_in = (Bytef*)in.data();
+        zs.avail_in = static_cast<uInt>(in.size());
+        zs.next_out = (Bytef*)&out[0];
+        zs.avail_out = static_cast<uInt>(out.size());
+        if(deflate(&zs, Z_FINISH) != Z_STREAM_END)
+            throw std::logic_error("deflate failed");
+        out.resize(zs.total_out);
+        deflateEnd(&zs);
+        return out;
+    }
+
+    // Compress with zlib and a preset dictionary, in
+    // the zlib format or as raw deflate.
+    static
+    std::string
+    compressDict(
+        string_view const& in,
+        string_view const& dict,
+        Wrap wrap)
+    {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        if(deflateInit2(&zs, 6, Z_DEFLATED,
+                wrap == Wrap::zlib ? 15 : -15,
+                8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw std::logic_error{"deflateInit2 failed"};
+        if(deflateSetDictionary(&zs, (Bytef const*)dict.data(),
+                static_cast<uInt>(dict.size())) != Z_OK)
+            throw std::logic_error{"deflateSetDictionary failed"};
+        std::string out;
+        out.resize(deflateBound(&zs,
+            static_cast<uLong>(in.size())) + 100);
+        zs.next_in = (Bytef*)in.data();
+        zs.avail_in = static_cast<uInt>(in.size());
+        zs.next_out = (Bytef*)&out[0];
+        zs.avail_out = static_cast<uInt>(out.size());
+        if(deflate(&zs, Z_FINISH) != Z_STREAM_END)
+            throw std::logic_error("deflate failed");
+        out.resize(zs.total_out);
+        deflateEnd(&zs);
+        return out;
+    }
+
+    // Decompress with `chunk` bytes of input and
+    // output at a time, until end of stream or error.
+    // The dictionary, if any, is set before the first
+    // write for raw deflate, or when asked for.
+    static
+    std::string
+    inflateWrapped(
+        std::string const& in,
+        Wrap wrap,
+        int windowBits,
+        std::size_t chunk,
+        error_code& ec,
+        std::string const* dict = nullptr)
+    {
+        inflate_stream is;
+        is.reset(windowBits, wrap);
+        if(dict && wrap == Wrap::none)
+        {
+            is.dictionary(dict->data(), dict->size(), ec);
+            if(ec)
+                return {};
+        }
+        std::string out;
+        z_params zs;
+        zs.next_in = in.data();
+        zs.avail_in = 0;
+        for(;;)
+        {
+            auto const used = static_cast<std::size_t>(
+                static_cast<char const*>(zs.next_in) - in.data());
+            zs.avail_in = (std::min)(chunk, in.size() - used);
+            out.resize(zs.total_out + chunk);
+            zs.next_out = &out[zs.total_out];
+            zs.avail_out = chunk;
+            ec = {};
+            is.write(zs, Flush::none, ec);
+            if(ec == error::need_dict && dict)
+            {
+                ec = {};
+                is.dictionary(dict->data(), dict->size(), ec);
+                if(ec)
+                    break;
+                continue;
+            }
+            if(ec && ec != error::need_buffers)
+                break;
+            if(ec && used == in.size())
+                break;
+        }
+        out.resize(zs.total_out);
+        return out;
+    }
+
+    void
+    testWrap()
+    {
+        auto const check = corpus1(50000);
+        for(auto wrap : {Wrap::zlib, Wrap::gzip})
+        {
+            auto const in = compressWrapped(check, wrap);
+            for(std::size_t chunk : {
+                std::size_t{1}, std::size_t{7},
+                std::size_t{4096}, in.size() + check.size()})
+            {
+                error_code ec;
+                auto const out =
+                    inflateWrapped(in, wrap, 15, chunk, ec);
+                BEAST_EXPECTS(ec == error::end_of_stream, ec.message());
+                BEAST_EXPECT(out == check);
+            }
+
+            // Corrupt the check value
+            auto bad = in;
+            bad[bad.size() - (wrap == Wrap::gzip ? 5 : 1)] ^= 1;
+            error_code ec;
+            inflateWrapped(bad, wrap, 15, 4096, ec);
+            BEAST_EXPECTS(
+                ec == error::incorrect_data_check, ec.message());
+
+            // Corrupt the header
+            bad = in;
+            bad[0] ^= 1;
+            inflateWrapped(bad, wrap, 15, 4096, ec);
+            BEAST_EXPECTS(
+                ec == error::incorrect_header_check, ec.message());
+
+            // Wrong format
+            inflateWrapped(in, wrap == Wrap::zlib ?
+                Wrap::gzip : Wrap::zlib, 15, 4096, ec);
+            BEAST_EXPECT(ec && ec != error::end_of_stream);
+        }
+        {
+            auto const in = compressWrapped(check, Wrap::zlib);
+            error_code ec;
+            inflateWrapped(in, Wrap::zlib, 9, 4096, ec);
+            BEAST_EXPECTS(
+                ec == error::invalid_window_size, ec.message());
+        }
+        {
+            auto bad = compressWrapped(check, Wrap::gzip);
+            bad[bad.size() - 1] ^= 1;
+            error_code ec;
+            inflateWrapped(bad, Wrap::gzip, 15, 4096, ec);
+            BEAST_EXPECTS(
+                ec == error::incorrect_length_check, ec.message());
+            bad[3] = 0x20;
+            inflateWrapped(bad, Wrap::gzip, 15, 4096, ec);
+            BEAST_EXPECTS(
+                ec == error::unknown_header_flags, ec.message());
+        }
+        {
+            // Optional gzip header fields
+            std::string extra(300, 'x');
+            char name[] = "name.txt";
+            char comment[] = "comment";
+            gz_header head;
+            memset(&head, 0, sizeof(head));
+            head.text = 1;
+            head.time = 1234567890;
+            head.os = 3;
+            head.extra = (Bytef*)&extra[0];
+            head.extra_len = static_cast<uInt>(extra.size());
+            head.name = (Bytef*)name;
+            head.comment = (Bytef*)comment;
+            head.hcrc = 1;
+            auto const in =
+                compressWrapped(check, Wrap::gzip, &head);
+            for(std::size_t chunk : {
+                std::size_t{1}, std::size_t{5}, std::size_t{4096}})
+            {
+                error_code ec;
+                auto const out = inflateWrapped(
+                    in, Wrap::gzip, 15, chunk, ec);
+                BEAST_EXPECTS(ec == error::end_of_stream, ec.message());
+                BEAST_EXPECT(out == check);
+            }
+            auto bad = in;
+            auto const pos = bad.find("name.txt");
+            BEAST_EXPECT(pos != std::string::npos);
+            bad[pos] = 'N';
+            error_code ec;
+            inflateWrapped(bad, Wrap::gzip, 15, 4096, ec);
+            BEAST_EXPECTS(
+                ec == error::incorrect_header_crc, ec.message());
+        }
+    }
+
+    void
+    testDictionary()
+    {
+        auto const check = corpus1(50000);
+        auto const dict = check.substr(0, 30000);
+        auto const other = corpus2(30000);
+        for(auto wrap : {Wrap::none, Wrap::zlib})
+        {
+            auto const in = compressDict(check, dict, wrap);
+            for(std::size_t chunk : {
+                std::size_t{1}, std::size_t{7}, std::size_t{4096},
+                in.size() + check.size()})
+            {
+                error_code ec;
+                auto const out = inflateWrapped(
+                    in, wrap, 15, chunk, ec, &dict);
+                BEAST_EXPECTS(ec == error::end_of_stream, ec.message());
+                BEAST_EXPECT(out == check);
+            }
+        }
+        {
+            // The header names the dictionary
+            auto const in = compressDict(check, dict, Wrap::zlib);
+            error_code ec;
+            inflateWrapped(in, Wrap::zlib, 15, 4096, ec);
+            BEAST_EXPECTS(ec == error::need_dict, ec.message());
+            inflateWrapped(in, Wrap::zlib, 15, 4096, ec, &other);
+            BEAST_EXPECTS(
+                ec == error::incorrect_data_check, ec.message());
+        }
+        {
+            // Only raw deflate takes a dictionary up front
+            error_code ec;
+            inflate_stream is;
+            is.reset(15, Wrap::zlib);
+            is.dictionary(dict.data(), dict.size(), ec);
+            BEAST_EXPECT(ec == error::stream_error);
+            ec = {};
+            is.reset(15, Wrap::gzip);
+            is.dictionary(dict.data(), dict.size(), ec);
+            BEAST_EXPECT(ec == error::stream_error);
+        }
+    }
+
+    void
+    testClear()
+    {
+        auto const inflate_once =
+            [&](inflate_stream& is)
+            {
+                std::string out(5, 0);
+                std::initializer_list<std::uint8_t> in = {
+                    0xf2, 0x48, 0xcd, 0xc9, 0xc9, 0x07, 0x00, 0x00,
+                    0x00, 0xff, 0xff};
+                z_params zs;
+                zs.next_in = &*in.begin();
+                zs.avail_in = in.size();
+                zs.next_out = &out[0];
+                zs.avail_out = out.size();
+                error_code ec;
+                is.write(zs, Flush::sync, ec);
+                BEAST_EXPECTS(! ec, ec.message());
+                return out;
+            };
+        inflate_stream is;
+        is.reset(9);
+        BEAST_EXPECT(is.allocated_size() == 0);
+        BEAST_EXPECT(inflate_once(is) == "Hello");
+        BEAST_EXPECT(is.allocated_size() == 512);
+        is.clear();
+        BEAST_EXPECT(is.allocated_size() == 0);
+        BEAST_EXPECT(inflate_once(is) == "Hello");
+        BEAST_EXPECT(is.allocated_size() == 512);
+    }
+
     void
     run() override
     {
@@ -650,6 +985,10 @@ public:
         testFixedHuffmanFlushTrees(beast_decompressor);
         testUncompressedFlushTrees(zlib_decompressor);
         testUncompressedFlushTrees(beast_decompressor);
+        testFastMatches();
+        testWrap();
+        testDictionary();
+        testClear();
     }
 };
 
@@ -0,0 +1,317 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+// Test that header file is self-contained.
+#include <boost/beast/zlib/parallel_deflate_stream.hpp>
+
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+
+#include "zlib-1.2.11/zlib.h"
+
+namespace boost {
+namespace beast {
+namespace zlib {
+
+class parallel_deflate_stream_test : public beast::unit_test::suite
+{
+public:
+    static
+    std::string
+    corpus(std::size_t n)
+    {
+        static std::string const alphabet{
+            "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+        };
+        std::string s;
+        s.reserve(n + 5);
+        std::mt19937 g;
+        std::uniform_int_distribution<std::size_t> d0{
+            0, alphabet.size() - 1};
+        std::uniform_int_distribution<std::size_t> d1{
+            1, 5};
+        while(s.size() < n)
+        {
+            auto const rep = d1(g);
+            auto const ch = alphabet[d0(g)];
+            s.insert(s.end(), rep, ch);
+        }
+        s.resize(n);
+        return s;
+    }
+
+    // Decompress with zlib, setting ok on success
+    static
+    std::string
+    decompress(std::string const& in, Wrap wrap, bool& ok)
+    {
+        z_stream zs;
+        std::memset(&zs, 0, sizeof(zs));
+        ok = inflateInit2(&zs,
+            wrap == Wrap::none ? -15 :
+            wrap == Wrap::zlib ? 15 : 15 + 16) == Z_OK;
+        std::string out;
+        if(! ok)
+            return out;
+        zs.next_in = (Bytef*)in.data();
+        zs.avail_in = static_cast<uInt>(in.size());
+        int result;
+        do
+        {
+            out.resize(zs.total_out + 65536);
+            zs.next_out = (Bytef*)&out[zs.total_out];
+            zs.avail_out = static_cast<uInt>(
+                out.size() - zs.total_out);
+            result = inflate(&zs, Z_NO_FLUSH);
+        }
+        while(result == Z_OK);
+        ok = result == Z_STREAM_END && zs.avail_in == 0;
+        out.resize(zs.total_out);
+        inflateEnd(&zs);
+        return out;
+    }
+
+    // Compress in pieces of the given sizes, then check the
+    // result with zlib.
+    void
+    doWrite(
+        parallel_deflate_stream& ds,
+        Wrap wrap,
+        std::string const& in,
+        std::size_t in_chunk,
+        std::size_t out_chunk,
+        Flush mid_flush = Flush::none)
+    {
+        ds.reset(6, Strategy::normal, wrap);
+        std::string out;
+        z_params zs;
+        zs.next_in = in.data();
+        zs.avail_in = 0;
+        for(;;)
+        {
+            auto const used = static_cast<std::size_t>(
+                static_cast<char const*>(zs.next_in) - in.data());
+            zs.avail_in = (std::min)(in.size() - used, in_chunk);
+            out.resize(zs.total_out + out_chunk);
+            zs.next_out = &out[zs.total_out];
+            zs.avail_out = out_chunk;
+            error_code ec;
+            ds.write(zs, used + zs.avail_in == in.size() ?
+                Flush::finish : mid_flush, ec);
+            if(ec == error::end_of_stream)
+                break;
+            if(! BEAST_EXPECTS(! ec || ec == error::need_buffers,
+                    ec.message()))
+                return;
+        }
+        out.resize(zs.total_out);
+        BEAST_EXPECT(zs.total_in == in.size());
+        bool ok;
+        auto const result = decompress(out, wrap, ok);
+        BEAST_EXPECT(ok);
+        BEAST_EXPECT(result == in);
+    }
+
+    void
+    testWrite()
+    {
+        net::thread_pool pool(4);
+        parallel_deflate_stream ds(pool.get_executor(), 3);
+        BEAST_EXPECT(ds.max_jobs() == 3);
+        ds.block_size(4096);
+        BEAST_EXPECT(ds.block_size() == 4096);
+        auto const in = corpus(100000);
+        for(auto wrap : {Wrap::none, Wrap::zlib, Wrap::gzip})
+        {
+            doWrite(ds, wrap, {}, 1, 64);
+            doWrite(ds, wrap, in, in.size(), 1 << 20);
+            doWrite(ds, wrap, in, 1000, 37);
+            doWrite(ds, wrap, in, 5000, 1000, Flush::sync);
+        }
+        ds.block_size(100);
+        doWrite(ds, Wrap::gzip, in, 777, 333);
+    }
+
+    void
+    testDictionary()
+    {
+        // Matches reach back into the block before
+        std::string const s = corpus(2000);
+        std::string in;
+        for(int i = 0; i < 64; ++i)
+            in.append(s);
+        net::thread_pool pool(2);
+        parallel_deflate_stream ds(pool.get_executor());
+        ds.block_size(4096);
+        ds.reset(6, Strategy::normal, Wrap::zlib);
+        std::string out(in.size(), 0);
+        z_params zs;
+        zs.next_in = in.data();
+        zs.avail_in = in.size();
+        zs.next_out = &out[0];
+        zs.avail_out = out.size();
+        error_code ec;
+        ds.write(zs, Flush::finish, ec);
+        BEAST_EXPECTS(ec == error::end_of_stream, ec.message());
+        out.resize(zs.total_out);
+        BEAST_EXPECT(out.size() < 2 * s.size());
+        bool ok;
+        BEAST_EXPECT(decompress(out, Wrap::zlib, ok) == in);
+        BEAST_EXPECT(ok);
+
+        // No more input after finishing
+        zs.next_in = in.data();
+        zs.avail_in = 1;
+        ds.write(zs, Flush::none, ec);
+        BEAST_EXPECT(ec == error::stream_error);
+    }
+
+    // Compress all of the input in one call
+    static
+    std::string
+    compress(parallel_deflate_stream& ds, std::string const& in)
+    {
+        std::string out(in.size() + 1024, 0);
+        z_params zs;
+        zs.next_in = in.data();
+        zs.avail_in = in.size();
+        zs.next_out = &out[0];
+        zs.avail_out = out.size();
+        error_code ec;
+        ds.write(zs, Flush::finish, ec);
+        out.resize(zs.total_out);
+        return out;
+    }
+
+    void
+    testBlockSize()
+    {
+        // The size is latched when the stream is reset
+        net::thread_pool pool(2);
+        auto const in = corpus(50000);
+        parallel_deflate_stream ds1(pool.get_executor());
+        parallel_deflate_stream ds2(pool.get_executor());
+        ds1.block_size(4096);
+        ds1.reset();
+        ds2.block_size(4096);
+        ds2.reset();
+        ds2.block_size(1000);
+        BEAST_EXPECT(ds2.block_size() == 1000);
+        auto const out = compress(ds1, in);
+        BEAST_EXPECT(compress(ds2, in) == out);
+        ds1.block_size(1000);
+        ds1.reset();
+        BEAST_EXPECT(compress(ds1, in) != out);
+    }
+
+    void
+    testRunningInThisThread()
+    {
+        // A synchronous write from the only thread which
+        // runs the executor compresses the blocks itself
+        auto const in = corpus(100000);
+        {
+            net::io_context ioc;
+            parallel_deflate_stream ds(ioc.get_executor(), 4);
+            ds.block_size(4096);
+            net::post(ioc,
+                [&]
+                {
+                    doWrite(ds, Wrap::gzip, in, 1000, 700);
+                });
+            ioc.run();
+        }
+        {
+            net::thread_pool pool(1);
+            parallel_deflate_stream ds(pool.get_executor(), 4);
+            ds.block_size(4096);
+            net::post(pool,
+                [&]
+                {
+                    doWrite(ds, Wrap::zlib, in, in.size(), 1 << 20);
+                });
+            pool.join();
+        }
+    }
+
+    void
+    testAsyncWrite()
+    {
+        net::thread_pool pool(4);
+        net::io_context ioc;
+        parallel_deflate_stream ds(pool.get_executor(), 2);
+        ds.block_size(8192);
+        ds.reset(6, Strategy::normal, Wrap::gzip);
+        auto const in = corpus(200000);
+        std::string out;
+        z_params zs;
+        zs.next_in = in.data();
+        zs.avail_in = 0;
+        bool done = false;
+        auto work = net::make_work_guard(ioc);
+        std::function<void(error_code)> next;
+        auto const start =
+            [&]
+            {
+                auto const used = static_cast<std::size_t>(
+                    static_cast<char const*>(zs.next_in) - in.data());
+                zs.avail_in = (std::min)(
+                    in.size() - used, std::size_t{3000});
+                out.resize(zs.total_out + 512);
+                zs.next_out = &out[zs.total_out];
+                zs.avail_out = 512;
+                ds.async_write(zs,
+                    used + zs.avail_in == in.size() ?
+                        Flush::finish : Flush::none,
+                    net::bind_executor(ioc, next));
+            };
+        next =
+            [&](error_code ec)
+            {
+                if(ec == error::end_of_stream)
+                    done = true;
+                else if(BEAST_EXPECTS(! ec ||
+                        ec == error::need_buffers, ec.message()))
+                    return start();
+                work.reset();
+            };
+        start();
+        ioc.run();
+        BEAST_EXPECT(done);
+        out.resize(zs.total_out);
+        bool ok;
+        BEAST_EXPECT(decompress(out, Wrap::gzip, ok) == in);
+        BEAST_EXPECT(ok);
+    }
+
+    void
+    run() override
+    {
+        testWrite();
+        testDictionary();
+        testBlockSize();
+        testRunningInThisThread();
+        testAsyncWrite();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,zlib,parallel_deflate_stream);
+
+} // zlib
+} // beast
+} // boost
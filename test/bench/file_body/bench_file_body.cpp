@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/http/async_file_body.hpp>
+#include <boost/beast/http/basic_file_body.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/beast/_experimental/test/stream.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class file_body_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // A file which simulates a slow disk: each read
+    // costs a fixed latency plus time proportional to
+    // the number of bytes read.
+    class throttled_file : public file
+    {
+    public:
+        std::size_t
+        read(void* buffer, std::size_t n, error_code& ec)
+        {
+            std::this_thread::sleep_for(
+                std::chrono::microseconds(50 + n / 200));
+            return file::read(buffer, n, ec);
+        }
+    };
+
+    static std::size_t constexpr file_size = 1024 * 1024;
+    static std::size_t constexpr connections = 8;
+
+    std::string path_;
+
+    struct result
+    {
+        clock_type::duration elapsed;
+        clock_type::duration max_stall;
+    };
+
+    // Serve the file to several connections on one thread,
+    // while a timer measures how late the reactor runs it.
+    template<class Body, class Init>
+    result
+    serve(Init const& init)
+    {
+        net::io_context ioc;
+        std::vector<std::unique_ptr<test::stream>> streams;
+        std::vector<std::unique_ptr<response<Body>>> messages;
+        std::size_t remain = connections;
+        for(std::size_t i = 0; i < connections; ++i)
+        {
+            streams.emplace_back(new test::stream(ioc));
+            streams.emplace_back(new test::stream(ioc));
+            streams[2 * i]->connect(*streams[2 * i + 1]);
+            messages.emplace_back(new response<Body>(status::ok, 11));
+            error_code ec;
+            messages.back()->body().open(
+                path_.c_str(), file_mode::read, ec);
+            BEAST_EXPECTS(! ec, ec.message());
+            init(messages.back()->body());
+            messages.back()->prepare_payload();
+        }
+
+        auto const start = clock_type::now();
+        clock_type::duration max_stall{};
+        net::steady_timer timer(ioc);
+        auto expected = clock_type::now();
+        std::function<void(error_code)> tick =
+            [&](error_code)
+            {
+                auto const now = clock_type::now();
+                if(now - expected > max_stall)
+                    max_stall = now - expected;
+                if(remain == 0)
+                    return;
+                expected = now + std::chrono::milliseconds(1);
+                timer.expires_at(expected);
+                timer.async_wait(tick);
+            };
+        tick({});
+
+        for(std::size_t i = 0; i < connections; ++i)
+            async_write(*streams[2 * i], *messages[i],
+                [&](error_code ec, std::size_t)
+                {
+                    BEAST_EXPECTS(! ec, ec.message());
+                    --remain;
+                });
+        ioc.run();
+        for(std::size_t i = 0; i < connections; ++i)
+            BEAST_EXPECT(streams[2 * i + 1]->str().size() >
+                file_size);
+        return {clock_type::now() - start, max_stall};
+    }
+
+    void
+    report(char const* name, result const& r)
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::milliseconds;
+        log <<
+            name << ": " <<
+            duration_cast<milliseconds>(r.elapsed).count() <<
+            "ms total, reactor stalled up to " <<
+            duration_cast<milliseconds>(r.max_stall).count() <<
+            "ms" << std::endl;
+    }
+
+    void
+    run() override
+    {
+        path_ = boost::filesystem::unique_path().string();
+        {
+            error_code ec;
+            file f;
+            f.open(path_.c_str(), file_mode::write, ec);
+            std::string const s(file_size, 'x');
+            f.write(s.data(), s.size(), ec);
+            BEAST_EXPECTS(! ec, ec.message());
+        }
+
+        net::thread_pool pool(4);
+        for(int i = 0; i < 3; ++i)
+        {
+            report("basic_file_body",
+                serve<basic_file_body<throttled_file>>(
+                    [](basic_file_body<throttled_file>::value_type&)
+                    {
+                    }));
+            report("async_file_body",
+                serve<basic_async_file_body<throttled_file>>(
+                    [&](basic_async_file_body<
+                        throttled_file>::value_type& body)
+                    {
+                        body.set_executor(pool.get_executor());
+                    }));
+        }
+        pool.join();
+
+        error_code ec;
+        boost::filesystem::remove(path_, ec);
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,file_body);
+
+} // http
+} // beast
+} // boost
@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/websocket/detail/mask.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <chrono>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+class mask_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    static std::size_t constexpr Bytes = 256 * 1024 * 1024;
+
+    // The loop which masked one byte at a time
+    static
+    void
+    mask_bytewise(
+        net::mutable_buffer const& b,
+        detail::prepared_key& key)
+    {
+        auto n = b.size();
+        auto const mask = key;
+        auto p = static_cast<unsigned char*>(b.data());
+        while(n >= 4)
+        {
+            for(int i = 0; i < 4; ++i)
+                p[i] ^= mask[i];
+            p += 4;
+            n -= 4;
+        }
+        if(n > 0)
+        {
+            for(std::size_t i = 0; i < n; ++i)
+                p[i] ^= mask[i];
+            auto const v0 = key;
+            for(std::size_t i = 0; i < key.size(); ++i)
+                key[i] = v0[(i + n) % key.size()];
+        }
+    }
+
+    // Mask `Bytes` octets in frames of `size`,
+    // returning the throughput in GB/s.
+    template<class F>
+    double
+    measure(std::size_t size, F const& f)
+    {
+        std::vector<unsigned char> v(size + 1, 0x5a);
+        // Start at an odd address, as a frame payload in
+        // a read buffer usually does after the header.
+        net::mutable_buffer const b(v.data() + 1, size);
+        detail::prepared_key key;
+        detail::prepare_key(key, 0x12345678);
+        auto const count = Bytes / size;
+        auto const when = clock_type::now();
+        for(std::size_t i = 0; i < count; ++i)
+            f(b, key);
+        std::chrono::duration<double> const elapsed =
+            clock_type::now() - when;
+        return static_cast<double>(count * size) /
+            elapsed.count() / 1e9;
+    }
+
+    void
+    bench(std::size_t size)
+    {
+        auto const gbs = [](double d)
+        {
+            return std::to_string(d).substr(0, 5) + " GB/s";
+        };
+        log << size << " byte frames" << std::endl;
+        log << "  bytewise: " << gbs(measure(size,
+            &mask_bytewise)) << std::endl;
+        auto const masked = [](
+            net::mutable_buffer const& b,
+            detail::prepared_key& key)
+        {
+            detail::mask_inplace(b, key);
+        };
+#if ! BOOST_BEAST_NO_INTRINSICS
+        auto& ci = beast::detail::get_mutable_cpu_info();
+        auto const saved = ci;
+        if(ci.avx2)
+            log << "  avx2:     " << gbs(measure(size,
+                masked)) << std::endl;
+        ci.avx2 = false;
+        if(ci.sse2)
+            log << "  sse2:     " << gbs(measure(size,
+                masked)) << std::endl;
+        ci.sse2 = false;
+        log << "  word:     " << gbs(measure(size,
+            masked)) << std::endl;
+        ci = saved;
+#else
+        log << "  word:     " << gbs(measure(size,
+            masked)) << std::endl;
+#endif
+    }
+
+    void
+    run() override
+    {
+        bench(64);
+        bench(1024);
+        bench(64 * 1024);
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,mask);
+
+} // websocket
+} // beast
+} // boost
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/http/field.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <chrono>
+#include <map>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace http {
+
+class field_lookup_test : public beast::unit_test::suite
+{
+public:
+    static std::size_t constexpr Trials = 5;
+    static std::size_t constexpr Repeat = 200000;
+
+    // Header names in the proportions seen on a typical
+    // browser-and-API ingress, spelled as clients send them,
+    // plus a share of extension headers that are not known.
+    std::vector<string_view>
+    header_mix()
+    {
+        return {
+            "Host", "User-Agent", "Accept", "Accept-Encoding",
+            "Accept-Language", "Connection", "Cookie", "Referer",
+            "Cache-Control", "Upgrade-Insecure-Requests",
+            "Sec-Fetch-Site", "Sec-Fetch-Mode", "Sec-Fetch-Dest",
+            "If-None-Match", "If-Modified-Since", "Authorization",
+            "Content-Type", "Content-Length", "Origin", "Pragma",
+            "X-Forwarded-For", "X-Forwarded-Proto", "X-Request-Id",
+            "X-Real-IP", "Transfer-Encoding", "Date", "Server",
+            "ETag", "Last-Modified", "Expires", "Vary", "Set-Cookie",
+            "Strict-Transport-Security", "Access-Control-Allow-Origin",
+            "content-type", "content-length", "accept-encoding",
+            "x-amzn-trace-id", "cf-connecting-ip", "traceparent"};
+    }
+
+    std::vector<string_view>
+    method_mix()
+    {
+        return {
+            "GET", "GET", "GET", "GET", "GET", "GET", "GET", "GET",
+            "POST", "POST", "PUT", "HEAD", "OPTIONS", "DELETE",
+            "PATCH", "PROPFIND", "M-SEARCH", "BREW"};
+    }
+
+    template<class Function>
+    void
+    timedTest(std::string const& name, Function&& f)
+    {
+        using namespace std::chrono;
+        using clock_type = std::chrono::high_resolution_clock;
+        log << name << std::endl;
+        for(std::size_t trial = 1; trial <= Trials; ++trial)
+        {
+            auto const t0 = clock_type::now();
+            auto const n = f();
+            auto const elapsed = clock_type::now() - t0;
+            log <<
+                "Trial " << trial << ": " <<
+                duration_cast<milliseconds>(elapsed).count() << " ms" <<
+                " (" << n << ")" << std::endl;
+        }
+    }
+
+    void
+    testSpeed()
+    {
+        auto const names = header_mix();
+        auto const methods = method_mix();
+
+        // Ordered case-insensitive map, the same
+        // lookup basic_fields does for its set.
+        std::map<string_view, field, iless> m;
+        for(unsigned i = 1; i < 353; ++i)
+        {
+            auto const f = static_cast<field>(i);
+            m.emplace(to_string(f), f);
+        }
+
+        testcase << "Lookup speed test, " <<
+            Repeat * names.size() << " names, " <<
+            Repeat * methods.size() << " methods";
+
+        timedTest("string_to_field",
+            [&]
+            {
+                std::size_t n = 0;
+                for(std::size_t i = 0; i < Repeat; ++i)
+                    for(auto s : names)
+                        n += string_to_field(s) != field::unknown;
+                return n;
+            });
+        timedTest("std::map<iless>",
+            [&]
+            {
+                std::size_t n = 0;
+                for(std::size_t i = 0; i < Repeat; ++i)
+                    for(auto s : names)
+                        n += m.find(s) != m.end();
+                return n;
+            });
+        timedTest("string_to_verb",
+            [&]
+            {
+                std::size_t n = 0;
+                for(std::size_t i = 0; i < Repeat; ++i)
+                    for(auto s : methods)
+                        n += string_to_verb(s) != verb::unknown;
+                return n;
+            });
+        pass();
+    }
+
+    void
+    run() override
+    {
+        testSpeed();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,field_lookup);
+
+} // http
+} // beast
+} // boost
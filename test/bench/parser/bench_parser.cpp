@@ -15,6 +15,7 @@
 #include <boost/beast/core/buffer_traits.hpp>
 #include <boost/beast/core/buffers_suffix.hpp>
 #include <boost/beast/core/buffers_to_string.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
 #include <boost/beast/core/ostream.hpp>
 #include <boost/beast/core/flat_buffer.hpp>
 #include <boost/beast/core/multi_buffer.hpp>
@@ -129,6 +130,23 @@ public:
             }
     }
 
+    // Parse only the header of each message
+    template<class Parser>
+    void
+    testHeader(std::size_t repeat, corpus const& v)
+    {
+        while(repeat--)
+            for(auto const& b : v)
+            {
+                Parser p;
+                p.header_limit((std::numeric_limits<std::uint32_t>::max)());
+                error_code ec;
+                p.put(b.data(), ec);
+                if(! BEAST_EXPECTS(p.is_header_done(), ec.message()))
+                    log << buffers_to_string(b.data()) << std::endl;
+            }
+    }
+
     template<class Function>
     void
     timedTest(std::size_t repeat, std::string const& name, Function&& f)
@@ -277,6 +295,75 @@ public:
         }
     };
 
+    // Stores the fields in a Fields container, to measure
+    // the cost of building and querying the container.
+    template<bool isRequest, class Fields>
+    struct fields_parser : basic_parser<isRequest>
+    {
+        Fields h;
+        std::size_t found = 0;
+
+        void
+        on_request_impl(verb, string_view,
+            string_view, int, error_code&) override
+        {
+        }
+
+        void
+        on_response_impl(int,
+            string_view, int, error_code&) override
+        {
+        }
+
+        void
+        on_field_impl(field name, string_view name_string,
+            string_view value, error_code&) override
+        {
+            h.insert(name, name_string, value);
+        }
+
+        void
+        on_header_impl(error_code& ec) override
+        {
+            if(h.count(field::content_length) > 1)
+                ec = error::bad_content_length;
+            found += h.count(field::host) +
+                h.count(field::user_agent);
+        }
+
+        void
+        on_body_init_impl(
+            boost::optional<std::uint64_t> const&,
+            error_code&) override
+        {
+        }
+
+        std::size_t
+        on_body_impl(
+            string_view s, error_code&) override
+        {
+            return s.size();
+        }
+
+        void
+        on_chunk_header_impl(std::uint64_t,
+            string_view, error_code&) override
+        {
+        }
+
+        std::size_t
+        on_chunk_body_impl(std::uint64_t,
+            string_view s, error_code&) override
+        {
+            return s.size();
+        }
+
+        void
+        on_finish_impl(error_code&) override
+        {
+        }
+    };
+
     void
     testSpeed()
     {
@@ -305,8 +392,7 @@ public:
             });
 #endif
 #if 1
-        timedTest(Trials, "http::basic_parser",
-            [&]
+        auto const basic = [&]
             {
                 testParser2<bench_parser<
                     true, dynamic_body, fields> >(
@@ -314,6 +400,49 @@ public:
                 testParser2<bench_parser<
                     false, dynamic_body, fields>>(
                         Repeat, cres_);
+            };
+#if ! BOOST_BEAST_NO_INTRINSICS
+        // Run once for each scanning path the CPU supports,
+        // narrowest last, so the gain of each width is visible.
+        auto& ci = beast::detail::get_mutable_cpu_info();
+        auto const saved = ci;
+        if(ci.avx512bw)
+            timedTest(Trials, "http::basic_parser (avx512bw)", basic);
+        ci.avx512bw = false;
+        if(ci.avx2)
+            timedTest(Trials, "http::basic_parser (avx2)", basic);
+        ci.avx2 = false;
+        if(ci.sse42)
+            timedTest(Trials, "http::basic_parser (sse4.2)", basic);
+        ci.sse42 = false;
+        timedTest(Trials, "http::basic_parser (scalar)", basic);
+        ci = saved;
+#else
+        timedTest(Trials, "http::basic_parser", basic);
+#endif
+        timedTest(Trials, "http::parser (header only)",
+            [&]
+            {
+                testHeader<request_parser<buffer_body>>(Repeat, creq_);
+                testHeader<response_parser<buffer_body>>(Repeat, cres_);
+            });
+        timedTest(Trials, "http::header_parser (header only)",
+            [&]
+            {
+                testHeader<request_header_parser>(Repeat, creq_);
+                testHeader<response_header_parser>(Repeat, cres_);
+            });
+        timedTest(Trials, "http::fields (header only)",
+            [&]
+            {
+                testHeader<fields_parser<true, fields>>(Repeat, creq_);
+                testHeader<fields_parser<false, fields>>(Repeat, cres_);
+            });
+        timedTest(Trials, "http::flat_fields (header only)",
+            [&]
+            {
+                testHeader<fields_parser<true, flat_fields>>(Repeat, creq_);
+                testHeader<fields_parser<false, flat_fields>>(Repeat, cres_);
             });
 #if 1
         timedTest(Trials, "nodejs_parser",
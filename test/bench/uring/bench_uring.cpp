@@ -0,0 +1,195 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/_experimental/core/uring_stream.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/beast/core/flat_static_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace boost {
+namespace beast {
+
+class uring_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+    using tcp = net::ip::tcp;
+
+    static std::size_t constexpr connections = 64;
+    static std::size_t constexpr round_trips = 1000;
+
+    // One side of a connection which echoes
+    // every message back to the other side.
+    template<class Stream>
+    class peer : public std::enable_shared_from_this<peer<Stream>>
+    {
+        Stream s_;
+        flat_static_buffer<4096> b_;
+        std::size_t size_;
+        std::size_t remain_;
+
+    public:
+        peer(net::io_context& ioc,
+            std::size_t size, std::size_t remain)
+            : s_(ioc)
+            , size_(size)
+            , remain_(remain)
+        {
+        }
+
+        Stream&
+        stream()
+        {
+            return s_;
+        }
+
+        void
+        register_buffer()
+        {
+            register_buffer(s_);
+        }
+
+        void
+        send()
+        {
+            auto self = this->shared_from_this();
+            b_.consume(b_.size());
+            auto const mb = b_.prepare(size_);
+            net::async_write(s_, mb,
+                [self](error_code ec, std::size_t)
+                {
+                    if(! ec)
+                        self->receive();
+                });
+        }
+
+        void
+        receive()
+        {
+            if(remain_-- == 0)
+                return;
+            auto self = this->shared_from_this();
+            net::async_read(s_, b_.prepare(size_),
+                [self](error_code ec, std::size_t)
+                {
+                    if(! ec)
+                        self->send();
+                });
+        }
+
+    private:
+#if BOOST_BEAST_USE_IO_URING
+        void
+        register_buffer(uring_stream& s)
+        {
+            error_code ec;
+            s.register_buffer(b_.prepare(b_.max_size()), ec);
+        }
+#endif
+
+        template<class Other>
+        void
+        register_buffer(Other&)
+        {
+        }
+    };
+
+    template<class Stream>
+    clock_type::duration
+    ping_pong(std::size_t size, bool registered)
+    {
+        net::io_context ioc;
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        std::vector<std::shared_ptr<peer<Stream>>> v;
+        std::size_t const remain = round_trips;
+        for(std::size_t i = 0; i < connections; ++i)
+        {
+            auto p1 = std::make_shared<peer<Stream>>(
+                ioc, size, remain);
+            auto p2 = std::make_shared<peer<Stream>>(
+                ioc, size, remain);
+            p1->stream().socket().connect(a.local_endpoint());
+            a.accept(p2->stream().socket());
+            p1->stream().socket().set_option(tcp::no_delay(true));
+            p2->stream().socket().set_option(tcp::no_delay(true));
+            if(registered)
+            {
+                p1->register_buffer();
+                p2->register_buffer();
+            }
+            v.push_back(p1);
+            v.push_back(p2);
+        }
+        auto const start = clock_type::now();
+        for(std::size_t i = 0; i < connections; ++i)
+        {
+            v[2 * i]->send();
+            v[2 * i + 1]->receive();
+        }
+        ioc.run();
+        return clock_type::now() - start;
+    }
+
+    void
+    report(char const* name, std::size_t size,
+        clock_type::duration elapsed)
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        auto const us = duration_cast<microseconds>(elapsed).count();
+        auto const n = 2 * connections * round_trips;
+        log <<
+            name << " (" << size << " bytes): " <<
+            us / 1000 << "ms, " <<
+            (us > 0 ? n * 1000000 / us : 0) << " msgs/s" <<
+            std::endl;
+    }
+
+    void
+    run() override
+    {
+#if BOOST_BEAST_USE_IO_URING
+        {
+            net::io_context ioc;
+            uring_stream s(ioc);
+            if(! s.is_uring())
+                log << "io_uring is not available" << std::endl;
+        }
+#else
+        log << "io_uring is not supported" << std::endl;
+#endif
+        for(std::size_t size : {64, 4096})
+        {
+            for(int i = 0; i < 3; ++i)
+            {
+                report("tcp_stream", size,
+                    ping_pong<tcp_stream>(size, false));
+#if BOOST_BEAST_USE_IO_URING
+                report("uring_stream", size,
+                    ping_pong<uring_stream>(size, false));
+                report("uring_stream, registered", size,
+                    ping_pong<uring_stream>(size, true));
+#endif
+            }
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,uring);
+
+} // beast
+} // boost
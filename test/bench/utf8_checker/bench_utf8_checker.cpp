@@ -8,6 +8,7 @@
 //
 
 #include <boost/beast/websocket/detail/utf8_checker.hpp>
+#include <boost/beast/core/detail/cpu_info.hpp>
 #include <boost/beast/_experimental/unit_test/suite.hpp>
 #include <chrono>
 #include <random>
@@ -86,6 +87,46 @@ public:
         return s;
     }
 
+    // Append one code point, encoded with `n` bytes
+    static
+    void
+    append(std::string& s, std::uint32_t cp, int n)
+    {
+        if(n == 1)
+        {
+            s.push_back(static_cast<char>(cp));
+            return;
+        }
+        static unsigned char const lead[] = { 0, 0, 0xc0, 0xe0, 0xf0 };
+        s.push_back(static_cast<char>(lead[n] | (cp >> (6 * (n - 1)))));
+        for(int i = n - 2; i >= 0; --i)
+            s.push_back(static_cast<char>(0x80 | ((cp >> (6 * i)) & 0x3f)));
+    }
+
+    // Text like JSON in a mix of scripts: ASCII punctuation
+    // and keys, with string values drawn from `first` to
+    // `first + count` using `n` bytes per code point.
+    std::string
+    corpus(
+        std::size_t size,
+        std::uint32_t first,
+        std::uint32_t count,
+        int n)
+    {
+        std::string s;
+        s.reserve(size + 64);
+        while(s.size() < size)
+        {
+            s.append("{\"id\":");
+            s.append(std::to_string(rand(100000)));
+            s.append(",\"name\":\"");
+            for(auto i = 2 + rand(20); i > 0; --i)
+                append(s, first + rand<std::uint32_t>(count), n);
+            s.append("\"},");
+        }
+        return s;
+    }
+
     void
     checkBeast(std::string const& s)
     {
@@ -118,21 +159,60 @@ public:
         return t.elapsed();
     }
 
+    template<class F>
     void
-    run() override
+    bench(char const* what, std::string const& s, F const& f)
     {
-        auto const s = corpus(32 * 1024 * 1024);
-        for(int i = 0; i < 5; ++ i)
+        for(int i = 0; i < 3; ++ i)
         {
             auto const elapsed = test([&]{
-                checkBeast(s);
-                checkBeast(s);
-                checkBeast(s);
-                checkBeast(s);
-                checkBeast(s);
+                f(s);
+                f(s);
+                f(s);
+                f(s);
+                f(s);
             });
-            log << "beast:  " << throughput(elapsed, s.size()) << " char/s" << std::endl;
+            log << what << throughput(elapsed, s.size() * 5) <<
+                " char/s" << std::endl;
         }
+    }
+
+    void
+    benchBeast(std::string const& s)
+    {
+        auto const f = [&](std::string const& s)
+        {
+            checkBeast(s);
+        };
+#if ! BOOST_BEAST_NO_INTRINSICS
+        auto& ci = beast::detail::get_mutable_cpu_info();
+        auto const saved = ci;
+        if(ci.avx2)
+            bench("beast (avx2):   ", s, f);
+        ci.avx2 = false;
+        if(ci.sse42)
+            bench("beast (sse4.2): ", s, f);
+        ci.sse42 = false;
+        bench("beast (scalar): ", s, f);
+        ci = saved;
+#else
+        bench("beast:          ", s, f);
+#endif
+    }
+
+    void
+    run() override
+    {
+        std::size_t constexpr size = 32 * 1024 * 1024;
+        auto const s = corpus(size);
+        log << "ascii" << std::endl;
+        benchBeast(s);
+        log << "latin and greek (2 byte)" << std::endl;
+        benchBeast(corpus(size, 0xc0, 0x300, 2));
+        log << "cjk (3 byte)" << std::endl;
+        benchBeast(corpus(size, 0x4e00, 0x5000, 3));
+        log << "emoji (4 byte)" << std::endl;
+        benchBeast(corpus(size, 0x1f300, 0x300, 4));
     #if BEAST_USE_BOOST_LOCALE_BENCHMARK
         for(int i = 0; i < 5; ++ i)
         {
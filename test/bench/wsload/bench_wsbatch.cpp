@@ -0,0 +1,209 @@
+//
+// Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Official repository: https://github.com/boostorg/beast
+//
+
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/beast/_experimental/unit_test/suite.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace boost {
+namespace beast {
+namespace websocket {
+
+class wsbatch_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+    using tcp = net::ip::tcp;
+    using ws_type = stream<tcp::socket>;
+
+    static std::size_t constexpr messages = 200000;
+
+    // Small messages, from 50 to 200 bytes
+    std::vector<std::string> payloads_;
+
+    wsbatch_test()
+    {
+        std::mt19937 rng;
+        std::uniform_int_distribution<std::size_t> size(50, 200);
+        std::uniform_int_distribution<int> ch('a', 'z');
+        for(std::size_t i = 0; i < 1024; ++i)
+        {
+            std::string s(size(rng), ' ');
+            for(auto& c : s)
+                c = static_cast<char>(ch(rng));
+            payloads_.emplace_back(std::move(s));
+        }
+    }
+
+    // Sends every message, `batch` at a time, with
+    // one write per message or one write per batch.
+    class sender
+    {
+        ws_type& ws_;
+        std::vector<std::string> const& payloads_;
+        std::vector<net::const_buffer> v_;
+        std::size_t batch_;
+        std::size_t remain_ = messages;
+        bool gather_;
+
+    public:
+        sender(ws_type& ws,
+            std::vector<std::string> const& payloads,
+            std::size_t batch, bool gather)
+            : ws_(ws)
+            , payloads_(payloads)
+            , batch_(batch)
+            , gather_(gather)
+        {
+        }
+
+        void
+        run()
+        {
+            if(remain_ == 0)
+                return;
+            if(! gather_)
+            {
+                auto const& s =
+                    payloads_[remain_ % payloads_.size()];
+                --remain_;
+                ws_.async_write(net::buffer(s),
+                    [this](error_code ec, std::size_t)
+                    {
+                        if(! ec)
+                            run();
+                    });
+                return;
+            }
+            v_.clear();
+            for(auto n = batch_; n && remain_; --n, --remain_)
+                v_.push_back(net::buffer(
+                    payloads_[remain_ % payloads_.size()]));
+            ws_.async_write_batch(v_,
+                [this](error_code ec, std::size_t)
+                {
+                    if(! ec)
+                        run();
+                });
+        }
+    };
+
+    // Reads messages until all have arrived
+    class receiver
+    {
+        ws_type& ws_;
+        flat_buffer b_;
+        std::size_t remain_ = messages;
+
+    public:
+        explicit
+        receiver(ws_type& ws)
+            : ws_(ws)
+        {
+        }
+
+        void
+        run()
+        {
+            if(remain_-- == 0)
+                return;
+            b_.clear();
+            ws_.async_read(b_,
+                [this](error_code ec, std::size_t)
+                {
+                    if(! ec)
+                        run();
+                });
+        }
+    };
+
+    clock_type::duration
+    trial(bool from_client, std::size_t batch, bool gather)
+    {
+        net::io_context ioc;
+        tcp::acceptor a(ioc, tcp::endpoint(
+            net::ip::make_address_v4("127.0.0.1"), 0));
+        ws_type client(ioc);
+        ws_type server(ioc);
+        client.next_layer().connect(a.local_endpoint());
+        a.accept(server.next_layer());
+        client.next_layer().set_option(tcp::no_delay(true));
+        server.next_layer().set_option(tcp::no_delay(true));
+        server.async_accept(
+            [](error_code ec)
+            {
+                if(ec)
+                    BOOST_THROW_EXCEPTION(system_error{ec});
+            });
+        client.async_handshake("localhost", "/",
+            [](error_code ec)
+            {
+                if(ec)
+                    BOOST_THROW_EXCEPTION(system_error{ec});
+            });
+        ioc.run();
+        ioc.restart();
+
+        auto& from = from_client ? client : server;
+        auto& to = from_client ? server : client;
+        sender s(from, payloads_, batch, gather);
+        receiver r(to);
+        auto const start = clock_type::now();
+        s.run();
+        r.run();
+        ioc.run();
+        return clock_type::now() - start;
+    }
+
+    void
+    report(char const* name, std::size_t batch,
+        clock_type::duration elapsed)
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        auto const us = duration_cast<microseconds>(elapsed).count();
+        log <<
+            name << " (" << batch << " per write): " <<
+            us / 1000 << "ms, " <<
+            (us > 0 ? messages * 1000000 / us : 0) << " msgs/s" <<
+            std::endl;
+    }
+
+    void
+    run() override
+    {
+        for(bool from_client : {false, true})
+        {
+            log << (from_client ?
+                "client to server" : "server to client") << std::endl;
+            for(int i = 0; i < 3; ++i)
+            {
+                report("write", 1,
+                    trial(from_client, 1, false));
+                report("write_batch", 16,
+                    trial(from_client, 16, true));
+                report("write_batch", 64,
+                    trial(from_client, 64, true));
+            }
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(beast,benchmarks,wsbatch);
+
+} // websocket
+} // beast
+} // boost
@@ -118,6 +118,32 @@ public:
         return out;
     }
 
+    // The output is not identical to that of ZLib, since
+    // strings are hashed differently, so check that ZLib
+    // decompresses it instead.
+    std::string
+    doInflateZLib(string_view const& in, std::size_t size)
+    {
+        int result;
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        result = inflateInit2(&zs, -15);
+        if(result != Z_OK)
+            throw std::logic_error("inflateInit2 failed");
+        std::string out;
+        out.resize(size);
+        zs.next_in = (Bytef*)in.data();
+        zs.avail_in = static_cast<uInt>(in.size());
+        zs.next_out = (Bytef*)&out[0];
+        zs.avail_out = static_cast<uInt>(out.size());
+        result = inflate(&zs, Z_SYNC_FLUSH);
+        if(result != Z_OK && result != Z_BUF_ERROR)
+            throw std::logic_error("inflate failed");
+        out.resize(zs.total_out);
+        inflateEnd(&zs);
+        return out;
+    }
+
     void
     doCorpus(
         std::size_t size,
@@ -142,14 +168,17 @@ public:
                 test::throughput(t.elapsed(), size * repeat);
             log << std::right << std::setw(12) << t1 << " B/s ";
             std::string out2;
+            t = test::timer();
             for(std::size_t j = 0; j < repeat; ++j)
                 out2 = doDeflateZLib(c1);
-            BEAST_EXPECT(out1 == out2);
             auto const t2 =
                 test::throughput(t.elapsed(), size * repeat);
+            BEAST_EXPECT(doInflateZLib(out1, size) == c1);
             log << std::right << std::setw(12) << t2 << " B/s";
             log << std::right << std::setw(12) <<
-                unsigned(double(t1)*100/t2-100) << "%";
+                int(double(t1)*100/t2-100) << "%";
+            log << std::right << std::setw(12) << out1.size() <<
+                " / " << out2.size() << " bytes";
             log << std::endl;
         }
         for(std::size_t i = 0; i < trials; ++i)
@@ -163,14 +192,17 @@ public:
                 test::throughput(t.elapsed(), size * repeat);
             log << std::right << std::setw(12) << t1 << " B/s ";
             std::string out2;
+            t = test::timer();
             for(std::size_t j = 0; j < repeat; ++j)
                 out2 = doDeflateZLib(c2);
-            BEAST_EXPECT(out1 == out2);
             auto const t2 =
                 test::throughput(t.elapsed(), size * repeat);
+            BEAST_EXPECT(doInflateZLib(out1, size) == c2);
             log << std::right << std::setw(12) << t2 << " B/s";
             log << std::right << std::setw(12) <<
-                unsigned(double(t1)*100/t2-100) << "%";
+                int(double(t1)*100/t2-100) << "%";
+            log << std::right << std::setw(12) << out1.size() <<
+                " / " << out2.size() << " bytes";
             log << std::endl;
         }
         log << std::endl;
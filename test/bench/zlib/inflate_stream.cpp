@@ -187,6 +187,7 @@ public:
             auto const t1 =
                 test::throughput(t.elapsed(), size * repeat);
             log << std::right << std::setw(12) << t1 << " B/s ";
+            t = test::timer();
             for(std::size_t j = 0; j < repeat; ++j)
                 out = doInflateZLib(in1);
             BEAST_EXPECT(out == c1);
@@ -194,7 +195,7 @@ public:
                 test::throughput(t.elapsed(), size * repeat);
             log << std::right << std::setw(12) << t2 << " B/s";
             log << std::right << std::setw(12) <<
-                unsigned(double(t1)*100/t2-100) << "%";
+                int(double(t1)*100/t2-100) << "%";
             log << std::endl;
         }
         for(std::size_t i = 0; i < trials; ++i)
@@ -208,6 +209,7 @@ public:
             auto const t1 =
                 test::throughput(t.elapsed(), size * scale * repeat);
             log << std::right << std::setw(12) << t1 << " B/s ";
+            t = test::timer();
             for(std::size_t j = 0; j < repeat; ++j)
                 out = doInflateZLib(in2);
             BEAST_EXPECT(out == c2);
@@ -215,7 +217,7 @@ public:
                 test::throughput(t.elapsed(), size * scale * repeat);
             log << std::right << std::setw(12) << t2 << " B/s";
             log << std::right << std::setw(12) <<
-                unsigned(double(t1)*100/t2-100) << "%";
+                int(double(t1)*100/t2-100) << "%";
             log << std::endl;
         }
         log << std::endl;
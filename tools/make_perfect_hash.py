@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2016-2019 Vinnie Falco (vinnie dot falco at gmail dot com)
+#
+# Distributed under the Boost Software License, Version 1.0. (See accompanying
+# file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+#
+# Official repository: https://github.com/boostorg/beast
+#
+
+# Generates the lookup tables used by string_to_field and string_to_verb.
+#
+# Usage: make_perfect_hash.py field.txt
+#
+# The digests computed here must match http::detail::perfect_hash in
+# include/boost/beast/http/detail/perfect_hash.hpp exactly. If either
+# the digest or the name lists change, rerun this script and paste
+# the output into http/impl/field.ipp and http/impl/verb.ipp.
+
+import random
+import sys
+
+M64 = (1 << 64) - 1
+FOLD = 0x2020202020202020
+
+# Fields use a hash-and-displace scheme: the top bits of the digest
+# select a bucket, and the bucket's displacement is xor'ed into the
+# low bits to select a slot.
+FIELD_BUCKET_BITS = 7
+FIELD_SLOT_BITS = 9
+
+# Verbs are few enough for a single multiply-shift, and
+# the length and first four bytes already tell them apart.
+VERB_SLOT_BITS = 7
+
+VERBS = [
+    "DELETE", "GET", "HEAD", "POST", "PUT", "CONNECT", "OPTIONS", "TRACE",
+    "COPY", "LOCK", "MKCOL", "MOVE", "PROPFIND", "PROPPATCH", "SEARCH",
+    "UNLOCK", "BIND", "REBIND", "UNBIND", "ACL", "REPORT", "MKACTIVITY",
+    "CHECKOUT", "MERGE", "M-SEARCH", "NOTIFY", "SUBSCRIBE", "UNSUBSCRIBE",
+    "PATCH", "PURGE", "MKCALENDAR", "LINK", "UNLINK",
+]
+
+
+def load_le(p, off, n):
+    v = 0
+    for i in range(n):
+        v |= p[off + i] << (8 * i)
+    return v
+
+
+def digest(s, fold, seed):
+    p = s.encode("latin1")
+    n = len(p)
+    if n >= 8:
+        a, b = load_le(p, 0, 8), load_le(p, n - 8, 8)
+    elif n >= 4:
+        a, b = load_le(p, 0, 4), load_le(p, n - 4, 4)
+    elif n > 0:
+        a, b = p[0] | (p[n // 2] << 8) | (p[n - 1] << 16), 0
+    else:
+        a, b = 0, 0
+    a |= fold
+    b |= fold
+    y = ((a ^ ((n << 58) & M64)) * seed) & M64
+    y = (((y ^ (y >> 29)) + b) * seed) & M64
+    return y ^ (y >> 32)
+
+
+def digest4(s, seed):
+    p = s.encode("latin1")
+    n = len(p)
+    if n >= 4:
+        a = load_le(p, 0, 4)
+    elif n > 0:
+        a = p[0] | (p[n // 2] << 8) | (p[n - 1] << 16)
+    else:
+        a = 0
+    return ((a ^ ((n << 58) & M64)) * seed) & M64
+
+
+def make_fields(names, seed):
+    nb = 1 << FIELD_BUCKET_BITS
+    ns = 1 << FIELD_SLOT_BITS
+    xs = [digest(s, FOLD, seed) for s in names]
+    buckets = [[] for _ in range(nb)]
+    for i, x in enumerate(xs):
+        buckets[x >> (64 - FIELD_BUCKET_BITS)].append(i)
+    slot = [0] * ns
+    disp = [0] * nb
+    for b in sorted(range(nb), key=lambda b: -len(buckets[b])):
+        keys = buckets[b]
+        if not keys:
+            continue
+        for d in range(ns):
+            pos = [(xs[i] ^ d) & (ns - 1) for i in keys]
+            if len(set(pos)) == len(pos) and \
+                    all(slot[q] == 0 for q in pos):
+                disp[b] = d
+                for i, q in zip(keys, pos):
+                    slot[q] = i + 1
+                break
+        else:
+            return None
+    return disp, slot
+
+
+def make_verbs(seed):
+    ns = 1 << VERB_SLOT_BITS
+    slot = [0] * ns
+    for i, s in enumerate(VERBS):
+        q = digest4(s, seed) >> (64 - VERB_SLOT_BITS)
+        if slot[q] != 0:
+            return None
+        slot[q] = i + 1
+    return slot
+
+
+def emit(name, ctype, values, width):
+    print("    static {} constexpr {}[{}] = {{".format(
+        ctype, name, len(values)))
+    for i in range(0, len(values), width):
+        row = ", ".join("{:>3}".format(v) for v in values[i:i + width])
+        sep = "," if i + width < len(values) else ""
+        print("        " + row + sep)
+    print("    };")
+
+
+def main():
+    names = sorted(
+        set(l.strip() for l in open(sys.argv[1]) if l.strip()),
+        key=lambda s: s.upper())
+    rnd = random.Random(1)
+    while True:
+        seed = rnd.getrandbits(64) | 1
+        fields = make_fields(names, seed)
+        verbs = make_verbs(seed)
+        if fields and verbs:
+            break
+    print("// seed")
+    print("    static std::uint64_t constexpr seed = 0x{:x};".format(seed))
+    print()
+    print("// field.ipp")
+    emit("disp", "std::uint16_t", fields[0], 12)
+    emit("slot", "std::uint16_t", fields[1], 12)
+    print()
+    print("// verb.ipp")
+    emit("slot", "unsigned char", verbs, 16)
+
+
+if __name__ == "__main__":
+    main()